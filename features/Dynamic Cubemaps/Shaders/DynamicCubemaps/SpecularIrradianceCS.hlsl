@@ -14,6 +14,7 @@ static const float InvNumSamples = 1.0 / float(NumSamples);
 cbuffer SpecularMapFilterSettings : register(b0)
 {
 	float roughness;
+	uint faceOffset;
 };
 
 TextureCube inputTexture : register(t0);
@@ -130,6 +131,7 @@ float3 Lin2sRGB(float3 color)
 
 [numthreads(32, 32, 1)] void main(uint3 ThreadID
 								  : SV_DispatchThreadID) {
+	ThreadID.z += faceOffset;
 	// Make sure we won't write past output when computing higher mipmap levels.
 	uint outputWidth, outputHeight, outputDepth;
 	outputTexture.GetDimensions(outputWidth, outputHeight, outputDepth);
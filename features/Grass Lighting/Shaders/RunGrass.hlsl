@@ -554,7 +554,7 @@ PS_OUTPUT main(PS_INPUT input, bool frontFace
 		} else if (perPassLLF[0].LightsVisualisationMode == 1) {
 			psout.Albedo.xyz = TurboColormap(0);
 		} else {
-			psout.Albedo.xyz = TurboColormap((float)lightCount / 128.0);
+			psout.Albedo.xyz = TurboColormap((float)lightCount / perPassLLF[0].ClusterMaxLights);
 		}
 	} else {
 		psout.Albedo.xyz = color;
@@ -12,8 +12,8 @@ StructuredBuffer<ClusterAABB> clusters : register(t0);
 StructuredBuffer<StructuredLight> lights : register(t1);
 
 RWStructuredBuffer<uint> lightIndexCounter : register(u0);  //1
-RWStructuredBuffer<uint> lightIndexList : register(u1);     //MAX_CLUSTER_LIGHTS * 16^3
-RWStructuredBuffer<LightGrid> lightGrid : register(u2);     //16^3
+RWStructuredBuffer<uint> lightIndexList : register(u1);     //MAX_CLUSTER_LIGHTS * CLUSTER_COUNT
+RWStructuredBuffer<LightGrid> lightGrid : register(u2);     //CLUSTER_COUNT
 
 groupshared StructuredLight sharedLights[GROUP_SIZE];
 
@@ -38,11 +38,13 @@ bool LightIntersectsCluster(StructuredLight light, ClusterAABB cluster, int eyeI
 	}
 
 	uint visibleLightCount = 0;
+	uint candidateLightCount = 0;
 	uint visibleLightIndices[MAX_CLUSTER_LIGHTS];
 
 	uint clusterIndex = groupIndex + GROUP_SIZE * groupId.z;
+	bool validCluster = clusterIndex < CLUSTER_COUNT;
 
-	ClusterAABB cluster = clusters[clusterIndex];
+	ClusterAABB cluster = clusters[min(clusterIndex, CLUSTER_COUNT - 1)];
 
 	uint lightOffset = 0;
 	uint lightCount = LightCount;
@@ -61,13 +63,16 @@ bool LightIntersectsCluster(StructuredLight light, ClusterAABB cluster, int eyeI
 		for (uint i = 0; i < batchSize; i++) {
 			StructuredLight light = lights[i];
 
-			if (visibleLightCount < MAX_CLUSTER_LIGHTS && (LightIntersectsCluster(light, cluster)
+			if (validCluster && (LightIntersectsCluster(light, cluster)
 #ifdef VR
-															  || LightIntersectsCluster(light, cluster, 1)
+									|| LightIntersectsCluster(light, cluster, 1)
 #endif  // VR
-																  )) {
-				visibleLightIndices[visibleLightCount] = lightOffset + i;
-				visibleLightCount++;
+										)) {
+				if (visibleLightCount < MAX_CLUSTER_LIGHTS) {
+					visibleLightIndices[visibleLightCount] = lightOffset + i;
+					visibleLightCount++;
+				}
+				candidateLightCount++;
 			}
 		}
 
@@ -76,6 +81,10 @@ bool LightIntersectsCluster(StructuredLight light, ClusterAABB cluster, int eyeI
 
 	GroupMemoryBarrierWithGroupSync();
 
+	// The last group is partially filled when the cluster count is not a multiple of GROUP_SIZE
+	if (!validCluster)
+		return;
+
 	uint offset = 0;
 	InterlockedAdd(lightIndexCounter[0], visibleLightCount, offset);
 
@@ -85,6 +94,7 @@ bool LightIntersectsCluster(StructuredLight light, ClusterAABB cluster, int eyeI
 
 	lightGrid[clusterIndex].offset = offset;
 	lightGrid[clusterIndex].lightCount = visibleLightCount;
+	lightGrid[clusterIndex].candidateCount = candidateLightCount;
 }
 
 //https://www.3dgep.com/forward-plus/#Grid_Frustums_Compute_Shader
@@ -1,10 +1,22 @@
 
 #define GROUP_SIZE (16 * 16 * 4)
-#define MAX_CLUSTER_LIGHTS 128
 
-#define CLUSTER_BUILDING_DISPATCH_SIZE_X 16
-#define CLUSTER_BUILDING_DISPATCH_SIZE_Y 16
-#define CLUSTER_BUILDING_DISPATCH_SIZE_Z 16
+// Grid dimensions and per-cluster capacity are provided by LightLimitFix::SetupClusters
+#ifndef MAX_CLUSTER_LIGHTS
+#	define MAX_CLUSTER_LIGHTS 128
+#endif
+
+#ifndef CLUSTER_BUILDING_DISPATCH_SIZE_X
+#	define CLUSTER_BUILDING_DISPATCH_SIZE_X 16
+#endif
+#ifndef CLUSTER_BUILDING_DISPATCH_SIZE_Y
+#	define CLUSTER_BUILDING_DISPATCH_SIZE_Y 16
+#endif
+#ifndef CLUSTER_BUILDING_DISPATCH_SIZE_Z
+#	define CLUSTER_BUILDING_DISPATCH_SIZE_Z 16
+#endif
+
+#define CLUSTER_COUNT (CLUSTER_BUILDING_DISPATCH_SIZE_X * CLUSTER_BUILDING_DISPATCH_SIZE_Y * CLUSTER_BUILDING_DISPATCH_SIZE_Z)
 
 struct ClusterAABB
 {
@@ -16,7 +28,8 @@ struct LightGrid
 {
 	uint offset;
 	uint lightCount;
-	float pad0[2];
+	uint candidateCount;  // includes lights dropped at MAX_CLUSTER_LIGHTS
+	float pad0;
 };
 
 struct StructuredLight
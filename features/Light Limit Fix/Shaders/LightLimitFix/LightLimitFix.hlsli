@@ -2,7 +2,8 @@ struct LightGrid
 {
 	uint offset;
 	uint lightCount;
-	float pad0[2];
+	uint candidateCount;  // includes lights dropped at MAX_CLUSTER_LIGHTS
+	float pad0;
 };
 
 struct StructuredLight
@@ -24,11 +25,15 @@ struct PerPassLLF
 	float LightsNear;
 	float LightsFar;
 	uint FrameCount;
+	uint ClusterSizeX;
+	uint ClusterSizeY;
+	uint ClusterSizeZ;
+	uint ClusterMaxLights;
 };
 
 StructuredBuffer<StructuredLight> lights : register(t17);
-StructuredBuffer<uint> lightList : register(t18);       //MAX_CLUSTER_LIGHTS * 16^3
-StructuredBuffer<LightGrid> lightGrid : register(t19);  //16^3
+StructuredBuffer<uint> lightList : register(t18);       //ClusterMaxLights * cluster count
+StructuredBuffer<LightGrid> lightGrid : register(t19);  //cluster count
 
 StructuredBuffer<PerPassLLF> perPassLLF : register(t32);
 
@@ -47,11 +52,13 @@ bool GetClusterIndex(in float2 uv, in float z, out uint clusterIndex)
 		return false;
 
 	float clampedZ = clamp(z, perPassLLF[0].LightsNear, perPassLLF[0].LightsFar);
-	uint clusterZ = uint(max((log2(z) - log2(perPassLLF[0].LightsNear)) * 16.0 / log2(perPassLLF[0].LightsFar / perPassLLF[0].LightsNear), 0.0));
-	uint2 clusterDim = ceil(lightingData[0].BufferDim / float2(16, 16));
-	uint3 cluster = uint3(uint2((uv * lightingData[0].BufferDim) / clusterDim), clusterZ);
+	uint3 clusterSize = uint3(perPassLLF[0].ClusterSizeX, perPassLLF[0].ClusterSizeY, perPassLLF[0].ClusterSizeZ);
+	uint clusterZ = uint(max((log2(z) - log2(perPassLLF[0].LightsNear)) * clusterSize.z / log2(perPassLLF[0].LightsFar / perPassLLF[0].LightsNear), 0.0));
+	uint2 clusterDim = ceil(lightingData[0].BufferDim / float2(clusterSize.xy));
+	// z at LightsFar and uv at 1 land one past the last cluster
+	uint3 cluster = min(uint3(uint2((uv * lightingData[0].BufferDim) / clusterDim), clusterZ), clusterSize - 1);
 
-	clusterIndex = cluster.x + (16 * cluster.y) + (16 * 16 * cluster.z);
+	clusterIndex = cluster.x + (clusterSize.x * cluster.y) + (clusterSize.x * clusterSize.y * cluster.z);
 	return true;
 }
 
@@ -111,14 +111,15 @@ float4 SSSSBlurCS(
 	float depthM = DepthTexture[DTid.xy].r;
 	depthM = GetScreenDepth(depthM);
 
-	bool humanProfile = sssAmount > 0.5;
+	// Each profile owns an equal slice of the encoded amount
+	uint profileIndex = min(uint(ceil(sssAmount * ProfileCount)) - 1, ProfileCount - 1);
+	sssAmount = saturate(sssAmount * ProfileCount - profileIndex);
 
-	float2 profile = humanProfile ? HumanProfile.xy : BaseProfile.xy;
-	uint kernelOffset = humanProfile ? SSSS_N_SAMPLES : 0;
+	float2 profile = Profiles[profileIndex].Params.xy;
 
 	// Accumulate center sample, multiplying it with its gaussian weight:
 	float4 colorBlurred = colorM;
-	colorBlurred.rgb *= Kernels[kernelOffset].rgb;
+	colorBlurred.rgb *= Profiles[profileIndex].Kernel[0].rgb;
 
 	// World-space width
 	float distanceToProjectionWindow = 1.0 / tan(0.5 * radians(SSSS_FOVY));
@@ -126,7 +127,7 @@ float4 SSSSBlurCS(
 
 	// Calculate the final step to fetch the surrounding pixels:
 	float2 finalStep = scale * BufferDim * dir;
-	finalStep *= saturate((humanProfile ? (sssAmount.x - 0.5) : sssAmount) * 2.0);
+	finalStep *= sssAmount;
 	finalStep *= profile.x;  // Modulate it using the profile
 	finalStep *= 1.0 / 3.0;  // Divide by 3 as the kernels range from -3 to 3.
 
@@ -151,8 +152,9 @@ float4 SSSSBlurCS(
 	float2x2 identityMatrix = float2x2(1.0, 0.0, 0.0, 1.0);
 
 	// Accumulate the other samples:
-	for (uint i = kernelOffset + 1; i < kernelOffset + SSSS_N_SAMPLES; i++) {
-		float2 offset = Kernels[i].a * finalStep;
+	for (uint i = 1; i < SSSS_N_SAMPLES; i++) {
+		float4 kernel = Profiles[profileIndex].Kernel[i];
+		float2 offset = kernel.a * finalStep;
 
 		// Apply randomized rotation
 		offset = mul(offset, rotationMatrix);
@@ -176,7 +178,7 @@ float4 SSSSBlurCS(
 		color = lerp(color, colorM.rgb, s * s);
 
 		// Accumulate:
-		colorBlurred.rgb += Kernels[i].rgb * color.rgb;
+		colorBlurred.rgb += kernel.rgb * color.rgb;
 	}
 
 	return colorBlurred;
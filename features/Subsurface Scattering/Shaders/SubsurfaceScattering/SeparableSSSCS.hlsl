@@ -13,20 +13,20 @@ RWTexture2D<unorm float4> NormalTexture : register(u1);
 
 struct DiffusionProfile
 {
-	float BlurRadius;
-	float Thickness;
+	float4 Kernel[SSSS_N_SAMPLES];  // rgb weight, a offset
+	float4 Params;                  // x blur radius, y thickness
 };
 
+StructuredBuffer<DiffusionProfile> Profiles : register(t3);
+
 cbuffer PerFrame : register(b0)
 {
-	float4 Kernels[SSSS_N_SAMPLES + SSSS_N_SAMPLES];
-	float4 BaseProfile;
-	float4 HumanProfile;
 	float4 CameraData;
 	float2 BufferDim;
 	float2 RcpBufferDim;
 	uint FrameCount;
 	float SSSS_FOVY;
+	uint ProfileCount;
 };
 
 float GetScreenDepth(float depth)
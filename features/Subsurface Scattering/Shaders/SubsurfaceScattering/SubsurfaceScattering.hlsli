@@ -1,8 +1,9 @@
 struct PerPassSSS
 {
 	uint ValidMaterial;
-	uint IsBeastRace;
-	uint pad0[2];
+	uint ProfileIndex;
+	uint ProfileCount;
+	uint pad0;
 };
 
 StructuredBuffer<PerPassSSS> perPassSSS : register(t36);
\ No newline at end of file
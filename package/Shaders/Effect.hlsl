@@ -666,7 +666,7 @@ PS_OUTPUT main(PS_INPUT input)
 		} else if (perPassLLF[0].LightsVisualisationMode == 1) {
 			psout.Color.xyz = TurboColormap(0.0);
 		} else {
-			psout.Color.xyz = TurboColormap((float)lightCount / 128.0);
+			psout.Color.xyz = TurboColormap((float)lightCount / perPassLLF[0].ClusterMaxLights);
 		}
 	}
 #	endif
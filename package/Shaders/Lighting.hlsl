@@ -2099,7 +2099,7 @@ PS_OUTPUT main(PS_INPUT input, bool frontFace
 		} else if (perPassLLF[0].LightsVisualisationMode == 1) {
 			psout.Albedo.xyz = TurboColormap((float)strictLightData[0].NumStrictLights / 15.0);
 		} else {
-			psout.Albedo.xyz = TurboColormap((float)numClusteredLights / 128.0);
+			psout.Albedo.xyz = TurboColormap((float)numClusteredLights / perPassLLF[0].ClusterMaxLights);
 		}
 	} else {
 		psout.Albedo.xyz = color.xyz - tmpColor.xyz * FrameParams.zzz;
@@ -2197,8 +2197,8 @@ PS_OUTPUT main(PS_INPUT input, bool frontFace
 
 #	if defined(SSS) && defined(SKIN)
 	if (perPassSSS[0].ValidMaterial) {
-		float sssAmount = saturate(baseColor.a) * 0.5;
-		psout.ScreenSpaceNormals.z = perPassSSS[0].IsBeastRace ? sssAmount : sssAmount + 0.5;
+		float sssAmount = saturate(baseColor.a);
+		psout.ScreenSpaceNormals.z = (perPassSSS[0].ProfileIndex + sssAmount) / perPassSSS[0].ProfileCount;
 	}
 #	endif
 
@@ -0,0 +1,136 @@
+#include "Benchmark.h"
+
+#include "Feature.h"
+#include "State.h"
+
+void Benchmark::Start(Config a_config)
+{
+	frames.clear();
+	featureTimes.clear();
+	features.clear();
+	for (auto* feature : Feature::GetFeatureList()) {
+		if (feature->loaded) {
+			features.push_back(feature);
+			feature->drawTime = 0;
+		}
+	}
+
+	for (uint i = 0; i < static_cast<uint>(Config::Total); i++) {
+		frameTimes[i].clear();
+		featureTotals[i].assign(features.size(), 0.0);
+		phaseCompiles[i] = 0;
+		summaries[i] = {};
+	}
+	comparison = {};
+	phase = 0;
+
+	State::GetSingleton()->profileFeatures = true;
+	running = true;
+	BeginPhase(a_config);
+}
+
+void Benchmark::Stop()
+{
+	if (!running)
+		return;
+
+	running = false;
+	State::GetSingleton()->profileFeatures = false;
+	UpdateSummaries();
+}
+
+void Benchmark::BeginPhase(Config a_config)
+{
+	config = a_config;
+	phase++;
+	phaseFrames = 0;
+	shaderCompiles = 0;
+	UpdateSummaries();
+}
+
+void Benchmark::AddFrame(double a_frameTime)
+{
+	if (!running)
+		return;
+
+	const auto configIndex = static_cast<uint>(config);
+	const auto compiles = shaderCompiles.exchange(0);
+	phaseCompiles[configIndex] += compiles;
+
+	const bool warmup = phaseFrames++ < warmupFrames;
+	if (!warmup)
+		frames.push_back({ phase, config, static_cast<float>(a_frameTime), compiles });
+
+	for (std::size_t i = 0; i < features.size(); i++) {
+		const double featureTime = std::exchange(features[i]->drawTime, 0) / 1e6;
+		if (!warmup) {
+			featureTimes.push_back(static_cast<float>(featureTime));
+			featureTotals[configIndex][i] += featureTime;
+		}
+	}
+
+	if (!warmup)
+		frameTimes[configIndex].push_back(a_frameTime);
+}
+
+double Benchmark::GetFeatureCost(Config a_config, std::size_t a_feature) const
+{
+	const auto configIndex = static_cast<uint>(a_config);
+	const auto count = frameTimes[configIndex].size();
+	return count ? featureTotals[configIndex][a_feature] / count : 0.0;
+}
+
+void Benchmark::UpdateSummaries()
+{
+	for (uint i = 0; i < static_cast<uint>(Config::Total); i++)
+		summaries[i] = BenchmarkStats::Summarize(frameTimes[i]);
+	comparison = BenchmarkStats::Compare(GetSummary(Config::User), GetSummary(Config::Test));
+}
+
+bool Benchmark::ExportCSV(const std::string& a_path, const std::string& a_summaryPath) const
+{
+	std::ofstream file(a_path);
+	std::ofstream summaryFile(a_summaryPath);
+	if (!file.is_open() || !summaryFile.is_open()) {
+		logger::warn("Failed to open {} or {} for writing", a_path, a_summaryPath);
+		return false;
+	}
+
+	auto configName = [](Config a_config) { return a_config == Config::Test ? "test" : "user"; };
+
+	file << "phase,config,frame_ms,shader_compiles";
+	for (auto* feature : features)
+		file << std::format(",{}_ms", feature->GetShortName());
+	file << "\n";
+
+	for (std::size_t frame = 0; frame < frames.size(); frame++) {
+		const auto& row = frames[frame];
+		file << std::format("{},{},{:.4f},{}", row.phase, configName(row.config), row.frameTime, row.shaderCompiles);
+		for (std::size_t i = 0; i < features.size(); i++)
+			file << std::format(",{:.4f}", featureTimes[frame * features.size() + i]);
+		file << "\n";
+	}
+
+	const auto& user = GetSummary(Config::User);
+	const auto& test = GetSummary(Config::Test);
+
+	summaryFile << "metric,user,test,delta,delta_low,delta_high\n";
+	summaryFile << std::format("frames,{},{},,,\n", user.count, test.count);
+	auto writeEstimate = [&](std::string_view a_name, const Estimate& a_user, const Estimate& a_test, const Estimate& a_delta) {
+		summaryFile << std::format("{},{:.4f},{:.4f},{:.4f},{:.4f},{:.4f}\n", a_name, a_user.value, a_test.value, a_delta.value, a_delta.low, a_delta.high);
+	};
+	writeEstimate("mean_ms", user.mean, test.mean, comparison.mean);
+	writeEstimate("median_ms", user.median, test.median, comparison.median);
+	writeEstimate("p95_ms", user.p95, test.p95, comparison.p95);
+	writeEstimate("p99_ms", user.p99, test.p99, comparison.p99);
+	summaryFile << std::format("stddev_ms,{:.4f},{:.4f},,,\n", user.standardDeviation, test.standardDeviation);
+	summaryFile << std::format("shader_compiles,{},{},,,\n", GetShaderCompiles(Config::User), GetShaderCompiles(Config::Test));
+	for (std::size_t i = 0; i < features.size(); i++) {
+		const double userCost = GetFeatureCost(Config::User, i);
+		const double testCost = GetFeatureCost(Config::Test, i);
+		summaryFile << std::format("{}_ms,{:.4f},{:.4f},{:.4f},,\n", features[i]->GetShortName(), userCost, testCost, testCost - userCost);
+	}
+
+	logger::info("Exported {} benchmark frames to {} and summary to {}", frames.size(), a_path, a_summaryPath);
+	return true;
+}
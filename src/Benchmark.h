@@ -0,0 +1,74 @@
+#pragma once
+
+#include "BenchmarkStats.h"
+
+struct Feature;
+
+/**
+ * Frame time statistics for the test mode, which alternates between the USER and TEST configs.
+ * Each interval is a phase; its first frames are discarded as warm-up so that shader compilation
+ * and cache misses caused by the switch itself do not skew the comparison.
+ */
+class Benchmark
+{
+public:
+	enum class Config : uint
+	{
+		User,
+		Test,
+		Total
+	};
+
+	using Estimate = BenchmarkStats::Estimate;
+	using Summary = BenchmarkStats::Summary;
+	using Comparison = BenchmarkStats::Comparison;
+
+	uint warmupFrames = 30;
+
+	void Start(Config a_config);
+	void Stop();
+	void BeginPhase(Config a_config);
+
+	// Called once per presented frame
+	void AddFrame(double a_frameTime);
+	void AddShaderCompile() { shaderCompiles++; }
+
+	inline bool IsRunning() const { return running; }
+	inline const Summary& GetSummary(Config a_config) const { return summaries[static_cast<uint>(a_config)]; }
+	inline const Comparison& GetComparison() const { return comparison; }
+	inline uint64_t GetShaderCompiles(Config a_config) const { return phaseCompiles[static_cast<uint>(a_config)]; }
+	double GetFeatureCost(Config a_config, std::size_t a_feature) const;
+	inline const std::vector<Feature*>& GetFeatures() const { return features; }
+
+	/**
+	 * Writes one row per recorded frame to a_path and the summary statistics to a_summaryPath.
+	 */
+	bool ExportCSV(const std::string& a_path, const std::string& a_summaryPath) const;
+
+private:
+	struct Frame
+	{
+		uint phase;
+		Config config;
+		float frameTime;
+		uint shaderCompiles;
+	};
+
+	void UpdateSummaries();
+
+	bool running = false;
+	Config config = Config::User;
+	uint phase = 0;
+	uint phaseFrames = 0;
+
+	std::vector<Frame> frames;
+	std::vector<float> featureTimes;  // frames.size() x features.size(), milliseconds
+	std::vector<Feature*> features;
+	std::vector<double> frameTimes[static_cast<uint>(Config::Total)];
+	std::vector<double> featureTotals[static_cast<uint>(Config::Total)];
+	uint64_t phaseCompiles[static_cast<uint>(Config::Total)]{};
+	std::atomic<uint> shaderCompiles = 0;
+
+	Summary summaries[static_cast<uint>(Config::Total)];
+	Comparison comparison;
+};
@@ -0,0 +1,78 @@
+#include "BenchmarkStats.h"
+
+namespace BenchmarkStats
+{
+	static constexpr double Z_95 = 1.96;
+
+	Estimate Percentile(std::span<const double> a_sorted, double a_percentile)
+	{
+		if (a_sorted.empty())
+			return {};
+
+		const auto count = a_sorted.size();
+		const double position = a_percentile * (count - 1);
+		const auto index = static_cast<std::size_t>(position);
+		const double fraction = position - index;
+
+		Estimate result;
+		result.value = index + 1 < count ? std::lerp(a_sorted[index], a_sorted[index + 1], fraction) : a_sorted[index];
+
+		// 1-based ranks bounding the percentile, from the normal approximation of the binomial distribution
+		const double center = a_percentile * count;
+		const double spread = Z_95 * std::sqrt(count * a_percentile * (1.0 - a_percentile));
+		const double lowRank = std::floor(center - spread);
+		const double highRank = std::ceil(center + spread) + 1.0;
+		result.low = std::min(a_sorted[static_cast<std::size_t>(std::clamp(lowRank, 1.0, static_cast<double>(count))) - 1], result.value);
+		result.high = std::max(a_sorted[static_cast<std::size_t>(std::clamp(highRank, 1.0, static_cast<double>(count))) - 1], result.value);
+		return result;
+	}
+
+	Summary Summarize(std::span<const double> a_samples)
+	{
+		Summary result;
+		result.count = a_samples.size();
+		if (!result.count)
+			return result;
+
+		std::vector<double> sorted(a_samples.begin(), a_samples.end());
+		std::ranges::sort(sorted);
+
+		double sum = 0.0;
+		for (auto sample : sorted)
+			sum += sample;
+		const double mean = sum / result.count;
+
+		double squares = 0.0;
+		for (auto sample : sorted)
+			squares += (sample - mean) * (sample - mean);
+		result.standardDeviation = result.count > 1 ? std::sqrt(squares / (result.count - 1)) : 0.0;
+
+		const double margin = Z_95 * result.standardDeviation / std::sqrt(static_cast<double>(result.count));
+		result.mean = { mean, mean - margin, mean + margin };
+		result.median = Percentile(sorted, 0.5);
+		result.p95 = Percentile(sorted, 0.95);
+		result.p99 = Percentile(sorted, 0.99);
+		return result;
+	}
+
+	Comparison Compare(const Summary& a_user, const Summary& a_test)
+	{
+		Comparison result;
+		if (!a_user.count || !a_test.count)
+			return result;
+
+		// Welch's interval for the difference of means
+		const double difference = a_test.mean.value - a_user.mean.value;
+		const double error = std::sqrt(a_user.standardDeviation * a_user.standardDeviation / a_user.count + a_test.standardDeviation * a_test.standardDeviation / a_test.count);
+		result.mean = { difference, difference - Z_95 * error, difference + Z_95 * error };
+
+		// Percentile intervals are combined conservatively
+		auto compare = [](const Estimate& a_userEstimate, const Estimate& a_testEstimate) {
+			return Estimate{ a_testEstimate.value - a_userEstimate.value, a_testEstimate.low - a_userEstimate.high, a_testEstimate.high - a_userEstimate.low };
+		};
+		result.median = compare(a_user.median, a_test.median);
+		result.p95 = compare(a_user.p95, a_test.p95);
+		result.p99 = compare(a_user.p99, a_test.p99);
+		return result;
+	}
+}
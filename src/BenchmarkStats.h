@@ -0,0 +1,49 @@
+#pragma once
+
+/**
+ * Frame time statistics behind the test mode benchmark, kept free of game types.
+ */
+namespace BenchmarkStats
+{
+	// A point estimate with its 95% confidence interval
+	struct Estimate
+	{
+		double value = 0.0;
+		double low = 0.0;
+		double high = 0.0;
+	};
+
+	struct Summary
+	{
+		std::size_t count = 0;
+		Estimate mean;
+		double standardDeviation = 0.0;
+		Estimate median;
+		Estimate p95;
+		Estimate p99;
+	};
+
+	// Test minus user for each statistic of Summary
+	struct Comparison
+	{
+		Estimate mean;
+		Estimate median;
+		Estimate p95;
+		Estimate p99;
+	};
+
+	/**
+	 * Mean with a normal-approximation interval, percentiles with distribution-free order statistic intervals.
+	 * Frame times are autocorrelated, so the intervals are optimistic for short phases.
+	 */
+	Summary Summarize(std::span<const double> a_samples);
+
+	/**
+	 * @brief Percentile of sorted samples, linearly interpolated between the samples at 0-based positions p * (count - 1).
+	 * The interval spans the 1-based ranks floor(np - z * sqrt(np(1 - p))) to ceil(np + z * sqrt(np(1 - p))) + 1,
+	 * clamped to the samples, so for 1..100 the median is 50.5 with an interval of [40, 61].
+	 */
+	Estimate Percentile(std::span<const double> a_sorted, double a_percentile);
+
+	Comparison Compare(const Summary& a_user, const Summary& a_test);
+}
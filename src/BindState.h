@@ -0,0 +1,95 @@
+#pragma once
+
+#include <bitset>
+
+struct ID3D11Buffer;
+struct ID3D11ShaderResourceView;
+
+/**
+ * Shadow copy of the binds features issue every draw, so binds that are already current are skipped.
+ * Context is ID3D11DeviceContext in the plugin. Anything with the same bind methods works, so the filter
+ * can also run against a context that records the binds outside the game.
+ */
+template <class Context>
+class BindState
+{
+public:
+	static constexpr uint32_t ShaderResourceSlotCount = 128;  // D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT
+	static constexpr uint32_t ConstantBufferSlotCount = 14;   // D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT
+
+	void SetPSShaderResources(Context& a_context, uint32_t a_slot, uint32_t a_count, ID3D11ShaderResourceView* const* a_views)
+	{
+		if (Filter(psShaderResources, a_slot, a_count, a_views))
+			a_context.PSSetShaderResources(a_slot, a_count, a_views);
+	}
+
+	void SetVSConstantBuffers(Context& a_context, uint32_t a_slot, uint32_t a_count, ID3D11Buffer* const* a_buffers)
+	{
+		if (Filter(vsConstantBuffers, a_slot, a_count, a_buffers))
+			a_context.VSSetConstantBuffers(a_slot, a_count, a_buffers);
+	}
+
+	void SetPSConstantBuffers(Context& a_context, uint32_t a_slot, uint32_t a_count, ID3D11Buffer* const* a_buffers)
+	{
+		if (Filter(psConstantBuffers, a_slot, a_count, a_buffers))
+			a_context.PSSetConstantBuffers(a_slot, a_count, a_buffers);
+	}
+
+	/** Forgets every shadowed slot, the next bind to each is issued. */
+	void Invalidate()
+	{
+		psShaderResources.known.reset();
+		vsConstantBuffers.known.reset();
+		psConstantBuffers.known.reset();
+	}
+
+	/** Invalidates the shadow and moves this frame's counts to the last frame ones. */
+	void EndFrame()
+	{
+		Invalidate();
+		lastFrameIssued = std::exchange(issued, 0);
+		lastFrameSkipped = std::exchange(skipped, 0);
+	}
+
+	uint64_t issued = 0;
+	uint64_t skipped = 0;
+	uint64_t lastFrameIssued = 0;
+	uint64_t lastFrameSkipped = 0;
+
+private:
+	template <class T, size_t N>
+	struct BoundSlots
+	{
+		T* values[N]{};
+		std::bitset<N> known;
+
+		// Returns false if every slot in the range already holds a_values
+		bool Update(uint32_t a_slot, uint32_t a_count, T* const* a_values)
+		{
+			bool changed = false;
+			for (uint32_t i = 0; i < a_count; i++) {
+				if (!known[a_slot + i] || values[a_slot + i] != a_values[i]) {
+					values[a_slot + i] = a_values[i];
+					known[a_slot + i] = true;
+					changed = true;
+				}
+			}
+			return changed;
+		}
+	};
+
+	template <class T, size_t N>
+	bool Filter(BoundSlots<T, N>& a_slots, uint32_t a_slot, uint32_t a_count, T* const* a_values)
+	{
+		if (!a_slots.Update(a_slot, a_count, a_values)) {
+			skipped++;
+			return false;
+		}
+		issued++;
+		return true;
+	}
+
+	BoundSlots<ID3D11ShaderResourceView, ShaderResourceSlotCount> psShaderResources;
+	BoundSlots<ID3D11Buffer, ConstantBufferSlotCount> vsConstantBuffers;
+	BoundSlots<ID3D11Buffer, ConstantBufferSlotCount> psConstantBuffers;
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+/**
+ * Per shader type lists of the handlers whose Draw needs to run for that type, in registration order.
+ * Built once when the handler set changes so the draw hook skips handlers that would return without work.
+ * Handler is Feature in the plugin.
+ */
+template <class Handler, size_t TypeCount>
+class DrawDispatch
+{
+public:
+	/** @brief Rebuilds every list from a_handlers, keeping those a_hasDraw(handler, type) accepts. */
+	template <class Range, class Predicate>
+	void Build(const Range& a_handlers, Predicate&& a_hasDraw)
+	{
+		for (size_t type = 0; type < TypeCount; ++type) {
+			lists[type].clear();
+			for (auto* handler : a_handlers)
+				if (a_hasDraw(handler, type))
+					lists[type].push_back(handler);
+		}
+	}
+
+	inline const std::vector<Handler*>& operator[](size_t a_type) const { return lists[a_type]; }
+
+private:
+	std::array<std::vector<Handler*>, TypeCount> lists;
+};
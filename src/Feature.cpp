@@ -29,7 +29,9 @@ void Feature::Load(json&)
 	ini.SetUnicode();
 	ini.LoadFile(ini_path.c_str());
 	if (auto value = ini.GetValue("Info", "Version")) {
-		REL::Version featureVersion(std::regex_replace(value, std::regex("-"), "."));
+		std::string versionString = value;
+		std::ranges::replace(versionString, '-', '.');
+		REL::Version featureVersion(versionString);
 
 		auto& minimalFeatureVersion = FeatureVersions::FEATURE_MINIMAL_VERSIONS.at(GetShortName());
 
@@ -119,9 +121,12 @@ const std::vector<Feature*>& Feature::GetFeatureList()
 		SubsurfaceScattering::GetSingleton()
 	};
 
-	static std::vector<Feature*> featuresVR(features);
-	std::erase_if(featuresVR, [](Feature* a) {
-		return !a->SupportsVR();
-	});
+	static std::vector<Feature*> featuresVR = [] {
+		std::vector<Feature*> result(features);
+		std::erase_if(result, [](Feature* a) {
+			return !a->SupportsVR();
+		});
+		return result;
+	}();
 	return (REL::Module::IsVR() && !State::GetSingleton()->IsDeveloperMode()) ? featuresVR : features;
 }
\ No newline at end of file
@@ -5,6 +5,7 @@ struct Feature
 	bool loaded = false;
 	std::string version;
 	std::string failedLoadedMessage;
+	uint64_t drawTime = 0;  // nanoseconds spent in Draw while State::profileFeatures is set
 
 	virtual std::string GetName() = 0;
 	virtual std::string GetShortName() = 0;
@@ -22,6 +23,13 @@ struct Feature
 	virtual void Reset() = 0;
 
 	virtual void DrawSettings() = 0;
+	/**
+	 * Whether Draw needs to be called for shaders of a type.
+	 * Queried when building the per-type draw lists, so it must not change at runtime.
+	 * 
+	 * \return true if Draw handles the shader type; else false
+	 */
+	virtual bool HasDraw(RE::BSShader::Type) { return true; }
 	virtual void Draw(const RE::BSShader* shader, const uint32_t descriptor) = 0;
 	virtual void DrawDeferred() {}
 	virtual void DrawPreProcess() {}
@@ -221,6 +221,19 @@ void CloudShadows::Draw(const RE::BSShader* shader, const uint32_t descriptor)
 	}
 }
 
+bool CloudShadows::HasDraw(RE::BSShader::Type shaderType)
+{
+	switch (shaderType) {
+	case RE::BSShader::Type::Sky:
+	case RE::BSShader::Type::Lighting:
+	case RE::BSShader::Type::DistantTree:
+	case RE::BSShader::Type::Grass:
+		return true;
+	default:
+		return false;
+	}
+}
+
 void CloudShadows::Load(json& o_json)
 {
 	if (o_json[GetName()].is_object())
@@ -56,6 +56,7 @@ struct CloudShadows : Feature
 	void CheckResourcesSide(int side);
 	void ModifySky(const RE::BSShader* shader, const uint32_t descriptor);
 	void ModifyLighting();
+	bool HasDraw(RE::BSShader::Type shaderType) override;
 	virtual void Draw(const RE::BSShader* shader, const uint32_t descriptor) override;
 
 	virtual void Load(json& o_json) override;
@@ -1,5 +1,7 @@
 #include "DistantTreeLighting.h"
 
+#include "Features/DistantTreeLighting/TreeLODIni.h"
+
 #include "State.h"
 #include "Util.h"
 
@@ -58,22 +60,37 @@ enum class DistantTreeShaderTechniques
 	Depth = 1,
 };
 
+void DistantTreeLighting::DataLoaded()
+{
+	// Editor IDs are gathered here, only the file reads are moved off the main thread
+	std::vector<std::pair<RE::TESWorldSpace*, std::string>> worldSpaces;
+	for (auto worldSpace : RE::TESDataHandler::GetSingleton()->GetFormArray<RE::TESWorldSpace>()) {
+		if (auto name = worldSpace->GetFormEditorID(); name && *name)
+			worldSpaces.emplace_back(worldSpace, name);
+	}
+
+	std::thread([this, worldSpaces = std::move(worldSpaces)]() {
+		const auto start = std::chrono::steady_clock::now();
+		uint32_t complexCount = 0;
+		for (const auto& [worldSpace, name] : worldSpaces) {
+			const bool complex = TreeLODIni::ReadComplexAtlasTexture("Data", name);
+			complexAtlasTextures.emplace(worldSpace, complex);
+			complexCount += complex;
+		}
+		complexAtlasTexturesLoaded.store(true, std::memory_order_release);
+		logger::info("[Tree LOD Lighting] Read tree LOD metadata of {} worldspaces ({} complex) in {:.1f} ms", worldSpaces.size(), complexCount,
+			std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+	}).detach();
+}
+
 void DistantTreeLighting::ModifyDistantTree(const RE::BSShader*, const uint32_t descriptor)
 {
-	if (auto player = RE::PlayerCharacter::GetSingleton()) {
-		if (auto worldSpace = player->GetWorldspace()) {
-			if (lastWorldSpace != worldSpace) {
-				lastWorldSpace = worldSpace;
-				if (auto name = worldSpace->GetFormEditorID()) {
-					CSimpleIniA ini;
-					ini.SetUnicode();
-					auto path = std::format("Data\\Textures\\Terrain\\{}\\Trees\\{}TreeLOD.ini", name, name);
-					ini.LoadFile(path.c_str());
-					complexAtlasTexture = ini.GetBoolValue("Information", "ComplexAtlasTexture", false);
-				} else {
-					complexAtlasTexture = false;
-				}
-			}
+	auto& frameContext = State::GetSingleton()->GetFrameContext();
+	if (auto worldSpace = frameContext.worldSpace) {
+		if (lastWorldSpace != worldSpace && complexAtlasTexturesLoaded.load(std::memory_order_acquire)) {
+			lastWorldSpace = worldSpace;
+			auto it = complexAtlasTextures.find(worldSpace);
+			complexAtlasTexture = it != complexAtlasTextures.end() && it->second;
 		}
 	}
 
@@ -82,20 +99,13 @@ void DistantTreeLighting::ModifyDistantTree(const RE::BSShader*, const uint32_t
 		PerPass perPassData{};
 		ZeroMemory(&perPassData, sizeof(perPassData));
 
-		auto& shaderState = RE::BSShaderManager::State::GetSingleton();
-		RE::NiTransform& dalcTransform = shaderState.directionalAmbientTransform;
-
-		Util::StoreTransform3x4NoScale(perPassData.DirectionalAmbient, dalcTransform);
+		perPassData.DirectionalAmbient = frameContext.directionalAmbient;
 
 		auto accumulator = RE::BSGraphics::BSShaderAccumulator::GetCurrentAccumulator();
 
 		auto sunLight = skyrim_cast<RE::NiDirectionalLight*>(accumulator->GetRuntimeData().activeShadowSceneNode->GetRuntimeData().sunLight->light.get());
 		if (sunLight) {
-			auto imageSpaceManager = RE::ImageSpaceManager::GetSingleton();
-			auto sunlightScale = !REL::Module::IsVR() ? imageSpaceManager->GetRuntimeData().data.baseData.hdr.sunlightScale :
-			                                            imageSpaceManager->GetVRRuntimeData().data.baseData.hdr.sunlightScale;
-
-			perPassData.DirLightScale = sunlightScale * sunLight->GetLightRuntimeData().fade;
+			perPassData.DirLightScale = frameContext.sunlightScale * sunLight->GetLightRuntimeData().fade;
 
 			perPassData.DirLightColor.x = sunLight->GetLightRuntimeData().diffuse.red;
 			perPassData.DirLightColor.y = sunLight->GetLightRuntimeData().diffuse.green;
@@ -115,11 +125,18 @@ void DistantTreeLighting::ModifyDistantTree(const RE::BSShader*, const uint32_t
 
 		auto context = RE::BSGraphics::Renderer::GetSingleton()->GetRuntimeData().context;
 
+		// The engine's per-geometry buffer changes every draw and is only known to the driver
 		ID3D11Buffer* buffers[2];
 		context->VSGetConstantBuffers(2, 1, buffers);  // buffers[0]
+		if (buffers[0])
+			buffers[0]->Release();
 		buffers[1] = perPass->CB();
-		context->VSSetConstantBuffers(2, ARRAYSIZE(buffers), buffers);
-		context->PSSetConstantBuffers(2, ARRAYSIZE(buffers), buffers);
+
+		// Pixel slot 2 is also set by the engine, so it is always bound
+		auto state = State::GetSingleton();
+		state->SetVSConstantBuffers(3, 1, &buffers[1]);
+		context->PSSetConstantBuffers(2, 1, buffers);
+		state->SetPSConstantBuffers(3, 1, &buffers[1]);
 	}
 }
 
@@ -132,6 +149,16 @@ void DistantTreeLighting::Draw(const RE::BSShader* shader, const uint32_t descri
 	}
 }
 
+bool DistantTreeLighting::HasDraw(RE::BSShader::Type shaderType)
+{
+	switch (shaderType) {
+	case RE::BSShader::Type::DistantTree:
+		return true;
+	default:
+		return false;
+	}
+}
+
 void DistantTreeLighting::Load(json& o_json)
 {
 	if (o_json[GetName()].is_object())
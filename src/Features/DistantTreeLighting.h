@@ -38,11 +38,17 @@ struct DistantTreeLighting : Feature
 	RE::TESWorldSpace* lastWorldSpace = nullptr;
 	bool complexAtlasTexture = false;
 
+	// ComplexAtlasTexture flag of each worldspace's TreeLOD.ini, filled off-thread once after data load
+	std::unordered_map<RE::TESWorldSpace*, bool> complexAtlasTextures;
+	std::atomic<bool> complexAtlasTexturesLoaded = false;
+
 	virtual void SetupResources();
 	virtual inline void Reset() {}
+	virtual void DataLoaded() override;
 
 	virtual void DrawSettings();
 	void ModifyDistantTree(const RE::BSShader* shader, const uint32_t descriptor);
+	bool HasDraw(RE::BSShader::Type shaderType) override;
 	virtual void Draw(const RE::BSShader* shader, const uint32_t descriptor);
 
 	virtual void Load(json& o_json);
@@ -0,0 +1,18 @@
+#include "Features/DistantTreeLighting/TreeLODIni.h"
+
+namespace TreeLODIni
+{
+	std::filesystem::path GetPath(const std::filesystem::path& a_dataDirectory, std::string_view a_worldSpace)
+	{
+		return a_dataDirectory / "Textures" / "Terrain" / a_worldSpace / "Trees" / (std::string(a_worldSpace) + "TreeLOD.ini");
+	}
+
+	bool ReadComplexAtlasTexture(const std::filesystem::path& a_dataDirectory, std::string_view a_worldSpace)
+	{
+		CSimpleIniA ini;
+		ini.SetUnicode();
+		if (ini.LoadFile(GetPath(a_dataDirectory, a_worldSpace).string().c_str()) < 0)
+			return false;
+		return ini.GetBoolValue("Information", "ComplexAtlasTexture", false);
+	}
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+/**
+ * Reads the TreeLOD.ini that DynDOLOD writes next to each worldspace's tree LOD atlas.
+ */
+namespace TreeLODIni
+{
+	/** @brief Path of a_worldSpace's ini below a_dataDirectory, Textures\Terrain\<worldspace>\Trees\<worldspace>TreeLOD.ini. */
+	std::filesystem::path GetPath(const std::filesystem::path& a_dataDirectory, std::string_view a_worldSpace);
+
+	/**
+	 * @brief Whether the worldspace uses a complex atlas texture, false if its ini is missing or unreadable.
+	 * Sections, keys and booleans are matched without case. Path case is left to the file system, which ignores it in the game.
+	 */
+	bool ReadComplexAtlasTexture(const std::filesystem::path& a_dataDirectory, std::string_view a_worldSpace);
+}
@@ -7,6 +7,13 @@
 
 constexpr auto MIPLEVELS = 10;
 
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(
+	DynamicCubemaps::Settings,
+	MaxThreadGroupsPerFrame,
+	UpdateDistanceThreshold,
+	UpdateAngleThreshold,
+	UpdateTimeThreshold)
+
 void DynamicCubemaps::DrawSettings()
 {
 	if (ImGui::TreeNodeEx("Settings", ImGuiTreeNodeFlags_DefaultOpen)) {
@@ -37,6 +44,35 @@ void DynamicCubemaps::DrawSettings()
 			}
 		}
 
+		if (ImGui::TreeNodeEx("Performance", ImGuiTreeNodeFlags_DefaultOpen)) {
+			ImGui::SliderInt("Max Thread Groups Per Frame", (int*)&settings.MaxThreadGroupsPerFrame, 0, 1024);
+			if (auto _tt = Util::HoverTooltipWrapper()) {
+				ImGui::Text(
+					"Spreads cubemap filtering over several frames, processing faces and mip levels until the budget is spent. "
+					"0 processes a whole step per frame.");
+			}
+
+			ImGui::SliderFloat("Update Distance", &settings.UpdateDistanceThreshold, 0.0f, 256.0f, "%.1f");
+			if (auto _tt = Util::HoverTooltipWrapper()) {
+				ImGui::Text("Camera movement required before the cubemap is captured and filtered again.");
+			}
+
+			ImGui::SliderFloat("Update Angle", &settings.UpdateAngleThreshold, 0.0f, 45.0f, "%.1f");
+			if (auto _tt = Util::HoverTooltipWrapper()) {
+				ImGui::Text("Camera rotation in degrees required before the cubemap is captured and filtered again.");
+			}
+
+			ImGui::SliderFloat("Update Time", &settings.UpdateTimeThreshold, 0.0f, 1.0f, "%.2f");
+			if (auto _tt = Util::HoverTooltipWrapper()) {
+				ImGui::Text("Passed game hours required before the cubemap is captured and filtered again.");
+			}
+
+			ImGui::Text(std::format("Thread Groups Last Frame : {}", threadGroupsLastFrame).c_str());
+			ImGui::Text(std::format("Skipped Updates : {}", skippedUpdates).c_str());
+
+			ImGui::TreePop();
+		}
+
 		if (ImGui::TreeNodeEx("Dynamic Cubemap Creator", ImGuiTreeNodeFlags_DefaultOpen)) {
 			ImGui::Text("You must enable creator mode by adding the shader define CREATOR");
 			ImGui::Checkbox("Enable Creator", &enableCreator);
@@ -139,8 +175,10 @@ RE::BSEventNotifyControl MenuOpenCloseEventHandler::ProcessEvent(const RE::MenuO
 {
 	// When entering a new cell, reset the capture
 	if (a_event->menuName == RE::LoadingMenu::MENU_NAME) {
-		if (!a_event->opening)
+		if (!a_event->opening) {
 			DynamicCubemaps::GetSingleton()->resetCapture = true;
+			DynamicCubemaps::GetSingleton()->environmentChanged = true;
+		}
 	}
 	return RE::BSEventNotifyControl::kContinue;
 }
@@ -281,15 +319,51 @@ void DynamicCubemaps::UpdateCubemapCapture()
 	context->CSSetSamplers(0, 1, &nullSampler);
 }
 
+bool DynamicCubemaps::ShouldUpdateEnvironment()
+{
+	auto state = RE::BSGraphics::RendererShadowState::GetSingleton();
+	auto eyePosition = !REL::Module::IsVR() ?
+	                       state->GetRuntimeData().posAdjust.getEye(0) :
+	                       state->GetVRRuntimeData().posAdjust.getEye(0);
+	float4x4 viewMatrix = !REL::Module::IsVR() ?
+	                          state->GetRuntimeData().cameraData.getEye(0).viewMat :
+	                          state->GetVRRuntimeData().cameraData.getEye(0).viewMat;
+
+	float3 position = { eyePosition.x, eyePosition.y, eyePosition.z };
+	float3 direction = { viewMatrix._13, viewMatrix._23, viewMatrix._33 };
+	direction.Normalize();
+
+	float gameHours = 0.0f;
+	if (auto calendar = RE::Calendar::GetSingleton())
+		gameHours = calendar->GetCurrentGameTime() * 24.0f;
+
+	bool update = environmentChanged ||
+	              float3::Distance(position, lastUpdatePosition) > settings.UpdateDistanceThreshold ||
+	              direction.Dot(lastUpdateDirection) < cos(DirectX::XMConvertToRadians(settings.UpdateAngleThreshold)) ||
+	              abs(gameHours - lastUpdateGameHours) > settings.UpdateTimeThreshold;
+
+	if (update) {
+		environmentChanged = false;
+		lastUpdatePosition = position;
+		lastUpdateDirection = direction;
+		lastUpdateGameHours = gameHours;
+	} else {
+		skippedUpdates++;
+	}
+
+	return update;
+}
+
 void DynamicCubemaps::DrawDeferred()
 {
 	auto shadowSceneNode = RE::BSShaderManager::State::GetSingleton().shadowSceneNode[0];
 	auto accumulator = RE::BSGraphics::BSShaderAccumulator::GetCurrentAccumulator();
 
 	if (shadowSceneNode == accumulator->GetRuntimeData().activeShadowSceneNode) {
-		if (nextTask == NextTask::kCapture) {
+		if (nextTask == NextTask::kCapture && ShouldUpdateEnvironment()) {
 			UpdateCubemapCapture();
 			nextTask = NextTask::kInferrence;
+			taskStep = 0;
 		}
 	}
 }
@@ -309,88 +383,157 @@ void DynamicCubemaps::UpdateCubemap()
 		context->PSSetShaderResources(64, 1, &view);
 	}
 
-	if (nextTask == NextTask::kInferrence) {
-		nextTask = NextTask::kIrradiance;
+	// A budget of 0 keeps one whole step per frame
+	uint budget = settings.MaxThreadGroupsPerFrame ? settings.MaxThreadGroupsPerFrame : UINT_MAX;
+	threadGroupsLastFrame = 0;
 
-		// Infer local reflection information
-		ID3D11UnorderedAccessView* uav = envInferredTexture->uav.get();
+	while (nextTask != NextTask::kCapture && threadGroupsLastFrame < budget) {
+		if (nextTask == NextTask::kInferrence)
+			threadGroupsLastFrame += UpdateInferrence(budget - threadGroupsLastFrame);
+		else
+			threadGroupsLastFrame += UpdateIrradiance(budget - threadGroupsLastFrame);
 
-		context->CSSetUnorderedAccessViews(0, 1, &uav, nullptr);
+		if (!settings.MaxThreadGroupsPerFrame)
+			break;
+	}
+}
 
+uint DynamicCubemaps::UpdateInferrence(uint a_budget)
+{
+	auto renderer = RE::BSGraphics::Renderer::GetSingleton();
+	auto context = renderer->GetRuntimeData().context;
+
+	if (taskStep == 0)
 		context->GenerateMips(envCaptureTexture->srv.get());
 
-		auto& cubemap = renderer->GetRendererData().cubemapRenderTargets[RE::RENDER_TARGETS_CUBEMAP::kREFLECTIONS];
+	const uint groupsX = (envCaptureTexture->desc.Width + 31) / 32;
+	const uint groupsY = (envCaptureTexture->desc.Height + 31) / 32;
+	const uint groupsPerFace = groupsX * groupsY;
+	const uint faces = std::clamp(a_budget / groupsPerFace, 1u, 6u - taskStep);
 
-		ID3D11ShaderResourceView* srvs[2] = { envCaptureTexture->srv.get(), activeReflections ? cubemap.SRV : defaultCubemap };
-		context->CSSetShaderResources(0, 2, srvs);
+	// Infer local reflection information
+	ID3D11UnorderedAccessView* uav = envInferredTexture->uav.get();
 
-		context->CSSetSamplers(0, 1, &computeSampler);
+	context->CSSetUnorderedAccessViews(0, 1, &uav, nullptr);
 
-		context->CSSetShader(activeReflections ? GetComputeShaderInferrenceReflections() : GetComputeShaderInferrence(), nullptr, 0);
+	auto& cubemap = renderer->GetRendererData().cubemapRenderTargets[RE::RENDER_TARGETS_CUBEMAP::kREFLECTIONS];
 
-		context->Dispatch((uint32_t)std::ceil(envCaptureTexture->desc.Width / 32.0f), (uint32_t)std::ceil(envCaptureTexture->desc.Height / 32.0f), 6);
+	ID3D11ShaderResourceView* srvs[2] = { envCaptureTexture->srv.get(), activeReflections ? cubemap.SRV : defaultCubemap };
+	context->CSSetShaderResources(0, 2, srvs);
 
-		srvs[0] = nullptr;
-		srvs[1] = nullptr;
-		context->CSSetShaderResources(0, 2, srvs);
+	context->CSSetSamplers(0, 1, &computeSampler);
 
-		uav = nullptr;
+	InferCubemapCB updateData{};
+	updateData.FaceOffset = taskStep;
+	inferCubemapCB->Update(updateData);
 
-		context->CSSetUnorderedAccessViews(0, 1, &uav, nullptr);
+	ID3D11Buffer* buffer = inferCubemapCB->CB();
+	context->CSSetConstantBuffers(0, 1, &buffer);
 
-		context->CSSetShader(nullptr, 0, 0);
+	context->CSSetShader(activeReflections ? GetComputeShaderInferrenceReflections() : GetComputeShaderInferrence(), nullptr, 0);
 
-		ID3D11SamplerState* sampler = nullptr;
-		context->CSSetSamplers(0, 1, &sampler);
-	} else if (nextTask == NextTask::kIrradiance) {
-		nextTask = NextTask::kCapture;
+	context->Dispatch(groupsX, groupsY, faces);
+
+	srvs[0] = nullptr;
+	srvs[1] = nullptr;
+	context->CSSetShaderResources(0, 2, srvs);
 
+	uav = nullptr;
+
+	context->CSSetUnorderedAccessViews(0, 1, &uav, nullptr);
+
+	buffer = nullptr;
+	context->CSSetConstantBuffers(0, 1, &buffer);
+
+	context->CSSetShader(nullptr, 0, 0);
+
+	ID3D11SamplerState* sampler = nullptr;
+	context->CSSetSamplers(0, 1, &sampler);
+
+	taskStep += faces;
+	if (taskStep == 6) {
+		nextTask = NextTask::kIrradiance;
+		taskStep = 0;
+	}
+
+	return faces * groupsPerFace;
+}
+
+uint DynamicCubemaps::UpdateIrradiance(uint a_budget)
+{
+	auto renderer = RE::BSGraphics::Renderer::GetSingleton();
+	auto context = renderer->GetRuntimeData().context;
+
+	if (taskStep == 0) {
 		// Copy cubemap to other resources
 		for (uint face = 0; face < 6; face++) {
 			uint srcSubresourceIndex = D3D11CalcSubresource(0, face, MIPLEVELS);
 			context->CopySubresourceRegion(envTexture->resource.get(), D3D11CalcSubresource(0, face, MIPLEVELS), 0, 0, 0, envInferredTexture->resource.get(), srcSubresourceIndex, nullptr);
 		}
 
-		// Compute pre-filtered specular environment map.
-		{
-			auto srv = envInferredTexture->srv.get();
-			context->GenerateMips(srv);
+		context->GenerateMips(envInferredTexture->srv.get());
+	}
 
-			context->CSSetShaderResources(0, 1, &srv);
-			context->CSSetSamplers(0, 1, &computeSampler);
-			context->CSSetShader(GetComputeShaderSpecularIrradiance(), nullptr, 0);
+	uint dispatched = 0;
 
-			ID3D11Buffer* buffer = spmapCB->CB();
-			context->CSSetConstantBuffers(0, 1, &buffer);
+	// Compute pre-filtered specular environment map, one task step is a single face of a single mip level
+	{
+		auto srv = envInferredTexture->srv.get();
 
-			float const delta_roughness = 1.0f / std::max(float(MIPLEVELS - 1), 1.0f);
+		context->CSSetShaderResources(0, 1, &srv);
+		context->CSSetSamplers(0, 1, &computeSampler);
+		context->CSSetShader(GetComputeShaderSpecularIrradiance(), nullptr, 0);
 
-			std::uint32_t size = std::max(envTexture->desc.Width, envTexture->desc.Height);
+		ID3D11Buffer* buffer = spmapCB->CB();
+		context->CSSetConstantBuffers(0, 1, &buffer);
 
-			for (std::uint32_t level = 1; level < MIPLEVELS; level++, size /= 2) {
-				const UINT numGroups = (UINT)std::max(1u, size / 32);
+		float const delta_roughness = 1.0f / std::max(float(MIPLEVELS - 1), 1.0f);
 
-				const SpecularMapFilterSettingsCB spmapConstants = { level * delta_roughness };
-				spmapCB->Update(spmapConstants);
+		const uint totalSteps = 6 * (MIPLEVELS - 1);
 
-				auto uav = uavArray[level - 1];
+		while (taskStep < totalSteps) {
+			const uint level = 1 + taskStep / 6;
+			const uint face = taskStep % 6;
 
-				context->CSSetUnorderedAccessViews(0, 1, &uav, nullptr);
-				context->Dispatch(numGroups, numGroups, 6);
-			}
-		}
+			const uint size = std::max(1u, std::max(envTexture->desc.Width, envTexture->desc.Height) >> level);
+			const uint numGroups = (size + 31) / 32;
+			const uint groupsPerFace = numGroups * numGroups;
 
-		ID3D11ShaderResourceView* nullSRV = { nullptr };
-		ID3D11SamplerState* nullSampler = { nullptr };
-		ID3D11Buffer* nullBuffer = { nullptr };
-		ID3D11UnorderedAccessView* nullUAV = { nullptr };
+			if (dispatched && dispatched + groupsPerFace > a_budget)
+				break;
 
-		context->CSSetShaderResources(0, 1, &nullSRV);
-		context->CSSetSamplers(0, 1, &nullSampler);
-		context->CSSetShader(nullptr, 0, 0);
-		context->CSSetConstantBuffers(0, 1, &nullBuffer);
-		context->CSSetUnorderedAccessViews(0, 1, &nullUAV, nullptr);
+			const uint faces = std::clamp((a_budget - dispatched) / groupsPerFace, 1u, 6u - face);
+
+			const SpecularMapFilterSettingsCB spmapConstants = { level * delta_roughness, face };
+			spmapCB->Update(spmapConstants);
+
+			auto uav = uavArray[level - 1];
+
+			context->CSSetUnorderedAccessViews(0, 1, &uav, nullptr);
+			context->Dispatch(numGroups, numGroups, faces);
+
+			dispatched += faces * groupsPerFace;
+			taskStep += faces;
+		}
+
+		if (taskStep == totalSteps) {
+			nextTask = NextTask::kCapture;
+			taskStep = 0;
+		}
 	}
+
+	ID3D11ShaderResourceView* nullSRV = { nullptr };
+	ID3D11SamplerState* nullSampler = { nullptr };
+	ID3D11Buffer* nullBuffer = { nullptr };
+	ID3D11UnorderedAccessView* nullUAV = { nullptr };
+
+	context->CSSetShaderResources(0, 1, &nullSRV);
+	context->CSSetSamplers(0, 1, &nullSampler);
+	context->CSSetShader(nullptr, 0, 0);
+	context->CSSetConstantBuffers(0, 1, &nullBuffer);
+	context->CSSetUnorderedAccessViews(0, 1, &nullUAV, nullptr);
+
+	return dispatched;
 }
 
 void DynamicCubemaps::Draw(const RE::BSShader* shader, const uint32_t)
@@ -426,6 +569,17 @@ void DynamicCubemaps::Draw(const RE::BSShader* shader, const uint32_t)
 	}
 }
 
+bool DynamicCubemaps::HasDraw(RE::BSShader::Type shaderType)
+{
+	switch (shaderType) {
+	case RE::BSShader::Type::Lighting:
+	case RE::BSShader::Type::Water:
+		return true;
+	default:
+		return false;
+	}
+}
+
 void DynamicCubemaps::SetupResources()
 {
 	GetComputeShaderUpdate();
@@ -497,6 +651,7 @@ void DynamicCubemaps::SetupResources()
 		envInferredTexture->CreateUAV(uavDesc);
 
 		updateCubemapCB = new ConstantBuffer(ConstantBufferDesc<UpdateCubemapCB>());
+		inferCubemapCB = new ConstantBuffer(ConstantBufferDesc<InferCubemapCB>());
 	}
 
 	{
@@ -542,10 +697,12 @@ void DynamicCubemaps::SetupResources()
 
 void DynamicCubemaps::Reset()
 {
+	bool previousReflections = activeReflections;
 	if (auto sky = RE::Sky::GetSingleton())
 		activeReflections = sky->mode.get() == RE::Sky::Mode::kFull;
 	else
 		activeReflections = false;
+	environmentChanged = environmentChanged || previousReflections != activeReflections;
 
 	auto setting = RE::GetINISetting("fCubeMapRefreshRate:Water");
 	setting->data.f = activeReflections ? 0 : FLT_MAX;
@@ -555,13 +712,18 @@ void DynamicCubemaps::Reset()
 
 void DynamicCubemaps::Load(json& o_json)
 {
+	if (o_json[GetName()].is_object())
+		settings = o_json[GetName()];
+
 	Feature::Load(o_json);
 }
 
-void DynamicCubemaps::Save(json&)
+void DynamicCubemaps::Save(json& o_json)
 {
+	o_json[GetName()] = settings;
 }
 
 void DynamicCubemaps::RestoreDefaultSettings()
 {
+	settings = {};
 }
\ No newline at end of file
@@ -28,7 +28,8 @@ public:
 	struct alignas(16) SpecularMapFilterSettingsCB
 	{
 		float roughness;
-		float pad[3];
+		uint faceOffset;
+		float pad[2];
 	};
 
 	ID3D11ComputeShader* specularIrradianceCS = nullptr;
@@ -48,8 +49,15 @@ public:
 	ID3D11ComputeShader* updateCubemapCS = nullptr;
 	ConstantBuffer* updateCubemapCB = nullptr;
 
+	struct alignas(16) InferCubemapCB
+	{
+		uint FaceOffset;
+		uint pad[3];
+	};
+
 	ID3D11ComputeShader* inferCubemapCS = nullptr;
 	ID3D11ComputeShader* inferCubemapReflectionsCS = nullptr;
+	ConstantBuffer* inferCubemapCB = nullptr;
 
 	Texture2D* envCaptureTexture = nullptr;
 	Texture2D* envCaptureRawTexture = nullptr;
@@ -70,6 +78,27 @@ public:
 
 	NextTask nextTask = NextTask::kCapture;
 
+	// Amortized filtering, faces and mip levels are spread over frames
+
+	struct Settings
+	{
+		uint MaxThreadGroupsPerFrame = 128;
+		float UpdateDistanceThreshold = 16.0f;
+		float UpdateAngleThreshold = 2.0f;
+		float UpdateTimeThreshold = 0.05f;
+	};
+
+	Settings settings;
+
+	uint taskStep = 0;
+	bool environmentChanged = true;
+	float3 lastUpdatePosition{};
+	float3 lastUpdateDirection{};
+	float lastUpdateGameHours = 0.0f;
+
+	uint threadGroupsLastFrame = 0;
+	uint skippedUpdates = 0;
+
 	// Editor window
 
 	bool enableCreator = false;
@@ -97,6 +126,7 @@ public:
 	virtual void DrawSettings();
 	virtual void DataLoaded() override;
 
+	bool HasDraw(RE::BSShader::Type shaderType) override;
 	virtual void Draw(const RE::BSShader* shader, const uint32_t descriptor);
 
 	virtual void Load(json& o_json);
@@ -125,6 +155,9 @@ public:
 	ID3D11ComputeShader* GetComputeShaderSpecularIrradiance();
 
 	void UpdateCubemapCapture();
+	bool ShouldUpdateEnvironment();
+	uint UpdateInferrence(uint a_budget);
+	uint UpdateIrradiance(uint a_budget);
 
 	virtual void DrawDeferred();
 
@@ -1,5 +1,6 @@
 #include "ExtendedMaterials.h"
 
+#include "State.h"
 #include "Util.h"
 
 NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(
@@ -138,11 +139,12 @@ void ExtendedMaterials::ModifyLighting(const RE::BSShader*, const uint32_t)
 		context->Unmap(perPass->resource.get(), 0);
 	}
 
+	// Sampler slot 1 is also set by the engine, so it is always bound
 	context->PSSetSamplers(1, 1, &terrainSampler);
 
 	ID3D11ShaderResourceView* views[1]{};
 	views[0] = perPass->srv.get();
-	context->PSSetShaderResources(30, 1, views);
+	State::GetSingleton()->SetPSShaderResources(30, 1, views);
 }
 
 void ExtendedMaterials::Draw(const RE::BSShader* shader, const uint32_t descriptor)
@@ -154,6 +156,16 @@ void ExtendedMaterials::Draw(const RE::BSShader* shader, const uint32_t descript
 	}
 }
 
+bool ExtendedMaterials::HasDraw(RE::BSShader::Type shaderType)
+{
+	switch (shaderType) {
+	case RE::BSShader::Type::Lighting:
+		return true;
+	default:
+		return false;
+	}
+}
+
 void ExtendedMaterials::SetupResources()
 {
 	D3D11_BUFFER_DESC sbDesc{};
@@ -54,6 +54,7 @@ struct ExtendedMaterials : Feature
 	virtual void DrawSettings();
 
 	void ModifyLighting(const RE::BSShader* shader, const uint32_t descriptor);
+	bool HasDraw(RE::BSShader::Type shaderType) override;
 	virtual void Draw(const RE::BSShader* shader, const uint32_t descriptor);
 
 	virtual void Load(json& o_json);
@@ -294,6 +294,16 @@ void GrassCollision::Draw(const RE::BSShader* shader, const uint32_t descriptor)
 	}
 }
 
+bool GrassCollision::HasDraw(RE::BSShader::Type shaderType)
+{
+	switch (shaderType) {
+	case RE::BSShader::Type::Grass:
+		return true;
+	default:
+		return false;
+	}
+}
+
 void GrassCollision::Load(json& o_json)
 {
 	if (o_json[GetName()].is_object())
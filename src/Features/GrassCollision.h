@@ -60,6 +60,7 @@ struct GrassCollision : Feature
 	virtual void DrawSettings();
 	void UpdateCollisions();
 	void ModifyGrass(const RE::BSShader* shader, const uint32_t descriptor);
+	bool HasDraw(RE::BSShader::Type shaderType) override;
 	virtual void Draw(const RE::BSShader* shader, const uint32_t descriptor);
 
 	virtual void Load(json& o_json);
@@ -83,17 +83,12 @@ void GrassLighting::ModifyGrass(const RE::BSShader*, const uint32_t descriptor)
 	const auto technique = descriptor & 0b1111;
 	if (technique != static_cast<uint32_t>(GrassShaderTechniques::RenderDepth)) {
 		if (updatePerFrame) {
-			auto& state = RE::BSShaderManager::State::GetSingleton();
-			RE::NiTransform& dalcTransform = state.directionalAmbientTransform;
-			auto imageSpaceManager = RE::ImageSpaceManager::GetSingleton();
+			auto& frameContext = State::GetSingleton()->GetFrameContext();
 
 			PerFrame perFrameData{};
 			ZeroMemory(&perFrameData, sizeof(perFrameData));
-			Util::StoreTransform3x4NoScale(perFrameData.DirectionalAmbient, dalcTransform);
-
-			perFrameData.SunlightScale = !REL::Module::IsVR() ?
-			                                 imageSpaceManager->GetRuntimeData().data.baseData.hdr.sunlightScale :
-			                                 imageSpaceManager->GetVRRuntimeData().data.baseData.hdr.sunlightScale;
+			perFrameData.DirectionalAmbient = frameContext.directionalAmbient;
+			perFrameData.SunlightScale = frameContext.sunlightScale;
 			perFrameData.Settings = settings;
 			perFrame->Update(perFrameData);
 
@@ -102,11 +97,16 @@ void GrassLighting::ModifyGrass(const RE::BSShader*, const uint32_t descriptor)
 
 		auto context = RE::BSGraphics::Renderer::GetSingleton()->GetRuntimeData().context;
 
+		// The engine's per-geometry buffer changes every draw and is only known to the driver
 		ID3D11Buffer* buffers[2];
 		context->VSGetConstantBuffers(2, 1, buffers);  // buffers[0]
+		if (buffers[0])
+			buffers[0]->Release();
 		buffers[1] = perFrame->CB();
-		context->VSSetConstantBuffers(2, ARRAYSIZE(buffers), buffers);
-		context->PSSetConstantBuffers(3, ARRAYSIZE(buffers), buffers);
+
+		auto state = State::GetSingleton();
+		state->SetVSConstantBuffers(3, 1, &buffers[1]);
+		state->SetPSConstantBuffers(3, ARRAYSIZE(buffers), buffers);
 	}
 }
 
@@ -119,6 +119,16 @@ void GrassLighting::Draw(const RE::BSShader* shader, const uint32_t descriptor)
 	}
 }
 
+bool GrassLighting::HasDraw(RE::BSShader::Type shaderType)
+{
+	switch (shaderType) {
+	case RE::BSShader::Type::Grass:
+		return true;
+	default:
+		return false;
+	}
+}
+
 void GrassLighting::Load(json& o_json)
 {
 	if (o_json[GetName()].is_object())
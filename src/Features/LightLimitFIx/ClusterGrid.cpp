@@ -0,0 +1,39 @@
+#include "Features/LightLimitFix/ClusterGrid.h"
+
+ClusterGridPreset ClusterGridAutoTune::Update(ClusterGridPreset a_current, uint a_lightCount, bool a_overflow)
+{
+	// Clusters dropping lights need a finer grid, whatever the density says
+	if (a_overflow && a_current < ClusterGridPreset::High) {
+		const auto finer = static_cast<ClusterGridPreset>(static_cast<uint>(a_current) + 1);
+		if (finer > minimumPreset) {
+			minimumPreset = finer;
+			minimumLightCount = a_lightCount;
+		} else if (finer == minimumPreset) {
+			minimumLightCount = std::max(minimumLightCount, a_lightCount);
+		}
+	} else if (minimumPreset != ClusterGridPreset::Low && a_lightCount * 2 < minimumLightCount) {
+		minimumPreset = ClusterGridPreset::Low;
+		minimumLightCount = 0;
+	}
+
+	// Density of the previous frame, a change must persist before the grid is rebuilt
+	auto target = ClusterGridPreset::High;
+	if (a_lightCount < 64)
+		target = ClusterGridPreset::Low;
+	else if (a_lightCount < 512)
+		target = ClusterGridPreset::Medium;
+	target = std::max(target, minimumPreset);
+
+	if (target == preset) {
+		frames = 0;
+	} else if (++frames >= SWITCH_FRAMES) {
+		preset = target;
+		frames = 0;
+	}
+	return preset;
+}
+
+void ClusterGridAutoTune::Reset()
+{
+	*this = {};
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+/**
+ * Layout of the light cluster grid, mirroring the Light Limit Fix shaders.
+ * ClusterBuildingCS runs one group per cluster, ClusterCullingCS one thread per cluster in groups of CULLING_GROUP_SIZE,
+ * and GetClusterIndex in LightLimitFix.hlsli maps a pixel to its cluster.
+ */
+struct ClusterGrid
+{
+	static constexpr uint CULLING_GROUP_SIZE = 16 * 16 * 4;  // GROUP_SIZE in Common.hlsli
+
+	struct DispatchSize
+	{
+		uint x;
+		uint y;
+		uint z;
+
+		bool operator==(const DispatchSize&) const = default;
+	};
+
+	// Depth range and render size the clusters are fitted to, from PerPass and LightingData
+	struct View
+	{
+		float lightsNear;
+		float lightsFar;
+		float bufferWidth;
+		float bufferHeight;
+	};
+
+	uint sizeX;
+	uint sizeY;
+	uint sizeZ;
+	uint maxLights;
+
+	constexpr uint Count() const { return sizeX * sizeY * sizeZ; }
+	constexpr uint Index(uint a_x, uint a_y, uint a_z) const { return a_x + sizeX * a_y + sizeX * sizeY * a_z; }
+
+	constexpr DispatchSize BuildingDispatch() const { return { sizeX, sizeY, sizeZ }; }
+	constexpr DispatchSize CullingDispatch() const { return { 1, 1, (Count() + CULLING_GROUP_SIZE - 1) / CULLING_GROUP_SIZE }; }
+
+	/** @return The cluster culled by a thread, Count() or more for the unused threads of the last group */
+	static constexpr uint CullingIndex(uint a_groupIndex, uint a_groupZ) { return a_groupIndex + CULLING_GROUP_SIZE * a_groupZ; }
+
+	/**
+	 * Cluster of a pixel at a_u, a_v with view depth a_z.
+	 * @return false if a_z is outside the lights depth range
+	 */
+	bool GetClusterIndex(const View& a_view, float a_u, float a_v, float a_z, uint& a_index) const
+	{
+		if (a_z < a_view.lightsNear || a_z > a_view.lightsFar)
+			return false;
+
+		const uint clusterZ = static_cast<uint>(std::max((std::log2(a_z) - std::log2(a_view.lightsNear)) * sizeZ / std::log2(a_view.lightsFar / a_view.lightsNear), 0.0f));
+		const uint clusterDimX = static_cast<uint>(std::ceil(a_view.bufferWidth / sizeX));
+		const uint clusterDimY = static_cast<uint>(std::ceil(a_view.bufferHeight / sizeY));
+		const uint clusterX = static_cast<uint>((a_u * a_view.bufferWidth) / clusterDimX);
+		const uint clusterY = static_cast<uint>((a_v * a_view.bufferHeight) / clusterDimY);
+
+		// z at lightsFar and a_u or a_v at 1 land one past the last cluster
+		a_index = Index(std::min(clusterX, sizeX - 1), std::min(clusterY, sizeY - 1), std::min(clusterZ, sizeZ - 1));
+		return true;
+	}
+
+	bool operator==(const ClusterGrid&) const = default;
+};
+
+enum class ClusterGridPreset : uint
+{
+	Low,
+	Medium,
+	High,
+	Total
+};
+
+inline constexpr ClusterGrid ClusterGridPresets[static_cast<uint>(ClusterGridPreset::Total)] = {
+	{ 8, 8, 16, 64 },
+	{ 16, 16, 16, 128 },
+	{ 32, 16, 24, 128 },
+};
+
+/**
+ * Chooses the cluster grid preset from the clustered light count and the overflow seen in cluster readbacks.
+ * A preset must be wanted for SWITCH_FRAMES frames in a row before it is used. Overflow at a preset keeps the grid
+ * finer than that preset until the light count falls well below the count the overflow was seen at, otherwise
+ * the grid would cycle between a preset that overflows and the next finer one.
+ */
+class ClusterGridAutoTune
+{
+public:
+	static constexpr uint SWITCH_FRAMES = 120;
+
+	/**
+	 * @param a_current Preset of the grid the latest readback was taken from
+	 * @param a_overflow Whether that readback had clusters dropping lights
+	 * @return The preset to use
+	 */
+	ClusterGridPreset Update(ClusterGridPreset a_current, uint a_lightCount, bool a_overflow);
+	void Reset();
+
+	inline ClusterGridPreset GetPreset() const { return preset; }
+	inline ClusterGridPreset GetMinimumPreset() const { return minimumPreset; }
+
+private:
+	ClusterGridPreset preset = ClusterGridPreset::Medium;
+	uint frames = 0;
+	ClusterGridPreset minimumPreset = ClusterGridPreset::Low;
+	uint minimumLightCount = 0;  // light count when overflow last raised or confirmed minimumPreset
+};
@@ -0,0 +1,27 @@
+#include "Features/LightLimitFix/ClusterHistogram.h"
+
+ClusterHistogram ClusterHistogram::Reduce(std::span<const Cluster> a_clusters, uint a_maxLights, uint a_indexCount)
+{
+	ClusterHistogram result{};
+	result.clusterCount = static_cast<uint>(a_clusters.size());
+	result.indexCount = a_indexCount;
+	result.indexCapacity = result.clusterCount * a_maxLights;
+
+	for (const auto& cluster : a_clusters) {
+		if (!cluster.lightCount) {
+			result.emptyClusters++;
+			continue;
+		}
+
+		auto bucket = a_maxLights ? (cluster.lightCount - 1) * BUCKET_COUNT / a_maxLights : 0;
+		result.buckets[std::min(bucket, BUCKET_COUNT - 1)]++;
+		result.maxLightCount = std::max(result.maxLightCount, cluster.lightCount);
+
+		if (cluster.candidateCount > cluster.lightCount) {
+			result.overflowingClusters++;
+			result.droppedLights += cluster.candidateCount - cluster.lightCount;
+		}
+	}
+
+	return result;
+}
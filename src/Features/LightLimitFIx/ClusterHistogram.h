@@ -0,0 +1,29 @@
+#pragma once
+
+/**
+ * Occupancy statistics of the light grid written by ClusterCullingCS.
+ */
+struct ClusterHistogram
+{
+	static constexpr uint BUCKET_COUNT = 8;
+
+	// Matches LightLimitFix::LightGrid
+	struct Cluster
+	{
+		uint offset;
+		uint lightCount;
+		uint candidateCount;  // lights intersecting the cluster, including the ones dropped at capacity
+		float pad0;
+	};
+
+	uint clusterCount = 0;
+	uint emptyClusters = 0;
+	uint buckets[BUCKET_COUNT]{};  // non-empty clusters in equal slices of the per-cluster capacity
+	uint overflowingClusters = 0;
+	uint droppedLights = 0;
+	uint maxLightCount = 0;
+	uint indexCount = 0;
+	uint indexCapacity = 0;
+
+	static ClusterHistogram Reduce(std::span<const Cluster> a_clusters, uint a_maxLights, uint a_indexCount);
+};
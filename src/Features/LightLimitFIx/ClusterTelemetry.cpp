@@ -0,0 +1,52 @@
+#include "Features/LightLimitFix/ClusterTelemetry.h"
+
+void ClusterTelemetry::Capture(ID3D11DeviceContext* a_context, ID3D11Buffer* a_lightGrid, ID3D11Buffer* a_lightCounter, uint a_clusterCount, uint a_maxLights)
+{
+	if (clusterCount != a_clusterCount || maxLights != a_maxLights) {
+		Reset();
+		clusterCount = a_clusterCount;
+		maxLights = a_maxLights;
+	}
+
+	// The oldest copy is read first, its buffers are reused for this frame
+	auto& slot = slots[frameIndex % READBACK_LATENCY];
+	frameIndex++;
+
+	if (slot.pending) {
+		D3D11_MAPPED_SUBRESOURCE counter, grid;
+		if (SUCCEEDED(a_context->Map(slot.counter.get(), 0, D3D11_MAP_READ, D3D11_MAP_FLAG_DO_NOT_WAIT, &counter))) {
+			if (SUCCEEDED(a_context->Map(slot.grid.get(), 0, D3D11_MAP_READ, D3D11_MAP_FLAG_DO_NOT_WAIT, &grid))) {
+				histogram = ClusterHistogram::Reduce({ static_cast<const Cluster*>(grid.pData), clusterCount }, maxLights, *static_cast<const uint*>(counter.pData));
+				valid = true;
+				a_context->Unmap(slot.grid.get(), 0);
+			}
+			a_context->Unmap(slot.counter.get(), 0);
+		}
+		slot.pending = false;
+	}
+
+	if (!slot.grid) {
+		auto device = RE::BSGraphics::Renderer::GetSingleton()->GetRuntimeData().forwarder;
+
+		D3D11_BUFFER_DESC desc{};
+		desc.Usage = D3D11_USAGE_STAGING;
+		desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+		desc.ByteWidth = sizeof(Cluster) * clusterCount;
+		DX::ThrowIfFailed(device->CreateBuffer(&desc, nullptr, slot.grid.put()));
+
+		desc.ByteWidth = sizeof(uint);
+		DX::ThrowIfFailed(device->CreateBuffer(&desc, nullptr, slot.counter.put()));
+	}
+
+	a_context->CopyResource(slot.grid.get(), a_lightGrid);
+	a_context->CopyResource(slot.counter.get(), a_lightCounter);
+	slot.pending = true;
+}
+
+void ClusterTelemetry::Reset()
+{
+	for (auto& slot : slots)
+		slot = {};
+	frameIndex = 0;
+	valid = false;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Features/LightLimitFix/ClusterHistogram.h"
+
+/**
+ * Reads back the light grid written by ClusterCullingCS and reduces it to a ClusterHistogram.
+ * The grid and the light index counter are copied into a ring of staging buffers
+ * and read back a few frames later, so the CPU never waits on the GPU.
+ */
+class ClusterTelemetry
+{
+public:
+	static constexpr uint BUCKET_COUNT = ClusterHistogram::BUCKET_COUNT;
+	static constexpr uint READBACK_LATENCY = 3;
+
+	using Cluster = ClusterHistogram::Cluster;
+	using Histogram = ClusterHistogram;
+
+	/**
+	 * Queues a copy of this frame's grid and reduces the copy queued READBACK_LATENCY frames ago, if the GPU is done with it.
+	 */
+	void Capture(ID3D11DeviceContext* a_context, ID3D11Buffer* a_lightGrid, ID3D11Buffer* a_lightCounter, uint a_clusterCount, uint a_maxLights);
+	void Reset();
+
+	inline bool HasHistogram() const { return valid; }
+	inline const Histogram& GetHistogram() const { return histogram; }
+
+private:
+	struct Slot
+	{
+		winrt::com_ptr<ID3D11Buffer> grid;
+		winrt::com_ptr<ID3D11Buffer> counter;
+		bool pending = false;
+	};
+
+	Slot slots[READBACK_LATENCY];
+	uint frameIndex = 0;
+	uint clusterCount = 0;
+	uint maxLights = 0;
+	Histogram histogram{};
+	bool valid = false;
+};
@@ -0,0 +1,192 @@
+#include "Features/LightLimitFix/LightStaging.h"
+
+#include <immintrin.h>
+
+static constexpr uint32_t STREAM_COUNT = static_cast<uint32_t>(LightStaging::Stream::Total);
+static constexpr uint32_t LANE_COUNT = 8;
+
+LightStaging::~LightStaging()
+{
+	if (data)
+		_aligned_free(data);
+}
+
+void LightStaging::Reserve(uint32_t a_capacity)
+{
+	a_capacity = (a_capacity + LANE_COUNT - 1) & ~(LANE_COUNT - 1);
+	if (a_capacity <= capacity)
+		return;
+
+	auto newData = static_cast<float*>(_aligned_malloc(sizeof(float) * STREAM_COUNT * a_capacity, 32));
+	if (data) {
+		for (uint32_t i = 0; i < STREAM_COUNT; i++)
+			memcpy(newData + i * a_capacity, data + i * capacity, sizeof(float) * count);
+		_aligned_free(data);
+	}
+
+	data = newData;
+	capacity = a_capacity;
+	flags.resize(capacity, kNone);
+}
+
+void LightStaging::Add(const Light& a_light)
+{
+	if (count == capacity)
+		Reserve(std::max(capacity * 2, 256u));
+
+	Data(Stream::PositionX)[count] = a_light.position.x;
+	Data(Stream::PositionY)[count] = a_light.position.y;
+	Data(Stream::PositionZ)[count] = a_light.position.z;
+	Data(Stream::OffsetX)[count] = a_light.offset.x;
+	Data(Stream::OffsetY)[count] = a_light.offset.y;
+	Data(Stream::OffsetZ)[count] = a_light.offset.z;
+	Data(Stream::Radius)[count] = a_light.radius;
+	Data(Stream::Red)[count] = a_light.color.x;
+	Data(Stream::Green)[count] = a_light.color.y;
+	Data(Stream::Blue)[count] = a_light.color.z;
+	Data(Stream::FlickerIntensity)[count] = a_light.flickerIntensity;
+	Data(Stream::LightFade)[count] = a_light.lightFade ? 1.0f : 0.0f;
+	flags[count] = a_light.flags;
+	count++;
+}
+
+namespace
+{
+	// Linear fade between start and end, matching the engine's light dimmer
+	struct FadeRange
+	{
+		__m256 start;
+		__m256 scale;
+		bool enabled;
+		bool ramp;
+
+		FadeRange(float a_start, float a_end)
+		{
+			enabled = a_end != 0.0f;
+			ramp = a_end > a_start;
+			start = _mm256_set1_ps(a_start);
+			scale = _mm256_set1_ps(ramp ? 1.0f / (a_end - a_start) : 0.0f);
+		}
+
+		inline __m256 Evaluate(__m256 a_distance) const
+		{
+			const __m256 one = _mm256_set1_ps(1.0f);
+			if (!enabled)
+				return one;
+			if (!ramp)
+				return _mm256_and_ps(_mm256_cmp_ps(a_distance, start, _CMP_LT_OQ), one);
+			__m256 dimmer = _mm256_sub_ps(one, _mm256_mul_ps(_mm256_sub_ps(a_distance, start), scale));
+			return _mm256_max_ps(_mm256_min_ps(dimmer, one), _mm256_setzero_ps());
+		}
+	};
+}
+
+void LightStaging::Process(const View& a_view)
+{
+	if (!count)
+		return;
+
+	// Zero the padding lanes so the last batch stays finite
+	uint32_t paddedCount = (count + LANE_COUNT - 1) & ~(LANE_COUNT - 1);
+	for (uint32_t i = 0; i < static_cast<uint32_t>(Stream::PositionWS); i++)
+		std::fill(data + i * capacity + count, data + i * capacity + paddedCount, 0.0f);
+
+	const FadeRange lightFade(a_view.lightFadeStart, a_view.lightFadeEnd);
+	const float distantLightFadeEnd = a_view.lightsFar * a_view.lightsFar;
+	const FadeRange distantLightFade(distantLightFadeEnd * (a_view.lightFadeStart / a_view.lightFadeEnd), distantLightFadeEnd);
+
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one = _mm256_set1_ps(1.0f);
+	const __m256 threshold = _mm256_set1_ps(1e-4f);
+	const __m256 greyR = _mm256_set1_ps(0.3f);
+	const __m256 greyG = _mm256_set1_ps(0.59f);
+	const __m256 greyB = _mm256_set1_ps(0.11f);
+
+	__m256 eyeOffset[2][3];
+	__m256 viewMatrix[2][4][3];
+	for (uint eyeIndex = 0; eyeIndex < a_view.eyeCount; eyeIndex++) {
+		float3 offset = eyeIndex ? a_view.eyeOffset : float3{};
+		eyeOffset[eyeIndex][0] = _mm256_set1_ps(offset.x);
+		eyeOffset[eyeIndex][1] = _mm256_set1_ps(offset.y);
+		eyeOffset[eyeIndex][2] = _mm256_set1_ps(offset.z);
+		for (uint row = 0; row < 4; row++)
+			for (uint column = 0; column < 3; column++)
+				viewMatrix[eyeIndex][row][column] = _mm256_set1_ps(a_view.viewMatrix[eyeIndex].m[row][column]);
+	}
+
+	float* positionX = Data(Stream::PositionX);
+	float* positionY = Data(Stream::PositionY);
+	float* positionZ = Data(Stream::PositionZ);
+	float* offsetX = Data(Stream::OffsetX);
+	float* offsetY = Data(Stream::OffsetY);
+	float* offsetZ = Data(Stream::OffsetZ);
+	float* radii = Data(Stream::Radius);
+	float* red = Data(Stream::Red);
+	float* green = Data(Stream::Green);
+	float* blue = Data(Stream::Blue);
+	float* flickerIntensity = Data(Stream::FlickerIntensity);
+	float* lightFadeMask = Data(Stream::LightFade);
+	float* grey = Data(Stream::Grey);
+
+	for (uint32_t i = 0; i < paddedCount; i += LANE_COUNT) {
+		__m256 x = _mm256_load_ps(positionX + i);
+		__m256 y = _mm256_load_ps(positionY + i);
+		__m256 z = _mm256_load_ps(positionZ + i);
+		__m256 radius = _mm256_load_ps(radii + i);
+
+		// Squared distance to the light sphere
+		__m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z));
+		distance = _mm256_sub_ps(distance, _mm256_mul_ps(radius, radius));
+
+		__m256 dimmer = distantLightFade.Evaluate(distance);
+		__m256 lightDimmer = _mm256_blendv_ps(one, lightFade.Evaluate(distance), _mm256_cmp_ps(_mm256_load_ps(lightFadeMask + i), zero, _CMP_NEQ_OQ));
+		dimmer = _mm256_mul_ps(dimmer, lightDimmer);
+
+		__m256 r = _mm256_mul_ps(_mm256_load_ps(red + i), dimmer);
+		__m256 g = _mm256_mul_ps(_mm256_load_ps(green + i), dimmer);
+		__m256 b = _mm256_mul_ps(_mm256_load_ps(blue + i), dimmer);
+
+		__m256 visible = _mm256_and_ps(
+			_mm256_cmp_ps(_mm256_add_ps(_mm256_add_ps(r, g), b), threshold, _CMP_GT_OQ),
+			_mm256_cmp_ps(radius, threshold, _CMP_GT_OQ));
+
+		int visibleMask = _mm256_movemask_ps(visible);
+		for (uint32_t lane = 0; lane < LANE_COUNT; lane++)
+			flags[i + lane] = static_cast<uint8_t>((flags[i + lane] & ~kVisible) | ((visibleMask >> lane) & 1 ? kVisible : kNone));
+
+		// Flicker is applied after the visibility test
+		__m256 intensity = _mm256_load_ps(flickerIntensity + i);
+		r = _mm256_max_ps(zero, _mm256_sub_ps(r, intensity));
+		g = _mm256_max_ps(zero, _mm256_sub_ps(g, intensity));
+		b = _mm256_max_ps(zero, _mm256_sub_ps(b, intensity));
+
+		_mm256_store_ps(red + i, r);
+		_mm256_store_ps(green + i, g);
+		_mm256_store_ps(blue + i, b);
+		_mm256_store_ps(grey + i, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r, greyR), _mm256_mul_ps(g, greyG)), _mm256_mul_ps(b, greyB)));
+
+		x = _mm256_add_ps(x, _mm256_load_ps(offsetX + i));
+		y = _mm256_add_ps(y, _mm256_load_ps(offsetY + i));
+		z = _mm256_add_ps(z, _mm256_load_ps(offsetZ + i));
+
+		for (uint eyeIndex = 0; eyeIndex < a_view.eyeCount; eyeIndex++) {
+			__m256 eyeX = _mm256_add_ps(x, eyeOffset[eyeIndex][0]);
+			__m256 eyeY = _mm256_add_ps(y, eyeOffset[eyeIndex][1]);
+			__m256 eyeZ = _mm256_add_ps(z, eyeOffset[eyeIndex][2]);
+
+			float* positionWS = data + (static_cast<uint32_t>(Stream::PositionWS) + eyeIndex * 3) * capacity;
+			_mm256_store_ps(positionWS + i, eyeX);
+			_mm256_store_ps(positionWS + capacity + i, eyeY);
+			_mm256_store_ps(positionWS + capacity * 2 + i, eyeZ);
+
+			// Row-vector transform, identical to DirectX::SimpleMath::Vector3::Transform
+			auto& m = viewMatrix[eyeIndex];
+			float* positionVS = data + (static_cast<uint32_t>(Stream::PositionVS) + eyeIndex * 3) * capacity;
+			for (uint column = 0; column < 3; column++) {
+				__m256 v = _mm256_add_ps(_mm256_mul_ps(eyeX, m[0][column]), _mm256_mul_ps(eyeY, m[1][column]));
+				v = _mm256_add_ps(v, _mm256_add_ps(_mm256_mul_ps(eyeZ, m[2][column]), m[3][column]));
+				_mm256_store_ps(positionVS + capacity * column + i, v);
+			}
+		}
+	}
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+/**
+ * Structure-of-arrays staging area for clustered lights.
+ * Lights are gathered with positions relative to the first eye, then distance fades,
+ * view-space transforms and luminance are evaluated eight lights at a time.
+ * Every stream is 32-byte aligned and padded to a multiple of eight lights.
+ */
+class LightStaging
+{
+public:
+	enum class Stream : uint32_t
+	{
+		PositionX,  // relative to the first eye
+		PositionY,
+		PositionZ,
+		OffsetX,  // flicker movement, applied after fading
+		OffsetY,
+		OffsetZ,
+		Radius,
+		Red,
+		Green,
+		Blue,
+		FlickerIntensity,
+		LightFade,  // 1 if the engine light fade has not been applied yet
+		Grey,
+		PositionWS,                   // xyz per eye
+		PositionVS = PositionWS + 6,  // xyz per eye
+		Total = PositionVS + 6
+	};
+
+	enum Flags : uint8_t
+	{
+		kNone = 0,
+		kFirstPersonShadow = 1 << 0,
+		kParticle = 1 << 1,
+		kVisible = 1 << 2
+	};
+
+	struct Light
+	{
+		float3 position;
+		float radius = 0.0f;
+		float3 color;
+		bool lightFade = false;
+		float3 offset{};
+		float flickerIntensity = 0.0f;
+		uint8_t flags = kNone;
+	};
+
+	struct View
+	{
+		uint eyeCount = 1;
+		float3 eyeOffset{};  // first eye position minus second eye position
+		float4x4 viewMatrix[2];
+		float lightFadeStart = 0.0f;
+		float lightFadeEnd = 0.0f;
+		float lightsFar = 0.0f;
+	};
+
+	LightStaging() = default;
+	LightStaging(const LightStaging&) = delete;
+	LightStaging& operator=(const LightStaging&) = delete;
+	~LightStaging();
+
+	inline void Clear() { count = 0; }
+	void Reserve(uint32_t a_capacity);
+	void Add(const Light& a_light);
+
+	/**
+	 * Evaluates fades, visibility, luminance and world/view-space positions for every staged light.
+	 */
+	void Process(const View& a_view);
+
+	inline uint32_t Size() const { return count; }
+	inline uint8_t GetFlags(uint32_t a_index) const { return flags[a_index]; }
+
+	inline float* Data(Stream a_stream) { return data + static_cast<uint32_t>(a_stream) * capacity; }
+	inline const float* Data(Stream a_stream) const { return data + static_cast<uint32_t>(a_stream) * capacity; }
+	inline const float* Data(Stream a_stream, uint32_t a_eye, uint32_t a_axis) const { return data + (static_cast<uint32_t>(a_stream) + a_eye * 3 + a_axis) * capacity; }
+
+private:
+	float* data = nullptr;
+	eastl::vector<uint8_t> flags;
+	uint32_t count = 0;
+	uint32_t capacity = 0;
+};
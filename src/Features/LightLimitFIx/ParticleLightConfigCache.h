@@ -0,0 +1,77 @@
+#pragma once
+
+// Lowercase file name of a texture path without the directory and ".dds", the key of the particle light config maps
+inline std::string ExtractTextureStem(std::string_view a_path)
+{
+	if (a_path.size() < 1)
+		return {};
+
+	auto lastSeparatorPos = a_path.find_last_of("\\/");
+	if (lastSeparatorPos == std::string::npos)
+		return {};
+
+	a_path = a_path.substr(lastSeparatorPos + 1);
+	if (a_path.size() < 4)
+		return {};
+	a_path.remove_suffix(4);  // Remove ".dds"
+
+	auto textureNameView = a_path | std::views::transform([](char a_char) { return static_cast<char>(::tolower(a_char)); });
+	std::string textureName = { textureNameView.begin(), textureNameView.end() };
+
+	return textureName;
+}
+
+/**
+ * Particle light configs resolved per effect material, so the texture stems are only extracted and looked up once.
+ * Material is RE::BSEffectShaderMaterial and Configs the config pair of LightLimitFix in the plugin.
+ */
+template <class Material, class Configs>
+class ParticleLightConfigCache
+{
+public:
+	static constexpr size_t MAX_ENTRIES = 4096;  // materials come and go with cells, start over rather than track them
+
+	/**
+	 * @brief Returns the configs of a_material, calling a_resolve(a_material) on a miss.
+	 * @param a_configVersion ParticleLights::configVersion, configs hold pointers into its maps so a reload drops every entry
+	 * @param a_sourceTexturePath, a_greyscaleTexturePath Interned texture paths, comparing them also catches freed materials whose address was reused
+	 */
+	template <class Resolve>
+	const std::optional<Configs>& Get(Material* a_material, uint a_configVersion, const char* a_sourceTexturePath, const char* a_greyscaleTexturePath, Resolve&& a_resolve)
+	{
+		if (version != a_configVersion || entries.size() > MAX_ENTRIES) {
+			entries.clear();
+			version = a_configVersion;
+		}
+
+		auto& entry = entries[a_material];
+		if (entry.resolved && entry.sourceTexturePath == a_sourceTexturePath && entry.greyscaleTexturePath == a_greyscaleTexturePath) {
+			hits++;
+		} else {
+			misses++;
+			entry.sourceTexturePath = a_sourceTexturePath;
+			entry.greyscaleTexturePath = a_greyscaleTexturePath;
+			entry.configs = a_resolve(a_material);
+			entry.resolved = true;
+		}
+		return entry.configs;
+	}
+
+	inline size_t GetSize() const { return entries.size(); }
+	inline uint64_t GetHits() const { return hits; }
+	inline uint64_t GetMisses() const { return misses; }
+
+private:
+	struct Entry
+	{
+		const char* sourceTexturePath = nullptr;
+		const char* greyscaleTexturePath = nullptr;
+		bool resolved = false;
+		std::optional<Configs> configs;
+	};
+
+	ankerl::unordered_dense::map<Material*, Entry> entries;
+	uint version = 0;
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+};
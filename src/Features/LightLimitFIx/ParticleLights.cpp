@@ -1,9 +1,22 @@
 #include "Features/LightLimitFix/ParticleLights.h"
 
-#include <numbers>
+namespace
+{
+	constexpr std::string_view SNAPSHOT_PATH = "Data\\SKSE\\Plugins\\CommunityShadersParticleLights.cache";
+}
 
 void ParticleLights::GetConfigs()
 {
+	configVersion++;
+
+	ParticleLightsIni::SnapshotLoader loader(ParticleLightsIni::LoadSnapshot(SNAPSHOT_PATH));
+
+	auto finish = [&]() {
+		logger::info("[LLF] {} particle light inis reused from snapshot, {} parsed", loader.GetReusedCount(), loader.GetParsedCount());
+		if (loader.IsChanged() && !ParticleLightsIni::SaveSnapshot(loader.GetSnapshot(), SNAPSHOT_PATH))
+			logger::warn("[LLF] Failed to write particle lights snapshot");
+	};
+
 	if (std::filesystem::exists("Data\\ParticleLights")) {
 		logger::info("[LLF] Loading particle lights configs");
 
@@ -11,56 +24,22 @@ void ParticleLights::GetConfigs()
 
 		if (configs.empty()) {
 			logger::warn("[LLF] No .ini files were found within the Data\\ParticleLights folder, aborting...");
+			finish();
 			return;
 		}
 
 		logger::info("[LLF] {} matching inis found", configs.size());
 
 		for (auto& path : configs) {
-			logger::info("[LLF] loading ini : {}", path);
-
-			CSimpleIniA ini;
-			ini.SetUnicode();
-			ini.SetMultiKey();
-
-			if (const auto rc = ini.LoadFile(path.c_str()); rc < 0) {
-				logger::error("\t\t[LLF] couldn't read INI");
+			const auto entry = loader.Get(path, false);
+			if (!entry.valid)
 				continue;
-			}
 
-			Config data{};
-			particleLightConfigs.insert({ "default", data });
-
-			data.cull = ini.GetBoolValue("Light", "Cull", false);
-			data.colorMult.red = (float)ini.GetDoubleValue("Light", "ColorMultRed", 1.0);
-			data.colorMult.green = (float)ini.GetDoubleValue("Light", "ColorMultGreen", 1.0);
-			data.colorMult.blue = (float)ini.GetDoubleValue("Light", "ColorMultBlue", 1.0);
-			data.radiusMult = (float)ini.GetDoubleValue("Light", "RadiusMult", 1.0);
-			data.saturationMult = (float)ini.GetDoubleValue("Light", "SaturationMult", 1.0);
-			data.flicker = ini.GetBoolValue("Light", "Flicker", false);
-			data.flickerSpeed = (float)ini.GetDoubleValue("Light", "FlickerSpeed", 1.0);
-			data.flickerIntensity = (float)ini.GetDoubleValue("Light", "FlickerIntensity", 0.0);
-			data.flickerMovement = (float)ini.GetDoubleValue("Light", "FlickerMovement", 0.0) / std::numbers::pi_v<float>;
-
-			auto lastSeparatorPos = path.find_last_of("\\/");
-			if (lastSeparatorPos != std::string::npos) {
-				std::string filename = path.substr(lastSeparatorPos + 1);
-				if (filename.size() < 4) {
-					logger::error("[LLF] Path too short");
-					continue;
-				}
-
-				filename.erase(filename.length() - 4);  // Remove ".ini"
-#pragma warning(push)
-#pragma warning(disable: 4244)
-				std::transform(filename.begin(), filename.end(), filename.begin(), ::tolower);
-#pragma warning(pop)
-
-				logger::debug("[LLF] Inserting {}", filename);
-
-				particleLightConfigs.insert({ filename, data });
-			} else {
-				logger::error("[LLF] Path incomplete");
+			particleLightConfigs.insert({ "default", Config{} });
+
+			if (auto filename = ParticleLightsIni::GetConfigName(path)) {
+				logger::debug("[LLF] Inserting {}", *filename);
+				particleLightConfigs.insert({ *filename, entry.config });
 			}
 		}
 	}
@@ -72,75 +51,23 @@ void ParticleLights::GetConfigs()
 
 		if (configs.empty()) {
 			logger::warn("[LLF] No .ini files were found within the Data\\ParticleLights\\Gradients folder, aborting...");
+			finish();
 			return;
 		}
 
 		logger::info("[LLF] {} matching inis found", configs.size());
 
 		for (auto& path : configs) {
-			logger::info("[LLF] loading ini : {}", path);
-
-			CSimpleIniA ini;
-			ini.SetUnicode();
-			ini.SetMultiKey();
-
-			if (const auto rc = ini.LoadFile(path.c_str()); rc < 0) {
-				logger::error("\t\t[LLF] couldn't read INI");
-				continue;
-			}
-
-			GradientConfig data{};
-			const char* value = nullptr;
-			constexpr std::string_view prefix1 = "0x";
-			constexpr std::string_view prefix2 = "#";
-			constexpr std::string_view cset = "0123456789ABCDEFabcdef";
-
-			value = ini.GetValue("Gradient", "Color");
-			if (value && strcmp(value, "") != 0) {
-				std::string_view str = value;
-
-				if (str.starts_with(prefix1)) {
-					str.remove_prefix(prefix1.size());
-				}
-
-				if (str.starts_with(prefix2)) {
-					str.remove_prefix(prefix2.size());
-				}
-
-				bool matches = std::strspn(str.data(), cset.data()) == str.size();
-
-				if (matches) {
-					uint32_t color = std::stoi(str.data(), 0, 16);
-					data.color = color;
-				} else {
-					logger::error("[LLF] invalid color");
-					continue;
-				}
-			} else {
-				logger::error("[LLF] missing color");
+			const auto entry = loader.Get(path, true);
+			if (!entry.valid)
 				continue;
-			}
 
-			auto lastSeparatorPos = path.find_last_of("\\/");
-			if (lastSeparatorPos != std::string::npos) {
-				std::string filename = path.substr(lastSeparatorPos + 1);
-				if (filename.size() < 4) {
-					logger::error("[LLF] Path too short");
-					continue;
-				}
-
-				filename.erase(filename.length() - 4);  // Remove ".ini"
-#pragma warning(push)
-#pragma warning(disable: 4244)
-				std::transform(filename.begin(), filename.end(), filename.begin(), ::tolower);
-#pragma warning(pop)
-
-				logger::debug("[LLF] Inserting {}", filename);
-
-				particleLightGradientConfigs.insert({ filename, data });
-			} else {
-				logger::error("[LLF] Path incomplete");
+			if (auto filename = ParticleLightsIni::GetConfigName(path)) {
+				logger::debug("[LLF] Inserting {}", *filename);
+				particleLightGradientConfigs.insert({ *filename, entry.gradient });
 			}
 		}
 	}
+
+	finish();
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Features/LightLimitFix/ParticleLightsIni.h"
+
 class ParticleLights
 {
 public:
@@ -15,25 +17,12 @@ public:
 		Normal = 1
 	};
 
-	struct Config
-	{
-		bool cull = false;
-		RE::NiColor colorMult{ 1.0f, 1.0f, 1.0f };
-		float radiusMult = 1.0f;
-		float saturationMult = 1.0f;
-		bool flicker = false;
-		float flickerSpeed = 0.0f;
-		float flickerIntensity = 0.0f;
-		float flickerMovement = 0.0f;
-	};
-
-	struct GradientConfig
-	{
-		RE::NiColor color;
-	};
+	using Config = ParticleLightsIni::Config;
+	using GradientConfig = ParticleLightsIni::GradientConfig;
 
 	ankerl::unordered_dense::map<std::string, Config> particleLightConfigs;
 	ankerl::unordered_dense::map<std::string, GradientConfig> particleLightGradientConfigs;
+	uint configVersion = 0;  // incremented whenever the config maps change
 
 	void GetConfigs();
 };
\ No newline at end of file
@@ -0,0 +1,193 @@
+#include "Features/LightLimitFix/ParticleLightsIni.h"
+
+#include <charconv>
+#include <numbers>
+
+namespace ParticleLightsIni
+{
+	template <class T>
+	static void Write(std::string& a_buffer, const T& a_value)
+	{
+		a_buffer.append(reinterpret_cast<const char*>(&a_value), sizeof(T));
+	}
+
+	template <class T>
+	static bool Read(std::string_view& a_buffer, T& a_value)
+	{
+		if (a_buffer.size() < sizeof(T))
+			return false;
+		memcpy(&a_value, a_buffer.data(), sizeof(T));
+		a_buffer.remove_prefix(sizeof(T));
+		return true;
+	}
+
+	std::optional<std::string> GetConfigName(const std::string& a_path)
+	{
+		auto lastSeparatorPos = a_path.find_last_of("\\/");
+		if (lastSeparatorPos == std::string::npos) {
+			logger::error("[LLF] Path incomplete");
+			return std::nullopt;
+		}
+
+		std::string filename = a_path.substr(lastSeparatorPos + 1);
+		if (filename.size() < 4) {
+			logger::error("[LLF] Path too short");
+			return std::nullopt;
+		}
+
+		filename.erase(filename.length() - 4);  // Remove ".ini"
+		std::ranges::transform(filename, filename.begin(), [](char a_char) { return static_cast<char>(::tolower(a_char)); });
+		return filename;
+	}
+
+	bool ParseConfig(const std::string& a_path, Config& a_data)
+	{
+		logger::info("[LLF] loading ini : {}", a_path);
+
+		CSimpleIniA ini;
+		ini.SetUnicode();
+		ini.SetMultiKey();
+
+		if (const auto rc = ini.LoadFile(a_path.c_str()); rc < 0) {
+			logger::error("\t\t[LLF] couldn't read INI");
+			return false;
+		}
+
+		a_data.cull = ini.GetBoolValue("Light", "Cull", false);
+		a_data.colorMult.red = (float)ini.GetDoubleValue("Light", "ColorMultRed", 1.0);
+		a_data.colorMult.green = (float)ini.GetDoubleValue("Light", "ColorMultGreen", 1.0);
+		a_data.colorMult.blue = (float)ini.GetDoubleValue("Light", "ColorMultBlue", 1.0);
+		a_data.radiusMult = (float)ini.GetDoubleValue("Light", "RadiusMult", 1.0);
+		a_data.saturationMult = (float)ini.GetDoubleValue("Light", "SaturationMult", 1.0);
+		a_data.flicker = ini.GetBoolValue("Light", "Flicker", false);
+		a_data.flickerSpeed = (float)ini.GetDoubleValue("Light", "FlickerSpeed", 1.0);
+		a_data.flickerIntensity = (float)ini.GetDoubleValue("Light", "FlickerIntensity", 0.0);
+		a_data.flickerMovement = (float)ini.GetDoubleValue("Light", "FlickerMovement", 0.0) / std::numbers::pi_v<float>;
+		return true;
+	}
+
+	bool ParseGradient(const std::string& a_path, GradientConfig& a_data)
+	{
+		logger::info("[LLF] loading ini : {}", a_path);
+
+		CSimpleIniA ini;
+		ini.SetUnicode();
+		ini.SetMultiKey();
+
+		if (const auto rc = ini.LoadFile(a_path.c_str()); rc < 0) {
+			logger::error("\t\t[LLF] couldn't read INI");
+			return false;
+		}
+
+		const char* value = nullptr;
+		constexpr std::string_view prefix1 = "0x";
+		constexpr std::string_view prefix2 = "#";
+
+		value = ini.GetValue("Gradient", "Color");
+		if (value && strcmp(value, "") != 0) {
+			std::string_view str = value;
+
+			if (str.starts_with(prefix1)) {
+				str.remove_prefix(prefix1.size());
+			}
+
+			if (str.starts_with(prefix2)) {
+				str.remove_prefix(prefix2.size());
+			}
+
+			// Rejects empty, partial and out of range values, which std::stoi threw on
+			uint32_t color = 0;
+			auto [end, ec] = std::from_chars(str.data(), str.data() + str.size(), color, 16);
+			if (str.empty() || ec != std::errc{} || end != str.data() + str.size()) {
+				logger::error("[LLF] invalid color");
+				return false;
+			}
+			a_data.color = Color::FromHex(color);
+		} else {
+			logger::error("[LLF] missing color");
+			return false;
+		}
+		return true;
+	}
+
+	bool GetFileStamp(const std::string& a_path, uint64_t& a_size, int64_t& a_time)
+	{
+		std::error_code ec;
+		a_size = std::filesystem::file_size(a_path, ec);
+		if (ec)
+			return false;
+		a_time = std::filesystem::last_write_time(a_path, ec).time_since_epoch().count();
+		return !ec;
+	}
+
+	std::string SerializeSnapshot(const Snapshot& a_snapshot)
+	{
+		std::string buffer;
+		Write(buffer, SNAPSHOT_MAGIC);
+		Write(buffer, SNAPSHOT_VERSION);
+		Write(buffer, static_cast<uint32_t>(sizeof(SnapshotEntry)));
+		Write(buffer, static_cast<uint32_t>(a_snapshot.size()));
+		for (const auto& [path, entry] : a_snapshot) {
+			Write(buffer, static_cast<uint32_t>(path.size()));
+			buffer.append(path);
+			Write(buffer, entry);
+		}
+		return buffer;
+	}
+
+	Snapshot DeserializeSnapshot(std::string_view a_data)
+	{
+		Snapshot snapshot;
+		uint32_t magic = 0, version = 0, entrySize = 0, count = 0;
+		if (!Read(a_data, magic) || !Read(a_data, version) || !Read(a_data, entrySize) || !Read(a_data, count) ||
+			magic != SNAPSHOT_MAGIC || version != SNAPSHOT_VERSION || entrySize != sizeof(SnapshotEntry))
+			return snapshot;
+
+		// A corrupt count must not reserve more entries than the data can hold
+		snapshot.reserve(std::min<size_t>(count, a_data.size() / (sizeof(uint32_t) + sizeof(SnapshotEntry))));
+		for (uint32_t i = 0; i < count; i++) {
+			uint32_t pathLength = 0;
+			SnapshotEntry entry;
+			if (!Read(a_data, pathLength) || a_data.size() < pathLength)
+				return {};
+			std::string path{ a_data.substr(0, pathLength) };
+			a_data.remove_prefix(pathLength);
+			if (!Read(a_data, entry))
+				return {};
+			snapshot.insert_or_assign(std::move(path), entry);
+		}
+		return snapshot;
+	}
+
+	Snapshot LoadSnapshot(const std::filesystem::path& a_path)
+	{
+		std::ifstream file(a_path, std::ios::binary);
+		if (!file)
+			return {};
+		std::string data{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+		return DeserializeSnapshot(data);
+	}
+
+	bool SaveSnapshot(const Snapshot& a_snapshot, const std::filesystem::path& a_path)
+	{
+		const auto buffer = SerializeSnapshot(a_snapshot);
+		std::ofstream file(a_path, std::ios::binary | std::ios::trunc);
+		return file && file.write(buffer.data(), buffer.size());
+	}
+
+	SnapshotEntry SnapshotLoader::Get(const std::string& a_path, bool a_gradient)
+	{
+		SnapshotEntry entry;
+		bool stamped = GetFileStamp(a_path, entry.size, entry.time);
+		if (auto it = previous.find(a_path); stamped && it != previous.end() && it->second.size == entry.size && it->second.time == entry.time) {
+			reusedCount++;
+			entry = it->second;
+		} else {
+			parsedCount++;
+			entry.valid = a_gradient ? ParseGradient(a_path, entry.gradient) : ParseConfig(a_path, entry.config);
+		}
+		if (stamped)
+			snapshot.insert_or_assign(a_path, entry);
+		return entry;
+	}
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+/**
+ * Particle light ini parsing and the snapshot that lets GetConfigs skip inis whose size and write time did not change.
+ * Snapshot layout: magic, version, entry size, entry count, then per entry the path length, path and raw SnapshotEntry.
+ */
+namespace ParticleLightsIni
+{
+	struct Color
+	{
+		float red = 0.0f;
+		float green = 0.0f;
+		float blue = 0.0f;
+
+		// Same decoding as RE::NiColor(std::uint32_t), 0xRRGGBB
+		static constexpr Color FromHex(uint32_t a_hex)
+		{
+			return { ((a_hex >> 16) & 0xFF) / 255.0f, ((a_hex >> 8) & 0xFF) / 255.0f, (a_hex & 0xFF) / 255.0f };
+		}
+	};
+
+	struct Config
+	{
+		bool cull = false;
+		Color colorMult{ 1.0f, 1.0f, 1.0f };
+		float radiusMult = 1.0f;
+		float saturationMult = 1.0f;
+		bool flicker = false;
+		float flickerSpeed = 0.0f;
+		float flickerIntensity = 0.0f;
+		float flickerMovement = 0.0f;
+	};
+
+	struct GradientConfig
+	{
+		Color color;
+	};
+
+	constexpr uint32_t SNAPSHOT_MAGIC = 0x43534C50;  // PLSC
+	constexpr uint32_t SNAPSHOT_VERSION = 1;
+
+	// Parsed result of one ini, reused while its size and write time are unchanged
+	struct SnapshotEntry
+	{
+		uint64_t size = 0;
+		int64_t time = 0;
+		bool valid = false;
+		Config config{};
+		GradientConfig gradient{};
+	};
+
+	using Snapshot = ankerl::unordered_dense::map<std::string, SnapshotEntry>;
+
+	/** @brief Lowercase file name of a_path without ".ini", the key of the config maps. */
+	std::optional<std::string> GetConfigName(const std::string& a_path);
+	bool ParseConfig(const std::string& a_path, Config& a_data);
+	bool ParseGradient(const std::string& a_path, GradientConfig& a_data);
+	bool GetFileStamp(const std::string& a_path, uint64_t& a_size, int64_t& a_time);
+
+	std::string SerializeSnapshot(const Snapshot& a_snapshot);
+	/** @brief Returns an empty snapshot if the header does not match this build or the data is truncated. */
+	Snapshot DeserializeSnapshot(std::string_view a_data);
+	Snapshot LoadSnapshot(const std::filesystem::path& a_path);
+	bool SaveSnapshot(const Snapshot& a_snapshot, const std::filesystem::path& a_path);
+
+	/**
+	 * Parses inis through the snapshot of the previous load and collects the snapshot of this one.
+	 * Inis that cannot be stamped are parsed every time and left out of the snapshot.
+	 */
+	class SnapshotLoader
+	{
+	public:
+		explicit SnapshotLoader(Snapshot a_previous) :
+			previous(std::move(a_previous)) {}
+
+		SnapshotEntry Get(const std::string& a_path, bool a_gradient);
+
+		/** @brief Whether the collected snapshot differs from the previous one and needs saving. */
+		inline bool IsChanged() const { return parsedCount || snapshot.size() != previous.size(); }
+		inline const Snapshot& GetSnapshot() const { return snapshot; }
+		inline uint GetParsedCount() const { return parsedCount; }
+		inline uint GetReusedCount() const { return reusedCount; }
+
+	private:
+		Snapshot previous;
+		Snapshot snapshot;
+		uint parsedCount = 0;
+		uint reusedCount = 0;
+	};
+}
@@ -5,13 +5,6 @@
 #include "State.h"
 #include "Util.h"
 
-static constexpr uint CLUSTER_SIZE_X = 16;
-static constexpr uint CLUSTER_SIZE_Y = 16;
-static constexpr uint CLUSTER_SIZE_Z = 16;
-constexpr uint CLUSTER_MAX_LIGHTS = 128;
-
-constexpr std::uint32_t CLUSTER_COUNT = CLUSTER_SIZE_X * CLUSTER_SIZE_Y * CLUSTER_SIZE_Z;
-
 static constexpr uint MAX_LIGHTS = 2048;
 
 NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(
@@ -27,7 +20,9 @@ NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(
 	ParticleBrightness,
 	ParticleRadius,
 	BillboardBrightness,
-	BillboardRadius)
+	BillboardRadius,
+	ClusterGridQuality,
+	EnableClusterGridAutoTune)
 
 void LightLimitFix::DrawSettings()
 {
@@ -111,9 +106,55 @@ void LightLimitFix::DrawSettings()
 		ImGui::TreePop();
 	}
 
+	if (ImGui::TreeNodeEx("Clustering", ImGuiTreeNodeFlags_DefaultOpen)) {
+		static const char* comboOptions[] = { "Low (8x8x16, 64 lights)", "Medium (16x16x16, 128 lights)", "High (32x16x24, 128 lights)" };
+		ImGui::Combo("Cluster Grid", (int*)&settings.ClusterGridQuality, comboOptions, 3);
+		if (auto _tt = Util::HoverTooltipWrapper()) {
+			ImGui::Text(
+				"Number of clusters the view is divided into and the maximum number of lights per cluster. "
+				"Finer grids cull lights more precisely in dense scenes but use more video memory.");
+		}
+
+		ImGui::Checkbox("Auto-Tune Cluster Grid", &settings.EnableClusterGridAutoTune);
+		if (auto _tt = Util::HoverTooltipWrapper()) {
+			ImGui::Text("Picks the cluster grid from the number of clustered lights in the scene, ignoring the setting above.");
+		}
+
+		ImGui::Spacing();
+		ImGui::Spacing();
+		ImGui::TreePop();
+	}
+
 	if (ImGui::TreeNodeEx("Statistics", ImGuiTreeNodeFlags_DefaultOpen)) {
 		ImGui::Text(std::format("Clustered Light Count : {}", lightCount).c_str());
+		ImGui::Text(std::format("Cluster Grid : {}x{}x{}, {} lights per cluster", clusterGrid.sizeX, clusterGrid.sizeY, clusterGrid.sizeZ, clusterGrid.maxLights).c_str());
+
+		if (ImGui::Checkbox("Enable Cluster Telemetry", &enableClusterTelemetry) && !enableClusterTelemetry)
+			clusterTelemetry.Reset();
+		if (auto _tt = Util::HoverTooltipWrapper()) {
+			ImGui::Text("Reads the light grid back from the GPU a few frames late to show how full the clusters are.");
+		}
+
+		if (enableClusterTelemetry && clusterTelemetry.HasHistogram()) {
+			const auto& histogram = clusterTelemetry.GetHistogram();
+			ImGui::Text(std::format("Cluster Occupancy : {} of {} empty, max {} lights", histogram.emptyClusters, histogram.clusterCount, histogram.maxLightCount).c_str());
+			ImGui::Text(std::format("Overflowing Clusters : {} ({} lights dropped)", histogram.overflowingClusters, histogram.droppedLights).c_str());
+			ImGui::Text(std::format("Light Index Usage : {} / {} ({:.1f}%)", histogram.indexCount, histogram.indexCapacity,
+				histogram.indexCapacity ? 100.0 * histogram.indexCount / histogram.indexCapacity : 0.0)
+							.c_str());
+
+			float buckets[ClusterTelemetry::BUCKET_COUNT];
+			for (uint i = 0; i < ClusterTelemetry::BUCKET_COUNT; i++)
+				buckets[i] = static_cast<float>(histogram.buckets[i]);
+			ImGui::PlotHistogram("Occupancy", buckets, ClusterTelemetry::BUCKET_COUNT, 0, "non-empty clusters by fill", 0.0f, FLT_MAX, ImVec2(0, 80));
+		}
 		ImGui::Text(std::format("Particle Lights Detection Count : {}", particleLightsDetectionHits).c_str());
+		ImGui::Text(std::format("Particle Light Config Cache : {} hits, {} misses", particleLightConfigCache.GetHits(), particleLightConfigCache.GetMisses()).c_str());
+		auto vertexColorLookups = vertexColorCacheHits + vertexColorCacheMisses;
+		ImGui::Text(std::format("Vertex Color Cache : {:.1f}% hits, {:.0f} us saved",
+			vertexColorLookups ? 100.0 * vertexColorCacheHits / vertexColorLookups : 0.0,
+			vertexColorScanTimer.count ? vertexColorCacheHits * vertexColorScanTimer.avgTime() / 1000.0 : 0.0)
+						.c_str());
 
 		ImGui::TreePop();
 	}
@@ -158,9 +199,6 @@ void LightLimitFix::SetupResources()
 	}
 
 	{
-		clusterBuildingCS = (ID3D11ComputeShader*)Util::CompileShader(L"Data\\Shaders\\LightLimitFix\\ClusterBuildingCS.hlsl", {}, "cs_5_0");
-		clusterCullingCS = (ID3D11ComputeShader*)Util::CompileShader(L"Data\\Shaders\\LightLimitFix\\ClusterCullingCS.hlsl", {}, "cs_5_0");
-
 		lightBuildingCB = new ConstantBuffer(ConstantBufferDesc<LightBuildingCB>());
 		lightCullingCB = new ConstantBuffer(ConstantBufferDesc<LightCullingCB>());
 	}
@@ -183,7 +221,79 @@ void LightLimitFix::SetupResources()
 		uavDesc.Buffer.FirstElement = 0;
 		uavDesc.Buffer.Flags = 0;
 
-		std::uint32_t numElements = CLUSTER_COUNT;
+		std::uint32_t numElements = 1;
+		sbDesc.StructureByteStride = sizeof(uint32_t);
+		sbDesc.ByteWidth = sizeof(uint32_t) * numElements;
+		lightCounter = eastl::make_unique<Buffer>(sbDesc);
+		srvDesc.Buffer.NumElements = numElements;
+		lightCounter->CreateSRV(srvDesc);
+		uavDesc.Buffer.NumElements = numElements;
+		lightCounter->CreateUAV(uavDesc);
+	}
+
+	{
+		D3D11_BUFFER_DESC sbDesc{};
+		sbDesc.Usage = D3D11_USAGE_DYNAMIC;
+		sbDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+		sbDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+		sbDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+		sbDesc.StructureByteStride = sizeof(LightData);
+		sbDesc.ByteWidth = sizeof(LightData) * MAX_LIGHTS;
+		lights = eastl::make_unique<Buffer>(sbDesc);
+
+		D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc;
+		srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+		srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+		srvDesc.Buffer.FirstElement = 0;
+		srvDesc.Buffer.NumElements = MAX_LIGHTS;
+		lights->CreateSRV(srvDesc);
+	}
+
+	UpdateClusterGrid();
+}
+
+void LightLimitFix::SetupClusters(ClusterGridPreset a_preset)
+{
+	const auto index = static_cast<uint>(a_preset);
+	const auto& grid = ClusterGridPresets[index];
+
+	if (!clusterBuildingShaders[index]) {
+		auto sizeX = std::to_string(grid.sizeX);
+		auto sizeY = std::to_string(grid.sizeY);
+		auto sizeZ = std::to_string(grid.sizeZ);
+		auto maxLights = std::to_string(grid.maxLights);
+		std::vector<std::pair<const char*, const char*>> defines = {
+			{ "CLUSTER_BUILDING_DISPATCH_SIZE_X", sizeX.c_str() },
+			{ "CLUSTER_BUILDING_DISPATCH_SIZE_Y", sizeY.c_str() },
+			{ "CLUSTER_BUILDING_DISPATCH_SIZE_Z", sizeZ.c_str() },
+			{ "MAX_CLUSTER_LIGHTS", maxLights.c_str() }
+		};
+		clusterBuildingShaders[index] = (ID3D11ComputeShader*)Util::CompileShader(L"Data\\Shaders\\LightLimitFix\\ClusterBuildingCS.hlsl", defines, "cs_5_0");
+		clusterCullingShaders[index] = (ID3D11ComputeShader*)Util::CompileShader(L"Data\\Shaders\\LightLimitFix\\ClusterCullingCS.hlsl", defines, "cs_5_0");
+	}
+
+	clusterBuildingCS = clusterBuildingShaders[index];
+	clusterCullingCS = clusterCullingShaders[index];
+
+	{
+		D3D11_BUFFER_DESC sbDesc{};
+		sbDesc.Usage = D3D11_USAGE_DEFAULT;
+		sbDesc.CPUAccessFlags = 0;
+		sbDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
+		sbDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+
+		D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc{};
+		srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+		srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+		srvDesc.Buffer.FirstElement = 0;
+
+		D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc{};
+		uavDesc.Format = DXGI_FORMAT_UNKNOWN;
+		uavDesc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+		uavDesc.Buffer.FirstElement = 0;
+		uavDesc.Buffer.Flags = 0;
+
+		std::uint32_t numElements = grid.Count();
 
 		sbDesc.StructureByteStride = sizeof(ClusterAABB);
 		sbDesc.ByteWidth = sizeof(ClusterAABB) * numElements;
@@ -193,16 +303,7 @@ void LightLimitFix::SetupResources()
 		uavDesc.Buffer.NumElements = numElements;
 		clusters->CreateUAV(uavDesc);
 
-		numElements = 1;
-		sbDesc.StructureByteStride = sizeof(uint32_t);
-		sbDesc.ByteWidth = sizeof(uint32_t) * numElements;
-		lightCounter = eastl::make_unique<Buffer>(sbDesc);
-		srvDesc.Buffer.NumElements = numElements;
-		lightCounter->CreateSRV(srvDesc);
-		uavDesc.Buffer.NumElements = numElements;
-		lightCounter->CreateUAV(uavDesc);
-
-		numElements = CLUSTER_COUNT * CLUSTER_MAX_LIGHTS;
+		numElements = grid.Count() * grid.maxLights;
 		sbDesc.StructureByteStride = sizeof(uint32_t);
 		sbDesc.ByteWidth = sizeof(uint32_t) * numElements;
 		lightList = eastl::make_unique<Buffer>(sbDesc);
@@ -211,7 +312,7 @@ void LightLimitFix::SetupResources()
 		uavDesc.Buffer.NumElements = numElements;
 		lightList->CreateUAV(uavDesc);
 
-		numElements = CLUSTER_COUNT;
+		numElements = grid.Count();
 		sbDesc.StructureByteStride = sizeof(LightGrid);
 		sbDesc.ByteWidth = sizeof(LightGrid) * numElements;
 		lightGrid = eastl::make_unique<Buffer>(sbDesc);
@@ -221,23 +322,27 @@ void LightLimitFix::SetupResources()
 		lightGrid->CreateUAV(uavDesc);
 	}
 
-	{
-		D3D11_BUFFER_DESC sbDesc{};
-		sbDesc.Usage = D3D11_USAGE_DYNAMIC;
-		sbDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-		sbDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-		sbDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
-		sbDesc.StructureByteStride = sizeof(LightData);
-		sbDesc.ByteWidth = sizeof(LightData) * MAX_LIGHTS;
-		lights = eastl::make_unique<Buffer>(sbDesc);
+	clusterGridPreset = a_preset;
+	clusterGrid = grid;
 
-		D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc;
-		srvDesc.Format = DXGI_FORMAT_UNKNOWN;
-		srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
-		srvDesc.Buffer.FirstElement = 0;
-		srvDesc.Buffer.NumElements = MAX_LIGHTS;
-		lights->CreateSRV(srvDesc);
+	logger::info("[LLF] Cluster grid set to {}x{}x{} with {} lights per cluster ({:.1f} MB light list)",
+		grid.sizeX, grid.sizeY, grid.sizeZ, grid.maxLights, grid.Count() * grid.maxLights * sizeof(uint32_t) / (1024.0 * 1024.0));
+}
+
+bool LightLimitFix::UpdateClusterGrid()
+{
+	auto preset = static_cast<ClusterGridPreset>(std::min(settings.ClusterGridQuality, static_cast<uint>(ClusterGridPreset::Total) - 1));
+
+	if (settings.EnableClusterGridAutoTune) {
+		const bool overflow = clusterTelemetry.HasHistogram() && clusterTelemetry.GetHistogram().overflowingClusters;
+		preset = clusterGridAutoTune.Update(clusterGridPreset, lightCount, overflow);
 	}
+
+	if (preset == clusterGridPreset)
+		return false;
+
+	SetupClusters(preset);
+	return true;
 }
 
 void LightLimitFix::Reset()
@@ -431,6 +536,10 @@ void LightLimitFix::Bind()
 			perPassData.EnableContactShadows = settings.EnableContactShadows;
 			perPassData.EnableLightsVisualisation = settings.EnableLightsVisualisation;
 			perPassData.LightsVisualisationMode = settings.LightsVisualisationMode;
+			perPassData.ClusterSizeX = clusterGrid.sizeX;
+			perPassData.ClusterSizeY = clusterGrid.sizeY;
+			perPassData.ClusterSizeZ = clusterGrid.sizeZ;
+			perPassData.ClusterMaxLights = clusterGrid.maxLights;
 
 			D3D11_MAPPED_SUBRESOURCE mapped;
 			DX::ThrowIfFailed(context->Map(perPass->resource.get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped));
@@ -461,25 +570,34 @@ struct VertexPosition
 	std::uint8_t data[3];
 };
 
-std::string ExtractTextureStem(std::string_view a_path)
+std::optional<LightLimitFix::ConfigPair> LightLimitFix::ResolveParticleLightConfigs(RE::BSEffectShaderMaterial* a_material)
 {
-	if (a_path.size() < 1)
-		return {};
-
-	auto lastSeparatorPos = a_path.find_last_of("\\/");
-	if (lastSeparatorPos == std::string::npos)
-		return {};
-
-	a_path = a_path.substr(lastSeparatorPos + 1);
-	a_path.remove_suffix(4);  // Remove ".dds"
-
-#pragma warning(push)
-#pragma warning(disable: 4244)
-	auto textureNameView = a_path | std::views::transform(::tolower);
-	std::string textureName = { textureNameView.begin(), textureNameView.end() };
-#pragma warning(pop)
-
-	return textureName;
+	if (a_material->sourceTexturePath.empty())
+		return std::nullopt;
+
+	std::string textureName = ExtractTextureStem(a_material->sourceTexturePath.c_str());
+	if (textureName.size() < 1)
+		return std::nullopt;
+
+	auto& configs = ParticleLights::GetSingleton()->particleLightConfigs;
+	auto it = configs.find(textureName);
+	if (it == configs.end())
+		return std::nullopt;
+
+	ParticleLights::Config* config = &it->second;
+	ParticleLights::GradientConfig* gradientConfig = nullptr;
+	if (!a_material->greyscaleTexturePath.empty()) {
+		textureName = ExtractTextureStem(a_material->greyscaleTexturePath.c_str());
+		if (textureName.size() < 1)
+			return std::nullopt;
+
+		auto& gradientConfigs = ParticleLights::GetSingleton()->particleLightGradientConfigs;
+		auto itGradient = gradientConfigs.find(textureName);
+		if (itGradient == gradientConfigs.end())
+			return std::nullopt;
+		gradientConfig = &itGradient->second;
+	}
+	return std::make_pair(config, gradientConfig);
 }
 
 std::optional<LightLimitFix::ConfigPair> LightLimitFix::GetParticleLightConfigs(RE::BSRenderPass* a_pass)
@@ -489,31 +607,9 @@ std::optional<LightLimitFix::ConfigPair> LightLimitFix::GetParticleLightConfigs(
 		if (auto shaderProperty = netimmerse_cast<RE::BSEffectShaderProperty*>(a_pass->shaderProperty)) {
 			if (!shaderProperty->lightData) {
 				if (auto material = shaderProperty->GetMaterial()) {
-					if (!material->sourceTexturePath.empty()) {
-						std::string textureName = ExtractTextureStem(material->sourceTexturePath.c_str());
-						if (textureName.size() < 1)
-							return std::nullopt;
-
-						auto& configs = ParticleLights::GetSingleton()->particleLightConfigs;
-						auto it = configs.find(textureName);
-						if (it == configs.end())
-							return std::nullopt;
-
-						ParticleLights::Config* config = &it->second;
-						ParticleLights::GradientConfig* gradientConfig = nullptr;
-						if (!material->greyscaleTexturePath.empty()) {
-							textureName = ExtractTextureStem(material->greyscaleTexturePath.c_str());
-							if (textureName.size() < 1)
-								return std::nullopt;
-
-							auto& gradientConfigs = ParticleLights::GetSingleton()->particleLightGradientConfigs;
-							auto itGradient = gradientConfigs.find(textureName);
-							if (itGradient == gradientConfigs.end())
-								return std::nullopt;
-							gradientConfig = &itGradient->second;
-						}
-						return std::make_pair(config, gradientConfig);
-					}
+					return particleLightConfigCache.Get(material, ParticleLights::GetSingleton()->configVersion,
+						material->sourceTexturePath.data(), material->greyscaleTexturePath.data(),
+						[this](RE::BSEffectShaderMaterial* a_material) { return ResolveParticleLightConfigs(a_material); });
 				}
 			}
 		}
@@ -539,13 +635,6 @@ bool LightLimitFix::AddParticleLight(RE::BSRenderPass* a_pass, LightLimitFix::Co
 	auto config = a_config.first;
 	auto gradientConfig = a_config.second;
 
-	a_pass->geometry->IncRefCount();
-	if (const auto particleSystem = netimmerse_cast<RE::NiParticleSystem*>(a_pass->geometry)) {
-		if (auto particleData = particleSystem->GetParticleRuntimeData().particleData.get()) {
-			particleData->IncRefCount();
-		}
-	}
-
 	RE::NiColorA color;
 	color.red = material->baseColor.red * material->baseColorScale;
 	color.green = material->baseColor.green * material->baseColorScale;
@@ -560,35 +649,61 @@ bool LightLimitFix::AddParticleLight(RE::BSRenderPass* a_pass, LightLimitFix::Co
 
 	if (auto rendererData = a_pass->geometry->GetGeometryRuntimeData().rendererData) {
 		if (auto triShape = a_pass->geometry->AsTriShape()) {
-			uint32_t vertexSize = rendererData->vertexDesc.GetSize();
 			if (rendererData->vertexDesc.HasFlag(RE::BSGraphics::Vertex::Flags::VF_COLORS)) {
-				uint32_t offset = rendererData->vertexDesc.GetAttributeOffset(RE::BSGraphics::Vertex::Attribute::VA_COLOR);
-
-				uint8_t maxAlpha = 0u;
-				VertexColor* vertexColor = nullptr;
-				bool alphaOne = false;
-				bool alphaZero = false;
-
-				for (int v = 0; v < triShape->GetTrishapeRuntimeData().vertexCount; v++) {
-					if (VertexColor* vertex = reinterpret_cast<VertexColor*>(&rendererData->rawVertexData[vertexSize * v + offset])) {
-						uint8_t alpha = vertex->data[3];
-						alphaZero = alphaOne || alpha == 0;
-						alphaOne = alphaOne || alpha == 255;
-						if (alpha > maxAlpha) {
-							maxAlpha = alpha;
-							vertexColor = vertex;
+				auto vertexCount = triShape->GetTrishapeRuntimeData().vertexCount;
+
+				if (vertexColorCache.size() > 4096)
+					vertexColorCache.clear();
+
+				// Vertex colors only change if the renderer data is replaced, so its addresses act as the change stamp
+				auto& entry = vertexColorCache[a_pass->geometry];
+				if (entry.rendererData == rendererData && entry.rawVertexData == rendererData->rawVertexData && entry.vertexCount == vertexCount) {
+					vertexColorCacheHits++;
+				} else {
+					vertexColorCacheMisses++;
+					vertexColorScanTimer.start();
+
+					entry.rendererData = rendererData;
+					entry.rawVertexData = rendererData->rawVertexData;
+					entry.vertexCount = vertexCount;
+					entry.emissive = false;
+
+					uint32_t vertexSize = rendererData->vertexDesc.GetSize();
+					uint32_t offset = rendererData->vertexDesc.GetAttributeOffset(RE::BSGraphics::Vertex::Attribute::VA_COLOR);
+
+					uint8_t maxAlpha = 0u;
+					VertexColor* vertexColor = nullptr;
+					bool alphaOne = false;
+					bool alphaZero = false;
+
+					for (int v = 0; v < vertexCount; v++) {
+						if (VertexColor* vertex = reinterpret_cast<VertexColor*>(&rendererData->rawVertexData[vertexSize * v + offset])) {
+							uint8_t alpha = vertex->data[3];
+							alphaZero = alphaOne || alpha == 0;
+							alphaOne = alphaOne || alpha == 255;
+							if (alpha > maxAlpha) {
+								maxAlpha = alpha;
+								vertexColor = vertex;
+							}
 						}
 					}
+
+					if (vertexColor && alphaZero && alphaOne) {
+						entry.emissive = true;
+						std::copy_n(vertexColor->data, 4, entry.color);
+					}
+
+					vertexColorScanTimer.end();
 				}
 
-				if (!vertexColor || !alphaZero || !alphaOne)
+				if (!entry.emissive)
 					return false;
 
-				color.red *= vertexColor->data[0] / 255.f;
-				color.green *= vertexColor->data[1] / 255.f;
-				color.blue *= vertexColor->data[2] / 255.f;
+				color.red *= entry.color[0] / 255.f;
+				color.green *= entry.color[1] / 255.f;
+				color.blue *= entry.color[2] / 255.f;
 				if (shaderProperty->flags.any(RE::BSShaderProperty::EShaderPropertyFlag::kVertexAlpha)) {
-					color.alpha *= vertexColor->data[3] / 255.f;
+					color.alpha *= entry.color[3] / 255.f;
 				}
 			}
 		}
@@ -605,7 +720,15 @@ bool LightLimitFix::AddParticleLight(RE::BSRenderPass* a_pass, LightLimitFix::Co
 		color.blue *= config->colorMult.blue;
 	}
 
-	queuedParticleLights.insert({ a_pass->geometry, { color, *config } });
+	// Only queued geometry holds a reference, which is released on the next Reset
+	if (queuedParticleLights.insert({ a_pass->geometry, { color, *config } }).second) {
+		a_pass->geometry->IncRefCount();
+		if (const auto particleSystem = netimmerse_cast<RE::NiParticleSystem*>(a_pass->geometry)) {
+			if (auto particleData = particleSystem->GetParticleRuntimeData().particleData.get()) {
+				particleData->IncRefCount();
+			}
+		}
+	}
 	return true;
 }
 
@@ -626,6 +749,19 @@ void LightLimitFix::Draw(const RE::BSShader* shader, const uint32_t)
 	}
 }
 
+bool LightLimitFix::HasDraw(RE::BSShader::Type shaderType)
+{
+	switch (shaderType) {
+	case RE::BSShader::Type::Lighting:
+	case RE::BSShader::Type::Grass:
+	case RE::BSShader::Type::Effect:
+	case RE::BSShader::Type::Water:
+		return true;
+	default:
+		return false;
+	}
+}
+
 void LightLimitFix::PostPostLoad()
 {
 	ParticleLights::GetSingleton()->GetConfigs();
@@ -639,79 +775,6 @@ void LightLimitFix::DataLoaded()
 	logger::info("[LLF] Unlocked magic light limit");
 }
 
-float LightLimitFix::CalculateLightDistance(float3 a_lightPosition, float a_radius)
-{
-	return (a_lightPosition.x * a_lightPosition.x) + (a_lightPosition.y * a_lightPosition.y) + (a_lightPosition.z * a_lightPosition.z) - (a_radius * a_radius);
-}
-
-void LightLimitFix::AddCachedParticleLights(eastl::vector<LightData>& lightsData, LightLimitFix::LightData& light, ParticleLights::Config* a_config, RE::BSGeometry* a_geometry, double a_timer)
-{
-	static float& lightFadeStart = (*(float*)REL::RelocationID(527668, 414582).address());
-	static float& lightFadeEnd = (*(float*)REL::RelocationID(527669, 414583).address());
-
-	float distance = CalculateLightDistance(light.positionWS[0].data, light.radius);
-
-	float dimmer = 0.0f;
-
-	if (distance < lightFadeStart || lightFadeEnd == 0.0f) {
-		dimmer = 1.0f;
-	} else if (distance <= lightFadeEnd) {
-		dimmer = 1.0f - ((distance - lightFadeStart) / (lightFadeEnd - lightFadeStart));
-	} else {
-		dimmer = 0.0f;
-	}
-
-	light.color *= dimmer;
-
-	float distantLightFadeStart = lightsFar * lightsFar * (lightFadeStart / lightFadeEnd);
-	float distantLightFadeEnd = lightsFar * lightsFar;
-
-	if (distance < distantLightFadeStart || distantLightFadeEnd == 0.0f) {
-		dimmer = 1.0f;
-	} else if (distance <= distantLightFadeEnd) {
-		dimmer = 1.0f - ((distance - distantLightFadeStart) / (distantLightFadeEnd - distantLightFadeStart));
-	} else {
-		dimmer = 0.0f;
-	}
-
-	light.color *= dimmer;
-
-	if ((light.color.x + light.color.y + light.color.z) > 1e-4 && light.radius > 1e-4) {
-		if (a_geometry && a_config && a_config->flicker) {
-			auto seed = (std::uint32_t)std::hash<void*>{}(a_geometry);
-
-			siv::PerlinNoise perlin1{ seed };
-			siv::PerlinNoise perlin2{ seed + 1 };
-			siv::PerlinNoise perlin3{ seed + 2 };
-			siv::PerlinNoise perlin4{ seed + 3 };
-
-			auto scaledTimer = a_timer * a_config->flickerSpeed;
-
-			for (int eyeIndex = 0; eyeIndex < eyeCount; eyeIndex++) {
-				light.positionWS[eyeIndex].data.x += (float)perlin1.noise1D(scaledTimer) * a_config->flickerMovement;
-				light.positionWS[eyeIndex].data.y += (float)perlin2.noise1D(scaledTimer) * a_config->flickerMovement;
-				light.positionWS[eyeIndex].data.z += (float)perlin3.noise1D(scaledTimer) * a_config->flickerMovement;
-			}
-
-			light.color.x = std::max(0.0f, light.color.x - ((float)perlin4.noise1D_01(scaledTimer) * a_config->flickerIntensity));
-			light.color.y = std::max(0.0f, light.color.y - ((float)perlin4.noise1D_01(scaledTimer) * a_config->flickerIntensity));
-			light.color.z = std::max(0.0f, light.color.z - ((float)perlin4.noise1D_01(scaledTimer) * a_config->flickerIntensity));
-		}
-
-		for (int eyeIndex = 0; eyeIndex < eyeCount; eyeIndex++)
-			light.positionVS[eyeIndex].data = DirectX::SimpleMath::Vector3::Transform(light.positionWS[eyeIndex].data, viewMatrixCached[eyeIndex]);
-
-		lightsData.push_back(light);
-
-		CachedParticleLight cachedParticleLight{};
-		cachedParticleLight.grey = float3(light.color.x, light.color.y, light.color.z).Dot(float3(0.3f, 0.59f, 0.11f));
-		cachedParticleLight.radius = light.radius;
-		cachedParticleLight.position = { light.positionWS[0].data.x + eyePositionCached[0].x, light.positionWS[0].data.y + eyePositionCached[0].y, light.positionWS[0].data.z + eyePositionCached[0].z };
-
-		cachedParticleLights.push_back(cachedParticleLight);
-	}
-}
-
 float3 LightLimitFix::Saturation(float3 color, float saturation)
 {
 	float grey = color.Dot(float3(0.3f, 0.59f, 0.11f));
@@ -768,8 +831,8 @@ void LightLimitFix::UpdateLights()
 		}
 	}
 
-	eastl::vector<LightData> lightsData{};
-	lightsData.reserve(MAX_LIGHTS);
+	lightStaging.Clear();
+	lightStaging.Reserve(MAX_LIGHTS);
 
 	// Process point lights
 
@@ -779,52 +842,41 @@ void LightLimitFix::UpdateLights()
 				if (IsValidLight(bsLight) && IsGlobalLight(bsLight)) {
 					auto& runtimeData = niLight->GetLightRuntimeData();
 
-					LightData light{};
+					LightStaging::Light light{};
 					light.color = { runtimeData.diffuse.red, runtimeData.diffuse.green, runtimeData.diffuse.blue };
 					light.color *= runtimeData.fade;
 					light.color *= bsLight->lodDimmer;
 
 					light.radius = runtimeData.radius.x;
 
-					SetLightPosition(light, niLight->world.translate);
-
-					static float& lightFadeStart = (*(float*)REL::RelocationID(527668, 414582).address());
-					static float& lightFadeEnd = (*(float*)REL::RelocationID(527669, 414583).address());
-
-					float distance = CalculateLightDistance(light.positionWS[0].data, light.radius);
+					auto positionWS = niLight->world.translate - eyePositionCached[0];
+					light.position = { positionWS.x, positionWS.y, positionWS.z };
 
-					float distantLightFadeStart = lightsFar * lightsFar * (lightFadeStart / lightFadeEnd);
-					float distantLightFadeEnd = lightsFar * lightsFar;
-
-					float dimmer;
-
-					if (distance < distantLightFadeStart || distantLightFadeEnd == 0.0f) {
-						dimmer = 1.0f;
-					} else if (distance <= distantLightFadeEnd) {
-						dimmer = 1.0f - ((distance - distantLightFadeStart) / (distantLightFadeEnd - distantLightFadeStart));
-					} else {
-						dimmer = 0.0f;
-					}
+					if (bsLight == firstPersonLight || bsLight == thirdPersonLight || niLight == refLight || niLight == magicLight)
+						light.flags = LightStaging::kFirstPersonShadow;
 
-					light.color *= dimmer;
-
-					if ((light.color.x + light.color.y + light.color.z) > 1e-4 && light.radius > 1e-4) {
-						light.firstPersonShadow = bsLight == firstPersonLight || bsLight == thirdPersonLight || niLight == refLight || niLight == magicLight;
-						lightsData.push_back(light);
-					}
+					lightStaging.Add(light);
 				}
 			}
 		}
 	}
 
 	{
-		std::lock_guard<std::shared_mutex> lk{ cachedParticleLightsMutex };
-		cachedParticleLights.clear();
-
-		LightData clusteredLight{};
+		LightStaging::Light clusteredLight{};
+		clusteredLight.lightFade = true;
+		clusteredLight.flags = LightStaging::kParticle;
 		uint32_t clusteredLights = 0;
 
-		auto eyePositionOffset = eyePositionCached[0] - eyePositionCached[1];
+		auto addClusteredLight = [&]() {
+			clusteredLight.radius /= (float)clusteredLights;
+			clusteredLight.position /= (float)clusteredLights;
+			lightStaging.Add(clusteredLight);
+
+			clusteredLights = 0;
+			clusteredLight.color = { 0, 0, 0 };
+			clusteredLight.radius = 0;
+			clusteredLight.position = { 0, 0, 0 };
+		};
 
 		for (const auto& particleLight : particleLights) {
 			if (const auto particleSystem = netimmerse_cast<RE::NiParticleSystem*>(particleLight.first);
@@ -851,26 +903,11 @@ void LightLimitFix::UpdateLights()
 						auto averageRadius = clusteredLight.radius / (float)clusteredLights;
 						float radiusDiff = abs(averageRadius - radius);
 
-						auto averagePosition = clusteredLight.positionWS[0].data / (float)clusteredLights;
+						auto averagePosition = clusteredLight.position / (float)clusteredLights;
 						float positionDiff = positionWS.GetDistance({ averagePosition.x, averagePosition.y, averagePosition.z });
 
-						if ((radiusDiff + positionDiff) > settings.ParticleLightsOptimisationClusterRadius || !settings.EnableParticleLightsOptimization) {
-							clusteredLight.radius /= (float)clusteredLights;
-							clusteredLight.positionWS[0].data /= (float)clusteredLights;
-							clusteredLight.positionWS[1].data = clusteredLight.positionWS[0].data;
-							if (eyeCount == 2) {
-								clusteredLight.positionWS[1].data.x += eyePositionOffset.x / (float)clusteredLights;
-								clusteredLight.positionWS[1].data.y += eyePositionOffset.y / (float)clusteredLights;
-								clusteredLight.positionWS[1].data.z += eyePositionOffset.z / (float)clusteredLights;
-							}
-
-							AddCachedParticleLights(lightsData, clusteredLight);
-
-							clusteredLights = 0;
-							clusteredLight.color = { 0, 0, 0 };
-							clusteredLight.radius = 0;
-							clusteredLight.positionWS[0].data = { 0, 0, 0 };
-						}
+						if ((radiusDiff + positionDiff) > settings.ParticleLightsOptimisationClusterRadius || !settings.EnableParticleLightsOptimization)
+							addClusteredLight();
 					}
 
 					float alpha = particleLight.second.color.alpha * particleData->GetParticlesRuntimeData().color[p].alpha;
@@ -881,16 +918,18 @@ void LightLimitFix::UpdateLights()
 					clusteredLight.color += Saturation(color, settings.ParticleLightsSaturation) * alpha * settings.ParticleBrightness;
 
 					clusteredLight.radius += radius * settings.ParticleRadius * particleLight.second.config.radiusMult;
-					clusteredLight.positionWS[0].data.x += positionWS.x;
-					clusteredLight.positionWS[0].data.y += positionWS.y;
-					clusteredLight.positionWS[0].data.z += positionWS.z;
+					clusteredLight.position.x += positionWS.x;
+					clusteredLight.position.y += positionWS.y;
+					clusteredLight.position.z += positionWS.z;
 
 					clusteredLights++;
 				}
 
 			} else {
 				// Process billboard
-				LightData light{};
+				LightStaging::Light light{};
+				light.lightFade = true;
+				light.flags = LightStaging::kParticle;
 
 				light.color.x = particleLight.second.color.red;
 				light.color.y = particleLight.second.color.green;
@@ -901,25 +940,48 @@ void LightLimitFix::UpdateLights()
 				light.color *= particleLight.second.color.alpha * settings.BillboardBrightness;
 				light.radius = particleLight.first->worldBound.radius * settings.BillboardRadius * particleLight.second.config.radiusMult;
 
-				auto position = particleLight.first->world.translate;
+				auto positionWS = particleLight.first->world.translate - eyePositionCached[0];
+				light.position = { positionWS.x, positionWS.y, positionWS.z };
 
-				SetLightPosition(light, position);  // Light is complete for both eyes by now
+				auto& config = particleLight.second.config;
+				if (config.flicker) {
+					auto seed = (std::uint32_t)std::hash<void*>{}(particleLight.first);
 
-				AddCachedParticleLights(lightsData, light, &particleLight.second.config, particleLight.first, State::GetSingleton()->timer);
-			}
-		}
+					siv::PerlinNoise perlin1{ seed };
+					siv::PerlinNoise perlin2{ seed + 1 };
+					siv::PerlinNoise perlin3{ seed + 2 };
+					siv::PerlinNoise perlin4{ seed + 3 };
 
-		if (clusteredLights) {
-			clusteredLight.radius /= (float)clusteredLights;
-			clusteredLight.positionWS[0].data /= (float)clusteredLights;
-			clusteredLight.positionWS[1].data = clusteredLight.positionWS[0].data;
-			if (eyeCount == 2) {
-				clusteredLight.positionWS[1].data.x += eyePositionOffset.x / (float)clusteredLights;
-				clusteredLight.positionWS[1].data.y += eyePositionOffset.y / (float)clusteredLights;
-				clusteredLight.positionWS[1].data.z += eyePositionOffset.z / (float)clusteredLights;
+					auto scaledTimer = State::GetSingleton()->timer * config.flickerSpeed;
+
+					light.offset.x = (float)perlin1.noise1D(scaledTimer) * config.flickerMovement;
+					light.offset.y = (float)perlin2.noise1D(scaledTimer) * config.flickerMovement;
+					light.offset.z = (float)perlin3.noise1D(scaledTimer) * config.flickerMovement;
+					light.flickerIntensity = (float)perlin4.noise1D_01(scaledTimer) * config.flickerIntensity;
+				}
+
+				lightStaging.Add(light);
 			}
-			AddCachedParticleLights(lightsData, clusteredLight);
 		}
+
+		if (clusteredLights)
+			addClusteredLight();
+	}
+
+	{
+		static float& lightFadeStart = (*(float*)REL::RelocationID(527668, 414582).address());
+		static float& lightFadeEnd = (*(float*)REL::RelocationID(527669, 414583).address());
+
+		LightStaging::View view{};
+		view.eyeCount = eyeCount;
+		view.eyeOffset = { eyePositionCached[0].x - eyePositionCached[1].x, eyePositionCached[0].y - eyePositionCached[1].y, eyePositionCached[0].z - eyePositionCached[1].z };
+		view.viewMatrix[0] = viewMatrixCached[0];
+		view.viewMatrix[1] = viewMatrixCached[1];
+		view.lightFadeStart = lightFadeStart;
+		view.lightFadeEnd = lightFadeEnd;
+		view.lightsFar = lightsFar;
+
+		lightStaging.Process(view);
 	}
 
 	static auto context = RE::BSGraphics::Renderer::GetSingleton()->GetRuntimeData().context;
@@ -928,8 +990,10 @@ void LightLimitFix::UpdateLights()
 		auto projMatrixUnjittered = eyeCount == 1 ? state->GetRuntimeData().cameraData.getEye().projMatrixUnjittered : state->GetVRRuntimeData().cameraData.getEye().projMatrixUnjittered;
 		float fov = atan(1.0f / static_cast<float4x4>(projMatrixUnjittered).m[0][0]) * 2.0f * (180.0f / 3.14159265359f);
 
+		bool clusterGridChanged = UpdateClusterGrid();
+
 		static float _near = 0.0f, _far = 0.0f, _fov = 0.0f, _lightsNear = 0.0f, _lightsFar = 0.0f;
-		if (fabs(_near - accumulator->kCamera->GetRuntimeData2().viewFrustum.fNear) > 1e-4 || fabs(_far - accumulator->kCamera->GetRuntimeData2().viewFrustum.fFar) > 1e-4 || fabs(_fov - fov) > 1e-4 || fabs(_lightsNear - lightsNear) > 1e-4 || fabs(_lightsFar - lightsFar) > 1e-4) {
+		if (clusterGridChanged || fabs(_near - accumulator->kCamera->GetRuntimeData2().viewFrustum.fNear) > 1e-4 || fabs(_far - accumulator->kCamera->GetRuntimeData2().viewFrustum.fFar) > 1e-4 || fabs(_fov - fov) > 1e-4 || fabs(_lightsNear - lightsNear) > 1e-4 || fabs(_lightsFar - lightsFar) > 1e-4) {
 			LightBuildingCB updateData{};
 			updateData.InvProjMatrix[0] = DirectX::XMMatrixInverse(nullptr, projMatrixUnjittered);
 			if (eyeCount == 1)
@@ -948,7 +1012,8 @@ void LightLimitFix::UpdateLights()
 			context->CSSetUnorderedAccessViews(0, 1, &clusters_uav, nullptr);
 
 			context->CSSetShader(clusterBuildingCS, nullptr, 0);
-			context->Dispatch(CLUSTER_SIZE_X, CLUSTER_SIZE_Y, CLUSTER_SIZE_Z);
+			const auto dispatch = clusterGrid.BuildingDispatch();
+			context->Dispatch(dispatch.x, dispatch.y, dispatch.z);
 
 			ID3D11UnorderedAccessView* null_uav = nullptr;
 			context->CSSetUnorderedAccessViews(0, 1, &null_uav, nullptr);
@@ -962,12 +1027,56 @@ void LightLimitFix::UpdateLights()
 	}
 
 	{
-		lightCount = std::min((uint)lightsData.size(), MAX_LIGHTS);
+		std::lock_guard<std::shared_mutex> lk{ cachedParticleLightsMutex };
+		cachedParticleLights.clear();
 
 		D3D11_MAPPED_SUBRESOURCE mapped;
 		DX::ThrowIfFailed(context->Map(lights->resource.get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped));
-		size_t bytes = sizeof(LightData) * lightCount;
-		memcpy_s(mapped.pData, bytes, lightsData.data(), bytes);
+		auto lightsData = static_cast<LightData*>(mapped.pData);
+
+		// Pack the staged lights into the GPU layout in a single pass
+		const float* red = lightStaging.Data(LightStaging::Stream::Red);
+		const float* green = lightStaging.Data(LightStaging::Stream::Green);
+		const float* blue = lightStaging.Data(LightStaging::Stream::Blue);
+		const float* radii = lightStaging.Data(LightStaging::Stream::Radius);
+		const float* grey = lightStaging.Data(LightStaging::Stream::Grey);
+
+		const float* positionWS[2][3]{};
+		const float* positionVS[2][3]{};
+		for (int eyeIndex = 0; eyeIndex < eyeCount; eyeIndex++) {
+			for (uint32_t axis = 0; axis < 3; axis++) {
+				positionWS[eyeIndex][axis] = lightStaging.Data(LightStaging::Stream::PositionWS, eyeIndex, axis);
+				positionVS[eyeIndex][axis] = lightStaging.Data(LightStaging::Stream::PositionVS, eyeIndex, axis);
+			}
+		}
+
+		lightCount = 0;
+		for (uint32_t i = 0; i < lightStaging.Size(); i++) {
+			auto flags = lightStaging.GetFlags(i);
+			if (!(flags & LightStaging::kVisible))
+				continue;
+
+			if (lightCount < MAX_LIGHTS) {
+				LightData light{};
+				light.color = { red[i], green[i], blue[i] };
+				light.radius = radii[i];
+				for (int eyeIndex = 0; eyeIndex < eyeCount; eyeIndex++) {
+					light.positionWS[eyeIndex].data = { positionWS[eyeIndex][0][i], positionWS[eyeIndex][1][i], positionWS[eyeIndex][2][i] };
+					light.positionVS[eyeIndex].data = { positionVS[eyeIndex][0][i], positionVS[eyeIndex][1][i], positionVS[eyeIndex][2][i] };
+				}
+				light.firstPersonShadow = (flags & LightStaging::kFirstPersonShadow) != 0;
+				lightsData[lightCount++] = light;
+			}
+
+			if (flags & LightStaging::kParticle) {
+				CachedParticleLight cachedParticleLight{};
+				cachedParticleLight.grey = grey[i];
+				cachedParticleLight.radius = radii[i];
+				cachedParticleLight.position = { positionWS[0][0][i] + eyePositionCached[0].x, positionWS[0][1][i] + eyePositionCached[0].y, positionWS[0][2][i] + eyePositionCached[0].z };
+				cachedParticleLights.push_back(cachedParticleLight);
+			}
+		}
+
 		context->Unmap(lights->resource.get(), 0);
 
 		LightCullingCB updateData{};
@@ -984,7 +1093,8 @@ void LightLimitFix::UpdateLights()
 		context->CSSetUnorderedAccessViews(0, 3, uavs, nullptr);
 
 		context->CSSetShader(clusterCullingCS, nullptr, 0);
-		context->Dispatch(CLUSTER_SIZE_X / 16, CLUSTER_SIZE_Y / 16, CLUSTER_SIZE_Z / 4);
+		const auto dispatch = clusterGrid.CullingDispatch();
+		context->Dispatch(dispatch.x, dispatch.y, dispatch.z);
 	}
 
 	context->CSSetShader(nullptr, nullptr, 0);
@@ -997,6 +1107,9 @@ void LightLimitFix::UpdateLights()
 
 	ID3D11UnorderedAccessView* null_uavs[3] = { nullptr };
 	context->CSSetUnorderedAccessViews(0, 3, null_uavs, nullptr);
+
+	if (enableClusterTelemetry)
+		clusterTelemetry.Capture(context, lightGrid->resource.get(), lightCounter->resource.get(), clusterGrid.Count(), clusterGrid.maxLights);
 }
 
 bool LightLimitFix::HasShaderDefine(RE::BSShader::Type shaderType)
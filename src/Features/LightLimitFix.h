@@ -8,6 +8,10 @@
 
 #include "Feature.h"
 #include "ShaderCache.h"
+#include <Features/LightLimitFix/ClusterGrid.h>
+#include <Features/LightLimitFix/ClusterTelemetry.h>
+#include <Features/LightLimitFix/LightStaging.h>
+#include <Features/LightLimitFix/ParticleLightConfigCache.h>
 #include <Features/LightLimitFix/ParticleLights.h>
 
 struct LightLimitFix : Feature
@@ -55,7 +59,8 @@ public:
 	{
 		uint offset;
 		uint lightCount;
-		float pad0[2];
+		uint candidateCount;
+		float pad0;
 	};
 
 	struct alignas(16) LightBuildingCB
@@ -81,6 +86,10 @@ public:
 		float LightsNear;
 		float LightsFar;
 		uint FrameCount;
+		uint ClusterSizeX;
+		uint ClusterSizeY;
+		uint ClusterSizeZ;
+		uint ClusterMaxLights;
 	};
 
 	struct alignas(16) StrictLightData
@@ -109,6 +118,17 @@ public:
 	ID3D11ComputeShader* clusterBuildingCS = nullptr;
 	ID3D11ComputeShader* clusterCullingCS = nullptr;
 
+	// Compute shaders are compiled per preset on first use, since the grid is baked into them
+	ID3D11ComputeShader* clusterBuildingShaders[static_cast<uint>(ClusterGridPreset::Total)]{};
+	ID3D11ComputeShader* clusterCullingShaders[static_cast<uint>(ClusterGridPreset::Total)]{};
+
+	ClusterGridPreset clusterGridPreset = ClusterGridPreset::Total;
+	ClusterGrid clusterGrid{};
+	ClusterGridAutoTune clusterGridAutoTune;
+
+	bool enableClusterTelemetry = false;
+	ClusterTelemetry clusterTelemetry;
+
 	ConstantBuffer* lightBuildingCB = nullptr;
 	ConstantBuffer* lightCullingCB = nullptr;
 
@@ -135,6 +155,8 @@ public:
 
 	PerPass perPassData{};
 
+	LightStaging lightStaging;
+
 	virtual void SetupResources();
 	virtual void Reset();
 
@@ -144,13 +166,14 @@ public:
 	virtual void RestoreDefaultSettings();
 
 	virtual void DrawSettings();
+	bool HasDraw(RE::BSShader::Type shaderType) override;
 	virtual void Draw(const RE::BSShader* shader, const uint32_t descriptor);
 
 	virtual void PostPostLoad() override;
 	virtual void DataLoaded() override;
 
-	float CalculateLightDistance(float3 a_lightPosition, float a_radius);
-	void AddCachedParticleLights(eastl::vector<LightData>& lightsData, LightLimitFix::LightData& light, ParticleLights::Config* a_config = nullptr, RE::BSGeometry* a_geometry = nullptr, double timer = 0.0f);
+	void SetupClusters(ClusterGridPreset a_preset);
+	bool UpdateClusterGrid();
 	void SetLightPosition(LightLimitFix::LightData& a_light, RE::NiPoint3 a_initialPosition, bool a_cached = true);
 	void UpdateLights();
 	void Bind();
@@ -175,6 +198,8 @@ public:
 		float BillboardRadius = 1.0f;
 		bool EnableParticleLightsOptimization = true;
 		uint ParticleLightsOptimisationClusterRadius = 32;
+		uint ClusterGridQuality = 1;  // ClusterGridPreset
+		bool EnableClusterGridAutoTune = false;
 	};
 
 	float lightsNear = 0.0f;
@@ -183,7 +208,24 @@ public:
 	Settings settings;
 
 	using ConfigPair = std::pair<ParticleLights::Config*, ParticleLights::GradientConfig*>;
+	std::optional<ConfigPair> ResolveParticleLightConfigs(RE::BSEffectShaderMaterial* a_material);
 	std::optional<ConfigPair> GetParticleLightConfigs(RE::BSRenderPass* a_pass);
+
+	ParticleLightConfigCache<RE::BSEffectShaderMaterial, ConfigPair> particleLightConfigCache;
+
+	struct VertexColorCacheEntry
+	{
+		const void* rendererData = nullptr;
+		const std::uint8_t* rawVertexData = nullptr;
+		std::uint32_t vertexCount = 0;
+		bool emissive = false;  // false if the vertex alphas rule out a particle light
+		std::uint8_t color[4]{};
+	};
+
+	ankerl::unordered_dense::map<RE::BSGeometry*, VertexColorCacheEntry> vertexColorCache;
+	uint64_t vertexColorCacheHits = 0;
+	uint64_t vertexColorCacheMisses = 0;
+	Util::CountedTimer vertexColorScanTimer;
 	bool AddParticleLight(RE::BSRenderPass* a_pass, ConfigPair a_config);
 	bool CheckParticleLights(RE::BSRenderPass* a_pass, uint32_t a_technique);
 
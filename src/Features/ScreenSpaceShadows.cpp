@@ -460,6 +460,18 @@ void ScreenSpaceShadows::Draw(const RE::BSShader* shader, const uint32_t descrip
 	}
 }
 
+bool ScreenSpaceShadows::HasDraw(RE::BSShader::Type shaderType)
+{
+	switch (shaderType) {
+	case RE::BSShader::Type::Grass:
+	case RE::BSShader::Type::DistantTree:
+	case RE::BSShader::Type::Lighting:
+		return true;
+	default:
+		return false;
+	}
+}
+
 void ScreenSpaceShadows::Load(json& o_json)
 {
 	if (o_json[GetName()].is_object())
@@ -4,14 +4,20 @@
 #include "State.h"
 #include <ShaderCache.h>
 
+#include <imgui_stdlib.h>
+
 NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(SubsurfaceScattering::DiffusionProfile,
 	BlurRadius, Thickness, Strength, Falloff)
 
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(SubsurfaceScattering::NamedProfile,
+	Name, Races, Profile)
+
 NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(
 	SubsurfaceScattering::Settings,
 	EnableCharacterLighting,
 	BaseProfile,
-	HumanProfile)
+	HumanProfile,
+	CustomProfiles)
 
 void SubsurfaceScattering::DrawSettings()
 {
@@ -55,6 +61,48 @@ void SubsurfaceScattering::DrawSettings()
 			ImGui::TreePop();
 		}
 
+		if (ImGui::TreeNodeEx("Custom Profiles", ImGuiTreeNodeFlags_DefaultOpen)) {
+			for (size_t i = 0; i < settings.CustomProfiles.size(); i++) {
+				auto& custom = settings.CustomProfiles[i];
+
+				ImGui::PushID((int)i);
+				if (ImGui::TreeNodeEx("Profile", ImGuiTreeNodeFlags_DefaultOpen, "%s", custom.Name.c_str())) {
+					ImGui::InputText("Name", &custom.Name);
+
+					if (ImGui::InputText("Races", &custom.Races))
+						raceProfileCache.clear();
+					if (auto _tt = Util::HoverTooltipWrapper()) {
+						ImGui::Text("Comma separated race editor IDs using this profile.");
+					}
+
+					ImGui::SliderFloat("Blur Radius", &custom.Profile.BlurRadius, 0, 3, "%.2f");
+					ImGui::SliderFloat("Thickness", &custom.Profile.Thickness, 0, 3, "%.2f");
+					ImGui::ColorEdit3("Strength", (float*)&custom.Profile.Strength);
+					ImGui::ColorEdit3("Falloff", (float*)&custom.Profile.Falloff);
+
+					if (ImGui::Button("Remove")) {
+						settings.CustomProfiles.erase(settings.CustomProfiles.begin() + i);
+						raceProfileCache.clear();
+						ImGui::TreePop();
+						ImGui::PopID();
+						break;
+					}
+
+					ImGui::TreePop();
+				}
+				ImGui::PopID();
+			}
+
+			ImGui::BeginDisabled(settings.CustomProfiles.size() >= SSSS_N_PROFILES - kCustom);
+			if (ImGui::Button("Add Profile")) {
+				settings.CustomProfiles.emplace_back();
+				raceProfileCache.clear();
+			}
+			ImGui::EndDisabled();
+
+			ImGui::TreePop();
+		}
+
 		ImGui::Spacing();
 		ImGui::Spacing();
 
@@ -62,96 +110,51 @@ void SubsurfaceScattering::DrawSettings()
 	}
 }
 
-float3 SubsurfaceScattering::Gaussian(DiffusionProfile& a_profile, float variance, float r)
+const SubsurfaceScattering::Kernel& SubsurfaceScattering::GetKernel(const DiffusionProfile& a_profile)
 {
-	/**
-     * We use a falloff to modulate the shape of the profile. Big falloffs
-     * spreads the shape making it wider, while small falloffs make it
-     * narrower.
-     */
-	float falloff[3] = { a_profile.Falloff.x, a_profile.Falloff.y, a_profile.Falloff.z };
-	float g[3];
-	for (int i = 0; i < 3; i++) {
-		float rr = r / (0.001f + falloff[i]);
-		g[i] = exp((-(rr * rr)) / (2.0f * variance)) / (2.0f * 3.14f * variance);
-	}
-	return float3(g[0], g[1], g[2]);
-}
+	auto it = kernelCache.find(a_profile);
+	if (it != kernelCache.end())
+		return it->second;
 
-float3 SubsurfaceScattering::Profile(DiffusionProfile& a_profile, float r)
-{
-	/**
-     * We used the red channel of the original skin profile defined in
-     * [d'Eon07] for all three channels. We noticed it can be used for green
-     * and blue channels (scaled using the falloff parameter) without
-     * introducing noticeable differences and allowing for total control over
-     * the profile. For example, it allows to create blue SSS gradients, which
-     * could be useful in case of rendering blue creatures.
-     */
-	return  // 0.233f * gaussian(0.0064f, r) + /* We consider this one to be directly bounced light, accounted by the strength parameter (see @STRENGTH) */
-		0.100f * Gaussian(a_profile, 0.0484f, r) +
-		0.118f * Gaussian(a_profile, 0.187f, r) +
-		0.113f * Gaussian(a_profile, 0.567f, r) +
-		0.358f * Gaussian(a_profile, 1.99f, r) +
-		0.078f * Gaussian(a_profile, 7.41f, r);
+	// Live tuning creates a new entry per slider step
+	if (kernelCache.size() >= 64)
+		kernelCache.clear();
+
+	Kernel kernel;
+	DiffusionKernel::Calculate(a_profile.Strength, a_profile.Falloff, kernel);
+	return kernelCache.emplace(a_profile, kernel).first->second;
 }
 
-void SubsurfaceScattering::CalculateKernel(DiffusionProfile& a_profile, Kernel& kernel)
+void SubsurfaceScattering::UpdateProfiles()
 {
-	uint nSamples = SSSS_N_SAMPLES;
-
-	const float RANGE = nSamples > 20 ? 3.0f : 2.0f;
-	const float EXPONENT = 2.0f;
-
-	// Calculate the offsets:
-	float step = 2.0f * RANGE / (nSamples - 1);
-	for (uint i = 0; i < nSamples; i++) {
-		float o = -RANGE + float(i) * step;
-		float sign = o < 0.0f ? -1.0f : 1.0f;
-		kernel.Sample[i].w = RANGE * sign * abs(pow(o, EXPONENT)) / pow(RANGE, EXPONENT);
+	const DiffusionProfile* profiles[SSSS_N_PROFILES] = { &settings.BaseProfile, &settings.HumanProfile };
+	uint count = kCustom;
+	for (auto& custom : settings.CustomProfiles) {
+		if (count == SSSS_N_PROFILES)
+			break;
+		profiles[count++] = &custom.Profile;
 	}
 
-	// Calculate the weights:
-	for (uint i = 0; i < nSamples; i++) {
-		float w0 = i > 0 ? abs(kernel.Sample[i].w - kernel.Sample[i - 1].w) : 0.0f;
-		float w1 = i < nSamples - 1 ? abs(kernel.Sample[i].w - kernel.Sample[i + 1].w) : 0.0f;
-		float area = (w0 + w1) / 2.0f;
-		float3 t = area * Profile(a_profile, kernel.Sample[i].w);
-		kernel.Sample[i].x = t.x;
-		kernel.Sample[i].y = t.y;
-		kernel.Sample[i].z = t.z;
+	ProfileData newProfileData[SSSS_N_PROFILES]{};
+	for (uint i = 0; i < count; i++) {
+		newProfileData[i].Samples = GetKernel(*profiles[i]);
+		newProfileData[i].Params = { profiles[i]->BlurRadius, profiles[i]->Thickness, 0, 0 };
 	}
 
-	// We want the offset 0.0 to come first:
-	float4 t = kernel.Sample[nSamples / 2];
-	for (uint i = nSamples / 2; i > 0; i--)
-		kernel.Sample[i] = kernel.Sample[i - 1];
-	kernel.Sample[0] = t;
-
-	// Calculate the sum of the weights, we will need to normalize them below:
-	float3 sum = float3(0.0f, 0.0f, 0.0f);
-	for (uint i = 0; i < nSamples; i++)
-		sum += float3(kernel.Sample[i]);
-
-	// Normalize the weights:
-	for (uint i = 0; i < nSamples; i++) {
-		kernel.Sample[i].x /= sum.x;
-		kernel.Sample[i].y /= sum.y;
-		kernel.Sample[i].z /= sum.z;
+	if (count != profileCount) {
+		profileCount = count;
+		CreatePerPassBuffers();
 	}
 
-	// Tweak them using the desired strength. The first one is:
-	//     lerp(1.0, kernel[0].rgb, strength)
-	kernel.Sample[0].x = (1.0f - a_profile.Strength.x) * 1.0f + a_profile.Strength.x * kernel.Sample[0].x;
-	kernel.Sample[0].y = (1.0f - a_profile.Strength.y) * 1.0f + a_profile.Strength.y * kernel.Sample[0].y;
-	kernel.Sample[0].z = (1.0f - a_profile.Strength.z) * 1.0f + a_profile.Strength.z * kernel.Sample[0].z;
-
-	// The others:
-	//     lerp(0.0, kernel[0].rgb, strength)
-	for (uint i = 1; i < nSamples; i++) {
-		kernel.Sample[i].x *= a_profile.Strength.x;
-		kernel.Sample[i].y *= a_profile.Strength.y;
-		kernel.Sample[i].z *= a_profile.Strength.z;
+	if (memcmp(newProfileData, profileData, sizeof(profileData)) != 0) {
+		memcpy(profileData, newProfileData, sizeof(profileData));
+
+		auto context = RE::BSGraphics::Renderer::GetSingleton()->GetRuntimeData().context;
+		D3D11_MAPPED_SUBRESOURCE mapped;
+		DX::ThrowIfFailed(context->Map(profileTable->resource.get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped));
+		size_t bytes = sizeof(profileData);
+		memcpy_s(mapped.pData, bytes, profileData, bytes);
+		context->Unmap(profileTable->resource.get(), 0);
 	}
 }
 
@@ -237,8 +240,7 @@ void SubsurfaceScattering::DrawSSS()
 
 		blurCBData.CameraData = Util::GetCameraData();
 
-		blurCBData.BaseProfile = { settings.BaseProfile.BlurRadius, settings.BaseProfile.Thickness, 0, 0 };
-		blurCBData.HumanProfile = { settings.HumanProfile.BlurRadius, settings.HumanProfile.Thickness, 0, 0 };
+		blurCBData.ProfileCount = profileCount;
 
 		blurCB->Update(blurCBData);
 	}
@@ -254,12 +256,13 @@ void SubsurfaceScattering::DrawSSS()
 		auto snowSwap = renderer->GetRuntimeData().renderTargets[RE::RENDER_TARGETS::kMAIN];
 		auto normals = renderer->GetRuntimeData().renderTargets[normalsMode];
 
-		ID3D11ShaderResourceView* views[3];
+		ID3D11ShaderResourceView* views[4];
 		views[0] = snowSwap.SRV;
 		views[1] = depth.depthSRV;
 		views[2] = normals.SRV;
+		views[3] = profileTable->srv.get();
 
-		context->CSSetShaderResources(0, 3, views);
+		context->CSSetShaderResources(0, 4, views);
 
 		ID3D11UnorderedAccessView* uav = blurHorizontalTemp->uav.get();
 
@@ -297,8 +300,8 @@ void SubsurfaceScattering::DrawSSS()
 	ID3D11Buffer* buffer = nullptr;
 	context->CSSetConstantBuffers(0, 1, &buffer);
 
-	ID3D11ShaderResourceView* views[3]{ nullptr, nullptr, nullptr };
-	context->CSSetShaderResources(0, 3, views);
+	ID3D11ShaderResourceView* views[4]{ nullptr, nullptr, nullptr, nullptr };
+	context->CSSetShaderResources(0, 4, views);
 
 	ID3D11UnorderedAccessView* uavs[2]{ nullptr, nullptr };
 	context->CSSetUnorderedAccessViews(0, 2, uavs, nullptr);
@@ -318,6 +321,16 @@ void SubsurfaceScattering::Draw(const RE::BSShader* a_shader, const uint32_t)
 	}
 }
 
+bool SubsurfaceScattering::HasDraw(RE::BSShader::Type shaderType)
+{
+	switch (shaderType) {
+	case RE::BSShader::Type::Lighting:
+		return true;
+	default:
+		return false;
+	}
+}
+
 void SubsurfaceScattering::SetupResources()
 {
 	{
@@ -325,21 +338,16 @@ void SubsurfaceScattering::SetupResources()
 	}
 
 	{
-		D3D11_BUFFER_DESC sbDesc{};
-		sbDesc.Usage = D3D11_USAGE_DYNAMIC;
-		sbDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-		sbDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-		sbDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
-		sbDesc.StructureByteStride = sizeof(PerPass);
-		sbDesc.ByteWidth = sizeof(PerPass);
-		perPass = std::make_unique<Buffer>(sbDesc);
+		profileTable = std::make_unique<Buffer>(StructuredBufferDesc<ProfileData>(SSSS_N_PROFILES, false, true));
 
 		D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc;
 		srvDesc.Format = DXGI_FORMAT_UNKNOWN;
 		srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
 		srvDesc.Buffer.FirstElement = 0;
-		srvDesc.Buffer.NumElements = 1;
-		perPass->CreateSRV(srvDesc);
+		srvDesc.Buffer.NumElements = SSSS_N_PROFILES;
+		profileTable->CreateSRV(srvDesc);
+
+		UpdateProfiles();
 	}
 
 	auto renderer = RE::BSGraphics::Renderer::GetSingleton();
@@ -362,6 +370,34 @@ void SubsurfaceScattering::SetupResources()
 	}
 }
 
+void SubsurfaceScattering::CreatePerPassBuffers()
+{
+	D3D11_BUFFER_DESC sbDesc{};
+	sbDesc.Usage = D3D11_USAGE_IMMUTABLE;
+	sbDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	sbDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+	sbDesc.StructureByteStride = sizeof(PerPass);
+	sbDesc.ByteWidth = sizeof(PerPass);
+
+	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc;
+	srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+	srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+	srvDesc.Buffer.FirstElement = 0;
+	srvDesc.Buffer.NumElements = 1;
+
+	for (uint material = 0; material < 2; material++) {
+		for (uint profile = 0; profile < SSSS_N_PROFILES; profile++) {
+			PerPass perPassData{ material, std::min(profile, profileCount - 1), profileCount };
+			D3D11_SUBRESOURCE_DATA initData{ &perPassData };
+			perPass[material][profile] = std::make_unique<Buffer>(sbDesc, &initData);
+			perPass[material][profile]->CreateSRV(srvDesc);
+		}
+	}
+
+	// Force the next pass to rebind
+	boundPerPass = nullptr;
+}
+
 void SubsurfaceScattering::Reset()
 {
 	normalsMode = RE::RENDER_TARGET::kNONE;
@@ -369,19 +405,20 @@ void SubsurfaceScattering::Reset()
 	auto& shaderManager = RE::BSShaderManager::State::GetSingleton();
 	shaderManager.characterLightEnabled = SIE::ShaderCache::Instance().IsEnabled() ? settings.EnableCharacterLighting : true;
 
-	CalculateKernel(settings.BaseProfile, blurCBData.BaseKernel);
-	CalculateKernel(settings.HumanProfile, blurCBData.HumanKernel);
+	UpdateProfiles();
 }
 
 void SubsurfaceScattering::RestoreDefaultSettings()
 {
 	settings = {};
+	raceProfileCache.clear();
 }
 
 void SubsurfaceScattering::Load(json& o_json)
 {
 	if (o_json[GetName()].is_object())
 		settings = o_json[GetName()];
+	raceProfileCache.clear();
 
 	Feature::Load(o_json);
 }
@@ -485,35 +522,69 @@ void SubsurfaceScattering::OverrideFirstPersonRenderTargets()
 	validMaterial = true;
 }
 
+void SubsurfaceScattering::DataLoaded()
+{
+	isBeastRaceKeyword = RE::TESForm::LookupByEditorID<RE::BGSKeyword>("IsBeastRace");
+
+	raceProfileCache.clear();
+	if (auto dataHandler = RE::TESDataHandler::GetSingleton()) {
+		for (auto race : dataHandler->GetFormArray<RE::TESRace>())
+			GetProfileIndex(race);
+	}
+
+	logger::info("[SSS] Cached skin profiles for {} races", raceProfileCache.size());
+}
+
+uint SubsurfaceScattering::GetProfileIndex(RE::TESRace* a_race)
+{
+	if (!a_race)
+		return kBase;
+
+	auto it = raceProfileCache.find(a_race);
+	if (it != raceProfileCache.end())
+		return it->second;
+
+	uint profileIndex = isBeastRaceKeyword && a_race->HasKeyword(isBeastRaceKeyword) ? kBase : kHuman;
+
+	if (auto editorID = a_race->GetFormEditorID(); editorID && *editorID) {
+		const size_t customCount = std::min<size_t>(settings.CustomProfiles.size(), SSSS_N_PROFILES - kCustom);
+		for (size_t i = 0; i < customCount; i++) {
+			for (const auto race : std::views::split(settings.CustomProfiles[i].Races, ',')) {
+				std::string_view name(race.begin(), race.end());
+				while (!name.empty() && name.front() == ' ')
+					name.remove_prefix(1);
+				while (!name.empty() && name.back() == ' ')
+					name.remove_suffix(1);
+				if (!name.empty() && _strnicmp(name.data(), editorID, name.size()) == 0 && editorID[name.size()] == '\0') {
+					profileIndex = kCustom + (uint)i;
+					break;
+				}
+			}
+		}
+	}
+
+	raceProfileCache.emplace(a_race, profileIndex);
+	return profileIndex;
+}
+
 void SubsurfaceScattering::BSLightingShader_SetupSkin(RE::BSRenderPass* a_pass)
 {
 	if (a_pass->shaderProperty->flags.any(RE::BSShaderProperty::EShaderPropertyFlag::kFace, RE::BSShaderProperty::EShaderPropertyFlag::kFaceGenRGBTint)) {
-		bool isBeastRace = true;
+		uint profileIndex = kBase;
 
 		auto geometry = a_pass->geometry;
 		if (auto userData = geometry->GetUserData()) {
-			if (auto actor = userData->As<RE::Actor>()) {
-				if (auto race = actor->GetRace()) {
-					static auto isBeastRaceForm = RE::TESForm::LookupByEditorID("IsBeastRace")->As<RE::BGSKeyword>();
-					isBeastRace = race->HasKeyword(isBeastRaceForm);
-				}
-			}
+			if (auto actor = userData->As<RE::Actor>())
+				profileIndex = GetProfileIndex(actor->GetRace());
 		}
 
-		static PerPass perPassData{};
-
-		if (perPassData.ValidMaterial != (uint)validMaterial || perPassData.IsBeastRace != (uint)isBeastRace) {
-			perPassData.ValidMaterial = validMaterial;
-			perPassData.IsBeastRace = isBeastRace;
+		auto view = perPass[validMaterial][profileIndex]->srv.get();
+		if (view != boundPerPass) {
+			boundPerPass = view;
 
 			auto renderer = RE::BSGraphics::Renderer::GetSingleton();
 			auto context = renderer->GetRuntimeData().context;
-
-			D3D11_MAPPED_SUBRESOURCE mapped;
-			DX::ThrowIfFailed(context->Map(perPass->resource.get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped));
-			size_t bytes = sizeof(PerPass);
-			memcpy_s(mapped.pData, bytes, &perPassData, bytes);
-			context->Unmap(perPass->resource.get(), 0);
+			context->PSSetShaderResources(36, 1, &view);
 		}
 	}
 }
@@ -522,7 +593,7 @@ void SubsurfaceScattering::Bind()
 {
 	auto renderer = RE::BSGraphics::Renderer::GetSingleton();
 	auto context = renderer->GetRuntimeData().context;
-	ID3D11ShaderResourceView* view = perPass->srv.get();
-	context->PSSetShaderResources(36, 1, &view);
 	validMaterial = true;
+	boundPerPass = perPass[validMaterial][kBase]->srv.get();
+	context->PSSetShaderResources(36, 1, &boundPerPass);
 }
@@ -3,7 +3,9 @@
 #include "Buffer.h"
 #include "Feature.h"
 
-#define SSSS_N_SAMPLES 21
+#include "Features/SubsurfaceScattering/DiffusionKernel.h"
+
+#define SSSS_N_PROFILES 4
 
 struct SubsurfaceScattering : Feature
 {
@@ -25,6 +27,24 @@ public:
 		float Thickness;
 		float3 Strength;
 		float3 Falloff;
+
+		bool operator==(const DiffusionProfile& a_rhs) const { return memcmp(this, &a_rhs, sizeof(DiffusionProfile)) == 0; }
+	};
+
+	struct DiffusionProfileHash
+	{
+		using is_avalanching = void;
+		uint64_t operator()(const DiffusionProfile& a_profile) const noexcept
+		{
+			return ankerl::unordered_dense::detail::wyhash::hash(&a_profile, sizeof(DiffusionProfile));
+		}
+	};
+
+	struct NamedProfile
+	{
+		std::string Name = "New Profile";
+		std::string Races;  // comma separated race editor IDs
+		DiffusionProfile Profile{ 1.0f, 1.0f, { 0.48f, 0.41f, 0.28f }, { 1.0f, 0.37f, 0.3f } };
 	};
 
 	struct Settings
@@ -32,27 +52,42 @@ public:
 		uint EnableCharacterLighting = false;
 		DiffusionProfile BaseProfile{ 1.0f, 1.0f, { 0.48f, 0.41f, 0.28f }, { 0.56f, 0.56f, 0.56f } };
 		DiffusionProfile HumanProfile{ 1.0f, 1.0f, { 0.48f, 0.41f, 0.28f }, { 1.0f, 0.37f, 0.3f } };
+		std::vector<NamedProfile> CustomProfiles;
 	};
 
 	Settings settings;
 
-	struct alignas(16) Kernel
+	enum ProfileIndex : uint
+	{
+		kBase = 0,
+		kHuman = 1,
+		kCustom = 2
+	};
+
+	using Kernel = DiffusionKernel::Kernel;
+
+	struct alignas(16) ProfileData
 	{
-		float4 Sample[SSSS_N_SAMPLES];
+		Kernel Samples;
+		float4 Params;  // x blur radius, y thickness
 	};
 
+	ProfileData profileData[SSSS_N_PROFILES]{};
+	uint profileCount = 0;
+	std::unique_ptr<Buffer> profileTable = nullptr;
+
+	// Kernels only depend on the profile values, so tuning back and forth is a lookup
+	ankerl::unordered_dense::map<DiffusionProfile, Kernel, DiffusionProfileHash> kernelCache;
+
 	struct alignas(16) BlurCB
 	{
-		Kernel BaseKernel;
-		Kernel HumanKernel;
-		float4 BaseProfile;
-		float4 HumanProfile;
 		float4 CameraData;
 		float2 BufferDim;
 		float2 RcpBufferDim;
 		uint FrameCount;
 		float SSSS_FOVY;
-		uint pad[2];
+		uint ProfileCount;
+		uint pad;
 	};
 
 	ConstantBuffer* blurCB = nullptr;
@@ -61,14 +96,20 @@ public:
 	struct alignas(16) PerPass
 	{
 		uint ValidMaterial;
-		uint IsBeastRace;
-		uint pad0[2];
+		uint ProfileIndex;
+		uint ProfileCount;
+		uint pad0;
 	};
 
-	std::unique_ptr<Buffer> perPass = nullptr;
+	// Immutable variants indexed by [ValidMaterial][ProfileIndex], switching is a single SRV bind
+	std::unique_ptr<Buffer> perPass[2][SSSS_N_PROFILES];
+	ID3D11ShaderResourceView* boundPerPass = nullptr;
 
 	bool validMaterial = true;
 
+	RE::BGSKeyword* isBeastRaceKeyword = nullptr;
+	ankerl::unordered_dense::map<RE::TESRace*, uint> raceProfileCache;
+
 	Texture2D* blurHorizontalTemp = nullptr;
 
 	ID3D11ComputeShader* horizontalSSBlur = nullptr;
@@ -89,14 +130,15 @@ public:
 
 	virtual void DrawSettings();
 
-	float3 Gaussian(DiffusionProfile& a_profile, float variance, float r);
-	float3 Profile(DiffusionProfile& a_profile, float r);
-	void CalculateKernel(DiffusionProfile& a_profile, Kernel& kernel);
+	const Kernel& GetKernel(const DiffusionProfile& a_profile);
+	void UpdateProfiles();
+	void CreatePerPassBuffers();
 
 	void DrawSSSWrapper(bool a_firstPerson = false);
 
 	void DrawSSS();
 
+	bool HasDraw(RE::BSShader::Type shaderType) override;
 	virtual void Draw(const RE::BSShader* shader, const uint32_t descriptor);
 
 	virtual void Load(json& o_json);
@@ -108,6 +150,9 @@ public:
 	ID3D11ComputeShader* GetComputeShaderClearBuffer();
 
 	virtual void PostPostLoad() override;
+	virtual void DataLoaded() override;
+
+	uint GetProfileIndex(RE::TESRace* a_race);
 
 	void OverrideFirstPersonRenderTargets();
 
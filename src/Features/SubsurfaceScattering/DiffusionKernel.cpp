@@ -0,0 +1,64 @@
+#include "Features/SubsurfaceScattering/DiffusionKernel.h"
+
+using namespace DirectX;
+
+namespace DiffusionKernel
+{
+	// We consider 0.233 * gaussian(0.0064) to be directly bounced light, accounted by the strength parameter
+	static constexpr float GaussianWeights[] = { 0.100f, 0.118f, 0.113f, 0.358f, 0.078f };
+	static constexpr float GaussianVariances[] = { 0.0484f, 0.187f, 0.567f, 1.99f, 7.41f };
+
+	XMVECTOR XM_CALLCONV Profile(FXMVECTOR a_falloff, float a_radius)
+	{
+		const XMVECTOR rr = XMVectorDivide(XMVectorReplicate(a_radius), XMVectorAdd(a_falloff, XMVectorReplicate(0.001f)));
+		const XMVECTOR rr2 = XMVectorNegate(XMVectorMultiply(rr, rr));
+
+		XMVECTOR result = XMVectorZero();
+		for (size_t i = 0; i < std::size(GaussianWeights); i++) {
+			const float variance = GaussianVariances[i];
+			const XMVECTOR g = XMVectorExpE(XMVectorScale(rr2, 1.0f / (2.0f * variance)));
+			result = XMVectorMultiplyAdd(g, XMVectorReplicate(GaussianWeights[i] / (2.0f * 3.14f * variance)), result);
+		}
+		return result;
+	}
+
+	void Calculate(const float3& a_strength, const float3& a_falloff, Kernel& a_kernel)
+	{
+		constexpr uint nSamples = SSSS_N_SAMPLES;
+		constexpr float RANGE = nSamples > 20 ? 3.0f : 2.0f;
+
+		// Calculate the offsets, quadratically distributed over the range:
+		const float step = 2.0f * RANGE / (nSamples - 1);
+		float offsets[nSamples];
+		for (uint i = 0; i < nSamples; i++) {
+			float o = -RANGE + float(i) * step;
+			offsets[i] = std::copysign(o * o, o) / RANGE;
+		}
+
+		const XMVECTOR falloff = XMLoadFloat3(&a_falloff);
+		const XMVECTOR strength = XMLoadFloat3(&a_strength);
+
+		// Calculate the weights, with the offset 0.0 first:
+		XMVECTOR weights[nSamples];
+		XMVECTOR sum = XMVectorZero();
+		for (uint i = 0; i < nSamples; i++) {
+			uint j = i == 0 ? nSamples / 2 : (i <= nSamples / 2 ? i - 1 : i);
+			float w0 = j > 0 ? abs(offsets[j] - offsets[j - 1]) : 0.0f;
+			float w1 = j < nSamples - 1 ? abs(offsets[j] - offsets[j + 1]) : 0.0f;
+			weights[i] = XMVectorScale(Profile(falloff, offsets[j]), (w0 + w1) * 0.5f);
+			sum = XMVectorAdd(sum, weights[i]);
+			a_kernel.Sample[i].w = offsets[j];
+		}
+
+		// Normalize the weights, then tweak them using the desired strength:
+		//     lerp(1.0, kernel[0].rgb, strength) for the first one
+		//     lerp(0.0, kernel[i].rgb, strength) for the others
+		const XMVECTOR rcpSum = XMVectorReciprocal(sum);
+		for (uint i = 0; i < nSamples; i++) {
+			XMVECTOR w = XMVectorMultiply(XMVectorMultiply(weights[i], rcpSum), strength);
+			if (i == 0)
+				w = XMVectorAdd(w, XMVectorSubtract(XMVectorSplatOne(), strength));
+			XMStoreFloat3(reinterpret_cast<XMFLOAT3*>(&a_kernel.Sample[i]), w);
+		}
+	}
+}
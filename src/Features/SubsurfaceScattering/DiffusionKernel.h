@@ -0,0 +1,26 @@
+#pragma once
+
+#define SSSS_N_SAMPLES 21
+
+/**
+ * Separable SSS kernel evaluation.
+ * Only depends on DirectXMath so the kernel can be computed and checked outside the game.
+ */
+namespace DiffusionKernel
+{
+	struct alignas(16) Kernel
+	{
+		float4 Sample[SSSS_N_SAMPLES];  // rgb weight, a offset
+	};
+
+	/**
+	 * Sum of the skin gaussians of [d'Eon07] evaluated for all three channels at once.
+	 * Falloff widens or narrows the shape per channel.
+	 */
+	DirectX::XMVECTOR XM_CALLCONV Profile(DirectX::FXMVECTOR a_falloff, float a_radius);
+
+	/**
+	 * Builds the kernel with the offset 0.0 sample first, normalized and scaled by strength.
+	 */
+	void Calculate(const float3& a_strength, const float3& a_falloff, Kernel& a_kernel);
+}
@@ -10,7 +10,10 @@ void TerrainBlending::DrawSettings()
 
 bool TerrainBlending::ValidBlendingPass(RE::BSRenderPass* a_pass)
 {
-	auto eyePosition = !REL::Module::IsVR() ? RE::BSGraphics::RendererShadowState::GetSingleton()->GetRuntimeData().posAdjust.getEye(0) : RE::BSGraphics::RendererShadowState::GetSingleton()->GetVRRuntimeData().posAdjust.getEye(0);
+	// Eye position and cubemap target change between accumulators, so they are read per pass
+	const bool isVR = State::GetSingleton()->GetFrameContext().isVR;
+	auto shadowState = RE::BSGraphics::RendererShadowState::GetSingleton();
+	auto eyePosition = !isVR ? shadowState->GetRuntimeData().posAdjust.getEye(0) : shadowState->GetVRRuntimeData().posAdjust.getEye(0);
 	auto objectPosition = a_pass->geometry->world.translate;
 	objectPosition -= eyePosition;
 	auto objectDistance = objectPosition.Length();
@@ -18,9 +21,9 @@ bool TerrainBlending::ValidBlendingPass(RE::BSRenderPass* a_pass)
 	if (objectDistance < optimisationDistance) {
 		auto accumulator = RE::BSGraphics::BSShaderAccumulator::GetCurrentAccumulator();
 
-		auto reflections = (!REL::Module::IsVR() ?
-								   RE::BSGraphics::RendererShadowState::GetSingleton()->GetRuntimeData().cubeMapRenderTarget :
-								   RE::BSGraphics::RendererShadowState::GetSingleton()->GetVRRuntimeData().cubeMapRenderTarget) == RE::RENDER_TARGETS_CUBEMAP::kREFLECTIONS;
+		auto reflections = (!isVR ?
+								   shadowState->GetRuntimeData().cubeMapRenderTarget :
+								   shadowState->GetVRRuntimeData().cubeMapRenderTarget) == RE::RENDER_TARGETS_CUBEMAP::kREFLECTIONS;
 
 		return !reflections && accumulator->GetRuntimeData().activeShadowSceneNode == RE::BSShaderManager::State::GetSingleton().shadowSceneNode[0];
 	}
@@ -72,10 +75,9 @@ void TerrainBlending::SetupGeometry(RE::BSRenderPass* a_pass)
 			Bindings::GetSingleton()->SetOverwriteTerrainMode(true);
 			Bindings::GetSingleton()->SetOverwriteTerrainMaskingMode(Bindings::TerrainMaskMode::kRead);
 
-			auto context = RE::BSGraphics::Renderer::GetSingleton()->GetRuntimeData().context;
 			auto view = Bindings::GetSingleton()->terrainBlendingMask ? Bindings::GetSingleton()->terrainBlendingMask->srv.get() : nullptr;
 			if (view)
-				context->PSSetShaderResources(35, 1, &view);
+				State::GetSingleton()->SetPSShaderResources(35, 1, &view);
 		} else {
 			Bindings::GetSingleton()->SetOverwriteTerrainMode(false);
 			Bindings::GetSingleton()->SetOverwriteTerrainMaskingMode(Bindings::TerrainMaskMode::kNone);
@@ -33,6 +33,7 @@ public:
 
 	bool ValidBlendingPass(RE::BSRenderPass* a_pass);
 
+	bool HasDraw(RE::BSShader::Type) override { return false; }
 	virtual void Draw(const RE::BSShader* shader, const uint32_t descriptor);
 
 	virtual void Load(json& o_json);
@@ -1,4 +1,5 @@
 #include "WaterBlending.h"
+#include <State.h>
 #include <Util.h>
 
 NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(
@@ -56,15 +57,26 @@ void WaterBlending::Draw(const RE::BSShader* shader, const uint32_t)
 			ID3D11ShaderResourceView* views[2]{};
 			views[0] = renderer->GetDepthStencilData().depthStencils[RE::RENDER_TARGETS_DEPTHSTENCIL::kPOST_ZPREPASS_COPY].depthSRV;
 			views[1] = perPass->srv.get();
-			context->PSSetShaderResources(33, ARRAYSIZE(views), views);
+			State::GetSingleton()->SetPSShaderResources(33, ARRAYSIZE(views), views);
 		} else {
 			ID3D11ShaderResourceView* views[1]{};
 			views[0] = perPass->srv.get();
-			context->PSSetShaderResources(34, ARRAYSIZE(views), views);
+			State::GetSingleton()->SetPSShaderResources(34, ARRAYSIZE(views), views);
 		}
 	}
 }
 
+bool WaterBlending::HasDraw(RE::BSShader::Type shaderType)
+{
+	switch (shaderType) {
+	case RE::BSShader::Type::Water:
+	case RE::BSShader::Type::Lighting:
+		return true;
+	default:
+		return false;
+	}
+}
+
 void WaterBlending::SetupResources()
 {
 	D3D11_BUFFER_DESC sbDesc{};
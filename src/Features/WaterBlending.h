@@ -40,6 +40,7 @@ public:
 
 	virtual void DrawSettings();
 
+	bool HasDraw(RE::BSShader::Type shaderType) override;
 	virtual void Draw(const RE::BSShader* shader, const uint32_t descriptor);
 
 	virtual void Load(json& o_json);
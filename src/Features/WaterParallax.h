@@ -22,6 +22,7 @@ public:
 
 	virtual void DrawSettings();
 
+	bool HasDraw(RE::BSShader::Type) override { return false; }
 	virtual void Draw(const RE::BSShader* shader, const uint32_t descriptor);
 
 	virtual void Load(json& o_json);
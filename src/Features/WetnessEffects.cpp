@@ -1,26 +1,8 @@
 #include "WetnessEffects.h"
 
+#include "State.h"
 #include "Util.h"
 
-const float MIN_START_PERCENTAGE = 0.05f;
-const float DEFAULT_TRANSITION_PERCENTAGE = 1.0f;
-const float TRANSITION_CURVE_MULTIPLIER = 2.0f;
-const float TRANSITION_DENOMINATOR = 256.0f;
-const float DRY_WETNESS = 0.0f;
-const float RAIN_DELTA_PER_SECOND = 2.0f / 3600.0f;
-const float SNOWY_DAY_DELTA_PER_SECOND = -0.489f / 3600.0f;  // Only doing evaporation until snow wetness feature is added
-const float CLOUDY_DAY_DELTA_PER_SECOND = -0.735f / 3600.0f;
-const float CLEAR_DAY_DELTA_PER_SECOND = -1.518f / 3600.0f;
-const float WETNESS_SCALE = 2.0;  // Speed at which wetness builds up and drys.
-const float PUDDLE_SCALE = 1.0;   // Speed at which puddles build up and dry
-const float MAX_PUDDLE_DEPTH = 3.0f;
-const float MAX_WETNESS_DEPTH = 2.0f;
-const float MAX_PUDDLE_WETNESS = 1.0f;
-const float MAX_WETNESS = 1.0f;
-const float SECONDS_IN_A_DAY = 86400;
-const float MAX_TIME_DELTA = SECONDS_IN_A_DAY - 30;
-const float MIN_WEATHER_TRANSITION_SPEED = 0.0f;
-const float MAX_WEATHER_TRANSITION_SPEED = 500.0f;
 const float AVERAGE_RAIN_VOLUME = 4000.0f;
 const float MIN_RAINDROP_CHANCE_MULTIPLIER = 0.1f;
 const float MAX_RAINDROP_CHANCE_MULTIPLIER = 2.0f;
@@ -215,55 +197,91 @@ void WetnessEffects::DrawSettings()
 	ImGui::Spacing();
 
 	if (ImGui::TreeNodeEx("Statistics", ImGuiTreeNodeFlags_DefaultOpen)) {
-		ImGui::Text(std::format("Wetness depth : {:.2f}", wetnessDepth / WETNESS_SCALE).c_str());
-		ImGui::Text(std::format("Puddle depth : {:.2f}", puddleDepth / PUDDLE_SCALE).c_str());
+		ImGui::Text(std::format("Wetness depth : {:.2f}", simulation.GetWetnessDepth() / WetnessSimulation::WETNESS_SCALE).c_str());
+		ImGui::Text(std::format("Puddle depth : {:.2f}", simulation.GetPuddleDepth() / WetnessSimulation::PUDDLE_SCALE).c_str());
+		ImGui::Text(std::format("Simulation steps : {}", simulation.GetLastStepCount()).c_str());
 		ImGui::Spacing();
 		ImGui::Spacing();
-		ImGui::Text(std::format("Current weather : {0:X}", currentWeatherID).c_str());
-		ImGui::Text(std::format("Previous weather : {0:X}", lastWeatherID).c_str());
+		ImGui::Text(std::format("Current weather : {0:X}", simulation.GetCurrentWeatherID()).c_str());
+		ImGui::Text(std::format("Previous weather : {0:X}", simulation.GetLastWeatherID()).c_str());
 		ImGui::TreePop();
 	}
 }
 
-float WetnessEffects::CalculateWeatherTransitionPercentage(float skyCurrentWeatherPct, float beginFade, bool fadeIn)
+WetnessSimulation::Weather WetnessEffects::GetWeather(RE::TESWeather* weather)
 {
-	float weatherTransitionPercentage = DEFAULT_TRANSITION_PERCENTAGE;
-	// Correct if beginFade is zero or negative
-	beginFade = beginFade > 0 ? beginFade : beginFade + TRANSITION_DENOMINATOR;
-	// Wait to start transition until precipitation begins/ends
-	float startPercentage = 1 - ((TRANSITION_DENOMINATOR - beginFade) * (1.0f / TRANSITION_DENOMINATOR));
-
-	if (fadeIn) {
-		float currentPercentage = (skyCurrentWeatherPct - startPercentage) / (1 - startPercentage);
-		weatherTransitionPercentage = std::clamp(currentPercentage, 0.0f, 1.0f);
-	} else {
-		float currentPercentage = (startPercentage - skyCurrentWeatherPct) / (startPercentage);
-		weatherTransitionPercentage = 1 - std::clamp(currentPercentage, 0.0f, 1.0f);
+	WetnessSimulation::Weather result;
+	result.id = weather->GetFormID();
+	result.precipitationBeginFadeIn = static_cast<float>(weather->data.precipitationBeginFadeIn);
+	result.precipitationEndFadeOut = static_cast<float>(weather->data.precipitationEndFadeOut);
+
+	// Figure out the weather type
+	if (weather->precipitationData && weather->data.flags.any(RE::TESWeather::WeatherDataFlag::kRainy)) {
+		result.type = WetnessSimulation::WeatherType::Rainy;
+		float rainDensity = weather->precipitationData->data[static_cast<int>(RE::BGSShaderParticleGeometryData::DataID::kParticleDensity)].f;
+		float rainGravity = weather->precipitationData->data[static_cast<int>(RE::BGSShaderParticleGeometryData::DataID::kGravityVelocity)].f;
+		result.raining = std::clamp(((rainDensity * rainGravity) / AVERAGE_RAIN_VOLUME), MIN_RAINDROP_CHANCE_MULTIPLIER, MAX_RAINDROP_CHANCE_MULTIPLIER);
+	} else if (weather->precipitationData && weather->data.flags.any(RE::TESWeather::WeatherDataFlag::kSnow)) {
+		result.type = WetnessSimulation::WeatherType::Snowy;
+	} else if (weather->data.flags.any(RE::TESWeather::WeatherDataFlag::kCloudy)) {
+		result.type = WetnessSimulation::WeatherType::Cloudy;
 	}
-	return weatherTransitionPercentage;
+	return result;
 }
 
-void WetnessEffects::CalculateWetness(RE::TESWeather* weather, RE::Sky* sky, float seconds, float& weatherWetnessDepth, float& weatherPuddleDepth)
+void WetnessEffects::UpdatePerPass()
 {
-	float wetnessDepthDelta = CLEAR_DAY_DELTA_PER_SECOND * WETNESS_SCALE * seconds;
-	float puddleDepthDelta = CLEAR_DAY_DELTA_PER_SECOND * PUDDLE_SCALE * seconds;
-	if (weather && sky) {
-		// Figure out the weather type and set the wetness
-		if (weather->precipitationData && weather->data.flags.any(RE::TESWeather::WeatherDataFlag::kRainy)) {
-			// Raining
-			wetnessDepthDelta = RAIN_DELTA_PER_SECOND * WETNESS_SCALE * seconds;
-			puddleDepthDelta = RAIN_DELTA_PER_SECOND * PUDDLE_SCALE * seconds;
-		} else if (weather->precipitationData && weather->data.flags.any(RE::TESWeather::WeatherDataFlag::kSnow)) {
-			wetnessDepthDelta = SNOWY_DAY_DELTA_PER_SECOND * WETNESS_SCALE * seconds;
-			puddleDepthDelta = SNOWY_DAY_DELTA_PER_SECOND * PUDDLE_SCALE * seconds;
-		} else if (weather->data.flags.any(RE::TESWeather::WeatherDataFlag::kCloudy)) {
-			wetnessDepthDelta = CLOUDY_DAY_DELTA_PER_SECOND * WETNESS_SCALE * seconds;
-			puddleDepthDelta = CLOUDY_DAY_DELTA_PER_SECOND * PUDDLE_SCALE * seconds;
+	auto& frameContext = State::GetSingleton()->GetFrameContext();
+
+	WetnessSimulation::Input input{};
+	if (settings.EnableWetnessEffects) {
+		auto sky = frameContext.sky;
+		auto calendar = RE::Calendar::GetSingleton();
+		if (sky && calendar && sky->mode.get() == RE::Sky::Mode::kFull && sky->currentWeather) {
+			input.hasWeather = true;
+			input.currentWeather = GetWeather(sky->currentWeather);
+			if (auto lastWeather = sky->lastWeather) {
+				input.hasLastWeather = true;
+				input.lastWeather = GetWeather(lastWeather);
+			}
+			input.currentWeatherPct = sky->currentWeatherPct;
+			input.gameTime = static_cast<double>(calendar->GetCurrentGameTime()) * 86400.0;
+			input.transitionSpeed = settings.WeatherTransitionSpeed;
 		}
 	}
 
-	weatherWetnessDepth = wetnessDepthDelta > 0 ? std::min(weatherWetnessDepth + wetnessDepthDelta, MAX_WETNESS_DEPTH) : std::max(weatherWetnessDepth + wetnessDepthDelta, 0.0f);
-	weatherPuddleDepth = puddleDepthDelta > 0 ? std::min(weatherPuddleDepth + puddleDepthDelta, MAX_PUDDLE_DEPTH) : std::max(weatherPuddleDepth + puddleDepthDelta, 0.0f);
+	auto wetness = simulation.Tick(input);
+
+	PerPass data{};
+	data.Wetness = wetness.wetness;
+	data.PuddleWetness = wetness.puddleWetness;
+	data.Raining = wetness.raining;
+
+	data.DirectionalAmbientWS = frameContext.directionalAmbient;
+
+	data.PrecipProj = precipProj;
+
+	if (!RE::UI::GetSingleton()->GameIsPaused())                       // from lightlimitfix
+		rainTimer += (size_t)(RE::GetSecondsSinceLastFrame() * 1000);  // BSTimer::delta is always 0 for some reason
+	data.Time = rainTimer / 1000.f;
+
+	data.settings = settings;
+	// Disable Shore Wetness if Wetness Effects are Disabled
+	data.settings.MaxShoreWetness = settings.EnableWetnessEffects ? settings.MaxShoreWetness : 0.0f;
+	// calculating some parameters on cpu
+	data.settings.RaindropChance *= data.Raining;
+	data.settings.RaindropGridSize = 1.f / settings.RaindropGridSize;
+	data.settings.RaindropInterval = 1.f / settings.RaindropInterval;
+	data.settings.RippleLifetime = settings.RaindropInterval / settings.RippleLifetime;
+	data.settings.ChaoticRippleStrength *= std::clamp(data.Raining, 0.f, 1.f);
+	data.settings.ChaoticRippleScale = 1.f / settings.ChaoticRippleScale;
+
+	auto context = RE::BSGraphics::Renderer::GetSingleton()->GetRuntimeData().context;
+	D3D11_MAPPED_SUBRESOURCE mapped;
+	DX::ThrowIfFailed(context->Map(perPass->resource.get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped));
+	size_t bytes = sizeof(PerPass);
+	memcpy_s(mapped.pData, bytes, &data, bytes);
+	context->Unmap(perPass->resource.get(), 0);
 }
 
 void WetnessEffects::Draw(const RE::BSShader* shader, const uint32_t)
@@ -271,115 +289,6 @@ void WetnessEffects::Draw(const RE::BSShader* shader, const uint32_t)
 	if (shader->shaderType.any(RE::BSShader::Type::Lighting, RE::BSShader::Type::Grass)) {
 		auto context = RE::BSGraphics::Renderer::GetSingleton()->GetRuntimeData().context;
 
-		if (requiresUpdate) {
-			requiresUpdate = false;
-
-			PerPass data{};
-			data.Wetness = DRY_WETNESS;
-			data.PuddleWetness = DRY_WETNESS;
-			currentWeatherID = 0;
-			uint32_t previousLastWeatherID = lastWeatherID;
-			lastWeatherID = 0;
-			float currentWeatherRaining = 0.0f;
-			float lastWeatherRaining = 0.0f;
-			float weatherTransitionPercentage = previousWeatherTransitionPercentage;
-
-			if (settings.EnableWetnessEffects) {
-				if (auto sky = RE::Sky::GetSingleton()) {
-					if (sky->mode.get() == RE::Sky::Mode::kFull) {
-						if (auto currentWeather = sky->currentWeather) {
-							if (currentWeather->precipitationData && currentWeather->data.flags.any(RE::TESWeather::WeatherDataFlag::kRainy)) {
-								float rainDensity = currentWeather->precipitationData->data[static_cast<int>(RE::BGSShaderParticleGeometryData::DataID::kParticleDensity)].f;
-								float rainGravity = currentWeather->precipitationData->data[static_cast<int>(RE::BGSShaderParticleGeometryData::DataID::kGravityVelocity)].f;
-								currentWeatherRaining = std::clamp(((rainDensity * rainGravity) / AVERAGE_RAIN_VOLUME), MIN_RAINDROP_CHANCE_MULTIPLIER, MAX_RAINDROP_CHANCE_MULTIPLIER);
-							}
-							currentWeatherID = currentWeather->GetFormID();
-							if (auto calendar = RE::Calendar::GetSingleton()) {
-								float currentWeatherWetnessDepth = wetnessDepth;
-								float currentWeatherPuddleDepth = puddleDepth;
-								float currentGameTime = calendar->GetCurrentGameTime() * SECONDS_IN_A_DAY;
-								lastGameTimeValue = lastGameTimeValue == 0 ? currentGameTime : lastGameTimeValue;
-								float seconds = currentGameTime - lastGameTimeValue;
-								lastGameTimeValue = currentGameTime;
-
-								if (abs(seconds) >= MAX_TIME_DELTA) {
-									// If too much time has passed, snap wetness depths to the current weather.
-									seconds = 0.0f;
-									currentWeatherWetnessDepth = 0.0f;
-									currentWeatherPuddleDepth = 0.0f;
-									weatherTransitionPercentage = DEFAULT_TRANSITION_PERCENTAGE;
-									CalculateWetness(currentWeather, sky, 1.0f, currentWeatherWetnessDepth, currentWeatherPuddleDepth);
-									wetnessDepth = currentWeatherWetnessDepth > 0 ? MAX_WETNESS_DEPTH : 0.0f;
-									puddleDepth = currentWeatherPuddleDepth > 0 ? MAX_PUDDLE_DEPTH : 0.0f;
-								}
-
-								if (seconds > 0 || (seconds < 0 && (wetnessDepth > 0 || puddleDepth > 0))) {
-									weatherTransitionPercentage = DEFAULT_TRANSITION_PERCENTAGE;
-									float lastWeatherWetnessDepth = wetnessDepth;
-									float lastWeatherPuddleDepth = puddleDepth;
-									seconds *= std::clamp(settings.WeatherTransitionSpeed, MIN_WEATHER_TRANSITION_SPEED, MAX_WEATHER_TRANSITION_SPEED);
-									CalculateWetness(currentWeather, sky, seconds, currentWeatherWetnessDepth, currentWeatherPuddleDepth);
-									// If there is a lastWeather, figure out what type it is and set the wetness
-									if (auto lastWeather = sky->lastWeather) {
-										lastWeatherID = lastWeather->GetFormID();
-										CalculateWetness(lastWeather, sky, seconds, lastWeatherWetnessDepth, lastWeatherPuddleDepth);
-										// If it was raining, wait to transition until precipitation ends, otherwise use the current weather's fade in
-										if (lastWeather->precipitationData && lastWeather->data.flags.any(RE::TESWeather::WeatherDataFlag::kRainy)) {
-											float rainDensity = lastWeather->precipitationData->data[static_cast<int>(RE::BGSShaderParticleGeometryData::DataID::kParticleDensity)].f;
-											float rainGravity = lastWeather->precipitationData->data[static_cast<int>(RE::BGSShaderParticleGeometryData::DataID::kGravityVelocity)].f;
-											lastWeatherRaining = std::clamp(((rainDensity * rainGravity) / AVERAGE_RAIN_VOLUME), MIN_RAINDROP_CHANCE_MULTIPLIER, MAX_RAINDROP_CHANCE_MULTIPLIER);
-											weatherTransitionPercentage = CalculateWeatherTransitionPercentage(sky->currentWeatherPct, lastWeather->data.precipitationEndFadeOut, false);
-										} else {
-											weatherTransitionPercentage = CalculateWeatherTransitionPercentage(sky->currentWeatherPct, currentWeather->data.precipitationBeginFadeIn, true);
-										}
-									}
-
-									// Transition between CurrentWeather and LastWeather depth values
-									wetnessDepth = std::lerp(lastWeatherWetnessDepth, currentWeatherWetnessDepth, weatherTransitionPercentage);
-									puddleDepth = std::lerp(lastWeatherPuddleDepth, currentWeatherPuddleDepth, weatherTransitionPercentage);
-								} else {
-									lastWeatherID = previousLastWeatherID;
-								}
-
-								// Calculate the wetness value from the water depth
-								data.Wetness = std::min(wetnessDepth, MAX_WETNESS);
-								data.PuddleWetness = std::min(puddleDepth, MAX_PUDDLE_WETNESS);
-								data.Raining = std::lerp(lastWeatherRaining, currentWeatherRaining, weatherTransitionPercentage);
-								previousWeatherTransitionPercentage = weatherTransitionPercentage;
-							}
-						}
-					}
-				}
-			}
-
-			auto& state = RE::BSShaderManager::State::GetSingleton();
-			RE::NiTransform& dalcTransform = state.directionalAmbientTransform;
-			Util::StoreTransform3x4NoScale(data.DirectionalAmbientWS, dalcTransform);
-
-			data.PrecipProj = precipProj;
-
-			static size_t rainTimer = 0;                                       // size_t for precision
-			if (!RE::UI::GetSingleton()->GameIsPaused())                       // from lightlimitfix
-				rainTimer += (size_t)(RE::GetSecondsSinceLastFrame() * 1000);  // BSTimer::delta is always 0 for some reason
-			data.Time = rainTimer / 1000.f;
-
-			data.settings = settings;
-			// Disable Shore Wetness if Wetness Effects are Disabled
-			data.settings.MaxShoreWetness = settings.EnableWetnessEffects ? settings.MaxShoreWetness : 0.0f;
-			// calculating some parameters on cpu
-			data.settings.RaindropChance *= data.Raining;
-			data.settings.RaindropGridSize = 1.f / settings.RaindropGridSize;
-			data.settings.RaindropInterval = 1.f / settings.RaindropInterval;
-			data.settings.RippleLifetime = settings.RaindropInterval / settings.RippleLifetime;
-			data.settings.ChaoticRippleStrength *= std::clamp(data.Raining, 0.f, 1.f);
-			data.settings.ChaoticRippleScale = 1.f / settings.ChaoticRippleScale;
-
-			D3D11_MAPPED_SUBRESOURCE mapped;
-			DX::ThrowIfFailed(context->Map(perPass->resource.get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped));
-			size_t bytes = sizeof(PerPass);
-			memcpy_s(mapped.pData, bytes, &data, bytes);
-			context->Unmap(perPass->resource.get(), 0);
-		}
 		ID3D11ShaderResourceView* views[1]{};
 		views[0] = perPass->srv.get();
 		context->PSSetShaderResources(22, ARRAYSIZE(views), views);
@@ -389,6 +298,17 @@ void WetnessEffects::Draw(const RE::BSShader* shader, const uint32_t)
 	}
 }
 
+bool WetnessEffects::HasDraw(RE::BSShader::Type shaderType)
+{
+	switch (shaderType) {
+	case RE::BSShader::Type::Lighting:
+	case RE::BSShader::Type::Grass:
+		return true;
+	default:
+		return false;
+	}
+}
+
 void WetnessEffects::SetupResources()
 {
 	{
@@ -426,7 +346,8 @@ void WetnessEffects::SetupResources()
 
 void WetnessEffects::Reset()
 {
-	requiresUpdate = true;
+	// Ticked once per frame at present, the result is used by the next frame's draws
+	UpdatePerPass();
 }
 
 void WetnessEffects::Load(json& o_json)
@@ -2,6 +2,7 @@
 
 #include "Buffer.h"
 #include "Feature.h"
+#include "Features/WetnessEffects/WetnessSimulation.h"
 
 struct WetnessEffects : Feature
 {
@@ -76,13 +77,8 @@ public:
 
 	std::unique_ptr<Texture2D> precipOcclusionTex = nullptr;
 
-	bool requiresUpdate = true;
-	float wetnessDepth = 0.0f;
-	float puddleDepth = 0.0f;
-	float lastGameTimeValue = 0.0f;
-	uint32_t currentWeatherID = 0;
-	uint32_t lastWeatherID = 0;
-	float previousWeatherTransitionPercentage = 0.0f;
+	WetnessSimulation simulation;
+	size_t rainTimer = 0;  // milliseconds, size_t for precision
 	RE::DirectX::XMFLOAT4X4 precipProj;
 
 	virtual void SetupResources();
@@ -90,14 +86,15 @@ public:
 
 	virtual void DrawSettings();
 
+	bool HasDraw(RE::BSShader::Type shaderType) override;
 	virtual void Draw(const RE::BSShader* shader, const uint32_t descriptor);
 
 	virtual void Load(json& o_json);
 	virtual void Save(json& o_json);
 
 	virtual void RestoreDefaultSettings();
-	float CalculateWeatherTransitionPercentage(float skyCurrentWeatherPct, float beginFade, bool fadeIn);
-	void CalculateWetness(RE::TESWeather* weather, RE::Sky* sky, float seconds, float& wetness, float& puddleWetness);
+	static WetnessSimulation::Weather GetWeather(RE::TESWeather* weather);
+	void UpdatePerPass();
 
 	virtual inline void PostPostLoad() override { Hooks::Install(); }
 
@@ -0,0 +1,145 @@
+#include "Features/WetnessEffects/WetnessSimulation.h"
+
+const float DEFAULT_TRANSITION_PERCENTAGE = 1.0f;
+const float TRANSITION_DENOMINATOR = 256.0f;
+const float RAIN_DELTA_PER_SECOND = 2.0f / 3600.0f;
+const float SNOWY_DAY_DELTA_PER_SECOND = -0.489f / 3600.0f;  // Only doing evaporation until snow wetness feature is added
+const float CLOUDY_DAY_DELTA_PER_SECOND = -0.735f / 3600.0f;
+const float CLEAR_DAY_DELTA_PER_SECOND = -1.518f / 3600.0f;
+const float MAX_PUDDLE_DEPTH = 3.0f;
+const float MAX_WETNESS_DEPTH = 2.0f;
+const float MAX_PUDDLE_WETNESS = 1.0f;
+const float MAX_WETNESS = 1.0f;
+const float SECONDS_IN_A_DAY = 86400;
+const float MAX_TIME_DELTA = SECONDS_IN_A_DAY - 30;
+const float MIN_WEATHER_TRANSITION_SPEED = 0.0f;
+const float MAX_WEATHER_TRANSITION_SPEED = 500.0f;
+
+float WetnessSimulation::CalculateWeatherTransitionPercentage(float a_currentWeatherPct, float a_beginFade, bool a_fadeIn)
+{
+	float weatherTransitionPercentage = DEFAULT_TRANSITION_PERCENTAGE;
+	// Correct if beginFade is zero or negative
+	a_beginFade = a_beginFade > 0 ? a_beginFade : a_beginFade + TRANSITION_DENOMINATOR;
+	// Wait to start transition until precipitation begins/ends
+	float startPercentage = 1 - ((TRANSITION_DENOMINATOR - a_beginFade) * (1.0f / TRANSITION_DENOMINATOR));
+
+	if (a_fadeIn) {
+		float currentPercentage = (a_currentWeatherPct - startPercentage) / (1 - startPercentage);
+		weatherTransitionPercentage = std::clamp(currentPercentage, 0.0f, 1.0f);
+	} else {
+		float currentPercentage = (startPercentage - a_currentWeatherPct) / (startPercentage);
+		weatherTransitionPercentage = 1 - std::clamp(currentPercentage, 0.0f, 1.0f);
+	}
+	return weatherTransitionPercentage;
+}
+
+void WetnessSimulation::CalculateWetness(WeatherType a_type, float a_seconds, float& a_wetnessDepth, float& a_puddleDepth)
+{
+	float deltaPerSecond = CLEAR_DAY_DELTA_PER_SECOND;
+	switch (a_type) {
+	case WeatherType::Rainy:
+		deltaPerSecond = RAIN_DELTA_PER_SECOND;
+		break;
+	case WeatherType::Snowy:
+		deltaPerSecond = SNOWY_DAY_DELTA_PER_SECOND;
+		break;
+	case WeatherType::Cloudy:
+		deltaPerSecond = CLOUDY_DAY_DELTA_PER_SECOND;
+		break;
+	default:
+		break;
+	}
+
+	float wetnessDepthDelta = deltaPerSecond * WETNESS_SCALE * a_seconds;
+	float puddleDepthDelta = deltaPerSecond * PUDDLE_SCALE * a_seconds;
+
+	a_wetnessDepth = wetnessDepthDelta > 0 ? std::min(a_wetnessDepth + wetnessDepthDelta, MAX_WETNESS_DEPTH) : std::max(a_wetnessDepth + wetnessDepthDelta, 0.0f);
+	a_puddleDepth = puddleDepthDelta > 0 ? std::min(a_puddleDepth + puddleDepthDelta, MAX_PUDDLE_DEPTH) : std::max(a_puddleDepth + puddleDepthDelta, 0.0f);
+}
+
+float WetnessSimulation::GetTransitionPercentage(const Input& a_input)
+{
+	if (!a_input.hasLastWeather)
+		return DEFAULT_TRANSITION_PERCENTAGE;
+
+	// If it was raining, wait to transition until precipitation ends, otherwise use the current weather's fade in
+	if (a_input.lastWeather.type == WeatherType::Rainy)
+		return CalculateWeatherTransitionPercentage(a_input.currentWeatherPct, a_input.lastWeather.precipitationEndFadeOut, false);
+	return CalculateWeatherTransitionPercentage(a_input.currentWeatherPct, a_input.currentWeather.precipitationBeginFadeIn, true);
+}
+
+void WetnessSimulation::Step(const Input& a_input, float a_seconds, float a_transitionPercentage)
+{
+	a_seconds *= std::clamp(a_input.transitionSpeed, MIN_WEATHER_TRANSITION_SPEED, MAX_WEATHER_TRANSITION_SPEED);
+
+	float currentWeatherWetnessDepth = wetnessDepth;
+	float currentWeatherPuddleDepth = puddleDepth;
+	CalculateWetness(a_input.currentWeather.type, a_seconds, currentWeatherWetnessDepth, currentWeatherPuddleDepth);
+
+	if (!a_input.hasLastWeather) {
+		wetnessDepth = currentWeatherWetnessDepth;
+		puddleDepth = currentWeatherPuddleDepth;
+		return;
+	}
+
+	float lastWeatherWetnessDepth = wetnessDepth;
+	float lastWeatherPuddleDepth = puddleDepth;
+	CalculateWetness(a_input.lastWeather.type, a_seconds, lastWeatherWetnessDepth, lastWeatherPuddleDepth);
+
+	// Transition between CurrentWeather and LastWeather depth values
+	wetnessDepth = std::lerp(lastWeatherWetnessDepth, currentWeatherWetnessDepth, a_transitionPercentage);
+	puddleDepth = std::lerp(lastWeatherPuddleDepth, currentWeatherPuddleDepth, a_transitionPercentage);
+}
+
+WetnessSimulation::Output WetnessSimulation::Tick(const Input& a_input)
+{
+	Output output{};
+	lastStepCount = 0;
+	if (!a_input.hasWeather) {
+		// Depths and game time are kept, so the time spent without a sky is caught up afterwards
+		currentWeatherID = 0;
+		lastWeatherID = 0;
+		return output;
+	}
+
+	currentWeatherID = a_input.currentWeather.id;
+	lastWeatherID = a_input.hasLastWeather ? a_input.lastWeather.id : 0;
+
+	const float transitionPercentage = GetTransitionPercentage(a_input);
+
+	lastGameTime = lastGameTime == 0.0 ? a_input.gameTime : lastGameTime;
+	double seconds = a_input.gameTime - lastGameTime;
+	lastGameTime = a_input.gameTime;
+
+	if (std::abs(seconds) >= MAX_TIME_DELTA) {
+		// If too much time has passed, snap wetness depths to the current weather.
+		float currentWeatherWetnessDepth = 0.0f;
+		float currentWeatherPuddleDepth = 0.0f;
+		CalculateWetness(a_input.currentWeather.type, 1.0f, currentWeatherWetnessDepth, currentWeatherPuddleDepth);
+		wetnessDepth = currentWeatherWetnessDepth > 0 ? MAX_WETNESS_DEPTH : 0.0f;
+		puddleDepth = currentWeatherPuddleDepth > 0 ? MAX_PUDDLE_DEPTH : 0.0f;
+		accumulator = 0.0;
+	} else if (seconds < 0) {
+		// Time went backwards, e.g. after loading an earlier save
+		accumulator = 0.0;
+		if (wetnessDepth > 0 || puddleDepth > 0) {
+			Step(a_input, static_cast<float>(seconds), transitionPercentage);
+			lastStepCount = 1;
+		}
+	} else {
+		accumulator += seconds;
+		const double step = std::max(STEP_SECONDS, accumulator / MAX_STEPS);
+		while (accumulator >= step) {
+			Step(a_input, static_cast<float>(step), transitionPercentage);
+			accumulator -= step;
+			lastStepCount++;
+		}
+	}
+
+	// Calculate the wetness value from the water depth
+	output.wetness = std::min(wetnessDepth, MAX_WETNESS);
+	output.puddleWetness = std::min(puddleDepth, MAX_PUDDLE_WETNESS);
+	const float lastWeatherRaining = a_input.hasLastWeather ? a_input.lastWeather.raining : 0.0f;
+	output.raining = std::lerp(lastWeatherRaining, a_input.currentWeather.raining, transitionPercentage);
+	return output;
+}
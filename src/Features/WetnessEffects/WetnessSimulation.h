@@ -0,0 +1,76 @@
+#pragma once
+
+/**
+ * Surface and puddle water depth driven by the weather, advanced in fixed steps of game time.
+ * Only plain weather descriptions go in, so the same timeline always produces the same output
+ * regardless of frame rate.
+ */
+class WetnessSimulation
+{
+public:
+	static constexpr double STEP_SECONDS = 1.0;    // game seconds per step, before the transition speed
+	static constexpr uint MAX_STEPS = 1024;        // larger time deltas use longer steps
+	static constexpr float WETNESS_SCALE = 2.0f;  // Speed at which wetness builds up and drys.
+	static constexpr float PUDDLE_SCALE = 1.0f;   // Speed at which puddles build up and dry
+
+	enum class WeatherType
+	{
+		Clear,
+		Cloudy,
+		Rainy,
+		Snowy
+	};
+
+	struct Weather
+	{
+		uint32_t id = 0;
+		WeatherType type = WeatherType::Clear;
+		float raining = 0.0f;  // raindrop chance multiplier from the precipitation volume, 0 unless rainy
+		float precipitationBeginFadeIn = 0.0f;
+		float precipitationEndFadeOut = 0.0f;
+	};
+
+	struct Input
+	{
+		bool hasWeather = false;  // false outside full sky mode
+		Weather currentWeather;
+		bool hasLastWeather = false;
+		Weather lastWeather;
+		float currentWeatherPct = 1.0f;
+		double gameTime = 0.0;  // seconds
+		float transitionSpeed = 1.0f;
+	};
+
+	struct Output
+	{
+		float wetness = 0.0f;
+		float puddleWetness = 0.0f;
+		float raining = 0.0f;
+	};
+
+	/**
+	 * Advances the simulation to a_input.gameTime and returns the values for this frame.
+	 */
+	Output Tick(const Input& a_input);
+
+	static float CalculateWeatherTransitionPercentage(float a_currentWeatherPct, float a_beginFade, bool a_fadeIn);
+	static void CalculateWetness(WeatherType a_type, float a_seconds, float& a_wetnessDepth, float& a_puddleDepth);
+
+	inline float GetWetnessDepth() const { return wetnessDepth; }
+	inline float GetPuddleDepth() const { return puddleDepth; }
+	inline uint32_t GetCurrentWeatherID() const { return currentWeatherID; }
+	inline uint32_t GetLastWeatherID() const { return lastWeatherID; }
+	inline uint GetLastStepCount() const { return lastStepCount; }  // steps taken by the last Tick
+
+private:
+	void Step(const Input& a_input, float a_seconds, float a_transitionPercentage);
+	static float GetTransitionPercentage(const Input& a_input);
+
+	float wetnessDepth = 0.0f;
+	float puddleDepth = 0.0f;
+	double lastGameTime = 0.0;
+	double accumulator = 0.0;
+	uint lastStepCount = 0;
+	uint32_t currentWeatherID = 0;
+	uint32_t lastWeatherID = 0;
+};
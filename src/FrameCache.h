@@ -0,0 +1,30 @@
+#pragma once
+
+namespace Util
+{
+	/**
+	 * Holds a value captured on the first Get of each frame and returned as is until Invalidate.
+	 * For engine state that does not change within a frame but is read on every draw.
+	 */
+	template <class T>
+	class FrameCache
+	{
+	public:
+		/** @brief Returns the cached value, calling a_capture(value) first if nothing was captured this frame. */
+		template <class Capture>
+		const T& Get(Capture&& a_capture)
+		{
+			if (!valid) {
+				a_capture(value);
+				valid = true;
+			}
+			return value;
+		}
+
+		inline void Invalidate() { valid = false; }
+
+	private:
+		T value{};
+		bool valid = false;
+	};
+}
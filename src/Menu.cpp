@@ -127,6 +127,11 @@ void Menu::Init(IDXGISwapChain* swapchain, ID3D11Device* device, ID3D11DeviceCon
 	style.MouseCursorScale = 1.f;
 	auto& io = ImGui::GetIO();
 	io.FontGlobalScale = trueScale;
+
+	SIE::ShaderCache::Instance().SubscribeCompilationEvents([this](const SIE::CompilationEvent& a_event) {
+		if (a_event.type == SIE::CompilationEvent::Type::Finished && benchmark.IsRunning())
+			benchmark.AddShaderCompile();
+	});
 }
 
 void Menu::DrawSettings()
@@ -340,16 +345,38 @@ void Menu::DrawSettings()
 					"This is activated if the startup compilation is skipped. "
 					"The more threads the faster compilation will finish but may make the system unresponsive. ");
 			}
+			ImGui::SliderInt("Shader Memory Budget", (int*)&shaderCache.memoryBudget, 0, 2048, "%d MB");
+			if (auto _tt = Util::HoverTooltipWrapper()) {
+				ImGui::Text(
+					"Memory for created shaders and their compiled bytecode before the least recently used ones are released. "
+					"Released shaders are created again when next drawn. "
+					"With the Disk Cache on, their bytecode is released too and read back from disk, otherwise it stays in memory and is not counted. "
+					"0 disables. ");
+			}
+			ImGui::SliderInt("Shader Eviction Frames", (int*)&shaderCache.evictionFrames, 60, 18000);
+			if (auto _tt = Util::HoverTooltipWrapper()) {
+				ImGui::Text("Frames a shader must be unused before it can be released. ");
+			}
+			ImGui::Checkbox("Shader Include Cache", &shaderCache.useIncludeCache);
+			if (auto _tt = Util::HoverTooltipWrapper()) {
+				ImGui::Text(
+					"Keep shader source files in memory and share them between compiler threads instead of reading them from disk for every shader. "
+					"Files are read again when modified. "
+					"Compare Shader Compile Times in Statistics with and without it after rebuilding shaders. ");
+			}
 
 			if (ImGui::SliderInt("Test Interval", (int*)&testInterval, 0, 10)) {
 				if (testInterval == 0) {
 					inTestMode = false;
+					benchmark.Stop();
 					logger::info("Disabling test mode.");
 					State::GetSingleton()->Load(true);  // restore last settings before entering test mode
 				} else if (testInterval && !inTestMode) {
 					logger::info("Saving current settings for test mode and starting test with interval {}.", testInterval);
 					State::GetSingleton()->Save(true);
 					inTestMode = true;
+					lastTestSwitch = lastTestFrame = high_resolution_clock::now();
+					benchmark.Start(usingTestConfig ? Benchmark::Config::Test : Benchmark::Config::User);
 				} else {
 					logger::info("Setting new interval {}.", testInterval);
 				}
@@ -361,6 +388,20 @@ void Menu::DrawSettings()
 					"Enabling will save current settings as TEST config. "
 					"This has no impact if no settings are changed. ");
 			}
+			ImGui::SliderInt("Test Warm-up Frames", (int*)&benchmark.warmupFrames, 0, 300);
+			if (auto _tt = Util::HoverTooltipWrapper()) {
+				ImGui::Text("Frames discarded from the statistics after each switch, while shaders compile and caches refill. ");
+			}
+			if (inTestMode || benchmark.GetSummary(Benchmark::Config::User).count) {
+				if (ImGui::Button("Export Test Results", { -1, 0 })) {
+					benchmark.ExportCSV("Data\\SKSE\\Plugins\\CommunityShadersBenchmark.csv", "Data\\SKSE\\Plugins\\CommunityShadersBenchmarkSummary.csv");
+				}
+				if (auto _tt = Util::HoverTooltipWrapper()) {
+					ImGui::Text(
+						"Writes every recorded frame to CommunityShadersBenchmark.csv "
+						"and the USER/TEST comparison to CommunityShadersBenchmarkSummary.csv in Data\\SKSE\\Plugins. ");
+				}
+			}
 			bool useFileWatcher = shaderCache.UseFileWatcher();
 			ImGui::TableNextColumn();
 			if (ImGui::Checkbox("Enable File Watcher", &useFileWatcher)) {
@@ -399,6 +440,101 @@ void Menu::DrawSettings()
 			}
 			if (ImGui::TreeNodeEx("Statistics", ImGuiTreeNodeFlags_DefaultOpen)) {
 				ImGui::Text(std::format("Shader Compiler : {}", shaderCache.GetShaderStatsString()).c_str());
+				ImGui::Text(std::format("Feature Binds : {} issued, {} skipped last frame", State::GetSingleton()->binds.lastFrameIssued, State::GetSingleton()->binds.lastFrameSkipped).c_str());
+				auto memoryStats = shaderCache.GetMemoryStats();
+				ImGui::Text(std::format("Shader Memory : {} shaders, {:.1f} MB, {:.1f} MB bytecode, {} evicted, {} restored", memoryStats.shaders, memoryStats.bytes / (1024.0 * 1024.0), memoryStats.bytecodeBytes / (1024.0 * 1024.0), memoryStats.evictions, memoryStats.restores).c_str());
+				auto includeStats = shaderCache.includeCache.GetStats();
+				ImGui::Text(std::format("Shader Include Cache : {} files, {} KB, {} hits, {} reads", includeStats.files, includeStats.bytes / 1024, includeStats.hits, includeStats.misses).c_str());
+				if (ImGui::TreeNode("Shader Bytecode")) {
+					if (auto _tt = Util::HoverTooltipWrapper()) {
+						ImGui::Text("Unique bytecode blobs / descriptors using them. Descriptors with identical bytecode share one shader object and one file in the disk cache.");
+					}
+					if (ImGui::BeginTable("##ShaderBytecode", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingStretchSame)) {
+						ImGui::TableSetupColumn("Type");
+						ImGui::TableSetupColumn("Vertex");
+						ImGui::TableSetupColumn("Pixel");
+						ImGui::TableSetupColumn("Saved");
+						ImGui::TableHeadersRow();
+						for (int classIndex = 1; classIndex < RE::BSShader::Type::Total; ++classIndex) {
+							auto type = static_cast<RE::BSShader::Type>(classIndex);
+							auto vertexStats = shaderCache.GetBytecodeStats(SIE::ShaderClass::Vertex, type);
+							auto pixelStats = shaderCache.GetBytecodeStats(SIE::ShaderClass::Pixel, type);
+							if (!vertexStats.descriptors && !pixelStats.descriptors)
+								continue;
+							ImGui::TableNextColumn();
+							ImGui::Text(std::format("{}", magic_enum::enum_name(type)).c_str());
+							ImGui::TableNextColumn();
+							ImGui::Text(std::format("{} / {}", vertexStats.unique, vertexStats.descriptors).c_str());
+							ImGui::TableNextColumn();
+							ImGui::Text(std::format("{} / {}", pixelStats.unique, pixelStats.descriptors).c_str());
+							ImGui::TableNextColumn();
+							ImGui::Text(std::format("{} KB", (vertexStats.savedBytes + pixelStats.savedBytes) / 1024).c_str());
+						}
+						ImGui::EndTable();
+					}
+					ImGui::TreePop();
+				}
+				if (ImGui::TreeNode("Shader Compile Times")) {
+					auto& compilationStats = shaderCache.compilationStats;
+					if (ImGui::Button("Write Compile Report")) {
+						compilationStats.WriteReport("Data\\SKSE\\Plugins\\CommunityShadersCompileReport.json");
+					}
+					if (auto _tt = Util::HoverTooltipWrapper()) {
+						const auto text = std::format(
+							"Writes the compile time histograms, the slowest permutations and the average compile time per define to Data\\SKSE\\Plugins\\CommunityShadersCompileReport.json. "
+							"The report is also written when the startup compile finishes and after later batches of {} or more shaders.",
+							SIE::ShaderCache::MIN_REPORT_BATCH);
+						ImGui::Text(text.c_str());
+					}
+					using Source = SIE::CompilationStats::Source;
+					if (ImGui::BeginTable("##ShaderCompileTimes", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingStretchSame)) {
+						ImGui::TableSetupColumn("Type");
+						ImGui::TableSetupColumn("Compiled");
+						ImGui::TableSetupColumn("Disk");
+						ImGui::TableSetupColumn("Memory");
+						ImGui::TableSetupColumn("Mean");
+						ImGui::TableSetupColumn("Max");
+						ImGui::TableHeadersRow();
+						for (int classIndex = 1; classIndex < RE::BSShader::Type::Total; ++classIndex) {
+							auto type = static_cast<RE::BSShader::Type>(classIndex);
+							auto typeStats = compilationStats.GetTypeStats(type);
+							auto compiles = typeStats.sources[static_cast<size_t>(Source::Compiled)] + typeStats.sources[static_cast<size_t>(Source::Failed)];
+							auto disk = typeStats.sources[static_cast<size_t>(Source::Disk)];
+							auto memory = typeStats.sources[static_cast<size_t>(Source::Memory)];
+							if (!compiles && !disk && !memory)
+								continue;
+							ImGui::TableNextColumn();
+							ImGui::Text(std::format("{}", magic_enum::enum_name(type)).c_str());
+							if (auto _tt = Util::HoverTooltipWrapper()) {
+								float buckets[SIE::CompilationStats::BUCKET_COUNT];
+								for (uint i = 0; i < SIE::CompilationStats::BUCKET_COUNT; i++)
+									buckets[i] = static_cast<float>(typeStats.buckets[i]);
+								ImGui::PlotHistogram("##CompileHistogram", buckets, SIE::CompilationStats::BUCKET_COUNT, 0, "compiles by duration, <1 ms to 1024+ ms", 0.0f, FLT_MAX, ImVec2(300, 80));
+							}
+							ImGui::TableNextColumn();
+							ImGui::Text(std::format("{}", compiles).c_str());
+							ImGui::TableNextColumn();
+							ImGui::Text(std::format("{}", disk).c_str());
+							ImGui::TableNextColumn();
+							ImGui::Text(std::format("{}", memory).c_str());
+							ImGui::TableNextColumn();
+							ImGui::Text(std::format("{:.1f} ms", compiles ? typeStats.compileMs / compiles : 0.0).c_str());
+							ImGui::TableNextColumn();
+							ImGui::Text(std::format("{:.1f} ms", typeStats.maxMs).c_str());
+						}
+						ImGui::EndTable();
+					}
+					if (ImGui::TreeNode("Slowest Permutations")) {
+						for (const auto& record : compilationStats.GetSlowest()) {
+							ImGui::Text(std::format("{:.1f} ms {}:{}:{:X}{}", record.milliseconds, magic_enum::enum_name(record.type), magic_enum::enum_name(record.shaderClass), record.descriptor, record.source == Source::Failed ? " (failed)" : "").c_str());
+							if (auto _tt = Util::HoverTooltipWrapper()) {
+								ImGui::Text(std::format("{} defines, {} bytes: {}", record.defineCount, record.defineBytes, record.defines).c_str());
+							}
+						}
+						ImGui::TreePop();
+					}
+					ImGui::TreePop();
+				}
 				ImGui::TreePop();
 			}
 		}
@@ -557,12 +693,17 @@ void Menu::DrawOverlay()
 	}
 
 	if (inTestMode) {  // In test mode
-		float seconds = (float)duration_cast<std::chrono::milliseconds>(high_resolution_clock::now() - lastTestSwitch).count() / 1000;
+		auto now = high_resolution_clock::now();
+		benchmark.AddFrame(duration<double, std::milli>(now - lastTestFrame).count());
+		lastTestFrame = now;
+
+		float seconds = (float)duration_cast<std::chrono::milliseconds>(now - lastTestSwitch).count() / 1000;
 		auto remaining = (float)testInterval - seconds;
 		if (remaining < 0) {
 			usingTestConfig = !usingTestConfig;
 			logger::info("Swapping mode to {}", usingTestConfig ? "test" : "user");
 			State::GetSingleton()->Load(usingTestConfig);
+			benchmark.BeginPhase(usingTestConfig ? Benchmark::Config::Test : Benchmark::Config::User);
 			lastTestSwitch = high_resolution_clock::now();
 		}
 		ImGui::SetNextWindowBgAlpha(1);
@@ -572,6 +713,29 @@ void Menu::DrawOverlay()
 			return;
 		}
 		ImGui::Text(fmt::format("{} Mode : {:.1f} seconds left", usingTestConfig ? "Test" : "User", remaining).c_str());
+
+		const auto& user = benchmark.GetSummary(Benchmark::Config::User);
+		const auto& test = benchmark.GetSummary(Benchmark::Config::Test);
+		if (user.count && test.count) {
+			const auto& comparison = benchmark.GetComparison();
+			ImGui::Text(fmt::format("Frames : {} user, {} test", user.count, test.count).c_str());
+			auto estimateRow = [](std::string_view a_name, const Benchmark::Estimate& a_user, const Benchmark::Estimate& a_test, const Benchmark::Estimate& a_delta) {
+				ImGui::Text(fmt::format("{} : {:.2f} ms -> {:.2f} ms ({:+.2f} ms, 95% CI {:+.2f} to {:+.2f})", a_name, a_user.value, a_test.value, a_delta.value, a_delta.low, a_delta.high).c_str());
+			};
+			estimateRow("Mean", user.mean, test.mean, comparison.mean);
+			estimateRow("Median", user.median, test.median, comparison.median);
+			estimateRow("P95", user.p95, test.p95, comparison.p95);
+			estimateRow("P99", user.p99, test.p99, comparison.p99);
+			ImGui::Text(fmt::format("Shader Compiles : {} user, {} test", benchmark.GetShaderCompiles(Benchmark::Config::User), benchmark.GetShaderCompiles(Benchmark::Config::Test)).c_str());
+
+			const auto& features = benchmark.GetFeatures();
+			for (std::size_t i = 0; i < features.size(); i++) {
+				const double userCost = benchmark.GetFeatureCost(Benchmark::Config::User, i);
+				const double testCost = benchmark.GetFeatureCost(Benchmark::Config::Test, i);
+				if (userCost > 0.0 || testCost > 0.0)
+					ImGui::Text(fmt::format("{} : {:.3f} ms -> {:.3f} ms", features[i]->GetName(), userCost, testCost).c_str());
+			}
+		}
 		ImGui::End();
 	}
 
@@ -859,10 +1023,24 @@ inline const uint32_t Menu::DIKToVK(uint32_t DIK)
 
 void Menu::ProcessInputEventQueue()
 {
-	std::unique_lock<std::shared_mutex> mutex(_inputEventMutex);
+	if (_keyEventQueue.Empty())
+		return;
+
+	_keyEventQueue.Drain([this](const KeyEvent& a_event) {
+		if (a_event.focusLost)
+			_pendingKeyEvents.clear();
+		else
+			_pendingKeyEvents.push_back(a_event);
+	});
+
+	if (auto dropped = _keyEventQueue.Dropped(); dropped != _droppedKeyEvents) {
+		logger::warn("Input event queue full, dropped {} events", dropped - _droppedKeyEvents);
+		_droppedKeyEvents = dropped;
+	}
+
 	ImGuiIO& io = ImGui::GetIO();
 
-	for (auto& event : _keyEventQueue) {
+	for (auto& event : _pendingKeyEvents) {
 		if (event.eventType == RE::INPUT_EVENT_TYPE::kChar) {
 			io.AddInputCharacter(event.keyCode);
 		}
@@ -897,7 +1075,7 @@ void Menu::ProcessInputEventQueue()
 					IsEnabled = !IsEnabled;
 				} else if (key == skipCompilationKey) {
 					auto& shaderCache = SIE::ShaderCache::Instance();
-					shaderCache.backgroundCompilation = true;
+					shaderCache.SetBackgroundCompilation(true);
 				} else if (key == effectToggleKey) {
 					auto& shaderCache = SIE::ShaderCache::Instance();
 					shaderCache.SetEnabled(!shaderCache.IsEnabled());
@@ -921,19 +1099,20 @@ void Menu::ProcessInputEventQueue()
 		}
 	}
 
-	_keyEventQueue.clear();
+	_pendingKeyEvents.clear();
 }
 
 void Menu::addToEventQueue(KeyEvent e)
 {
-	std::unique_lock<std::shared_mutex> mutex(_inputEventMutex);
-	_keyEventQueue.emplace_back(e);
+	_keyEventQueue.Push(e);
 }
 
 void Menu::OnFocusLost()
 {
-	std::unique_lock<std::shared_mutex> mutex(_inputEventMutex);
-	_keyEventQueue.clear();
+	// Window messages are handled on the input thread, so this is queued like any other event
+	KeyEvent event(nullptr);
+	event.focusLost = true;
+	_keyEventQueue.Push(event);
 }
 
 void Menu::ProcessInputEvents(RE::InputEvent* const* a_events)
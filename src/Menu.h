@@ -1,10 +1,12 @@
 #pragma once
 
+#include "Benchmark.h"
 #include "imgui.h"
 #include "imgui_impl_dx11.h"
 #include "imgui_impl_win32.h"
 #include <chrono>
-#include <shared_mutex>
+
+#include "Util.h"
 
 using namespace std::chrono;
 #define BUFFER_VIEWER_NODE(a_value)                                                                  \
@@ -57,6 +59,8 @@ private:
 	bool usingTestConfig = false;  // Whether we're using the test config
 
 	std::chrono::steady_clock::time_point lastTestSwitch = high_resolution_clock::now();  // Time of last test switch
+	std::chrono::steady_clock::time_point lastTestFrame = high_resolution_clock::now();   // Time of last frame in test mode
+	Benchmark benchmark;                                                                  // Frame statistics of the test mode
 
 	Menu() {}
 	const char* KeyIdToString(uint32_t key);
@@ -70,6 +74,7 @@ private:
 
 	struct KeyEvent
 	{
+		KeyEvent() = default;
 		KeyEvent(const nullptr_t) {}
 
 		KeyEvent(const RE::ButtonEvent* a_event) :
@@ -95,10 +100,12 @@ private:
 		RE::INPUT_EVENT_TYPE eventType;
 		float value;
 		float heldDownSecs;
+		bool focusLost = false;  // events queued before this one are discarded
 	};
 	const uint32_t DIKToVK(uint32_t DIK);
-	mutable std::shared_mutex _inputEventMutex;
-	std::vector<KeyEvent> _keyEventQueue{};
+	Util::SPSCQueue<KeyEvent, 256> _keyEventQueue;  // filled by the input thread, drained once per frame by the render thread
+	std::vector<KeyEvent> _pendingKeyEvents{};      // render thread only
+	uint64_t _droppedKeyEvents = 0;
 	void addToEventQueue(KeyEvent e);
 	void ProcessInputEventQueue();
 };
\ No newline at end of file
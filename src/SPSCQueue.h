@@ -0,0 +1,50 @@
+#pragma once
+
+namespace Util
+{
+	/**
+	 * Bounded single-producer single-consumer queue that never blocks either side.
+	 * Push is only called from the producer thread, Empty and Drain only from the consumer thread.
+	 * Values pushed while the queue is full are dropped and counted.
+	 */
+	template <typename T, std::size_t N>
+	class SPSCQueue
+	{
+		static_assert(N && !(N & (N - 1)), "capacity must be a power of two");
+
+	public:
+		bool Push(const T& a_value)
+		{
+			const auto writeIndex = head.load(std::memory_order_relaxed);
+			if (writeIndex - tail.load(std::memory_order_acquire) == N) {
+				dropped.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+			values[writeIndex & (N - 1)] = a_value;
+			head.store(writeIndex + 1, std::memory_order_release);
+			return true;
+		}
+
+		inline bool Empty() const { return head.load(std::memory_order_acquire) == tail.load(std::memory_order_relaxed); }
+
+		// Calls a_func on every queued value in order, then releases their slots to the producer
+		template <typename F>
+		std::size_t Drain(F&& a_func)
+		{
+			auto readIndex = tail.load(std::memory_order_relaxed);
+			const auto writeIndex = head.load(std::memory_order_acquire);
+			for (auto i = readIndex; i != writeIndex; i++)
+				a_func(values[i & (N - 1)]);
+			tail.store(writeIndex, std::memory_order_release);
+			return writeIndex - readIndex;
+		}
+
+		inline uint64_t Dropped() const { return dropped.load(std::memory_order_relaxed); }
+
+	private:
+		std::atomic<std::size_t> head = 0;
+		std::atomic<std::size_t> tail = 0;
+		std::atomic<uint64_t> dropped = 0;
+		T values[N];
+	};
+}
@@ -8,6 +8,8 @@
 #include <wrl/client.h>
 
 #include "Feature.h"
+#include "ShaderDefines.h"
+#include "ShaderIncludeHandler.h"
 #include "State.h"
 
 namespace SIE
@@ -16,12 +18,6 @@ namespace SIE
 	{
 		static void GetShaderDefines(RE::BSShader::Type, uint32_t, D3D_SHADER_MACRO*);
 		static std::string GetShaderString(ShaderClass, const RE::BSShader&, uint32_t, bool = false);
-		/**
-		@brief Get the BSShader::Type from the ShaderString
-		@param a_key The key generated from GetShaderString
-		@return A string with a valid BSShader::Type
-		*/
-		static std::string GetTypeFromShaderString(std::string);
 		constexpr const char* VertexShaderProfile = "vs_5_0";
 		constexpr const char* PixelShaderProfile = "ps_5_0";
 		constexpr const char* ComputeShaderProfile = "cs_5_0";
@@ -73,435 +69,31 @@ namespace SIE
 			VanillaGetLightingShaderDefines(descriptor, defines + lastIndex);
 		}
 
-		enum class BloodSplatterShaderTechniques
-		{
-			Splatter = 0,
-			Flare = 1,
-		};
-
-		static void GetBloodSplaterShaderDefines(uint32_t descriptor, D3D_SHADER_MACRO* defines)
-		{
-			int lastIndex = 0;
-			if (descriptor == static_cast<uint32_t>(BloodSplatterShaderTechniques::Splatter)) {
-				defines[lastIndex++] = { "SPLATTER", nullptr };
-			} else if (descriptor == static_cast<uint32_t>(BloodSplatterShaderTechniques::Flare)) {
-				defines[lastIndex++] = { "FLARE", nullptr };
-			}
-
-			for (auto* feature : Feature::GetFeatureList()) {
-				if (feature->loaded && feature->HasShaderDefine(RE::BSShader::Type::BloodSplatter)) {
-					defines[lastIndex++] = { feature->GetShaderDefineName().data(), nullptr };
-				}
-			}
-
-			defines[lastIndex] = { nullptr, nullptr };
-		}
-
-		enum class DistantTreeShaderTechniques
-		{
-			DistantTreeBlock = 0,
-			Depth = 1,
-		};
-
-		enum class DistantTreeShaderFlags
-		{
-			AlphaTest = 0x10000,
-		};
-
-		static void GetDistantTreeShaderDefines(uint32_t descriptor, D3D_SHADER_MACRO* defines)
-		{
-			const auto technique = descriptor & 1;
-			int lastIndex = 0;
-			if (technique == static_cast<uint32_t>(DistantTreeShaderTechniques::Depth)) {
-				defines[lastIndex++] = { "RENDER_DEPTH", nullptr };
-			}
-			if (descriptor & static_cast<uint32_t>(DistantTreeShaderFlags::AlphaTest)) {
-				defines[lastIndex++] = { "DO_ALPHA_TEST", nullptr };
-			}
-
-			for (auto* feature : Feature::GetFeatureList()) {
-				if (feature->loaded && feature->HasShaderDefine(RE::BSShader::Type::DistantTree)) {
-					defines[lastIndex++] = { feature->GetShaderDefineName().data(), nullptr };
-				}
-			}
-
-			defines[lastIndex] = { nullptr, nullptr };
-		}
-
-		enum class SkyShaderTechniques
-		{
-			SunOcclude = 0,
-			SunGlare = 1,
-			MoonAndStarsMask = 2,
-			Stars = 3,
-			Clouds = 4,
-			CloudsLerp = 5,
-			CloudsFade = 6,
-			Texture = 7,
-			Sky = 8,
-		};
-
-		static void GetSkyShaderDefines(uint32_t descriptor, D3D_SHADER_MACRO* defines)
-		{
-			const auto technique = static_cast<SkyShaderTechniques>(descriptor);
-			int lastIndex = 0;
-			switch (technique) {
-			case SkyShaderTechniques::SunOcclude:
-				{
-					defines[lastIndex++] = { "OCCLUSION", nullptr };
-					break;
-				}
-			case SkyShaderTechniques::SunGlare:
-				{
-					defines[lastIndex++] = { "TEX", nullptr };
-					defines[lastIndex++] = { "DITHER", nullptr };
-					break;
-				}
-			case SkyShaderTechniques::MoonAndStarsMask:
-				{
-					defines[lastIndex++] = { "TEX", nullptr };
-					defines[lastIndex++] = { "MOONMASK", nullptr };
-					break;
-				}
-			case SkyShaderTechniques::Stars:
-				{
-					defines[lastIndex++] = { "HORIZFADE", nullptr };
-					break;
-				}
-			case SkyShaderTechniques::Clouds:
-				{
-					defines[lastIndex++] = { "TEX", nullptr };
-					defines[lastIndex++] = { "CLOUDS", nullptr };
-					break;
-				}
-			case SkyShaderTechniques::CloudsLerp:
-				{
-					defines[lastIndex++] = { "TEX", nullptr };
-					defines[lastIndex++] = { "CLOUDS", nullptr };
-					defines[lastIndex++] = { "TEXLERP", nullptr };
-					break;
-				}
-			case SkyShaderTechniques::CloudsFade:
-				{
-					defines[lastIndex++] = { "TEX", nullptr };
-					defines[lastIndex++] = { "CLOUDS", nullptr };
-					defines[lastIndex++] = { "TEXFADE", nullptr };
-					break;
-				}
-			case SkyShaderTechniques::Texture:
-				{
-					defines[lastIndex++] = { "TEX", nullptr };
-					break;
-				}
-			case SkyShaderTechniques::Sky:
-				{
-					defines[lastIndex++] = { "DITHER", nullptr };
-					break;
-				}
-			}
-
-			for (auto* feature : Feature::GetFeatureList()) {
-				if (feature->loaded && feature->HasShaderDefine(RE::BSShader::Type::Sky)) {
-					defines[lastIndex++] = { feature->GetShaderDefineName().data(), nullptr };
-				}
-			}
-
-			defines[lastIndex] = { nullptr, nullptr };
-		}
-
-		enum class GrassShaderTechniques
-		{
-			RenderDepth = 8,
-		};
-
-		enum class GrassShaderFlags
-		{
-			AlphaTest = 0x10000,
-		};
-
-		static void GetGrassShaderDefines(uint32_t descriptor, D3D_SHADER_MACRO* defines)
-		{
-			const auto technique = descriptor & 0b1111;
-			int lastIndex = 0;
-			if (technique == static_cast<uint32_t>(GrassShaderTechniques::RenderDepth)) {
-				defines[lastIndex++] = { "RENDER_DEPTH", nullptr };
-			}
-			if (descriptor & static_cast<uint32_t>(GrassShaderFlags::AlphaTest)) {
-				defines[lastIndex++] = { "DO_ALPHA_TEST", nullptr };
-			}
-
-			for (auto* feature : Feature::GetFeatureList()) {
-				if (feature->loaded && feature->HasShaderDefine(RE::BSShader::Type::Grass)) {
-					defines[lastIndex++] = { feature->GetShaderDefineName().data(), nullptr };
-				}
-			}
-
-			defines[lastIndex] = { nullptr, nullptr };
-		}
-
-		enum class ParticleShaderTechniques
-		{
-			Particles = 0,
-			ParticlesGryColor = 1,
-			ParticlesGryAlpha = 2,
-			ParticlesGryColorAlpha = 3,
-			EnvCubeSnow = 4,
-			EnvCubeRain = 5,
-		};
-
-		static void GetParticleShaderDefines(uint32_t descriptor, D3D_SHADER_MACRO* defines)
-		{
-			const auto technique = static_cast<ParticleShaderTechniques>(descriptor);
-			int lastIndex = 0;
-			switch (technique) {
-			case ParticleShaderTechniques::ParticlesGryColor:
-				{
-					defines[lastIndex++] = { "GRAYSCALE_TO_COLOR", nullptr };
-					break;
-				}
-			case ParticleShaderTechniques::ParticlesGryAlpha:
-				{
-					defines[lastIndex++] = { "GRAYSCALE_TO_ALPHA", nullptr };
-					break;
-				}
-			case ParticleShaderTechniques::ParticlesGryColorAlpha:
-				{
-					defines[lastIndex++] = { "GRAYSCALE_TO_COLOR", nullptr };
-					defines[lastIndex++] = { "GRAYSCALE_TO_ALPHA", nullptr };
-					break;
-				}
-			case ParticleShaderTechniques::EnvCubeSnow:
-				{
-					defines[lastIndex++] = { "ENVCUBE", nullptr };
-					defines[lastIndex++] = { "SNOW", nullptr };
-					break;
-				}
-			case ParticleShaderTechniques::EnvCubeRain:
-				{
-					defines[lastIndex++] = { "ENVCUBE", nullptr };
-					defines[lastIndex++] = { "RAIN", nullptr };
-					break;
-				}
-			}
-
-			for (auto* feature : Feature::GetFeatureList()) {
-				if (feature->loaded && feature->HasShaderDefine(RE::BSShader::Type::Particle)) {
-					defines[lastIndex++] = { feature->GetShaderDefineName().data(), nullptr };
-				}
-			}
-
-			defines[lastIndex] = { nullptr, nullptr };
-		}
-
-		static void GetEffectShaderDefines(uint32_t descriptor, D3D_SHADER_MACRO* defines)
-		{
-			if (descriptor & static_cast<uint32_t>(ShaderCache::EffectShaderFlags::Vc)) {
-				defines[0] = { "VC", nullptr };
-				++defines;
-			}
-			if (descriptor & static_cast<uint32_t>(ShaderCache::EffectShaderFlags::TexCoord)) {
-				defines[0] = { "TEXCOORD", nullptr };
-				++defines;
-			}
-			if (descriptor & static_cast<uint32_t>(ShaderCache::EffectShaderFlags::TexCoordIndex)) {
-				defines[0] = { "TEXCOORD_INDEX", nullptr };
-				++defines;
-			}
-			if (descriptor & static_cast<uint32_t>(ShaderCache::EffectShaderFlags::Skinned)) {
-				defines[0] = { "SKINNED", nullptr };
-				++defines;
-			}
-			if (descriptor & static_cast<uint32_t>(ShaderCache::EffectShaderFlags::Normals)) {
-				defines[0] = { "NORMALS", nullptr };
-				++defines;
-			}
-			if (descriptor & static_cast<uint32_t>(ShaderCache::EffectShaderFlags::BinormalTangent)) {
-				defines[0] = { "BINORMAL_TANGENT", nullptr };
-				++defines;
-			}
-			if (descriptor & static_cast<uint32_t>(ShaderCache::EffectShaderFlags::Texture)) {
-				defines[0] = { "TEXTURE", nullptr };
-				++defines;
-			}
-			if (descriptor & static_cast<uint32_t>(ShaderCache::EffectShaderFlags::IndexedTexture)) {
-				defines[0] = { "INDEXED_TEXTURE", nullptr };
-				++defines;
-			}
-			if (descriptor & static_cast<uint32_t>(ShaderCache::EffectShaderFlags::Falloff)) {
-				defines[0] = { "FALLOFF", nullptr };
-				++defines;
-			}
-			if (descriptor & static_cast<uint32_t>(ShaderCache::EffectShaderFlags::AddBlend)) {
-				defines[0] = { "ADDBLEND", nullptr };
-				++defines;
-			}
-			if (descriptor & static_cast<uint32_t>(ShaderCache::EffectShaderFlags::MultBlend)) {
-				defines[0] = { "MULTBLEND", nullptr };
-				++defines;
-			}
-			if (descriptor & static_cast<uint32_t>(ShaderCache::EffectShaderFlags::Particles)) {
-				defines[0] = { "PARTICLES", nullptr };
-				++defines;
-			}
-			if (descriptor & static_cast<uint32_t>(ShaderCache::EffectShaderFlags::StripParticles)) {
-				defines[0] = { "STRIP_PARTICLES", nullptr };
-				++defines;
-			}
-			if (descriptor & static_cast<uint32_t>(ShaderCache::EffectShaderFlags::Blood)) {
-				defines[0] = { "BLOOD", nullptr };
-				++defines;
-			}
-			if (descriptor & static_cast<uint32_t>(ShaderCache::EffectShaderFlags::Membrane)) {
-				defines[0] = { "MEMBRANE", nullptr };
-				++defines;
-			}
-			if (descriptor & static_cast<uint32_t>(ShaderCache::EffectShaderFlags::Lighting)) {
-				defines[0] = { "LIGHTING", nullptr };
-				++defines;
-			}
-			if (descriptor & static_cast<uint32_t>(ShaderCache::EffectShaderFlags::ProjectedUv)) {
-				defines[0] = { "PROJECTED_UV", nullptr };
-				++defines;
-			}
-			if (descriptor & static_cast<uint32_t>(ShaderCache::EffectShaderFlags::Soft)) {
-				defines[0] = { "SOFT", nullptr };
-				++defines;
-			}
-			if (descriptor & static_cast<uint32_t>(ShaderCache::EffectShaderFlags::GrayscaleToColor)) {
-				defines[0] = { "GRAYSCALE_TO_COLOR", nullptr };
-				++defines;
-			}
-			if (descriptor & static_cast<uint32_t>(ShaderCache::EffectShaderFlags::GrayscaleToAlpha)) {
-				defines[0] = { "GRAYSCALE_TO_ALPHA", nullptr };
-				++defines;
-			}
-			if (descriptor & static_cast<uint32_t>(ShaderCache::EffectShaderFlags::IgnoreTexAlpha)) {
-				defines[0] = { "IGNORE_TEX_ALPHA", nullptr };
-				++defines;
-			}
-			if (descriptor & static_cast<uint32_t>(ShaderCache::EffectShaderFlags::MultBlendDecal)) {
-				defines[0] = { "MULTBLEND_DECAL", nullptr };
-				++defines;
-			}
-			if (descriptor & static_cast<uint32_t>(ShaderCache::EffectShaderFlags::AlphaTest)) {
-				defines[0] = { "ALPHA_TEST", nullptr };
-				++defines;
-			}
-			if (descriptor & static_cast<uint32_t>(ShaderCache::EffectShaderFlags::SkyObject)) {
-				defines[0] = { "SKY_OBJECT", nullptr };
-				++defines;
-			}
-			if (descriptor & static_cast<uint32_t>(ShaderCache::EffectShaderFlags::MsnSpuSkinned)) {
-				defines[0] = { "MSN_SPU_SKINNED", nullptr };
-				++defines;
-			}
-			if (descriptor & static_cast<uint32_t>(ShaderCache::EffectShaderFlags::MotionVectorsNormals)) {
-				defines[0] = { "MOTIONVECTORS_NORMALS", nullptr };
-				++defines;
-			}
-
-			for (auto* feature : Feature::GetFeatureList()) {
-				if (feature->loaded && feature->HasShaderDefine(RE::BSShader::Type::Effect)) {
-					defines[0] = { feature->GetShaderDefineName().data(), nullptr };
-					++defines;
-				}
-			}
-
-			defines[0] = { nullptr, nullptr };
-		}
-
-		static void GetWaterShaderDefines(uint32_t descriptor, D3D_SHADER_MACRO* defines)
-		{
-			int lastIndex = 0;
-			defines[lastIndex++] = { "WATER", nullptr };
-			defines[lastIndex++] = { "FOG", nullptr };
-
-			if (descriptor & static_cast<uint32_t>(ShaderCache::WaterShaderFlags::Vc)) {
-				defines[lastIndex++] = { "VC", nullptr };
-			}
-			if (descriptor & static_cast<uint32_t>(ShaderCache::WaterShaderFlags::NormalTexCoord)) {
-				defines[lastIndex++] = { "NORMAL_TEXCOORD", nullptr };
-			}
-			if (descriptor & static_cast<uint32_t>(ShaderCache::WaterShaderFlags::Reflections)) {
-				defines[lastIndex++] = { "REFLECTIONS", nullptr };
-			}
-			if (descriptor & static_cast<uint32_t>(ShaderCache::WaterShaderFlags::Refractions)) {
-				defines[lastIndex++] = { "REFRACTIONS", nullptr };
-			}
-			if (descriptor & static_cast<uint32_t>(ShaderCache::WaterShaderFlags::Depth)) {
-				defines[lastIndex++] = { "DEPTH", nullptr };
-			}
-			if (descriptor & static_cast<uint32_t>(ShaderCache::WaterShaderFlags::Interior)) {
-				defines[lastIndex++] = { "INTERIOR", nullptr };
-			}
-			if (descriptor & static_cast<uint32_t>(ShaderCache::WaterShaderFlags::Wading)) {
-				defines[lastIndex++] = { "WADING", nullptr };
-			}
-			if (descriptor & static_cast<uint32_t>(ShaderCache::WaterShaderFlags::VertexAlphaDepth)) {
-				defines[lastIndex++] = { "VERTEX_ALPHA_DEPTH", nullptr };
-			}
-			if (descriptor & static_cast<uint32_t>(ShaderCache::WaterShaderFlags::Cubemap)) {
-				defines[lastIndex++] = { "CUBEMAP", nullptr };
-			}
-			if (descriptor & static_cast<uint32_t>(ShaderCache::WaterShaderFlags::Flowmap)) {
-				defines[lastIndex++] = { "FLOWMAP", nullptr };
-			}
-			if (descriptor & static_cast<uint32_t>(ShaderCache::WaterShaderFlags::BlendNormals)) {
-				defines[lastIndex++] = { "BLEND_NORMALS", nullptr };
-			}
-
-			const auto technique = (descriptor >> 11) & 0xF;
-			if (technique == static_cast<uint32_t>(ShaderCache::WaterShaderTechniques::Underwater)) {
-				defines[lastIndex++] = { "UNDERWATER", nullptr };
-			} else if (technique == static_cast<uint32_t>(ShaderCache::WaterShaderTechniques::Lod)) {
-				defines[lastIndex++] = { "LOD", nullptr };
-			} else if (technique == static_cast<uint32_t>(ShaderCache::WaterShaderTechniques::Stencil)) {
-				defines[lastIndex++] = { "STENCIL", nullptr };
-			} else if (technique == static_cast<uint32_t>(ShaderCache::WaterShaderTechniques::Simple)) {
-				defines[lastIndex++] = { "SIMPLE", nullptr };
-			} else if (technique < 8) {
-				static constexpr std::array<const char*, 8> numLightDefines = { { "0", "1", "2", "3", "4",
-					"5", "6", "7" } };
-				defines[lastIndex++] = { "SPECULAR", nullptr };
-				defines[lastIndex++] = { "NUM_SPECULAR_LIGHTS", numLightDefines[technique] };
-			}
-
-			for (auto* feature : Feature::GetFeatureList()) {
-				if (feature->loaded && feature->HasShaderDefine(RE::BSShader::Type::Water)) {
-					defines[lastIndex++] = { feature->GetShaderDefineName().data(), nullptr };
-				}
-			}
-
-			defines[lastIndex] = { nullptr, nullptr };
-		}
-
 		static void GetShaderDefines(RE::BSShader::Type type, uint32_t descriptor,
 			D3D_SHADER_MACRO* defines)
 		{
 			switch (type) {
-			case RE::BSShader::Type::Grass:
-				GetGrassShaderDefines(descriptor, defines);
+			case RE::BSShader::Type::Lighting:
+				GetLightingShaderDefines(descriptor, defines);
 				break;
+			case RE::BSShader::Type::Grass:
 			case RE::BSShader::Type::Sky:
-				GetSkyShaderDefines(descriptor, defines);
-				break;
 			case RE::BSShader::Type::Water:
-				GetWaterShaderDefines(descriptor, defines);
-				break;
 			case RE::BSShader::Type::BloodSplatter:
-				GetBloodSplaterShaderDefines(descriptor, defines);
-				break;
-			case RE::BSShader::Type::Lighting:
-				GetLightingShaderDefines(descriptor, defines);
-				break;
 			case RE::BSShader::Type::DistantTree:
-				GetDistantTreeShaderDefines(descriptor, defines);
-				break;
 			case RE::BSShader::Type::Particle:
-				GetParticleShaderDefines(descriptor, defines);
-				break;
 			case RE::BSShader::Type::Effect:
-				GetEffectShaderDefines(descriptor, defines);
+				{
+					auto lastIndex = GetVanillaShaderDefines(type, descriptor, defines);
+					for (auto* feature : Feature::GetFeatureList()) {
+						if (feature->loaded && feature->HasShaderDefine(type)) {
+							defines[lastIndex++] = { feature->GetShaderDefineName().data(), nullptr };
+						}
+					}
+					defines[lastIndex] = { nullptr, nullptr };
+				}
+				break;
+			default:
 				break;
 			}
 		}
@@ -783,30 +375,6 @@ namespace SIE
 			return it->second;
 		}
 
-		static std::string MergeDefinesString(std::array<D3D_SHADER_MACRO, 64>& defines, bool a_sort = false)
-		{
-			std::string result;
-			if (a_sort)
-				std::sort(std::begin(defines), std::end(defines), [](const D3D_SHADER_MACRO& a, const D3D_SHADER_MACRO& b) {
-					return a.Name > b.Name;
-				});
-			for (const auto& def : defines) {
-				if (def.Name != nullptr) {
-					result += def.Name;
-					if (def.Definition != nullptr && !std::string(def.Definition).empty()) {
-						result += "=";
-						result += def.Definition;
-					}
-					result += ' ';
-				} else {
-					if (a_sort)  // sometimes the sort messes up so null entries get interspersed
-						continue;
-					break;
-				}
-			}
-			return result;
-		}
-
 		static void AddAttribute(uint64_t& desc, RE::BSGraphics::Vertex::Attribute attribute)
 		{
 			desc |= ((1ull << (44 + attribute)) | (1ull << (54 + attribute)) |
@@ -945,31 +513,92 @@ namespace SIE
 			return std::format(L"Data/ShaderCache/{}/{:X}.cso", std::wstring(name.begin(), name.end()), descriptor);
 		}
 
-		static std::string GetShaderString(ShaderClass shaderClass, const RE::BSShader& shader, uint32_t descriptor, bool hashkey)
+		static uint64_t GetBytecodeHash(ID3DBlob& shaderData)
 		{
-			auto sourceShaderFile = shader.fxpFilename;
-			std::array<D3D_SHADER_MACRO, 64> defines{};
-			SIE::SShaderCache::GetShaderDefines(shader.shaderType.get(), descriptor, &defines[0]);
-			std::string result;
-			if (hashkey)  // generate hashkey so don't include descriptor
-				result = fmt::format("{}:{}:{}", sourceShaderFile, magic_enum::enum_name(shaderClass), SIE::SShaderCache::MergeDefinesString(defines, true));
-			else
-				result = fmt::format("{}:{}:{:X}:{}", sourceShaderFile, magic_enum::enum_name(shaderClass), descriptor, SIE::SShaderCache::MergeDefinesString(defines, true));
-			return result;
+			return ankerl::unordered_dense::detail::wyhash::hash(shaderData.GetBufferPointer(), shaderData.GetBufferSize());
+		}
+
+		// Unique bytecode is stored once per hash, descriptor files are hard links to it
+		static std::wstring GetBytecodePath(const std::string_view& name, uint64_t hash)
+		{
+			return std::format(L"Data/ShaderCache/{}/Bytecode/{:016X}.bin", std::wstring(name.begin(), name.end()), hash);
+		}
+
+		// Hard linked descriptor files share one timestamp, so each keeps its own compile time next to it
+		static std::wstring GetCompileTimePath(const std::wstring& diskPath)
+		{
+			return diskPath + L".time";
+		}
+
+		static void SaveCompileTime(const std::wstring& diskPath)
+		{
+			std::ofstream file(GetCompileTimePath(diskPath), std::ios::trunc);
+			file << duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+		}
+
+		static system_clock::time_point GetCompileTime(const std::wstring& diskPath)
+		{
+			std::ifstream file(GetCompileTimePath(diskPath));
+			int64_t compileTime = 0;
+			if (file >> compileTime)
+				return system_clock::time_point(milliseconds(compileTime));
+			return std::chrono::clock_cast<std::chrono::system_clock>(std::filesystem::last_write_time(diskPath));
+		}
+
+		static bool BytecodeMatches(const std::wstring& bytecodePath, ID3DBlob& shaderBlob)
+		{
+			std::ifstream file(bytecodePath, std::ios::binary | std::ios::ate);
+			if (!file.is_open() || static_cast<size_t>(file.tellg()) != shaderBlob.GetBufferSize())
+				return false;
+			std::string bytecode(shaderBlob.GetBufferSize(), '\0');
+			file.seekg(0);
+			file.read(bytecode.data(), bytecode.size());
+			return file && memcmp(bytecode.data(), shaderBlob.GetBufferPointer(), bytecode.size()) == 0;
 		}
 
-		std::string GetTypeFromShaderString(std::string a_key)
+		static HRESULT SaveDeduplicatedBlob(ID3DBlob& shaderBlob, const std::string_view& name, const std::wstring& diskPath)
 		{
-			std::string type = "";
-			std::string::size_type pos = a_key.find(':');
-			if (pos != std::string::npos)
-				type = a_key.substr(0, pos);
-			return type;
+			const auto bytecodePath = GetBytecodePath(name, GetBytecodeHash(shaderBlob));
+			std::error_code ec;
+			std::filesystem::create_directories(std::filesystem::path(bytecodePath).parent_path(), ec);
+
+			// Never write through an existing link, that would change every descriptor sharing it
+			std::filesystem::remove(diskPath, ec);
+			std::filesystem::remove(GetCompileTimePath(diskPath), ec);
+
+			// A hash collision keeps a private copy instead of linking to different bytecode
+			const bool shared = std::filesystem::exists(bytecodePath, ec) ? BytecodeMatches(bytecodePath, shaderBlob) : SUCCEEDED(D3DWriteBlobToFile(&shaderBlob, bytecodePath.c_str(), true));
+			if (shared) {
+				std::filesystem::create_hard_link(bytecodePath, diskPath, ec);
+				if (!ec) {
+					SaveCompileTime(diskPath);
+					return S_OK;
+				}
+			}
+			return D3DWriteBlobToFile(&shaderBlob, diskPath.c_str(), true);
+		}
+
+		static std::string GetShaderString(ShaderClass shaderClass, const RE::BSShader& shader, uint32_t descriptor, bool hashkey)
+		{
+			std::array<D3D_SHADER_MACRO, 64> defines{};
+			SIE::SShaderCache::GetShaderDefines(shader.shaderType.get(), descriptor, &defines[0]);
+			// generate hashkey so don't include descriptor
+			return GetShaderKey(shader.fxpFilename, magic_enum::enum_name(shaderClass), MergeDefinesString(defines, true), hashkey ? std::nullopt : std::optional(descriptor));
 		}
 
 		static ID3DBlob* CompileShader(ShaderClass shaderClass, const RE::BSShader& shader, uint32_t descriptor, bool useDiskCache)
 		{
 			ID3DBlob* shaderBlob = nullptr;
+			const auto type = shader.shaderType.get();
+
+			const auto startTime = high_resolution_clock::now();
+			CompilationStats::Record record{ shaderClass, type, descriptor };
+			auto addRecord = [&](CompilationStats::Source a_source) {
+				record.source = a_source;
+				record.milliseconds = duration<double, std::milli>(high_resolution_clock::now() - startTime).count();
+				record.bytecodeBytes = shaderBlob ? shaderBlob->GetBufferSize() : 0;
+				ShaderCache::Instance().compilationStats.Add(std::move(record));
+			};
 
 			// check hashmap
 			auto& cache = ShaderCache::Instance();
@@ -977,9 +606,9 @@ namespace SIE
 				// already compiled before
 				logger::debug("Shader already compiled; using cache: {}", SShaderCache::GetShaderString(shaderClass, shader, descriptor));
 				cache.IncCacheHitTasks();
+				addRecord(CompilationStats::Source::Memory);
 				return shaderBlob;
 			}
-			const auto type = shader.shaderType.get();
 
 			// check diskcache
 			auto diskPath = GetDiskPath(shader.fxpFilename, descriptor, shaderClass);
@@ -987,7 +616,7 @@ namespace SIE
 			if (!shaderBlob && useDiskCache && std::filesystem::exists(diskPath)) {
 				shaderBlob = nullptr;
 				// check build time of cache
-				auto diskCacheTime = cache.UseFileWatcher() ? std::chrono::clock_cast<std::chrono::system_clock>(std::filesystem::last_write_time(diskPath)) : system_clock::now();
+				auto diskCacheTime = cache.UseFileWatcher() ? GetCompileTime(diskPath) : system_clock::now();
 				if (cache.ShaderModifiedSince(shader.fxpFilename, diskCacheTime)) {
 					logger::debug("Diskcached shader {} older than {}", SIE::SShaderCache::GetShaderString(shaderClass, shader, descriptor, true), std::format("{:%Y%m%d%H%M}", diskCacheTime));
 				} else if (FAILED(D3DReadFileToBlob(diskPath.c_str(), &shaderBlob))) {
@@ -1003,6 +632,7 @@ namespace SIE
 					});
 					logger::debug("Loaded shader from {}", str);
 					cache.AddCompletedShader(shaderClass, shader, descriptor, shaderBlob);
+					addRecord(CompilationStats::Source::Disk);
 					return shaderBlob;
 				}
 			}
@@ -1035,13 +665,27 @@ namespace SIE
 			std::transform(path.begin(), path.end(), std::back_inserter(strPath), [](wchar_t c) {
 				return (char)c;
 			});
-			logger::debug("Compiling {} {}:{}:{:X} to {}", strPath, magic_enum::enum_name(type), magic_enum::enum_name(shaderClass), descriptor, MergeDefinesString(defines));
+			record.defines = MergeDefinesString(defines);
+			record.defineCount = static_cast<uint32_t>(std::ranges::find_if(defines, [](const D3D_SHADER_MACRO& a_define) { return a_define.Name == nullptr; }) - defines.begin());
+			record.defineBytes = record.defines.size();
+			std::error_code sourceError;
+			record.sourceBytes = static_cast<size_t>(std::filesystem::file_size(path, sourceError));
+			if (sourceError)
+				record.sourceBytes = 0;
+			logger::debug("Compiling {} {}:{}:{:X} to {}", strPath, magic_enum::enum_name(type), magic_enum::enum_name(shaderClass), descriptor, record.defines);
 
 			// compile shaders
 			ID3DBlob* errorBlob = nullptr;
 			const uint32_t flags = !State::GetSingleton()->IsDeveloperMode() ? D3DCOMPILE_OPTIMIZATION_LEVEL3 : D3DCOMPILE_DEBUG;
-			const HRESULT compileResult = D3DCompileFromFile(path.c_str(), defines.data(), D3D_COMPILE_STANDARD_FILE_INCLUDE, "main",
-				GetShaderProfile(shaderClass), flags, 0, &shaderBlob, &errorBlob);
+			HRESULT compileResult;
+			if (auto source = cache.useIncludeCache ? cache.includeCache.Load(path) : nullptr) {
+				ShaderIncludeHandler includeHandler(cache.includeCache, source);
+				compileResult = D3DCompile(source->data.data(), source->data.size(), strPath.c_str(), defines.data(), &includeHandler, "main",
+					GetShaderProfile(shaderClass), flags, 0, &shaderBlob, &errorBlob);
+			} else {
+				compileResult = D3DCompileFromFile(path.c_str(), defines.data(), D3D_COMPILE_STANDARD_FILE_INCLUDE, "main",
+					GetShaderProfile(shaderClass), flags, 0, &shaderBlob, &errorBlob);
+			}
 
 			if (FAILED(compileResult)) {
 				if (errorBlob != nullptr) {
@@ -1055,9 +699,11 @@ namespace SIE
 				}
 				if (shaderBlob != nullptr) {
 					shaderBlob->Release();
+					shaderBlob = nullptr;
 				}
 
 				cache.AddCompletedShader(shaderClass, shader, descriptor, nullptr);
+				addRecord(CompilationStats::Source::Failed);
 				return nullptr;
 			}
 			logger::debug("Compiled shader {}:{}:{:X}", magic_enum::enum_name(type), magic_enum::enum_name(shaderClass), descriptor);
@@ -1087,7 +733,7 @@ namespace SIE
 					}
 				}
 
-				const HRESULT saveResult = D3DWriteBlobToFile(shaderBlob, diskPath.c_str(), true);
+				const HRESULT saveResult = SaveDeduplicatedBlob(*shaderBlob, shader.fxpFilename, diskPath);
 				if (FAILED(saveResult)) {
 					std::string str;
 					std::transform(diskPath.begin(), diskPath.end(), std::back_inserter(str), [](wchar_t c) {
@@ -1103,9 +749,24 @@ namespace SIE
 				}
 			}
 			cache.AddCompletedShader(shaderClass, shader, descriptor, shaderBlob);
+			addRecord(CompilationStats::Source::Compiled);
 			return shaderBlob;
 		}
 
+		static std::unique_ptr<RE::BSGraphics::VertexShader> AllocateVertexShader(ID3DBlob& shaderData, uint32_t descriptor)
+		{
+			auto rawPtr =
+				new uint8_t[sizeof(RE::BSGraphics::VertexShader) + shaderData.GetBufferSize()];
+			auto shaderPtr = new (rawPtr) RE::BSGraphics::VertexShader;
+			memcpy(rawPtr + sizeof(RE::BSGraphics::VertexShader), shaderData.GetBufferPointer(),
+				shaderData.GetBufferSize());
+			auto newShader = std::unique_ptr<RE::BSGraphics::VertexShader>(shaderPtr);
+			newShader->byteCodeSize = (uint32_t)shaderData.GetBufferSize();
+			newShader->id = descriptor;
+			newShader->shaderDesc = 0;
+			return newShader;
+		}
+
 		std::unique_ptr<RE::BSGraphics::VertexShader> CreateVertexShader(ID3DBlob& shaderData,
 			RE::BSShader::Type type, uint32_t descriptor)
 		{
@@ -1118,15 +779,7 @@ namespace SIE
 				REL::Relocation<ID3D11Buffer**>(RELOCATION_ID(524759, 411375));
 			static const auto bufferData = REL::Relocation<void*>(RELOCATION_ID(524965, 411446));
 
-			auto rawPtr =
-				new uint8_t[sizeof(RE::BSGraphics::VertexShader) + shaderData.GetBufferSize()];
-			auto shaderPtr = new (rawPtr) RE::BSGraphics::VertexShader;
-			memcpy(rawPtr + sizeof(RE::BSGraphics::VertexShader), shaderData.GetBufferPointer(),
-				shaderData.GetBufferSize());
-			auto newShader = std::unique_ptr<RE::BSGraphics::VertexShader>(shaderPtr);
-			newShader->byteCodeSize = (uint32_t)shaderData.GetBufferSize();
-			newShader->id = descriptor;
-			newShader->shaderDesc = 0;
+			auto newShader = AllocateVertexShader(shaderData, descriptor);
 
 			Microsoft::WRL::ComPtr<ID3D11ShaderReflection> reflector;
 			const auto reflectionResult = D3DReflect(shaderData.GetBufferPointer(), shaderData.GetBufferSize(),
@@ -1224,6 +877,31 @@ namespace SIE
 
 			return newShader;
 		}
+
+		/** Shares the D3D object and reflected constant layout of a shader created from identical bytecode. */
+		static std::unique_ptr<RE::BSGraphics::VertexShader> CloneVertexShader(const RE::BSGraphics::VertexShader& source,
+			ID3DBlob& shaderData, uint32_t descriptor)
+		{
+			auto newShader = AllocateVertexShader(shaderData, descriptor);
+			newShader->shaderDesc = source.shaderDesc;
+			std::copy(std::begin(source.constantBuffers), std::end(source.constantBuffers), std::begin(newShader->constantBuffers));
+			std::copy(source.constantTable.begin(), source.constantTable.end(), newShader->constantTable.begin());
+			newShader->shader = source.shader;
+			newShader->shader->AddRef();
+			return newShader;
+		}
+
+		static std::unique_ptr<RE::BSGraphics::PixelShader> ClonePixelShader(const RE::BSGraphics::PixelShader& source,
+			uint32_t descriptor)
+		{
+			auto newShader = std::make_unique<RE::BSGraphics::PixelShader>();
+			newShader->id = descriptor;
+			std::copy(std::begin(source.constantBuffers), std::end(source.constantBuffers), std::begin(newShader->constantBuffers));
+			std::copy(source.constantTable.begin(), source.constantTable.end(), newShader->constantTable.begin());
+			newShader->shader = source.shader;
+			newShader->shader->AddRef();
+			return newShader;
+		}
 	}
 
 	RE::BSGraphics::VertexShader* ShaderCache::GetVertexShader(const RE::BSShader& shader,
@@ -1249,13 +927,21 @@ namespace SIE
 			}
 			return nullptr;
 		}
+		bool evicted = false;
 		{
 			std::lock_guard lockGuard(vertexShadersMutex);
-			auto& typeCache = vertexShaders[static_cast<size_t>(shader.shaderType.underlying())];
-			auto it = typeCache.find(descriptor);
-			if (it != typeCache.end()) {
-				return it->second.get();
-			}
+			const auto typeIndex = static_cast<size_t>(shader.shaderType.underlying());
+			if (auto cached = vertexShaders.Find(typeIndex, descriptor, frameIndex))
+				return cached;
+			evicted = vertexShaders.WasEvicted(typeIndex, descriptor);
+		}
+
+		if (evicted) {
+			// Bytecode kept in memory creates the shader again right away
+			if (GetCompletedShader(key))
+				return MakeAndAddVertexShader(shader, descriptor);
+			// Dropped bytecode is read back from the disk cache like a first load
+			compilationSet.Forget({ ShaderClass::Vertex, shader, descriptor });
 		}
 
 		if (IsAsync()) {
@@ -1291,13 +977,21 @@ namespace SIE
 			}
 			return nullptr;
 		}
+		bool evicted = false;
 		{
 			std::lock_guard lockGuard(pixelShadersMutex);
-			auto& typeCache = pixelShaders[static_cast<size_t>(shader.shaderType.underlying())];
-			auto it = typeCache.find(descriptor);
-			if (it != typeCache.end()) {
-				return it->second.get();
-			}
+			const auto typeIndex = static_cast<size_t>(shader.shaderType.underlying());
+			if (auto cached = pixelShaders.Find(typeIndex, descriptor, frameIndex))
+				return cached;
+			evicted = pixelShaders.WasEvicted(typeIndex, descriptor);
+		}
+
+		if (evicted) {
+			// Bytecode kept in memory creates the shader again right away
+			if (GetCompletedShader(key))
+				return MakeAndAddPixelShader(shader, descriptor);
+			// Dropped bytecode is read back from the disk cache like a first load
+			compilationSet.Forget({ ShaderClass::Pixel, shader, descriptor });
 		}
 
 		if (IsAsync()) {
@@ -1317,46 +1011,27 @@ namespace SIE
 
 	void ShaderCache::Clear()
 	{
+		auto release = [](auto& a_shader) { a_shader.shader->Release(); };
 		std::lock_guard lockGuardV(vertexShadersMutex);
-		{
-			for (auto& shaders : vertexShaders) {
-				for (auto& [id, shader] : shaders) {
-					shader->shader->Release();
-				}
-				shaders.clear();
-			}
-		}
+		vertexShaders.Clear(release);
 		std::lock_guard lockGuardP(pixelShadersMutex);
-		{
-			for (auto& shaders : pixelShaders) {
-				for (auto& [id, shader] : shaders) {
-					shader->shader->Release();
-				}
-				shaders.clear();
-			}
-		}
+		pixelShaders.Clear(release);
 		compilationSet.Clear();
+		compilationStats.Clear();
+		includeCache.Clear();
 		std::unique_lock lock{ mapMutex };
 		shaderMap.clear();
+		bytecodeBytes = 0;
 	}
 
 	void ShaderCache::Clear(RE::BSShader::Type a_type)
 	{
 		logger::debug("Clearing cache for {}", magic_enum::enum_name(a_type));
+		auto release = [](auto& a_shader) { a_shader.shader->Release(); };
 		std::lock_guard lockGuardV(vertexShadersMutex);
-		{
-			for (auto& [id, shader] : vertexShaders[static_cast<size_t>(a_type)]) {
-				shader->shader->Release();
-			}
-			vertexShaders[static_cast<size_t>(a_type)].clear();
-		}
+		vertexShaders.Clear(static_cast<size_t>(a_type), release);
 		std::lock_guard lockGuardP(pixelShadersMutex);
-		{
-			for (auto& [id, shader] : pixelShaders[static_cast<size_t>(a_type)]) {
-				shader->shader->Release();
-			}
-			pixelShaders[static_cast<size_t>(a_type)].clear();
-		}
+		pixelShaders.Clear(static_cast<size_t>(a_type), release);
 		compilationSet.Clear();
 	}
 
@@ -1366,13 +1041,28 @@ namespace SIE
 		auto status = a_blob ? ShaderCompilationTask::Status::Completed : ShaderCompilationTask::Status::Failed;
 		std::unique_lock lock{ mapMutex };
 		logger::debug("Adding {} shader to map: {}", magic_enum ::enum_name(status), key);
+		if (auto it = shaderMap.find(key); it != shaderMap.end() && it->second.blob)
+			bytecodeBytes -= it->second.blob->GetBufferSize();
 		shaderMap.insert_or_assign(key, ShaderCacheResult{ a_blob, status, system_clock::now() });
+		if (a_blob)
+			bytecodeBytes += a_blob->GetBufferSize();
 		return (bool)a_blob;
 	}
 
+	void ShaderCache::DropCompletedShader(const std::string& a_key)
+	{
+		std::unique_lock lock{ mapMutex };
+		auto it = shaderMap.find(a_key);
+		if (it == shaderMap.end() || !it->second.blob)
+			return;
+		bytecodeBytes -= it->second.blob->GetBufferSize();
+		it->second.blob->Release();
+		shaderMap.erase(it);
+	}
+
 	ID3DBlob* ShaderCache::GetCompletedShader(const std::string a_key)
 	{
-		std::string type = SIE::SShaderCache::GetTypeFromShaderString(a_key);
+		std::string type = GetTypeFromShaderKey(a_key);
 		UpdateShaderModifiedTime(a_key);
 		std::scoped_lock lock{ mapMutex };
 		if (!shaderMap.empty() && shaderMap.contains(a_key)) {
@@ -1419,6 +1109,22 @@ namespace SIE
 		return compilationSet.totalTasks && compilationSet.completedTasks + compilationSet.failedTasks < compilationSet.totalTasks;
 	}
 
+	void ShaderCache::WaitForCompilation()
+	{
+		compilationSet.WaitForCompletion();
+	}
+
+	void ShaderCache::SetBackgroundCompilation(bool value)
+	{
+		backgroundCompilation = value;
+		compilationSet.NotifyCompletion();
+	}
+
+	void ShaderCache::SubscribeCompilationEvents(CompilationListener a_listener)
+	{
+		compilationSet.Subscribe(std::move(a_listener));
+	}
+
 	bool ShaderCache::IsEnabled() const
 	{
 		return isEnabled;
@@ -1507,6 +1213,32 @@ namespace SIE
 	ShaderCache::ShaderCache()
 	{
 		logger::debug("ShaderCache initialized with {} compiler threads", (int)compilationThreadCount);
+		compilationSet.Subscribe([](const CompilationEvent& a_event) {
+			if (!spdlog::should_log(spdlog::level::debug))
+				return;
+			if (a_event.type == CompilationEvent::Type::Finished)
+				logger::debug("Compiling Task succeeded: {} ({:.1f} ms)", a_event.task.GetString(), a_event.milliseconds);
+			else if (a_event.type == CompilationEvent::Type::Failed)
+				logger::debug("Compiling Task failed: {} ({:.1f} ms)", a_event.task.GetString(), a_event.milliseconds);
+		});
+		compilationSet.Subscribe([this](const CompilationEvent& a_event) {
+			// Counted on Started, a task can finish before its Queued event is published
+			if (a_event.type == CompilationEvent::Type::Started) {
+				reportBatchTasks++;
+				return;
+			}
+			if (a_event.type != CompilationEvent::Type::Finished && a_event.type != CompilationEvent::Type::Failed)
+				return;
+			if (IsCompiling())
+				return;
+			// Several threads can finish the last tasks at once, only the one that claims the count writes
+			const auto batchTasks = reportBatchTasks.exchange(0);
+			if (batchTasks == 0)
+				return;
+			// The startup batch is always reported, later ones only when large enough to be worth rewriting the report for
+			if (!reportWritten.exchange(true) || batchTasks >= MIN_REPORT_BATCH)
+				compilationStats.WriteReport("Data\\SKSE\\Plugins\\CommunityShadersCompileReport.json");
+		});
 		compilationPool.push_task(&ShaderCache::ManageCompilationSet, this, ssource.get_token());
 	}
 
@@ -1595,6 +1327,20 @@ namespace SIE
 				SShaderCache::CompileShader(ShaderClass::Vertex, shader, descriptor, isDiskCache)) {
 			static const auto device = REL::Relocation<ID3D11Device**>(RE::Offset::D3D11Device);
 
+			const auto typeIndex = static_cast<size_t>(shader.shaderType.get());
+			const auto hash = SShaderCache::GetBytecodeHash(*shaderBlob);
+			{
+				std::lock_guard lockGuard(vertexShadersMutex);
+				if (auto source = vertexShaders.FindShared(typeIndex, hash)) {
+					auto clone = SShaderCache::CloneVertexShader(*source, *shaderBlob, descriptor);
+					auto [stored, added] = vertexShaders.Add(typeIndex, descriptor, clone, &shader, hash,
+						sizeof(RE::BSGraphics::VertexShader) + shaderBlob->GetBufferSize(), shaderBlob->GetBufferSize(), true, frameIndex);
+					if (!added)
+						clone->shader->Release();
+					return stored;
+				}
+			}
+
 			auto newShader = SShaderCache::CreateVertexShader(*shaderBlob, shader.shaderType.get(),
 				descriptor);
 
@@ -1609,9 +1355,13 @@ namespace SIE
 					newShader->shader->Release();
 				}
 			} else {
-				return vertexShaders[static_cast<size_t>(shader.shaderType.get())]
-				    .insert_or_assign(descriptor, std::move(newShader))
-				    .first->second.get();
+				// The driver object is assumed to be about as large as the bytecode
+				auto [stored, added] = vertexShaders.Add(typeIndex, descriptor, newShader, &shader, hash,
+					sizeof(RE::BSGraphics::VertexShader) + shaderBlob->GetBufferSize() * 2, shaderBlob->GetBufferSize(), false, frameIndex);
+				// Another thread created it first, the shader it returned stays valid
+				if (!added)
+					newShader->shader->Release();
+				return stored;
 			}
 		}
 		return nullptr;
@@ -1624,6 +1374,20 @@ namespace SIE
 				SShaderCache::CompileShader(ShaderClass::Pixel, shader, descriptor, isDiskCache)) {
 			static const auto device = REL::Relocation<ID3D11Device**>(RE::Offset::D3D11Device);
 
+			const auto typeIndex = static_cast<size_t>(shader.shaderType.get());
+			const auto hash = SShaderCache::GetBytecodeHash(*shaderBlob);
+			{
+				std::lock_guard lockGuard(pixelShadersMutex);
+				if (auto source = pixelShaders.FindShared(typeIndex, hash)) {
+					auto clone = SShaderCache::ClonePixelShader(*source, descriptor);
+					auto [stored, added] = pixelShaders.Add(typeIndex, descriptor, clone, &shader, hash,
+						sizeof(RE::BSGraphics::PixelShader), shaderBlob->GetBufferSize(), true, frameIndex);
+					if (!added)
+						clone->shader->Release();
+					return stored;
+				}
+			}
+
 			auto newShader = SShaderCache::CreatePixelShader(*shaderBlob, shader.shaderType.get(),
 				descriptor);
 
@@ -1638,14 +1402,75 @@ namespace SIE
 					newShader->shader->Release();
 				}
 			} else {
-				return pixelShaders[static_cast<size_t>(shader.shaderType.get())]
-				    .insert_or_assign(descriptor, std::move(newShader))
-				    .first->second.get();
+				auto [stored, added] = pixelShaders.Add(typeIndex, descriptor, newShader, &shader, hash,
+					sizeof(RE::BSGraphics::PixelShader) + shaderBlob->GetBufferSize(), shaderBlob->GetBufferSize(), false, frameIndex);
+				// Another thread created it first, the shader it returned stays valid
+				if (!added)
+					newShader->shader->Release();
+				return stored;
 			}
 		}
 		return nullptr;
 	}
 
+	ShaderCache::BytecodeStats ShaderCache::GetBytecodeStats(ShaderClass a_class, RE::BSShader::Type a_type)
+	{
+		if (a_class == ShaderClass::Vertex) {
+			std::lock_guard lockGuard(vertexShadersMutex);
+			return vertexShaders.GetBytecodeStats(static_cast<size_t>(a_type));
+		} else if (a_class == ShaderClass::Pixel) {
+			std::lock_guard lockGuard(pixelShadersMutex);
+			return pixelShaders.GetBytecodeStats(static_cast<size_t>(a_type));
+		}
+		return {};
+	}
+
+	ShaderCache::MemoryStats ShaderCache::GetMemoryStats()
+	{
+		MemoryStats stats;
+		std::scoped_lock lock(vertexShadersMutex, pixelShadersMutex);
+		stats.shaders = vertexShaders.GetCount() + pixelShaders.GetCount();
+		stats.bytes = vertexShaders.GetBytes() + pixelShaders.GetBytes();
+		stats.bytecodeBytes = bytecodeBytes;
+		stats.evictions = vertexShaders.GetEvictions() + pixelShaders.GetEvictions();
+		stats.restores = vertexShaders.GetRestores() + pixelShaders.GetRestores();
+		return stats;
+	}
+
+	void ShaderCache::EvictUnusedShaders()
+	{
+		const uint32_t frame = ++frameIndex;
+		const size_t budget = static_cast<size_t>(memoryBudget) * 1024 * 1024;
+		// Scanning every entry is not free, only check a few times per second
+		if (!budget || frame % 30)
+			return;
+
+		// Bytecode can only be dropped if the disk cache can give it back, and not while a compile thread may hold a blob
+		const bool dropBytecode = isDiskCache && !IsCompiling();
+		auto usedBytes = [&]() {
+			return vertexShaders.GetBytes() + pixelShaders.GetBytes() + (dropBytecode ? bytecodeBytes.load() : 0);
+		};
+		if (usedBytes() <= budget)
+			return;
+
+		std::scoped_lock lock(vertexShadersMutex, pixelShadersMutex);
+		auto evict = [&](auto& a_store, ShaderClass a_class) {
+			std::vector<typename std::remove_reference_t<decltype(a_store)>::Candidate> candidates;
+			a_store.CollectCandidates(frame, evictionFrames, candidates);
+			for (const auto& candidate : candidates) {
+				if (usedBytes() <= budget)
+					break;
+				auto entry = a_store.Evict(candidate.type, candidate.descriptor);
+				entry.shader->shader->Release();
+				// Descriptors with the same defines share the blob, the first one evicted drops it
+				if (dropBytecode)
+					DropCompletedShader(SShaderCache::GetShaderString(a_class, *entry.owner, candidate.descriptor, true));
+			}
+		};
+		evict(vertexShaders, ShaderClass::Vertex);
+		evict(pixelShaders, ShaderClass::Pixel);
+	}
+
 	uint64_t ShaderCache::GetCachedHitTasks()
 	{
 		return compilationSet.cacheHitTasks;
@@ -1753,8 +1578,7 @@ namespace SIE
 
 	size_t ShaderCompilationTask::GetId() const
 	{
-		return descriptor + (static_cast<size_t>(shader.shaderType.underlying()) << 32) +
-		       (static_cast<size_t>(shaderClass) << 60);
+		return GetShaderTaskId(static_cast<uint32_t>(shaderClass), shader.shaderType.underlying(), descriptor);
 	}
 
 	std::string ShaderCompilationTask::GetString() const
@@ -1784,8 +1608,10 @@ namespace SIE
 			lastCalculation = lastReset = high_resolution_clock::now();
 		}
 		auto node = availableTasks.extract(availableTasks.begin());
-		auto& task = node.value();
-		tasksInProgress.insert(std::move(node));
+		ShaderCompilationTask task = node.value();
+		tasksInProgress.emplace(task, steady_clock::now());
+		lock.unlock();
+		Publish({ CompilationEvent::Type::Started, task });
 		return task;
 	}
 
@@ -1800,29 +1626,69 @@ namespace SIE
 			if (wasAdded) {
 				conditionVariable.notify_one();
 				totalTasks++;
+				Publish({ CompilationEvent::Type::Queued, task });
 			}
 		}
 	}
 
+	void CompilationSet::Forget(const ShaderCompilationTask& task)
+	{
+		std::scoped_lock lock(compilationMutex);
+		processedTasks.erase(task);
+	}
+
 	void CompilationSet::Complete(const ShaderCompilationTask& task)
 	{
 		auto& cache = ShaderCache::Instance();
-		auto key = task.GetString();
-		auto shaderBlob = cache.GetCompletedShader(task);
-		if (shaderBlob) {
-			logger::debug("Compiling Task succeeded: {}", key);
+		bool succeeded = cache.GetCompletedShader(task) != nullptr;
+		if (succeeded)
 			completedTasks++;
-		} else {
-			logger::debug("Compiling Task failed: {}", key);
+		else
 			failedTasks++;
-		}
 		auto now = high_resolution_clock::now();
 		totalMs += duration_cast<milliseconds>(now - lastCalculation).count();
 		lastCalculation = now;
-		std::scoped_lock lock(compilationMutex);
-		processedTasks.insert(task);
-		tasksInProgress.erase(task);
+		double taskMs = 0.0;
+		{
+			std::scoped_lock lock(compilationMutex);
+			processedTasks.insert(task);
+			if (auto it = tasksInProgress.find(task); it != tasksInProgress.end()) {
+				taskMs = duration<double, std::milli>(steady_clock::now() - it->second).count();
+				tasksInProgress.erase(it);
+			}
+		}
 		conditionVariable.notify_one();
+		completionVariable.notify_all();
+		Publish({ succeeded ? CompilationEvent::Type::Finished : CompilationEvent::Type::Failed, task, taskMs });
+	}
+
+	void CompilationSet::WaitForCompletion()
+	{
+		auto& shaderCache = ShaderCache::Instance();
+		std::unique_lock lock(compilationMutex);
+		completionVariable.wait(lock, [&shaderCache]() { return !shaderCache.IsCompiling() || shaderCache.backgroundCompilation; });
+	}
+
+	void CompilationSet::NotifyCompletion()
+	{
+		// Taking the lock orders this wake-up after a waiter's predicate check
+		{
+			std::scoped_lock lock(compilationMutex);
+		}
+		completionVariable.notify_all();
+	}
+
+	void CompilationSet::Subscribe(CompilationListener a_listener)
+	{
+		std::unique_lock lock(listenersMutex);
+		listeners.push_back(std::move(a_listener));
+	}
+
+	void CompilationSet::Publish(const CompilationEvent& a_event)
+	{
+		std::shared_lock lock(listenersMutex);
+		for (auto& listener : listeners)
+			listener(a_event);
 	}
 
 	void CompilationSet::Clear()
@@ -1838,6 +1704,7 @@ namespace SIE
 		lastReset = high_resolution_clock::now();
 		lastCalculation = high_resolution_clock::now();
 		totalMs = (double)duration_cast<std::chrono::milliseconds>(lastReset - lastReset).count();
+		completionVariable.notify_all();
 	}
 
 	std::string CompilationSet::GetHumanTime(double a_totalms)
@@ -1875,6 +1742,138 @@ namespace SIE
 			GetHumanTime(GetEta() + totalMs));
 	}
 
+	uint CompilationStats::GetBucket(double a_milliseconds)
+	{
+		if (a_milliseconds < 1.0)
+			return 0;
+		return std::min(static_cast<uint>(std::log2(a_milliseconds)) + 1, BUCKET_COUNT - 1);
+	}
+
+	std::string CompilationStats::GetBucketName(uint a_bucket)
+	{
+		if (a_bucket == 0)
+			return "<1 ms";
+		if (a_bucket == BUCKET_COUNT - 1)
+			return fmt::format("{}+ ms", 1u << (a_bucket - 1));
+		return fmt::format("{}-{} ms", 1u << (a_bucket - 1), 1u << a_bucket);
+	}
+
+	void CompilationStats::Add(Record&& a_record)
+	{
+		const bool compiled = a_record.source == Source::Compiled || a_record.source == Source::Failed;
+
+		std::scoped_lock lock(mutex);
+		auto& typeStats = types[static_cast<size_t>(a_record.type)];
+		typeStats.sources[static_cast<size_t>(a_record.source)]++;
+		if (!compiled)
+			return;
+
+		typeStats.buckets[GetBucket(a_record.milliseconds)]++;
+		typeStats.compileMs += a_record.milliseconds;
+		typeStats.maxMs = std::max(typeStats.maxMs, a_record.milliseconds);
+
+		// Every define of the permutation is charged its full compile time, their averages rank the expensive ones
+		for (const auto token : std::views::split(std::string_view(a_record.defines), ' ')) {
+			std::string_view define(token.begin(), token.end());
+			define = define.substr(0, define.find('='));
+			if (define.empty())
+				continue;
+			auto& defineStats = defines[std::string(define)];
+			defineStats.count++;
+			defineStats.milliseconds += a_record.milliseconds;
+		}
+
+		if (slowest.size() < SLOWEST_COUNT || a_record.milliseconds > slowest.back().milliseconds) {
+			auto it = std::ranges::upper_bound(slowest, a_record.milliseconds, std::greater{}, &Record::milliseconds);
+			slowest.insert(it, std::move(a_record));
+			if (slowest.size() > SLOWEST_COUNT)
+				slowest.pop_back();
+		}
+	}
+
+	void CompilationStats::Clear()
+	{
+		std::scoped_lock lock(mutex);
+		types = {};
+		slowest.clear();
+		defines.clear();
+	}
+
+	CompilationStats::TypeStats CompilationStats::GetTypeStats(RE::BSShader::Type a_type)
+	{
+		std::scoped_lock lock(mutex);
+		return types[static_cast<size_t>(a_type)];
+	}
+
+	std::vector<CompilationStats::Record> CompilationStats::GetSlowest()
+	{
+		std::scoped_lock lock(mutex);
+		return slowest;
+	}
+
+	bool CompilationStats::WriteReport(const std::string& a_path)
+	{
+		// Compile threads keep adding records while the report is built and written
+		decltype(types) typesCopy;
+		decltype(slowest) slowestCopy;
+		std::vector<std::pair<std::string, DefineStats>> sortedDefines;
+		{
+			std::scoped_lock lock(mutex);
+			typesCopy = types;
+			slowestCopy = slowest;
+			sortedDefines.assign(defines.begin(), defines.end());
+		}
+
+		nlohmann::json report;
+		for (int typeIndex = 1; typeIndex < RE::BSShader::Type::Total; ++typeIndex) {
+			const auto& typeStats = typesCopy[typeIndex];
+			if (std::ranges::all_of(typeStats.sources, [](uint64_t a_count) { return a_count == 0; }))
+				continue;
+			const auto compiles = typeStats.sources[static_cast<size_t>(Source::Compiled)] + typeStats.sources[static_cast<size_t>(Source::Failed)];
+			nlohmann::json typeReport;
+			for (size_t source = 0; source < static_cast<size_t>(Source::Total); source++)
+				typeReport[std::string(magic_enum::enum_name(static_cast<Source>(source)))] = typeStats.sources[source];
+			typeReport["CompileMs"] = typeStats.compileMs;
+			typeReport["MeanMs"] = compiles ? typeStats.compileMs / compiles : 0.0;
+			typeReport["MaxMs"] = typeStats.maxMs;
+			for (uint bucket = 0; bucket < BUCKET_COUNT; bucket++)
+				typeReport["Histogram"][GetBucketName(bucket)] = typeStats.buckets[bucket];
+			report["Types"][std::string(magic_enum::enum_name(static_cast<RE::BSShader::Type>(typeIndex)))] = typeReport;
+		}
+
+		report["Slowest"] = nlohmann::json::array();
+		for (const auto& record : slowestCopy) {
+			report["Slowest"].push_back({
+				{ "Type", std::string(magic_enum::enum_name(record.type)) },
+				{ "Class", std::string(magic_enum::enum_name(record.shaderClass)) },
+				{ "Descriptor", fmt::format("{:X}", record.descriptor) },
+				{ "Result", std::string(magic_enum::enum_name(record.source)) },
+				{ "Ms", record.milliseconds },
+				{ "SourceBytes", record.sourceBytes },
+				{ "DefineCount", record.defineCount },
+				{ "DefineBytes", record.defineBytes },
+				{ "BytecodeBytes", record.bytecodeBytes },
+				{ "Defines", record.defines },
+			});
+		}
+
+		std::ranges::sort(sortedDefines, std::greater{}, [](const auto& a_define) { return a_define.second.milliseconds / a_define.second.count; });
+		report["Defines"] = nlohmann::json::array();
+		for (const auto& [define, defineStats] : sortedDefines)
+			report["Defines"].push_back({ { "Define", define }, { "Permutations", defineStats.count }, { "MeanMs", defineStats.milliseconds / defineStats.count } });
+
+		const auto text = report.dump(1);
+		std::scoped_lock lock(fileMutex);  // the menu can write the report while compiles finish
+		std::ofstream file(a_path);
+		if (!file.is_open()) {
+			logger::warn("Failed to open {} for writing", a_path);
+			return false;
+		}
+		file << text;
+		logger::info("Saved shader compile report to {}", a_path);
+		return true;
+	}
+
 	void UpdateListener::processQueue()
 	{
 		SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
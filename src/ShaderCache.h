@@ -3,9 +3,14 @@
 #include <RE/B/BSShader.h>
 
 #include "BS_thread_pool.hpp"
+#include "ShaderDescriptors.h"
+#include "ShaderIncludeCache.h"
+#include "ShaderStore.h"
 #include "efsw/efsw.hpp"
 #include <chrono>
 #include <condition_variable>
+#include <functional>
+#include <shared_mutex>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -59,13 +64,37 @@ struct std::hash<SIE::ShaderCompilationTask>
 
 namespace SIE
 {
+	struct CompilationEvent
+	{
+		enum class Type
+		{
+			Queued,
+			Started,
+			Finished,
+			Failed
+		};
+		Type type;
+		const ShaderCompilationTask& task;
+		double milliseconds = 0.0;  // time spent compiling, only set for Finished and Failed
+	};
+
+	using CompilationListener = std::function<void(const CompilationEvent&)>;
+
 	class CompilationSet
 	{
 	public:
 		std::optional<ShaderCompilationTask> WaitTake(std::stop_token stoken);
 		void Add(const ShaderCompilationTask& task);
 		void Complete(const ShaderCompilationTask& task);
+		/** @brief Lets a processed task be added again, for shaders whose bytecode was dropped on eviction. */
+		void Forget(const ShaderCompilationTask& task);
 		void Clear();
+		/** @brief Blocks until every queued task has completed or failed, or compilation moved to the background. */
+		void WaitForCompletion();
+		/** @brief Wakes threads blocked in WaitForCompletion so they re-check their condition. */
+		void NotifyCompletion();
+		/** @brief Registers a listener called on the compiling thread for every task state change. */
+		void Subscribe(CompilationListener a_listener);
 		std::string GetHumanTime(double a_totalms);
 		double GetEta();
 		std::string GetStatsString(bool a_timeOnly = false);
@@ -77,14 +106,84 @@ namespace SIE
 
 	private:
 		std::unordered_set<ShaderCompilationTask> availableTasks;
-		std::unordered_set<ShaderCompilationTask> tasksInProgress;
-		std::unordered_set<ShaderCompilationTask> processedTasks;  // completed or failed
+		std::unordered_map<ShaderCompilationTask, std::chrono::steady_clock::time_point> tasksInProgress;  // task to start time
+		std::unordered_set<ShaderCompilationTask> processedTasks;                                          // completed or failed
 		std::condition_variable_any conditionVariable;
+		std::condition_variable_any completionVariable;
+		std::vector<CompilationListener> listeners;
+		std::shared_mutex listenersMutex;
+
+		void Publish(const CompilationEvent& a_event);
 		std::chrono::steady_clock::time_point lastReset = high_resolution_clock::now();
 		std::chrono::steady_clock::time_point lastCalculation = high_resolution_clock::now();
 		double totalMs = (double)duration_cast<std::chrono::milliseconds>(lastReset - lastReset).count();
 	};
 
+	/**
+	 * Cost of every shader permutation requested this session, bucketed per shader type,
+	 * with the slowest compiles kept along with their defines.
+	 */
+	class CompilationStats
+	{
+	public:
+		enum class Source
+		{
+			Memory,  // already compiled this session
+			Disk,    // loaded from the disk cache
+			Compiled,
+			Failed,
+			Total
+		};
+
+		static constexpr uint BUCKET_COUNT = 12;  // log2 milliseconds, under 1 ms first and 1024 ms or more last
+		static constexpr size_t SLOWEST_COUNT = 20;
+
+		struct Record
+		{
+			ShaderClass shaderClass;
+			RE::BSShader::Type type;
+			uint32_t descriptor;
+			Source source = Source::Memory;
+			double milliseconds = 0.0;
+			size_t sourceBytes = 0;  // entry file only, includes are not counted
+			uint32_t defineCount = 0;
+			size_t defineBytes = 0;
+			size_t bytecodeBytes = 0;
+			std::string defines;  // only set when compiled
+		};
+
+		struct TypeStats
+		{
+			std::array<uint64_t, BUCKET_COUNT> buckets{};  // compiled and failed only, cache hits would hide the cost
+			std::array<uint64_t, static_cast<size_t>(Source::Total)> sources{};
+			double compileMs = 0.0;
+			double maxMs = 0.0;
+		};
+
+		static uint GetBucket(double a_milliseconds);
+		static std::string GetBucketName(uint a_bucket);
+
+		void Add(Record&& a_record);
+		void Clear();
+		TypeStats GetTypeStats(RE::BSShader::Type a_type);
+		std::vector<Record> GetSlowest();
+		/** @brief Writes the per type histograms, the slowest permutations and the average compile time per define as JSON. */
+		bool WriteReport(const std::string& a_path);
+
+	private:
+		struct DefineStats
+		{
+			uint64_t count = 0;
+			double milliseconds = 0.0;
+		};
+
+		std::mutex mutex;
+		std::mutex fileMutex;
+		std::array<TypeStats, static_cast<size_t>(RE::BSShader::Type::Total)> types;
+		std::vector<Record> slowest;  // descending duration
+		std::unordered_map<std::string, DefineStats> defines;
+	};
+
 	struct ShaderCacheResult
 	{
 		ID3DBlob* blob;
@@ -124,6 +223,10 @@ namespace SIE
 		}
 
 		bool IsCompiling();
+		/** @brief Blocks until shader compilation finishes or is moved to the background. */
+		void WaitForCompilation();
+		void SetBackgroundCompilation(bool value);
+		void SubscribeCompilationEvents(CompilationListener a_listener);
 		bool IsEnabled() const;
 		void SetEnabled(bool value);
 		bool IsAsync() const;
@@ -173,6 +276,25 @@ namespace SIE
 		RE::BSGraphics::PixelShader* MakeAndAddPixelShader(const RE::BSShader& shader,
 			uint32_t descriptor);
 
+		using BytecodeStats = ShaderBytecodeStats;
+		/** @brief How many unique bytecode blobs back the created shaders of a type. */
+		BytecodeStats GetBytecodeStats(ShaderClass a_class, RE::BSShader::Type a_type);
+
+		struct MemoryStats
+		{
+			size_t shaders = 0;
+			size_t bytes = 0;
+			size_t bytecodeBytes = 0;  // compiled bytecode kept in memory to create shaders from
+			uint64_t evictions = 0;
+			uint64_t restores = 0;  // evicted shaders created again
+		};
+		MemoryStats GetMemoryStats();
+		/**
+		 * @brief Once per frame. Evicts the least recently used shaders, unused for at least evictionFrames, while over memoryBudget.
+		 * With the disk cache on, the bytecode of evicted shaders is dropped too and read back from disk when they are next drawn.
+		 */
+		void EvictUnusedShaders();
+
 		uint64_t GetCachedHitTasks();
 		uint64_t GetCompletedTasks();
 		uint64_t GetFailedTasks();
@@ -188,110 +310,23 @@ namespace SIE
 
 		int32_t compilationThreadCount = std::max(static_cast<int32_t>(std::thread::hardware_concurrency()) - 1, 1);
 		int32_t backgroundCompilationThreadCount = std::max(static_cast<int32_t>(std::thread::hardware_concurrency()) / 2, 1);
+		CompilationStats compilationStats;
+		ShaderIncludeCache includeCache;
+		bool useIncludeCache = true;  // serve shader sources from includeCache instead of letting the compiler read them
 		BS::thread_pool compilationPool{};
-		bool backgroundCompilation = false;
+		std::atomic<bool> backgroundCompilation = false;
+		std::atomic<uint64_t> reportBatchTasks = 0;  // tasks started since the compile report was last considered
+		std::atomic<bool> reportWritten = false;     // the startup batch has been reported
+		static constexpr uint64_t MIN_REPORT_BATCH = 64;  // smaller batches after startup are on-demand compiles, the menu writes those
 		bool menuLoaded = false;
+		uint32_t memoryBudget = 0;  // MB of created shaders before eviction, 0 disables
+		uint32_t evictionFrames = 1800;
 
-		enum class LightingShaderTechniques
-		{
-			None = 0,
-			Envmap = 1,
-			Glowmap = 2,
-			Parallax = 3,
-			Facegen = 4,
-			FacegenRGBTint = 5,
-			Hair = 6,
-			ParallaxOcc = 7,
-			MTLand = 8,
-			LODLand = 9,
-			Snow = 10,  // unused
-			MultilayerParallax = 11,
-			TreeAnim = 12,
-			LODObjects = 13,
-			MultiIndexSparkle = 14,
-			LODObjectHD = 15,
-			Eye = 16,
-			Cloud = 17,  // unused
-			LODLandNoise = 18,
-			MTLandLODBlend = 19,
-			Outline = 20,
-		};
-
-		enum class LightingShaderFlags
-		{
-			VC = 1 << 0,
-			Skinned = 1 << 1,
-			ModelSpaceNormals = 1 << 2,
-			// flags 3 to 8 are unused
-			Specular = 1 << 9,
-			SoftLighting = 1 << 10,
-			RimLighting = 1 << 11,
-			BackLighting = 1 << 12,
-			ShadowDir = 1 << 13,
-			DefShadow = 1 << 14,
-			ProjectedUV = 1 << 15,
-			AnisoLighting = 1 << 16,
-			AmbientSpecular = 1 << 17,
-			WorldMap = 1 << 18,
-			BaseObjectIsSnow = 1 << 19,
-			DoAlphaTest = 1 << 20,
-			Snow = 1 << 21,
-			CharacterLight = 1 << 22,
-			AdditionalAlphaMask = 1 << 23,
-		};
-
-		enum class WaterShaderTechniques
-		{
-			Underwater = 8,
-			Lod = 9,
-			Stencil = 10,
-			Simple = 11,
-		};
-
-		enum class WaterShaderFlags
-		{
-			Vc = 1 << 0,
-			NormalTexCoord = 1 << 1,
-			Reflections = 1 << 2,
-			Refractions = 1 << 3,
-			Depth = 1 << 4,
-			Interior = 1 << 5,
-			Wading = 1 << 6,
-			VertexAlphaDepth = 1 << 7,
-			Cubemap = 1 << 8,
-			Flowmap = 1 << 9,
-			BlendNormals = 1 << 10,
-		};
-
-		enum class EffectShaderFlags
-		{
-			Vc = 1 << 0,
-			TexCoord = 1 << 1,
-			TexCoordIndex = 1 << 2,
-			Skinned = 1 << 3,
-			Normals = 1 << 4,
-			BinormalTangent = 1 << 5,
-			Texture = 1 << 6,
-			IndexedTexture = 1 << 7,
-			Falloff = 1 << 8,
-			AddBlend = 1 << 10,
-			MultBlend = 1 << 11,
-			Particles = 1 << 12,
-			StripParticles = 1 << 13,
-			Blood = 1 << 14,
-			Membrane = 1 << 15,
-			Lighting = 1 << 16,
-			ProjectedUv = 1 << 17,
-			Soft = 1 << 18,
-			GrayscaleToColor = 1 << 19,
-			GrayscaleToAlpha = 1 << 20,
-			IgnoreTexAlpha = 1 << 21,
-			MultBlendDecal = 1 << 22,
-			AlphaTest = 1 << 23,
-			SkyObject = 1 << 24,
-			MsnSpuSkinned = 1 << 25,
-			MotionVectorsNormals = 1 << 26,
-		};
+		using LightingShaderTechniques = SIE::LightingShaderTechniques;
+		using LightingShaderFlags = SIE::LightingShaderFlags;
+		using WaterShaderTechniques = SIE::WaterShaderTechniques;
+		using WaterShaderFlags = SIE::WaterShaderFlags;
+		using EffectShaderFlags = SIE::EffectShaderFlags;
 
 		uint blockedKeyIndex = (uint)-1;  // index in shaderMap; negative value indicates disabled
 		std::string blockedKey = "";
@@ -304,12 +339,13 @@ namespace SIE
 
 		~ShaderCache();
 
-		std::array<std::map<uint32_t, std::unique_ptr<RE::BSGraphics::VertexShader>>,
-			static_cast<size_t>(RE::BSShader::Type::Total)>
-			vertexShaders;
-		std::array<std::map<uint32_t, std::unique_ptr<RE::BSGraphics::PixelShader>>,
-			static_cast<size_t>(RE::BSShader::Type::Total)>
-			pixelShaders;
+		/** @brief Drops the compiled bytecode of a_key, it is read from the disk cache when next needed. */
+		void DropCompletedShader(const std::string& a_key);
+
+		ShaderStore<RE::BSGraphics::VertexShader, RE::BSShader, static_cast<size_t>(RE::BSShader::Type::Total)> vertexShaders;  // guarded by vertexShadersMutex
+		ShaderStore<RE::BSGraphics::PixelShader, RE::BSShader, static_cast<size_t>(RE::BSShader::Type::Total)> pixelShaders;    // guarded by pixelShadersMutex
+		std::atomic<size_t> bytecodeBytes = 0;  // blobs in shaderMap
+		std::atomic<uint32_t> frameIndex = 0;
 
 		bool isEnabled = false;
 		bool isDiskCache = false;
@@ -0,0 +1,248 @@
+#pragma once
+
+#include <charconv>
+
+#include "ShaderDescriptors.h"
+
+namespace SIE
+{
+	/**
+	 * Writes the defines the vanilla shaders compile with for a descriptor, without a terminator, and returns how many were written.
+	 * ShaderType is RE::BSShader::Type and Macro is D3D_SHADER_MACRO in the plugin.
+	 * Lighting defines come from the game and are not handled here, nor are types without vanilla defines.
+	 */
+	template <class ShaderType, class Macro>
+	inline uint32_t GetVanillaShaderDefines(ShaderType a_type, uint32_t a_descriptor, Macro* a_defines)
+	{
+		uint32_t lastIndex = 0;
+		switch (a_type) {
+		case ShaderType::Grass:
+			{
+				const auto technique = a_descriptor & 0b1111;
+				if (technique == static_cast<uint32_t>(GrassShaderTechniques::RenderDepth))
+					a_defines[lastIndex++] = { "RENDER_DEPTH", nullptr };
+				if (a_descriptor & static_cast<uint32_t>(GrassShaderFlags::AlphaTest))
+					a_defines[lastIndex++] = { "DO_ALPHA_TEST", nullptr };
+			}
+			break;
+		case ShaderType::Sky:
+			switch (static_cast<SkyShaderTechniques>(a_descriptor)) {
+			case SkyShaderTechniques::SunOcclude:
+				a_defines[lastIndex++] = { "OCCLUSION", nullptr };
+				break;
+			case SkyShaderTechniques::SunGlare:
+				a_defines[lastIndex++] = { "TEX", nullptr };
+				a_defines[lastIndex++] = { "DITHER", nullptr };
+				break;
+			case SkyShaderTechniques::MoonAndStarsMask:
+				a_defines[lastIndex++] = { "TEX", nullptr };
+				a_defines[lastIndex++] = { "MOONMASK", nullptr };
+				break;
+			case SkyShaderTechniques::Stars:
+				a_defines[lastIndex++] = { "HORIZFADE", nullptr };
+				break;
+			case SkyShaderTechniques::Clouds:
+				a_defines[lastIndex++] = { "TEX", nullptr };
+				a_defines[lastIndex++] = { "CLOUDS", nullptr };
+				break;
+			case SkyShaderTechniques::CloudsLerp:
+				a_defines[lastIndex++] = { "TEX", nullptr };
+				a_defines[lastIndex++] = { "CLOUDS", nullptr };
+				a_defines[lastIndex++] = { "TEXLERP", nullptr };
+				break;
+			case SkyShaderTechniques::CloudsFade:
+				a_defines[lastIndex++] = { "TEX", nullptr };
+				a_defines[lastIndex++] = { "CLOUDS", nullptr };
+				a_defines[lastIndex++] = { "TEXFADE", nullptr };
+				break;
+			case SkyShaderTechniques::Texture:
+				a_defines[lastIndex++] = { "TEX", nullptr };
+				break;
+			case SkyShaderTechniques::Sky:
+				a_defines[lastIndex++] = { "DITHER", nullptr };
+				break;
+			}
+			break;
+		case ShaderType::Water:
+			{
+				static constexpr std::pair<WaterShaderFlags, const char*> flagDefines[] = {
+					{ WaterShaderFlags::Vc, "VC" },
+					{ WaterShaderFlags::NormalTexCoord, "NORMAL_TEXCOORD" },
+					{ WaterShaderFlags::Reflections, "REFLECTIONS" },
+					{ WaterShaderFlags::Refractions, "REFRACTIONS" },
+					{ WaterShaderFlags::Depth, "DEPTH" },
+					{ WaterShaderFlags::Interior, "INTERIOR" },
+					{ WaterShaderFlags::Wading, "WADING" },
+					{ WaterShaderFlags::VertexAlphaDepth, "VERTEX_ALPHA_DEPTH" },
+					{ WaterShaderFlags::Cubemap, "CUBEMAP" },
+					{ WaterShaderFlags::Flowmap, "FLOWMAP" },
+					{ WaterShaderFlags::BlendNormals, "BLEND_NORMALS" },
+				};
+
+				a_defines[lastIndex++] = { "WATER", nullptr };
+				a_defines[lastIndex++] = { "FOG", nullptr };
+				for (const auto& [flag, name] : flagDefines) {
+					if (a_descriptor & static_cast<uint32_t>(flag))
+						a_defines[lastIndex++] = { name, nullptr };
+				}
+
+				const auto technique = (a_descriptor >> 11) & 0xF;
+				if (technique == static_cast<uint32_t>(WaterShaderTechniques::Underwater)) {
+					a_defines[lastIndex++] = { "UNDERWATER", nullptr };
+				} else if (technique == static_cast<uint32_t>(WaterShaderTechniques::Lod)) {
+					a_defines[lastIndex++] = { "LOD", nullptr };
+				} else if (technique == static_cast<uint32_t>(WaterShaderTechniques::Stencil)) {
+					a_defines[lastIndex++] = { "STENCIL", nullptr };
+				} else if (technique == static_cast<uint32_t>(WaterShaderTechniques::Simple)) {
+					a_defines[lastIndex++] = { "SIMPLE", nullptr };
+				} else if (technique < 8) {
+					static constexpr std::array<const char*, 8> numLightDefines = { { "0", "1", "2", "3", "4",
+						"5", "6", "7" } };
+					a_defines[lastIndex++] = { "SPECULAR", nullptr };
+					a_defines[lastIndex++] = { "NUM_SPECULAR_LIGHTS", numLightDefines[technique] };
+				}
+			}
+			break;
+		case ShaderType::BloodSplatter:
+			if (a_descriptor == static_cast<uint32_t>(BloodSplatterShaderTechniques::Splatter))
+				a_defines[lastIndex++] = { "SPLATTER", nullptr };
+			else if (a_descriptor == static_cast<uint32_t>(BloodSplatterShaderTechniques::Flare))
+				a_defines[lastIndex++] = { "FLARE", nullptr };
+			break;
+		case ShaderType::DistantTree:
+			if ((a_descriptor & 1) == static_cast<uint32_t>(DistantTreeShaderTechniques::Depth))
+				a_defines[lastIndex++] = { "RENDER_DEPTH", nullptr };
+			if (a_descriptor & static_cast<uint32_t>(DistantTreeShaderFlags::AlphaTest))
+				a_defines[lastIndex++] = { "DO_ALPHA_TEST", nullptr };
+			break;
+		case ShaderType::Particle:
+			switch (static_cast<ParticleShaderTechniques>(a_descriptor)) {
+			case ParticleShaderTechniques::ParticlesGryColor:
+				a_defines[lastIndex++] = { "GRAYSCALE_TO_COLOR", nullptr };
+				break;
+			case ParticleShaderTechniques::ParticlesGryAlpha:
+				a_defines[lastIndex++] = { "GRAYSCALE_TO_ALPHA", nullptr };
+				break;
+			case ParticleShaderTechniques::ParticlesGryColorAlpha:
+				a_defines[lastIndex++] = { "GRAYSCALE_TO_COLOR", nullptr };
+				a_defines[lastIndex++] = { "GRAYSCALE_TO_ALPHA", nullptr };
+				break;
+			case ParticleShaderTechniques::EnvCubeSnow:
+				a_defines[lastIndex++] = { "ENVCUBE", nullptr };
+				a_defines[lastIndex++] = { "SNOW", nullptr };
+				break;
+			case ParticleShaderTechniques::EnvCubeRain:
+				a_defines[lastIndex++] = { "ENVCUBE", nullptr };
+				a_defines[lastIndex++] = { "RAIN", nullptr };
+				break;
+			default:
+				break;
+			}
+			break;
+		case ShaderType::Effect:
+			{
+				static constexpr std::pair<EffectShaderFlags, const char*> flagDefines[] = {
+					{ EffectShaderFlags::Vc, "VC" },
+					{ EffectShaderFlags::TexCoord, "TEXCOORD" },
+					{ EffectShaderFlags::TexCoordIndex, "TEXCOORD_INDEX" },
+					{ EffectShaderFlags::Skinned, "SKINNED" },
+					{ EffectShaderFlags::Normals, "NORMALS" },
+					{ EffectShaderFlags::BinormalTangent, "BINORMAL_TANGENT" },
+					{ EffectShaderFlags::Texture, "TEXTURE" },
+					{ EffectShaderFlags::IndexedTexture, "INDEXED_TEXTURE" },
+					{ EffectShaderFlags::Falloff, "FALLOFF" },
+					{ EffectShaderFlags::AddBlend, "ADDBLEND" },
+					{ EffectShaderFlags::MultBlend, "MULTBLEND" },
+					{ EffectShaderFlags::Particles, "PARTICLES" },
+					{ EffectShaderFlags::StripParticles, "STRIP_PARTICLES" },
+					{ EffectShaderFlags::Blood, "BLOOD" },
+					{ EffectShaderFlags::Membrane, "MEMBRANE" },
+					{ EffectShaderFlags::Lighting, "LIGHTING" },
+					{ EffectShaderFlags::ProjectedUv, "PROJECTED_UV" },
+					{ EffectShaderFlags::Soft, "SOFT" },
+					{ EffectShaderFlags::GrayscaleToColor, "GRAYSCALE_TO_COLOR" },
+					{ EffectShaderFlags::GrayscaleToAlpha, "GRAYSCALE_TO_ALPHA" },
+					{ EffectShaderFlags::IgnoreTexAlpha, "IGNORE_TEX_ALPHA" },
+					{ EffectShaderFlags::MultBlendDecal, "MULTBLEND_DECAL" },
+					{ EffectShaderFlags::AlphaTest, "ALPHA_TEST" },
+					{ EffectShaderFlags::SkyObject, "SKY_OBJECT" },
+					{ EffectShaderFlags::MsnSpuSkinned, "MSN_SPU_SKINNED" },
+					{ EffectShaderFlags::MotionVectorsNormals, "MOTIONVECTORS_NORMALS" },
+				};
+
+				for (const auto& [flag, name] : flagDefines) {
+					if (a_descriptor & static_cast<uint32_t>(flag))
+						a_defines[lastIndex++] = { name, nullptr };
+				}
+			}
+			break;
+		default:
+			break;
+		}
+		return lastIndex;
+	}
+
+	/**
+	 * Joins null-terminated defines into "NAME NAME=VALUE " form.
+	 * Sorting orders them by name and value so the same set of defines always gives the same string, whatever order features added them in.
+	 */
+	template <class Macro, size_t N>
+	inline std::string MergeDefinesString(std::array<Macro, N>& a_defines, bool a_sort = false)
+	{
+		if (a_sort) {
+			auto defined = [](const char* a_string) { return a_string ? std::string_view(a_string) : std::string_view(); };
+			std::sort(std::begin(a_defines), std::end(a_defines), [&](const Macro& a, const Macro& b) {
+				if (!a.Name || !b.Name)  // null entries last
+					return a.Name && !b.Name;
+				if (auto order = std::string_view(a.Name) <=> std::string_view(b.Name); order != 0)
+					return order < 0;
+				return defined(a.Definition) < defined(b.Definition);
+			});
+		}
+
+		std::string result;
+		for (const auto& def : a_defines) {
+			if (def.Name == nullptr)
+				break;
+			result += def.Name;
+			if (def.Definition != nullptr && *def.Definition != '\0') {
+				result += "=";
+				result += def.Definition;
+			}
+			result += ' ';
+		}
+		return result;
+	}
+
+	/**
+	 * Builds the key a shader permutation is cached under, "file:class:defines".
+	 * The descriptor is only added for logging, hash keys leave it out so permutations with the same defines share one shader.
+	 */
+	inline std::string GetShaderKey(std::string_view a_file, std::string_view a_class, std::string_view a_defines, std::optional<uint32_t> a_descriptor = std::nullopt)
+	{
+		std::string result;
+		result.reserve(a_file.size() + a_class.size() + a_defines.size() + 11);
+		result.append(a_file).append(":").append(a_class).append(":");
+		if (a_descriptor) {
+			char buffer[8];
+			auto [end, error] = std::to_chars(std::begin(buffer), std::end(buffer), *a_descriptor, 16);
+			std::transform(std::begin(buffer), end, std::back_inserter(result), [](char c) { return static_cast<char>(::toupper(c)); });
+			result.append(":");
+		}
+		result.append(a_defines);
+		return result;
+	}
+
+	/** @brief Returns the shader file a key from GetShaderKey was built for, or an empty string for a malformed key. */
+	inline std::string GetTypeFromShaderKey(std::string_view a_key)
+	{
+		const auto pos = a_key.find(':');
+		return pos != std::string_view::npos ? std::string(a_key.substr(0, pos)) : std::string();
+	}
+
+	/** @brief Packs a compilation task into one id, the descriptor in the low 32 bits, then the shader type and class. */
+	constexpr size_t GetShaderTaskId(uint32_t a_class, uint32_t a_type, uint32_t a_descriptor)
+	{
+		return a_descriptor + (static_cast<size_t>(a_type) << 32) + (static_cast<size_t>(a_class) << 60);
+	}
+}
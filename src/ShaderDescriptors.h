@@ -0,0 +1,234 @@
+#pragma once
+
+namespace SIE
+{
+	enum class LightingShaderTechniques
+	{
+		None = 0,
+		Envmap = 1,
+		Glowmap = 2,
+		Parallax = 3,
+		Facegen = 4,
+		FacegenRGBTint = 5,
+		Hair = 6,
+		ParallaxOcc = 7,
+		MTLand = 8,
+		LODLand = 9,
+		Snow = 10,  // unused
+		MultilayerParallax = 11,
+		TreeAnim = 12,
+		LODObjects = 13,
+		MultiIndexSparkle = 14,
+		LODObjectHD = 15,
+		Eye = 16,
+		Cloud = 17,  // unused
+		LODLandNoise = 18,
+		MTLandLODBlend = 19,
+		Outline = 20,
+	};
+
+	enum class LightingShaderFlags
+	{
+		VC = 1 << 0,
+		Skinned = 1 << 1,
+		ModelSpaceNormals = 1 << 2,
+		// flags 3 to 8 are unused
+		Specular = 1 << 9,
+		SoftLighting = 1 << 10,
+		RimLighting = 1 << 11,
+		BackLighting = 1 << 12,
+		ShadowDir = 1 << 13,
+		DefShadow = 1 << 14,
+		ProjectedUV = 1 << 15,
+		AnisoLighting = 1 << 16,
+		AmbientSpecular = 1 << 17,
+		WorldMap = 1 << 18,
+		BaseObjectIsSnow = 1 << 19,
+		DoAlphaTest = 1 << 20,
+		Snow = 1 << 21,
+		CharacterLight = 1 << 22,
+		AdditionalAlphaMask = 1 << 23,
+	};
+
+	enum class WaterShaderTechniques
+	{
+		Underwater = 8,
+		Lod = 9,
+		Stencil = 10,
+		Simple = 11,
+	};
+
+	enum class WaterShaderFlags
+	{
+		Vc = 1 << 0,
+		NormalTexCoord = 1 << 1,
+		Reflections = 1 << 2,
+		Refractions = 1 << 3,
+		Depth = 1 << 4,
+		Interior = 1 << 5,
+		Wading = 1 << 6,
+		VertexAlphaDepth = 1 << 7,
+		Cubemap = 1 << 8,
+		Flowmap = 1 << 9,
+		BlendNormals = 1 << 10,
+	};
+
+	enum class EffectShaderFlags
+	{
+		Vc = 1 << 0,
+		TexCoord = 1 << 1,
+		TexCoordIndex = 1 << 2,
+		Skinned = 1 << 3,
+		Normals = 1 << 4,
+		BinormalTangent = 1 << 5,
+		Texture = 1 << 6,
+		IndexedTexture = 1 << 7,
+		Falloff = 1 << 8,
+		AddBlend = 1 << 10,
+		MultBlend = 1 << 11,
+		Particles = 1 << 12,
+		StripParticles = 1 << 13,
+		Blood = 1 << 14,
+		Membrane = 1 << 15,
+		Lighting = 1 << 16,
+		ProjectedUv = 1 << 17,
+		Soft = 1 << 18,
+		GrayscaleToColor = 1 << 19,
+		GrayscaleToAlpha = 1 << 20,
+		IgnoreTexAlpha = 1 << 21,
+		MultBlendDecal = 1 << 22,
+		AlphaTest = 1 << 23,
+		SkyObject = 1 << 24,
+		MsnSpuSkinned = 1 << 25,
+		MotionVectorsNormals = 1 << 26,
+	};
+
+	enum class BloodSplatterShaderTechniques
+	{
+		Splatter = 0,
+		Flare = 1,
+	};
+
+	enum class DistantTreeShaderTechniques
+	{
+		DistantTreeBlock = 0,
+		Depth = 1,
+	};
+
+	enum class DistantTreeShaderFlags
+	{
+		AlphaTest = 0x10000,
+	};
+
+	enum class SkyShaderTechniques
+	{
+		SunOcclude = 0,
+		SunGlare = 1,
+		MoonAndStarsMask = 2,
+		Stars = 3,
+		Clouds = 4,
+		CloudsLerp = 5,
+		CloudsFade = 6,
+		Texture = 7,
+		Sky = 8,
+	};
+
+	enum class GrassShaderTechniques
+	{
+		RenderDepth = 8,
+	};
+
+	enum class GrassShaderFlags
+	{
+		AlphaTest = 0x10000,
+	};
+
+	enum class ParticleShaderTechniques
+	{
+		Particles = 0,
+		ParticlesGryColor = 1,
+		ParticlesGryAlpha = 2,
+		ParticlesGryColorAlpha = 3,
+		EnvCubeSnow = 4,
+		EnvCubeRain = 5,
+	};
+
+	/**
+	 * Clears the descriptor bits that Community Shaders handles itself, so their permutations share one shader.
+	 * ShaderType is RE::BSShader::Type in the plugin and only needs Lighting, Water and Effect members.
+	 */
+	template <class ShaderType>
+	inline void RemapShaderDescriptors(ShaderType a_type, bool a_improvedSnow, uint32_t& a_vertexDescriptor, uint32_t& a_pixelDescriptor)
+	{
+		switch (a_type) {
+		case ShaderType::Lighting:
+			{
+				a_vertexDescriptor &= ~((uint32_t)LightingShaderFlags::AdditionalAlphaMask |
+										(uint32_t)LightingShaderFlags::AmbientSpecular |
+										(uint32_t)LightingShaderFlags::DoAlphaTest |
+										(uint32_t)LightingShaderFlags::ShadowDir |
+										(uint32_t)LightingShaderFlags::DefShadow |
+										(uint32_t)LightingShaderFlags::CharacterLight |
+										(uint32_t)LightingShaderFlags::RimLighting |
+										(uint32_t)LightingShaderFlags::SoftLighting |
+										(uint32_t)LightingShaderFlags::BackLighting |
+										(uint32_t)LightingShaderFlags::Specular |
+										(uint32_t)LightingShaderFlags::AnisoLighting |
+										(uint32_t)LightingShaderFlags::BaseObjectIsSnow |
+										(uint32_t)LightingShaderFlags::Snow);
+
+				a_pixelDescriptor &= ~((uint32_t)LightingShaderFlags::AmbientSpecular |
+									   (uint32_t)LightingShaderFlags::ShadowDir |
+									   (uint32_t)LightingShaderFlags::DefShadow |
+									   (uint32_t)LightingShaderFlags::CharacterLight);
+
+				if (!a_improvedSnow)
+					a_pixelDescriptor &= ~((uint32_t)LightingShaderFlags::Snow);
+
+				{
+					uint32_t technique = 0x3F & (a_vertexDescriptor >> 24);
+					if (technique == (uint32_t)LightingShaderTechniques::Glowmap ||
+						technique == (uint32_t)LightingShaderTechniques::Parallax ||
+						technique == (uint32_t)LightingShaderTechniques::Facegen ||
+						technique == (uint32_t)LightingShaderTechniques::FacegenRGBTint ||
+						technique == (uint32_t)LightingShaderTechniques::LODObjects ||
+						technique == (uint32_t)LightingShaderTechniques::LODObjectHD ||
+						technique == (uint32_t)LightingShaderTechniques::MultiIndexSparkle ||
+						technique == (uint32_t)LightingShaderTechniques::Hair)
+						a_vertexDescriptor &= ~(0x3F << 24);
+				}
+
+				{
+					uint32_t technique = 0x3F & (a_pixelDescriptor >> 24);
+					if (technique == (uint32_t)LightingShaderTechniques::Glowmap)
+						a_pixelDescriptor &= ~(0x3F << 24);
+				}
+			}
+			break;
+		case ShaderType::Water:
+			{
+				a_vertexDescriptor &= ~((uint32_t)WaterShaderFlags::Reflections |
+										(uint32_t)WaterShaderFlags::Cubemap |
+										(uint32_t)WaterShaderFlags::Interior);
+
+				a_pixelDescriptor &= ~((uint32_t)WaterShaderFlags::Reflections |
+									   (uint32_t)WaterShaderFlags::Cubemap |
+									   (uint32_t)WaterShaderFlags::Interior);
+			}
+			break;
+		case ShaderType::Effect:
+			{
+				a_vertexDescriptor &= ~((uint32_t)EffectShaderFlags::GrayscaleToColor |
+										(uint32_t)EffectShaderFlags::GrayscaleToAlpha |
+										(uint32_t)EffectShaderFlags::IgnoreTexAlpha);
+
+				a_pixelDescriptor &= ~((uint32_t)EffectShaderFlags::GrayscaleToColor |
+									   (uint32_t)EffectShaderFlags::GrayscaleToAlpha |
+									   (uint32_t)EffectShaderFlags::IgnoreTexAlpha);
+			}
+			break;
+		default:
+			break;
+		}
+	}
+}
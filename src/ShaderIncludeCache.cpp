@@ -0,0 +1,66 @@
+#include "ShaderIncludeCache.h"
+
+#include <cwctype>
+
+namespace SIE
+{
+	std::shared_ptr<const ShaderIncludeCache::File> ShaderIncludeCache::Load(const std::filesystem::path& a_path)
+	{
+		std::error_code error;
+		const auto path = std::filesystem::absolute(a_path, error).lexically_normal();
+		if (error)
+			return nullptr;
+		const auto writeTime = std::filesystem::last_write_time(path, error);
+		if (error)
+			return nullptr;
+
+		auto key = path.wstring();
+		std::ranges::transform(key, key.begin(), [](wchar_t c) { return static_cast<wchar_t>(towlower(c)); });
+
+		{
+			std::shared_lock lock(mutex);
+			if (auto it = files.find(key); it != files.end() && it->second->writeTime == writeTime) {
+				hits++;
+				return it->second;
+			}
+		}
+
+		std::ifstream stream(path, std::ios::binary);
+		if (!stream.is_open())
+			return nullptr;
+		auto file = std::make_shared<File>();
+		file->data.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+		file->directory = path.parent_path();
+		file->writeTime = writeTime;
+
+		// Files still used by a compile keep their old contents until it ends
+		std::unique_lock lock(mutex);
+		files.insert_or_assign(std::move(key), file);
+		misses++;
+		return file;
+	}
+
+	std::shared_ptr<const ShaderIncludeCache::File> ShaderIncludeCache::LoadInclude(const std::filesystem::path& a_fileName, bool a_local, const File* a_parent, const std::filesystem::path& a_rootDirectory)
+	{
+		if (a_local && a_parent && a_parent->directory != a_rootDirectory) {
+			if (auto file = Load(a_parent->directory / a_fileName))
+				return file;
+		}
+		return Load(a_rootDirectory / a_fileName);
+	}
+
+	void ShaderIncludeCache::Clear()
+	{
+		std::unique_lock lock(mutex);
+		files.clear();
+	}
+
+	ShaderIncludeCache::Stats ShaderIncludeCache::GetStats()
+	{
+		std::shared_lock lock(mutex);
+		Stats stats{ files.size(), 0, hits, misses };
+		for (const auto& [path, file] : files)
+			stats.bytes += file->data.size();
+		return stats;
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <filesystem>
+#include <shared_mutex>
+
+namespace SIE
+{
+	/**
+	 * Shader source files shared by all compile threads. A file is read from disk once and served from
+	 * memory until its modification time changes, so permutations of the same entry file stop rereading
+	 * the whole include tree.
+	 */
+	class ShaderIncludeCache
+	{
+	public:
+		struct File
+		{
+			std::string data;
+			std::filesystem::path directory;
+			std::filesystem::file_time_type writeTime;
+		};
+
+		struct Stats
+		{
+			size_t files = 0;
+			size_t bytes = 0;
+			uint64_t hits = 0;
+			uint64_t misses = 0;  // first reads and rereads of modified files
+		};
+
+		/** @brief Returns the contents of a_path, read from disk only if not cached or modified since.
+		@return nullptr if the file cannot be read
+		*/
+		std::shared_ptr<const File> Load(const std::filesystem::path& a_path);
+		/** @brief Resolves an include of a compile whose entry file is in a_rootDirectory.
+		Local includes are tried against a_parent's directory first and a_rootDirectory second, other includes only against a_rootDirectory.
+		@return nullptr if no candidate can be read
+		*/
+		std::shared_ptr<const File> LoadInclude(const std::filesystem::path& a_fileName, bool a_local, const File* a_parent, const std::filesystem::path& a_rootDirectory);
+		void Clear();
+		Stats GetStats();
+
+	private:
+		std::shared_mutex mutex;
+		std::unordered_map<std::wstring, std::shared_ptr<const File>> files;  // lower case absolute path
+		std::atomic<uint64_t> hits = 0;
+		std::atomic<uint64_t> misses = 0;
+	};
+}
@@ -0,0 +1,34 @@
+#include "ShaderIncludeHandler.h"
+
+namespace SIE
+{
+	ShaderIncludeHandler::ShaderIncludeHandler(ShaderIncludeCache& a_cache, std::shared_ptr<const ShaderIncludeCache::File> a_entry) :
+		cache(a_cache), rootDirectory(a_entry->directory), openFiles{ std::move(a_entry) }
+	{}
+
+	HRESULT __stdcall ShaderIncludeHandler::Open(D3D_INCLUDE_TYPE a_type, LPCSTR a_fileName, LPCVOID a_parentData, LPCVOID* a_data, UINT* a_bytes)
+	{
+		const ShaderIncludeCache::File* parent = nullptr;
+		for (const auto& file : openFiles) {
+			if (file->data.data() == a_parentData) {
+				parent = file.get();
+				break;
+			}
+		}
+
+		if (auto file = cache.LoadInclude(a_fileName, a_type == D3D_INCLUDE_LOCAL, parent, rootDirectory)) {
+			*a_data = file->data.data();
+			*a_bytes = static_cast<UINT>(file->data.size());
+			openFiles.push_back(std::move(file));
+			return S_OK;
+		}
+
+		logger::debug("Failed to open shader include {}", a_fileName);
+		return E_FAIL;
+	}
+
+	HRESULT __stdcall ShaderIncludeHandler::Close(LPCVOID)
+	{
+		return S_OK;
+	}
+}
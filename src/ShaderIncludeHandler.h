@@ -0,0 +1,26 @@
+#pragma once
+
+#include <d3dcommon.h>
+
+#include "ShaderIncludeCache.h"
+
+namespace SIE
+{
+	/**
+	 * Include handler for a single compile, backed by a ShaderIncludeCache.
+	 * Local includes are resolved against the including file's directory first and the entry file's directory second.
+	 */
+	class ShaderIncludeHandler : public ID3DInclude
+	{
+	public:
+		ShaderIncludeHandler(ShaderIncludeCache& a_cache, std::shared_ptr<const ShaderIncludeCache::File> a_entry);
+
+		HRESULT __stdcall Open(D3D_INCLUDE_TYPE a_type, LPCSTR a_fileName, LPCVOID a_parentData, LPCVOID* a_data, UINT* a_bytes) override;
+		HRESULT __stdcall Close(LPCVOID a_data) override;
+
+	private:
+		ShaderIncludeCache& cache;
+		std::filesystem::path rootDirectory;
+		std::vector<std::shared_ptr<const ShaderIncludeCache::File>> openFiles;  // kept alive until the compile ends
+	};
+}
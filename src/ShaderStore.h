@@ -0,0 +1,197 @@
+#pragma once
+
+#include <map>
+#include <unordered_set>
+
+namespace SIE
+{
+	struct ShaderBytecodeStats
+	{
+		uint32_t unique = 0;
+		uint32_t descriptors = 0;
+		size_t savedBytes = 0;  // bytecode not duplicated in memory or on disk
+	};
+
+	/**
+	 * Created shaders of one class per shader type and descriptor, with their estimated memory and the frame they were last used.
+	 * A descriptor whose bytecode matches a created shader is added as a clone sharing its D3D object.
+	 * Evicted descriptors are remembered so a lookup can tell a restore from a first load.
+	 * Shader is RE::BSGraphics::VertexShader or PixelShader and Owner the RE::BSShader in the plugin.
+	 * Not thread safe, ShaderCache guards each store with its shader mutex.
+	 */
+	template <class Shader, class Owner, size_t TypeCount>
+	class ShaderStore
+	{
+	public:
+		struct Entry
+		{
+			std::unique_ptr<Shader> shader;
+			const Owner* owner = nullptr;
+			uint64_t bytecodeHash = 0;
+			size_t bytes = 0;  // estimate of the shader object, bytecode copy and driver object
+			uint32_t lastUsedFrame = 0;
+		};
+
+		struct Candidate
+		{
+			uint32_t lastUsedFrame;
+			size_t type;
+			uint32_t descriptor;
+		};
+
+		/** @brief Returns the shader of a_descriptor and marks it used in a_frame, nullptr if not created. */
+		Shader* Find(size_t a_type, uint32_t a_descriptor, uint32_t a_frame)
+		{
+			auto& shaders = types[a_type].shaders;
+			auto it = shaders.find(a_descriptor);
+			if (it == shaders.end())
+				return nullptr;
+			it->second.lastUsedFrame = a_frame;
+			return it->second.shader.get();
+		}
+
+		bool WasEvicted(size_t a_type, uint32_t a_descriptor) const { return types[a_type].evicted.contains(a_descriptor); }
+
+		/** @brief Returns the created shader a new descriptor with bytecode a_hash can clone, nullptr if there is none. */
+		const Shader* FindShared(size_t a_type, uint64_t a_hash) const
+		{
+			const auto& type = types[a_type];
+			auto it = type.bytecode.find(a_hash);
+			if (it == type.bytecode.end())
+				return nullptr;
+			auto sourceIt = type.shaders.find(it->second.source);
+			return sourceIt != type.shaders.end() ? sourceIt->second.shader.get() : nullptr;
+		}
+
+		/**
+		 * @brief Stores a_shader for a_descriptor unless it was created by another thread first.
+		 * @param a_clone Whether a_shader shares the D3D object of FindShared(a_type, a_hash)
+		 * @return The stored shader, and false if it already existed. a_shader is then left for the caller to release.
+		 */
+		std::pair<Shader*, bool> Add(size_t a_type, uint32_t a_descriptor, std::unique_ptr<Shader>& a_shader, const Owner* a_owner,
+			uint64_t a_hash, size_t a_bytes, size_t a_bytecodeSize, bool a_clone, uint32_t a_frame)
+		{
+			auto& type = types[a_type];
+			auto [it, added] = type.shaders.try_emplace(a_descriptor);
+			if (!added) {
+				it->second.lastUsedFrame = a_frame;
+				return { it->second.shader.get(), false };
+			}
+			it->second = Entry{ std::move(a_shader), a_owner, a_hash, a_bytes, a_frame };
+			bytes += a_bytes;
+			if (type.evicted.erase(a_descriptor))
+				restores++;
+
+			if (a_clone) {
+				if (auto indexIt = type.bytecode.find(a_hash); indexIt != type.bytecode.end())
+					indexIt->second.clones.insert(a_descriptor);
+			} else {
+				type.bytecode.try_emplace(a_hash, BytecodeEntry{ a_descriptor, {}, a_bytecodeSize });
+			}
+			return { it->second.shader.get(), true };
+		}
+
+		/** @brief Appends the shaders unused for at least a_minAge frames, least recently used first. */
+		void CollectCandidates(uint32_t a_frame, uint32_t a_minAge, std::vector<Candidate>& a_candidates) const
+		{
+			const auto first = a_candidates.size();
+			for (size_t type = 0; type < TypeCount; type++) {
+				for (const auto& [descriptor, entry] : types[type].shaders) {
+					if (a_frame - entry.lastUsedFrame >= a_minAge)
+						a_candidates.push_back({ entry.lastUsedFrame, type, descriptor });
+				}
+			}
+			std::stable_sort(a_candidates.begin() + first, a_candidates.end(), [](const Candidate& a, const Candidate& b) { return a.lastUsedFrame < b.lastUsedFrame; });
+		}
+
+		/** @brief Removes a_descriptor and remembers it as evicted. The returned entry still holds the D3D object for the caller to release. */
+		Entry Evict(size_t a_type, uint32_t a_descriptor)
+		{
+			auto& type = types[a_type];
+			auto it = type.shaders.find(a_descriptor);
+			if (it == type.shaders.end())
+				return {};
+
+			if (auto indexIt = type.bytecode.find(it->second.bytecodeHash); indexIt != type.bytecode.end()) {
+				// Clones look the source up by descriptor, so an evicted source can no longer be shared.
+				// Clones of an earlier source are members of neither and leave the entry alone.
+				if (indexIt->second.source == a_descriptor)
+					type.bytecode.erase(indexIt);
+				else
+					indexIt->second.clones.erase(a_descriptor);
+			}
+
+			Entry entry = std::move(it->second);
+			type.shaders.erase(it);
+			type.evicted.insert(a_descriptor);
+			bytes -= entry.bytes;
+			evictions++;
+			return entry;
+		}
+
+		/** @brief Removes every shader of a_type, calling a_release on each, and forgets its evictions. */
+		template <class F>
+		void Clear(size_t a_type, F&& a_release)
+		{
+			auto& type = types[a_type];
+			for (auto& [descriptor, entry] : type.shaders) {
+				a_release(*entry.shader);
+				bytes -= entry.bytes;
+			}
+			type.shaders.clear();
+			type.bytecode.clear();
+			type.evicted.clear();
+		}
+
+		template <class F>
+		void Clear(F&& a_release)
+		{
+			for (size_t type = 0; type < TypeCount; type++)
+				Clear(type, a_release);
+		}
+
+		ShaderBytecodeStats GetBytecodeStats(size_t a_type) const
+		{
+			ShaderBytecodeStats stats;
+			for (const auto& [hash, entry] : types[a_type].bytecode) {
+				stats.unique++;
+				stats.descriptors += 1 + static_cast<uint32_t>(entry.clones.size());
+				stats.savedBytes += entry.clones.size() * entry.size;
+			}
+			return stats;
+		}
+
+		size_t GetCount() const
+		{
+			size_t count = 0;
+			for (const auto& type : types)
+				count += type.shaders.size();
+			return count;
+		}
+
+		inline size_t GetBytes() const { return bytes; }
+		inline uint64_t GetEvictions() const { return evictions; }
+		inline uint64_t GetRestores() const { return restores; }
+
+	private:
+		// Shaders created from identical bytecode share the D3D object and reflection of the source descriptor
+		struct BytecodeEntry
+		{
+			uint32_t source;
+			std::unordered_set<uint32_t> clones;  // only clones of this source, so each is counted once
+			size_t size;
+		};
+
+		struct TypeShaders
+		{
+			std::map<uint32_t, Entry> shaders;
+			std::unordered_map<uint64_t, BytecodeEntry> bytecode;
+			std::unordered_set<uint32_t> evicted;
+		};
+
+		std::array<TypeShaders, TypeCount> types;
+		std::atomic<size_t> bytes = 0;  // read without the lock to skip eviction while under budget
+		uint64_t evictions = 0;
+		uint64_t restores = 0;  // evicted shaders created again
+	};
+}
@@ -1,13 +1,95 @@
 #include "BSShaderHooks.h"
 
+#include "BS_thread_pool.hpp"
+#include "ShaderCache.h"
+
 namespace BSShaderHooks
 {
+	using TechniqueFileMap = std::unordered_map<REX::TechniqueID, std::wstring>;
+
+	struct ReplacementResult
+	{
+		REX::PixelShader* entry;
+		const std::wstring* path;
+		ID3DBlob* shaderBlob = nullptr;
+		bool cacheHit = false;
+		double milliseconds = 0.0;
+	};
+
+	/** Compiles every replacement for a_bsShader in parallel, then creates the shaders on the calling thread. */
+	static void ReplacePixelShaders(REX::BSShader* bsShader, const TechniqueFileMap& techniqueFileMap, std::size_t& successCount, std::size_t& failedCount)
+	{
+		auto& shaderCache = SIE::ShaderCache::Instance();
+		const bool useDiskCache = shaderCache.IsDiskCache();
+		const auto start = std::chrono::steady_clock::now();
+
+		std::vector<std::pair<REX::PixelShader*, const std::wstring*>> compileJobs;
+		for (const auto& entry : bsShader->m_PixelShaderTable) {
+			auto tFileIt = techniqueFileMap.find(entry->m_TechniqueID);
+			if (tFileIt == techniqueFileMap.end())
+				continue;
+
+			if (tFileIt->second.ends_with(L".hlsl")) {
+				compileJobs.emplace_back(entry, &tFileIt->second);
+			} else if (const auto shader = ShaderCompiler::RegisterPixelShader(tFileIt->second)) {
+				successCount++;
+				entry->m_Shader = shader;
+			} else {
+				failedCount++;
+			}
+		}
+
+		if (compileJobs.empty())
+			return;
+
+		// A dedicated pool, the shader cache pool keeps long-running tasks that could starve these jobs
+		BS::thread_pool pool(static_cast<BS::concurrency_t>(std::min(compileJobs.size(), static_cast<std::size_t>(shaderCache.compilationThreadCount))));
+		std::vector<std::future<ReplacementResult>> results;
+		results.reserve(compileJobs.size());
+		for (const auto& [entry, path] : compileJobs) {
+			results.push_back(pool.submit([entry, path, useDiskCache]() {
+				ReplacementResult result{ entry, path };
+				const auto taskStart = std::chrono::steady_clock::now();
+				result.shaderBlob = ShaderCompiler::CompilePixelShader(*path, useDiskCache, &result.cacheHit);
+				result.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - taskStart).count();
+				return result;
+			}));
+		}
+
+		std::size_t cacheHits = 0;
+		for (auto& future : results) {
+			auto result = future.get();
+			const auto pathStr = std::filesystem::path(*result.path).generic_string();
+			if (!result.shaderBlob) {
+				logger::info("{} failed to compile in {:.1f} ms", pathStr, result.milliseconds);
+				failedCount++;
+				continue;
+			}
+
+			logger::info("{} {} in {:.1f} ms", pathStr, result.cacheHit ? "loaded from disk cache" : "compiled", result.milliseconds);
+			cacheHits += result.cacheHit;
+			if (const auto shader = ShaderCompiler::RegisterPixelShader(result.shaderBlob)) {
+				logger::info("shader compiled successfully, replacing old shader");
+				successCount++;
+				result.entry->m_Shader = shader;
+			} else {
+				failedCount++;
+			}
+			result.shaderBlob->Release();
+		}
+
+		logger::info("{} replacement shaders for {} ready in {:.1f} ms ({} from disk cache, {} threads)",
+			compileJobs.size(), bsShader->m_LoaderType,
+			std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(),
+			cacheHits, pool.get_thread_count());
+	}
+
 	void hk_LoadShaders(REX::BSShader* bsShader, std::uintptr_t)
 	{
 		logger::info("BSShader::LoadShaders called on {} - ps count {}", bsShader->m_LoaderType, bsShader->m_PixelShaderTable.size());
 
 		if (strcmp("Lighting", bsShader->m_LoaderType) == 0) {
-			std::unordered_map<REX::TechniqueID, std::wstring> techniqueFileMap;
+			TechniqueFileMap techniqueFileMap;
 
 			const auto shaderDir = std::filesystem::current_path() /= "Data/SKSE/plugins/shaders/"sv;
 
@@ -28,22 +110,11 @@ namespace BSShaderHooks
 					techniqueFileMap.insert(std::make_pair(techniqueId, absolute(entry.path()).wstring()));
 				}
 
-				for (const auto& entry : bsShader->m_PixelShaderTable) {
-					auto tFileIt = techniqueFileMap.find(entry->m_TechniqueID);
-					if (tFileIt != techniqueFileMap.end()) {
-						if (const auto shader = ShaderCompiler::CompileAndRegisterPixelShader(tFileIt->second)) {
-							logger::info("shader compiled successfully, replacing old shader");
-							successCount++;
-							entry->m_Shader = shader;
-						} else {
-							failedCount++;
-						}
-					}
-				}
+				ReplacePixelShaders(bsShader, techniqueFileMap, successCount, failedCount);
 			}
 		}
 
-		std::unordered_map<REX::TechniqueID, std::wstring> techniqueFileMap;
+		TechniqueFileMap techniqueFileMap;
 
 		const auto shaderDir = std::filesystem::current_path() /= std::format("Data\\Shaders\\{}\\"sv, bsShader->m_LoaderType);
 		if (std::filesystem::exists(shaderDir)) {
@@ -77,21 +148,9 @@ namespace BSShaderHooks
 				techniqueFileMap.insert(std::make_pair(techniqueId, absolute(entry.path()).wstring()));
 			}
 
-			for (const auto& entry : bsShader->m_PixelShaderTable) {
-				auto tFileIt = techniqueFileMap.find(entry->m_TechniqueID);
-				if (tFileIt != techniqueFileMap.end()) {
-					bool compile = tFileIt->second.ends_with(L".hlsl");
-					if (const auto shader = compile ? ShaderCompiler::CompileAndRegisterPixelShader(tFileIt->second) : ShaderCompiler::RegisterPixelShader(tFileIt->second)) {
-						logger::info("shader compiled successfully, replacing old shader");
-						successCount++;
-						entry->m_Shader = shader;
-					} else {
-						failedCount++;
-					}
-				}
-			}
+			ReplacePixelShaders(bsShader, techniqueFileMap, successCount, failedCount);
 
 			logger::info("found shaders: {} successfully replaced: {} failed to replace: {}", foundCount, successCount, failedCount);
 		}
 	}
-}
\ No newline at end of file
+}
@@ -1,13 +1,17 @@
+#include "ShaderCompiler.h"
+
 #include "d3d11.h"
 #include "d3dcompiler.h"
 #include "util.h"
 
+#include "ShaderCache.h"
+#include "ShaderIncludeHandler.h"
+#include "State.h"
+
 namespace ShaderCompiler
 {
 	ID3D11PixelShader* RegisterPixelShader(const std::wstring a_filePath)
 	{
-		REL::Relocation<ID3D11Device**> g_ID3D11Device{ RELOCATION_ID(524729, 411348) };
-
 		ID3DBlob* shaderBlob = nullptr;
 
 		if (FAILED(D3DReadFileToBlob(a_filePath.c_str(), &shaderBlob))) {
@@ -21,16 +25,21 @@ namespace ShaderCompiler
 
 		logger::debug("shader load succeeded");
 
+		auto regShader = RegisterPixelShader(shaderBlob);
+		shaderBlob->Release();
+		return regShader;
+	}
+
+	ID3D11PixelShader* RegisterPixelShader(ID3DBlob* a_shaderBlob)
+	{
+		REL::Relocation<ID3D11Device**> g_ID3D11Device{ RELOCATION_ID(524729, 411348) };
+
 		logger::debug("registering shader");
 
 		ID3D11PixelShader* regShader;
 
-		if (FAILED((*g_ID3D11Device)->CreatePixelShader(shaderBlob->GetBufferPointer(), shaderBlob->GetBufferSize(), nullptr, &regShader))) {
+		if (FAILED((*g_ID3D11Device)->CreatePixelShader(a_shaderBlob->GetBufferPointer(), a_shaderBlob->GetBufferSize(), nullptr, &regShader))) {
 			logger::error("pixel shader registration failed");
-
-			if (shaderBlob)
-				shaderBlob->Release();
-
 			return nullptr;
 		}
 
@@ -43,4 +52,60 @@ namespace ShaderCompiler
 	{
 		return static_cast<ID3D11PixelShader*>(Util::CompileShader(a_filePath.data(), {}, "ps_5_0"));
 	}
-}
\ No newline at end of file
+
+	/**
+	 * Hashes the preprocessed source, which holds the contents of every resolved include, together with
+	 * every setting that changes the compiled bytecode. Includes are read through the shader include cache.
+	 */
+	static std::optional<uint64_t> GetSourceHash(const std::wstring& a_filePath)
+	{
+		auto& cache = SIE::ShaderCache::Instance().includeCache;
+		auto source = cache.Load(a_filePath);
+		if (!source)
+			return std::nullopt;
+
+		auto macros = Util::GetShaderMacros({}, "ps_5_0");
+		const auto sourceName = std::filesystem::path(a_filePath).string();
+		SIE::ShaderIncludeHandler includeHandler(cache, source);
+		winrt::com_ptr<ID3DBlob> preprocessed;
+		winrt::com_ptr<ID3DBlob> errors;
+		if (FAILED(D3DPreprocess(source->data.data(), source->data.size(), sourceName.c_str(), macros.data(), &includeHandler, preprocessed.put(), errors.put())))
+			return std::nullopt;
+
+		std::string key(static_cast<const char*>(preprocessed->GetBufferPointer()), preprocessed->GetBufferSize());
+		auto state = State::GetSingleton();
+		key += std::format("|{}|{}|{}", SHADER_CACHE_VERSION.string(), REL::Module::IsVR(), state->IsDeveloperMode());
+
+		return ankerl::unordered_dense::detail::wyhash::hash(key.data(), key.size());
+	}
+
+	ID3DBlob* CompilePixelShader(const std::wstring& a_filePath, bool a_useDiskCache, bool* a_cacheHit)
+	{
+		if (a_cacheHit)
+			*a_cacheHit = false;
+
+		std::wstring diskPath;
+		if (a_useDiskCache) {
+			if (auto hash = GetSourceHash(a_filePath)) {
+				diskPath = std::format(L"Data/ShaderCache/Replacement/{:016X}.pso", *hash);
+				ID3DBlob* shaderBlob = nullptr;
+				if (std::filesystem::exists(diskPath) && SUCCEEDED(D3DReadFileToBlob(diskPath.c_str(), &shaderBlob))) {
+					if (a_cacheHit)
+						*a_cacheHit = true;
+					return shaderBlob;
+				}
+				if (shaderBlob)
+					shaderBlob->Release();
+			}
+		}
+
+		ID3DBlob* shaderBlob = Util::CompileShaderBlob(a_filePath.c_str(), {}, "ps_5_0");
+		if (shaderBlob && !diskPath.empty()) {
+			std::error_code ec;
+			std::filesystem::create_directories(L"Data/ShaderCache/Replacement", ec);
+			if (FAILED(D3DWriteBlobToFile(shaderBlob, diskPath.c_str(), true)))
+				logger::error("Failed to save replacement shader to {}", std::filesystem::path(diskPath).generic_string());
+		}
+		return shaderBlob;
+	}
+}
@@ -5,5 +5,14 @@
 namespace ShaderCompiler
 {
 	ID3D11PixelShader* RegisterPixelShader(const std::wstring a_filePath);
+	ID3D11PixelShader* RegisterPixelShader(ID3DBlob* a_shaderBlob);
 	ID3D11PixelShader* CompileAndRegisterPixelShader(const std::wstring a_filePath);
+
+	/** @brief Compiles a pixel shader to bytecode without touching the device, so it is safe to call from worker threads.
+	@param  a_filePath Path to the .hlsl source.
+	@param  a_useDiskCache Whether to reuse and store bytecode in Data/ShaderCache/Replacement, keyed by a hash of the source and compile settings.
+	@param  a_cacheHit Optional, set to true when the bytecode was loaded from the disk cache.
+	@return The bytecode, or nullptr if compilation failed. The caller owns the reference.
+	*/
+	ID3DBlob* CompilePixelShader(const std::wstring& a_filePath, bool a_useDiskCache, bool* a_cacheHit = nullptr);
 }
@@ -35,10 +35,15 @@ void State::Draw()
 				}
 
 				if (vertexShader && pixelShader) {
-					for (auto* feature : Feature::GetFeatureList()) {
-						if (feature->loaded) {
+					if (profileFeatures) {
+						for (auto* feature : drawFeatures[type]) {
+							const auto start = std::chrono::steady_clock::now();
 							feature->Draw(currentShader, currentPixelDescriptor);
+							feature->drawTime += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
 						}
+					} else {
+						for (auto* feature : drawFeatures[type])
+							feature->Draw(currentShader, currentPixelDescriptor);
 					}
 				}
 			}
@@ -166,10 +171,62 @@ void State::Reset()
 		if (feature->loaded)
 			feature->Reset();
 	Bindings::GetSingleton()->Reset();
+	SIE::ShaderCache::Instance().EvictUnusedShaders();
+	binds.EndFrame();
+	frameContext.Invalidate();
 	if (!RE::UI::GetSingleton()->GameIsPaused())
 		timer += RE::GetSecondsSinceLastFrame();
 }
 
+static_assert(BindState<ID3D11DeviceContext>::ShaderResourceSlotCount == D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT);
+static_assert(BindState<ID3D11DeviceContext>::ConstantBufferSlotCount == D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT);
+
+void State::SetPSShaderResources(uint a_slot, uint a_count, ID3D11ShaderResourceView* const* a_views)
+{
+	binds.SetPSShaderResources(*RE::BSGraphics::Renderer::GetSingleton()->GetRuntimeData().context, a_slot, a_count, a_views);
+}
+
+void State::SetVSConstantBuffers(uint a_slot, uint a_count, ID3D11Buffer* const* a_buffers)
+{
+	binds.SetVSConstantBuffers(*RE::BSGraphics::Renderer::GetSingleton()->GetRuntimeData().context, a_slot, a_count, a_buffers);
+}
+
+void State::SetPSConstantBuffers(uint a_slot, uint a_count, ID3D11Buffer* const* a_buffers)
+{
+	binds.SetPSConstantBuffers(*RE::BSGraphics::Renderer::GetSingleton()->GetRuntimeData().context, a_slot, a_count, a_buffers);
+}
+
+const State::FrameContext& State::GetFrameContext()
+{
+	return frameContext.Get([](FrameContext& a_context) {
+		a_context.isVR = REL::Module::IsVR();
+
+		auto imageSpaceManager = RE::ImageSpaceManager::GetSingleton();
+		a_context.sunlightScale = !a_context.isVR ?
+		                              imageSpaceManager->GetRuntimeData().data.baseData.hdr.sunlightScale :
+		                              imageSpaceManager->GetVRRuntimeData().data.baseData.hdr.sunlightScale;
+
+		Util::StoreTransform3x4NoScale(a_context.directionalAmbient, RE::BSShaderManager::State::GetSingleton().directionalAmbientTransform);
+
+		a_context.sky = RE::Sky::GetSingleton();
+
+		auto player = RE::PlayerCharacter::GetSingleton();
+		a_context.worldSpace = player ? player->GetWorldspace() : nullptr;
+	});
+}
+
+void State::InvalidateBinds()
+{
+	binds.Invalidate();
+}
+
+void State::UpdateDrawFeatures()
+{
+	drawFeatures.Build(Feature::GetFeatureList(), [](Feature* a_feature, size_t a_type) {
+		return a_feature->loaded && a_feature->HasDraw((RE::BSShader::Type)a_type);
+	});
+}
+
 void State::Setup()
 {
 	SetupResources();
@@ -224,6 +281,12 @@ void State::Load(bool a_test)
 			shaderCache.backgroundCompilationThreadCount = std::clamp(advanced["Background Compiler Threads"].get<int32_t>(), 1, static_cast<int32_t>(std::thread::hardware_concurrency()));
 		if (advanced["Use FileWatcher"].is_boolean())
 			shaderCache.SetFileWatcher(advanced["Use FileWatcher"]);
+		if (advanced["Shader Memory Budget"].is_number_unsigned())
+			shaderCache.memoryBudget = advanced["Shader Memory Budget"];
+		if (advanced["Shader Eviction Frames"].is_number_unsigned())
+			shaderCache.evictionFrames = std::max(advanced["Shader Eviction Frames"].get<uint32_t>(), 60u);
+		if (advanced["Shader Include Cache"].is_boolean())
+			shaderCache.useIncludeCache = advanced["Shader Include Cache"];
 	}
 
 	if (settings["General"].is_object()) {
@@ -251,6 +314,7 @@ void State::Load(bool a_test)
 
 	for (auto* feature : Feature::GetFeatureList())
 		feature->Load(settings);
+	UpdateDrawFeatures();
 	i.close();
 	if (settings["Version"].is_string() && settings["Version"].get<std::string>() != Plugin::VERSION.string()) {
 		logger::info("Found older config for version {}; upgrading to {}", (std::string)settings["Version"], Plugin::VERSION.string());
@@ -273,6 +337,9 @@ void State::Save(bool a_test)
 	advanced["Compiler Threads"] = shaderCache.compilationThreadCount;
 	advanced["Background Compiler Threads"] = shaderCache.backgroundCompilationThreadCount;
 	advanced["Use FileWatcher"] = shaderCache.UseFileWatcher();
+	advanced["Shader Memory Budget"] = shaderCache.memoryBudget;
+	advanced["Shader Eviction Frames"] = shaderCache.evictionFrames;
+	advanced["Shader Include Cache"] = shaderCache.useIncludeCache;
 	settings["Advanced"] = advanced;
 
 	json general;
@@ -325,6 +392,8 @@ void State::SetLogLevel(spdlog::level::level_enum a_level)
 	logLevel = a_level;
 	spdlog::set_level(logLevel);
 	spdlog::flush_on(logLevel);
+	// Developer mode changes the feature list in VR
+	UpdateDrawFeatures();
 	logger::info("Log Level set to {} ({})", magic_enum::enum_name(logLevel), static_cast<int>(logLevel));
 }
 
@@ -444,78 +513,10 @@ void State::ModifyShaderLookup(const RE::BSShader& a_shader, uint& a_vertexDescr
 			lastPixelDescriptor = a_pixelDescriptor;
 		}
 
-		switch (a_shader.shaderType.get()) {
-		case RE::BSShader::Type::Lighting:
-			{
-				a_vertexDescriptor &= ~((uint32_t)SIE::ShaderCache::LightingShaderFlags::AdditionalAlphaMask |
-										(uint32_t)SIE::ShaderCache::LightingShaderFlags::AmbientSpecular |
-										(uint32_t)SIE::ShaderCache::LightingShaderFlags::DoAlphaTest |
-										(uint32_t)SIE::ShaderCache::LightingShaderFlags::ShadowDir |
-										(uint32_t)SIE::ShaderCache::LightingShaderFlags::DefShadow |
-										(uint32_t)SIE::ShaderCache::LightingShaderFlags::CharacterLight |
-										(uint32_t)SIE::ShaderCache::LightingShaderFlags::RimLighting |
-										(uint32_t)SIE::ShaderCache::LightingShaderFlags::SoftLighting |
-										(uint32_t)SIE::ShaderCache::LightingShaderFlags::BackLighting |
-										(uint32_t)SIE::ShaderCache::LightingShaderFlags::Specular |
-										(uint32_t)SIE::ShaderCache::LightingShaderFlags::AnisoLighting |
-										(uint32_t)SIE::ShaderCache::LightingShaderFlags::BaseObjectIsSnow |
-										(uint32_t)SIE::ShaderCache::LightingShaderFlags::Snow);
-
-				a_pixelDescriptor &= ~((uint32_t)SIE::ShaderCache::LightingShaderFlags::AmbientSpecular |
-									   (uint32_t)SIE::ShaderCache::LightingShaderFlags::ShadowDir |
-									   (uint32_t)SIE::ShaderCache::LightingShaderFlags::DefShadow |
-									   (uint32_t)SIE::ShaderCache::LightingShaderFlags::CharacterLight);
-
-				static auto enableImprovedSnow = RE::GetINISetting("bEnableImprovedSnow:Display");
-				static bool vr = REL::Module::IsVR();
-
-				if (vr || !enableImprovedSnow->GetBool())
-					a_pixelDescriptor &= ~((uint32_t)SIE::ShaderCache::LightingShaderFlags::Snow);
-
-				{
-					uint32_t technique = 0x3F & (a_vertexDescriptor >> 24);
-					if (technique == (uint32_t)SIE::ShaderCache::LightingShaderTechniques::Glowmap ||
-						technique == (uint32_t)SIE::ShaderCache::LightingShaderTechniques::Parallax ||
-						technique == (uint32_t)SIE::ShaderCache::LightingShaderTechniques::Facegen ||
-						technique == (uint32_t)SIE::ShaderCache::LightingShaderTechniques::FacegenRGBTint ||
-						technique == (uint32_t)SIE::ShaderCache::LightingShaderTechniques::LODObjects ||
-						technique == (uint32_t)SIE::ShaderCache::LightingShaderTechniques::LODObjectHD ||
-						technique == (uint32_t)SIE::ShaderCache::LightingShaderTechniques::MultiIndexSparkle ||
-						technique == (uint32_t)SIE::ShaderCache::LightingShaderTechniques::Hair)
-						a_vertexDescriptor &= ~(0x3F << 24);
-				}
+		static auto enableImprovedSnow = RE::GetINISetting("bEnableImprovedSnow:Display");
+		static bool vr = REL::Module::IsVR();
 
-				{
-					uint32_t technique = 0x3F & (a_pixelDescriptor >> 24);
-					if (technique == (uint32_t)SIE::ShaderCache::LightingShaderTechniques::Glowmap)
-						a_pixelDescriptor &= ~(0x3F << 24);
-				}
-			}
-			break;
-		case RE::BSShader::Type::Water:
-			{
-				a_vertexDescriptor &= ~((uint32_t)SIE::ShaderCache::WaterShaderFlags::Reflections |
-										(uint32_t)SIE::ShaderCache::WaterShaderFlags::Cubemap |
-										(uint32_t)SIE::ShaderCache::WaterShaderFlags::Interior |
-										(uint32_t)SIE::ShaderCache::WaterShaderFlags::Reflections);
-
-				a_pixelDescriptor &= ~((uint32_t)SIE::ShaderCache::WaterShaderFlags::Reflections |
-									   (uint32_t)SIE::ShaderCache::WaterShaderFlags::Cubemap |
-									   (uint32_t)SIE::ShaderCache::WaterShaderFlags::Interior);
-			}
-			break;
-		case RE::BSShader::Type::Effect:
-			{
-				a_vertexDescriptor &= ~((uint32_t)SIE::ShaderCache::EffectShaderFlags::GrayscaleToColor |
-										(uint32_t)SIE::ShaderCache::EffectShaderFlags::GrayscaleToAlpha |
-										(uint32_t)SIE::ShaderCache::EffectShaderFlags::IgnoreTexAlpha);
-
-				a_pixelDescriptor &= ~((uint32_t)SIE::ShaderCache::EffectShaderFlags::GrayscaleToColor |
-									   (uint32_t)SIE::ShaderCache::EffectShaderFlags::GrayscaleToAlpha |
-									   (uint32_t)SIE::ShaderCache::EffectShaderFlags::IgnoreTexAlpha);
-			}
-			break;
-		}
+		SIE::RemapShaderDescriptors(a_shader.shaderType.get(), !vr && enableImprovedSnow->GetBool(), a_vertexDescriptor, a_pixelDescriptor);
 
 		ID3D11ShaderResourceView* view = shaderDataBuffer->srv.get();
 		context->PSSetShaderResources(127, 1, &view);
@@ -1,9 +1,14 @@
 #pragma once
 
+#include <BindState.h>
 #include <Buffer.h>
+#include <DrawDispatch.h>
+#include <FrameCache.h>
 #include <nlohmann/json.hpp>
 using json = nlohmann::json;
 
+struct Feature;
+
 class State
 {
 public:
@@ -18,6 +23,9 @@ public:
 	bool updateShader = true;
 	RE::BSShader* currentShader = nullptr;
 
+	// Loaded features whose Draw handles each shader type, in load order
+	DrawDispatch<Feature, RE::BSShader::Type::Total> drawFeatures;
+
 	uint32_t currentVertexDescriptor = 0;
 	uint32_t currentPixelDescriptor = 0;
 	spdlog::level::level_enum logLevel = spdlog::level::info;
@@ -28,6 +36,7 @@ public:
 	const std::string defaultConfigPath = "Data\\SKSE\\Plugins\\CommunityShaders.json";
 
 	bool upscalerLoaded = false;
+	bool profileFeatures = false;  // accumulate Feature::drawTime, used by the test mode benchmark
 
 	float timer = 0;
 
@@ -36,6 +45,7 @@ public:
 	void DrawPreProcess();
 	void Reset();
 	void Setup();
+	void UpdateDrawFeatures();
 
 	void Load(bool a_test = false);
 	void Save(bool a_test = false);
@@ -94,6 +104,21 @@ public:
 
 	std::unique_ptr<Buffer> shaderDataBuffer = nullptr;
 
+	/*
+	 * Shadow copy of the binds features issue every draw, so binds that are already current are skipped.
+	 *
+	 * <p>
+	 * Only for slots the engine never writes. Anything else that binds those slots must call InvalidateBinds.
+	 * The shadow is also dropped every frame in Reset.
+	 * </p>
+	 */
+	void SetPSShaderResources(uint a_slot, uint a_count, ID3D11ShaderResourceView* const* a_views);
+	void SetVSConstantBuffers(uint a_slot, uint a_count, ID3D11Buffer* const* a_buffers);
+	void SetPSConstantBuffers(uint a_slot, uint a_count, ID3D11Buffer* const* a_buffers);
+	void InvalidateBinds();
+
+	BindState<ID3D11DeviceContext> binds;
+
 	void UpdateSharedData(const RE::BSShader* shader, const uint32_t descriptor);
 
 	bool lightingDataRequiresUpdate = false;
@@ -113,4 +138,24 @@ public:
 
 	float screenWidth = 0;
 	float screenHeight = 0;
+
+	// Engine values that do not change within a frame, shared by the features' per-draw paths
+	struct FrameContext
+	{
+		bool isVR = false;
+		float sunlightScale = 1.0f;
+		DirectX::XMFLOAT3X4 directionalAmbient{};  // without scale, as features upload it
+		RE::Sky* sky = nullptr;
+		RE::TESWorldSpace* worldSpace = nullptr;
+	};
+
+	/*
+	 * Snapshot of FrameContext, captured on the first call of each frame.
+	 *
+	 * @return The values for the frame being rendered.
+	 */
+	const FrameContext& GetFrameContext();
+
+private:
+	Util::FrameCache<FrameContext> frameContext;
 };
@@ -109,10 +109,8 @@ namespace Util
 		Resource->SetPrivateData(WKPDID_D3DDebugObjectNameT, len, buffer);
 	}
 
-	ID3D11DeviceChild* CompileShader(const wchar_t* FilePath, const std::vector<std::pair<const char*, const char*>>& Defines, const char* ProgramType, const char* Program)
+	std::vector<D3D_SHADER_MACRO> GetShaderMacros(const std::vector<std::pair<const char*, const char*>>& Defines, const char* ProgramType)
 	{
-		auto device = RE::BSGraphics::Renderer::GetSingleton()->GetRuntimeData().forwarder;
-
 		// Build defines (aka convert vector->D3DCONSTANT array)
 		std::vector<D3D_SHADER_MACRO> macros;
 
@@ -145,13 +143,22 @@ namespace Util
 		else if (!_stricmp(ProgramType, "cs_5_1"))
 			macros.push_back({ "COMPUTESHADER", "" });
 		else
-			return nullptr;
+			return {};
 
 		// Add null terminating entry
 		macros.push_back({ "WINPC", "" });
 		macros.push_back({ "DX11", "" });
 		macros.push_back({ nullptr, nullptr });
 
+		return macros;
+	}
+
+	ID3DBlob* CompileShaderBlob(const wchar_t* FilePath, const std::vector<std::pair<const char*, const char*>>& Defines, const char* ProgramType, const char* Program)
+	{
+		auto macros = GetShaderMacros(Defines, ProgramType);
+		if (macros.empty())
+			return nullptr;
+
 		// Compiler setup
 		uint32_t flags = !State::GetSingleton()->IsDeveloperMode() ? (D3DCOMPILE_ENABLE_STRICTNESS | D3DCOMPILE_OPTIMIZATION_LEVEL3) : D3DCOMPILE_DEBUG;
 
@@ -169,6 +176,17 @@ namespace Util
 			return nullptr;
 		}
 
+		return shaderBlob;
+	}
+
+	ID3D11DeviceChild* CompileShader(const wchar_t* FilePath, const std::vector<std::pair<const char*, const char*>>& Defines, const char* ProgramType, const char* Program)
+	{
+		auto device = RE::BSGraphics::Renderer::GetSingleton()->GetRuntimeData().forwarder;
+
+		ID3DBlob* shaderBlob = CompileShaderBlob(FilePath, Defines, ProgramType, Program);
+		if (!shaderBlob)
+			return nullptr;
+
 		if (!_stricmp(ProgramType, "ps_5_0")) {
 			ID3D11PixelShader* regShader;
 			device->CreatePixelShader(shaderBlob->GetBufferPointer(), shaderBlob->GetBufferSize(), nullptr, &regShader);
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "SPSCQueue.h"
+
 /**
  @def GET_INSTANCE_MEMBER
  @brief Set variable in current namespace based on instance member from GetRuntimeData or GetVRRuntimeData.
@@ -21,6 +23,12 @@ namespace Util
 	std::string GetNameFromSRV(ID3D11ShaderResourceView* a_srv);
 	std::string GetNameFromRTV(ID3D11RenderTargetView* a_rtv);
 	void SetResourceName(ID3D11DeviceChild* Resource, const char* Format, ...);
+	/**
+	 * @brief Builds the macros CompileShaderBlob compiles with, null terminated.
+	 * @return An empty vector if ProgramType is not supported
+	 */
+	std::vector<D3D_SHADER_MACRO> GetShaderMacros(const std::vector<std::pair<const char*, const char*>>& Defines, const char* ProgramType);
+	ID3DBlob* CompileShaderBlob(const wchar_t* FilePath, const std::vector<std::pair<const char*, const char*>>& Defines, const char* ProgramType, const char* Program = "main");
 	ID3D11DeviceChild* CompileShader(const wchar_t* FilePath, const std::vector<std::pair<const char*, const char*>>& Defines, const char* ProgramType, const char* Program = "main");
 	std::string DefinesToString(std::vector<std::pair<const char*, const char*>>& defines);
 	std::string DefinesToString(std::vector<D3D_SHADER_MACRO>& defines);
@@ -117,9 +117,7 @@ void MessageHandler(SKSE::MessagingInterface::Message* message)
 			if (errors.empty()) {
 				auto& shaderCache = SIE::ShaderCache::Instance();
 				shaderCache.menuLoaded = true;
-				while (shaderCache.IsCompiling() && !shaderCache.backgroundCompilation) {
-					std::this_thread::sleep_for(100ms);
-				}
+				shaderCache.WaitForCompilation();
 
 				if (shaderCache.IsDiskCache()) {
 					shaderCache.WriteDiskCacheInfo();
@@ -0,0 +1,138 @@
+#include "Catch.h"
+
+#include "BenchmarkStats.h"
+
+#include <random>
+
+namespace
+{
+	std::vector<double> Sequence(std::size_t a_count)
+	{
+		std::vector<double> samples(a_count);
+		std::iota(samples.begin(), samples.end(), 1.0);
+		return samples;
+	}
+
+	bool Contains(const BenchmarkStats::Estimate& a_estimate, double a_value)
+	{
+		return a_estimate.low <= a_value && a_value <= a_estimate.high;
+	}
+}
+
+TEST_CASE("BenchmarkStats of no samples is empty", "[BenchmarkStats]")
+{
+	const auto summary = BenchmarkStats::Summarize({});
+	CHECK(summary.count == 0);
+	CHECK(summary.mean.value == 0.0);
+	CHECK(summary.median.value == 0.0);
+	CHECK(summary.p99.high == 0.0);
+
+	const auto percentile = BenchmarkStats::Percentile({}, 0.5);
+	CHECK(percentile.value == 0.0);
+
+	const auto comparison = BenchmarkStats::Compare(summary, BenchmarkStats::Summarize(Sequence(10)));
+	CHECK(comparison.mean.value == 0.0);
+	CHECK(comparison.p95.low == 0.0);
+}
+
+TEST_CASE("BenchmarkStats of a single sample", "[BenchmarkStats]")
+{
+	const double samples[] = { 16.6 };
+	const auto summary = BenchmarkStats::Summarize(samples);
+	CHECK(summary.count == 1);
+	CHECK(summary.standardDeviation == 0.0);
+	for (const auto* estimate : { &summary.mean, &summary.median, &summary.p95, &summary.p99 }) {
+		CHECK(estimate->value == 16.6);
+		CHECK(estimate->low == 16.6);
+		CHECK(estimate->high == 16.6);
+	}
+}
+
+TEST_CASE("BenchmarkStats mean and standard deviation of known samples", "[BenchmarkStats]")
+{
+	const double samples[] = { 5.0, 1.0, 4.0, 2.0, 3.0 };
+	const auto summary = BenchmarkStats::Summarize(samples);
+	const double margin = 1.96 * std::sqrt(2.5) / std::sqrt(5.0);
+	CHECK(summary.count == 5);
+	CHECK(summary.mean.value == Catch::Approx(3.0));
+	CHECK(summary.standardDeviation == Catch::Approx(std::sqrt(2.5)));
+	CHECK(summary.mean.low == Catch::Approx(3.0 - margin));
+	CHECK(summary.mean.high == Catch::Approx(3.0 + margin));
+	CHECK(summary.median.value == Catch::Approx(3.0));
+}
+
+TEST_CASE("BenchmarkStats percentile rank convention", "[BenchmarkStats]")
+{
+	const auto samples = Sequence(100);
+
+	// Values interpolate between 0-based positions p * (count - 1)
+	const auto median = BenchmarkStats::Percentile(samples, 0.5);
+	CHECK(median.value == Catch::Approx(50.5));
+	// Ranks 40 and 61 lie symmetrically around the 1-based median rank of 50.5
+	CHECK(median.low == 40.0);
+	CHECK(median.high == 61.0);
+
+	// 1-based ranks floor(95 - 4.27) = 90 and ceil(95 + 4.27) + 1 = 101, clamped to 100
+	const auto p95 = BenchmarkStats::Percentile(samples, 0.95);
+	CHECK(p95.value == Catch::Approx(95.05));
+	CHECK(p95.low == 90.0);
+	CHECK(p95.high == 100.0);
+
+	const auto minimum = BenchmarkStats::Percentile(samples, 0.0);
+	CHECK(minimum.value == 1.0);
+	CHECK(minimum.low == 1.0);
+	const auto maximum = BenchmarkStats::Percentile(samples, 1.0);
+	CHECK(maximum.value == 100.0);
+	CHECK(maximum.high == 100.0);
+}
+
+TEST_CASE("BenchmarkStats intervals contain their estimates", "[BenchmarkStats]")
+{
+	std::mt19937 random(7);
+	std::exponential_distribution<double> distribution(1.0 / 16.0);
+	for (std::size_t count : { 2, 3, 10, 57, 1000 }) {
+		std::vector<double> samples(count);
+		for (auto& sample : samples)
+			sample = distribution(random);
+
+		const auto summary = BenchmarkStats::Summarize(samples);
+		INFO("count " << count);
+		for (const auto* estimate : { &summary.mean, &summary.median, &summary.p95, &summary.p99 })
+			CHECK(Contains(*estimate, estimate->value));
+		CHECK(summary.median.value <= summary.p95.value);
+		CHECK(summary.p95.value <= summary.p99.value);
+
+		const auto comparison = BenchmarkStats::Compare(summary, summary);
+		for (const auto* estimate : { &comparison.mean, &comparison.median, &comparison.p95, &comparison.p99 }) {
+			CHECK(estimate->value == 0.0);
+			CHECK(Contains(*estimate, 0.0));
+		}
+	}
+}
+
+TEST_CASE("BenchmarkStats intervals cover the true value", "[BenchmarkStats]")
+{
+	// Uniform samples on [0, 1): the true mean and median are 0.5, P95 is 0.95
+	// Order statistic intervals are discrete and slightly conservative
+	constexpr uint trials = 1000;
+	std::mt19937 random(11);
+	std::uniform_real_distribution<double> distribution;
+	uint meanCovered = 0, medianCovered = 0, p95Covered = 0;
+	std::vector<double> samples(200);
+	for (uint trial = 0; trial < trials; trial++) {
+		for (auto& sample : samples)
+			sample = distribution(random);
+		const auto summary = BenchmarkStats::Summarize(samples);
+		meanCovered += Contains(summary.mean, 0.5);
+		medianCovered += Contains(summary.median, 0.5);
+		p95Covered += Contains(summary.p95, 0.95);
+	}
+
+	INFO("mean " << meanCovered << ", median " << medianCovered << ", p95 " << p95Covered);
+	CHECK(meanCovered > trials * 0.92);
+	CHECK(meanCovered < trials * 0.98);
+	CHECK(medianCovered > trials * 0.92);
+	CHECK(medianCovered < trials * 0.995);
+	CHECK(p95Covered > trials * 0.92);
+	CHECK(p95Covered < trials * 0.995);
+}
@@ -0,0 +1,154 @@
+#include "Catch.h"
+
+#include "BindState.h"
+#include "RecordingBindContext.h"
+
+namespace
+{
+	char resources[64];
+
+	ID3D11Buffer* FakeBuffer(int a_index) { return reinterpret_cast<ID3D11Buffer*>(resources + a_index); }
+	ID3D11ShaderResourceView* FakeView(int a_index) { return reinterpret_cast<ID3D11ShaderResourceView*>(resources + 32 + a_index); }
+
+	// Binds GrassLighting and WaterBlending issue for one draw, the per-geometry buffer changes every ten draws
+	template <class Bind>
+	void DrawSequence(uint32_t a_first, uint32_t a_count, Bind&& a_bind)
+	{
+		for (uint32_t draw = a_first; draw < a_first + a_count; draw++) {
+			ID3D11Buffer* buffers[2] = { FakeBuffer(0), FakeBuffer(1 + (draw / 10) % 8) };
+			a_bind.VS(3, 1, &buffers[1]);
+			a_bind.PS(3, 2, buffers);
+			ID3D11ShaderResourceView* views[1] = { FakeView(draw % 2) };
+			a_bind.SRV(33, 1, views);
+		}
+	}
+
+	struct Filtered
+	{
+		BindState<RecordingBindContext>& binds;
+		RecordingBindContext& context;
+		void VS(uint32_t a_slot, uint32_t a_count, ID3D11Buffer* const* a_buffers) { binds.SetVSConstantBuffers(context, a_slot, a_count, a_buffers); }
+		void PS(uint32_t a_slot, uint32_t a_count, ID3D11Buffer* const* a_buffers) { binds.SetPSConstantBuffers(context, a_slot, a_count, a_buffers); }
+		void SRV(uint32_t a_slot, uint32_t a_count, ID3D11ShaderResourceView* const* a_views) { binds.SetPSShaderResources(context, a_slot, a_count, a_views); }
+	};
+
+	struct Direct
+	{
+		RecordingBindContext& context;
+		void VS(uint32_t a_slot, uint32_t a_count, ID3D11Buffer* const* a_buffers) { context.VSSetConstantBuffers(a_slot, a_count, a_buffers); }
+		void PS(uint32_t a_slot, uint32_t a_count, ID3D11Buffer* const* a_buffers) { context.PSSetConstantBuffers(a_slot, a_count, a_buffers); }
+		void SRV(uint32_t a_slot, uint32_t a_count, ID3D11ShaderResourceView* const* a_views) { context.PSSetShaderResources(a_slot, a_count, a_views); }
+	};
+}
+
+TEST_CASE("BindState skips binds that are already current", "[BindState]")
+{
+	BindState<RecordingBindContext> binds;
+	RecordingBindContext context;
+
+	ID3D11ShaderResourceView* view = FakeView(0);
+	binds.SetPSShaderResources(context, 30, 1, &view);
+	binds.SetPSShaderResources(context, 30, 1, &view);
+	REQUIRE(context.calls.size() == 1);
+	CHECK(context.calls[0] == RecordingBindContext::Call{ "PSSetShaderResources", 30, { view } });
+	CHECK(binds.issued == 1);
+	CHECK(binds.skipped == 1);
+
+	// The same pointer in another stage or slot is a different bind
+	ID3D11Buffer* buffer = FakeBuffer(0);
+	binds.SetVSConstantBuffers(context, 3, 1, &buffer);
+	binds.SetPSConstantBuffers(context, 3, 1, &buffer);
+	binds.SetPSConstantBuffers(context, 4, 1, &buffer);
+	CHECK(context.calls.size() == 4);
+
+	// Unbinding is tracked like any other value
+	ID3D11ShaderResourceView* null = nullptr;
+	binds.SetPSShaderResources(context, 30, 1, &null);
+	binds.SetPSShaderResources(context, 30, 1, &null);
+	CHECK(context.calls.size() == 5);
+	CHECK(context.psShaderResources[30] == nullptr);
+}
+
+TEST_CASE("BindState issues a whole range when any slot in it changed", "[BindState]")
+{
+	BindState<RecordingBindContext> binds;
+	RecordingBindContext context;
+
+	ID3D11Buffer* buffers[2] = { FakeBuffer(0), FakeBuffer(1) };
+	binds.SetPSConstantBuffers(context, 3, 2, buffers);
+	buffers[1] = FakeBuffer(2);
+	binds.SetPSConstantBuffers(context, 3, 2, buffers);
+
+	REQUIRE(context.calls.size() == 2);
+	CHECK(context.calls[1] == RecordingBindContext::Call{ "PSSetConstantBuffers", 3, { FakeBuffer(0), FakeBuffer(2) } });
+
+	// A range that overlaps only known slots with the same values is skipped
+	binds.SetPSConstantBuffers(context, 4, 1, &buffers[1]);
+	CHECK(context.calls.size() == 2);
+}
+
+TEST_CASE("BindState reissues binds after invalidation and at the end of a frame", "[BindState]")
+{
+	BindState<RecordingBindContext> binds;
+	RecordingBindContext context;
+
+	ID3D11Buffer* buffer = FakeBuffer(0);
+	binds.SetVSConstantBuffers(context, 3, 1, &buffer);
+	binds.Invalidate();
+	binds.SetVSConstantBuffers(context, 3, 1, &buffer);
+	binds.SetVSConstantBuffers(context, 3, 1, &buffer);
+	CHECK(context.calls.size() == 2);
+
+	binds.EndFrame();
+	CHECK(binds.lastFrameIssued == 2);
+	CHECK(binds.lastFrameSkipped == 1);
+	CHECK(binds.issued == 0);
+	CHECK(binds.skipped == 0);
+
+	binds.SetVSConstantBuffers(context, 3, 1, &buffer);
+	CHECK(context.calls.size() == 3);
+}
+
+TEST_CASE("BindState leaves the context in the same state as unfiltered binds", "[BindState]")
+{
+	BindState<RecordingBindContext> binds;
+	RecordingBindContext filtered;
+	RecordingBindContext direct;
+
+	Filtered filteredBind{ binds, filtered };
+	Direct directBind{ direct };
+	for (uint32_t draw = 0; draw < 100; draw++) {
+		DrawSequence(draw, 1, filteredBind);
+		DrawSequence(draw, 1, directBind);
+		INFO("draw " << draw);
+		CHECK(filtered.psShaderResources == direct.psShaderResources);
+		CHECK(filtered.vsConstantBuffers == direct.vsConstantBuffers);
+		CHECK(filtered.psConstantBuffers == direct.psConstantBuffers);
+	}
+
+	// Three binds per draw: the SRV alternates every draw and the per-geometry buffer changes ten times
+	CHECK(direct.calls.size() == 300);
+	CHECK(filtered.calls.size() == 100 + 10 * 2);
+	CHECK(binds.issued == filtered.calls.size());
+	CHECK(binds.skipped == direct.calls.size() - filtered.calls.size());
+}
+
+TEST_CASE("BindState benchmark", "[.][benchmark][BindState]")
+{
+	BENCHMARK("Filtered draw binds")
+	{
+		BindState<RecordingBindContext> binds;
+		RecordingBindContext context;
+		context.calls.reserve(30000);
+		DrawSequence(0, 10000, Filtered{ binds, context });
+		return context.calls.size();
+	};
+
+	BENCHMARK("Direct draw binds")
+	{
+		RecordingBindContext context;
+		context.calls.reserve(30000);
+		DrawSequence(0, 10000, Direct{ context });
+		return context.calls.size();
+	};
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+// Catch2 v3 ships split headers, v2 a single header; the tests only use what both provide.
+#if __has_include(<catch2/catch_all.hpp>)
+#	include <catch2/catch_all.hpp>
+#else
+#	include <catch2/catch.hpp>
+namespace Catch
+{
+	using Catch::Detail::Approx;
+}
+#endif
@@ -0,0 +1,190 @@
+#include "Catch.h"
+
+#include "Features/LightLimitFix/ClusterGrid.h"
+
+namespace
+{
+	void CheckBuildingCoversEveryCluster(const ClusterGrid& a_grid)
+	{
+		const auto dispatch = a_grid.BuildingDispatch();
+		std::vector<uint> hits(a_grid.Count());
+		for (uint z = 0; z < dispatch.z; z++)
+			for (uint y = 0; y < dispatch.y; y++)
+				for (uint x = 0; x < dispatch.x; x++) {
+					const uint index = a_grid.Index(x, y, z);
+					REQUIRE(index < a_grid.Count());
+					hits[index]++;
+				}
+		CHECK(std::ranges::all_of(hits, [](uint a_hits) { return a_hits == 1; }));
+	}
+
+	// Returns the number of threads in the last group that map to a cluster
+	uint CheckCullingCoversEveryCluster(const ClusterGrid& a_grid)
+	{
+		const auto dispatch = a_grid.CullingDispatch();
+		REQUIRE(dispatch.x == 1);
+		REQUIRE(dispatch.y == 1);
+
+		std::vector<uint> hits(a_grid.Count());
+		uint lastGroupValid = 0;
+		for (uint groupZ = 0; groupZ < dispatch.z; groupZ++) {
+			for (uint groupIndex = 0; groupIndex < ClusterGrid::CULLING_GROUP_SIZE; groupIndex++) {
+				const uint index = ClusterGrid::CullingIndex(groupIndex, groupZ);
+				if (index >= a_grid.Count())
+					continue;
+				hits[index]++;
+				if (groupZ == dispatch.z - 1)
+					lastGroupValid++;
+			}
+		}
+		CHECK(std::ranges::all_of(hits, [](uint a_hits) { return a_hits == 1; }));
+		return lastGroupValid;
+	}
+}
+
+TEST_CASE("ClusterGrid presets dispatch every cluster once", "[ClusterGrid]")
+{
+	constexpr uint expectedCounts[] = { 1024, 4096, 12288 };
+	constexpr uint expectedCullingGroups[] = { 1, 4, 12 };
+	for (uint i = 0; i < static_cast<uint>(ClusterGridPreset::Total); i++) {
+		const auto& grid = ClusterGridPresets[i];
+		INFO("preset " << i);
+		CHECK(grid.Count() == expectedCounts[i]);
+		CHECK(grid.BuildingDispatch() == ClusterGrid::DispatchSize{ grid.sizeX, grid.sizeY, grid.sizeZ });
+		CHECK(grid.CullingDispatch().z == expectedCullingGroups[i]);
+		CheckBuildingCoversEveryCluster(grid);
+		CHECK(CheckCullingCoversEveryCluster(grid) == ClusterGrid::CULLING_GROUP_SIZE);
+	}
+}
+
+TEST_CASE("ClusterGrid culling dispatch handles a partial last group", "[ClusterGrid]")
+{
+	const ClusterGrid grid{ 10, 10, 11, 64 };  // 1100 clusters
+	CHECK(grid.CullingDispatch().z == 2);
+	CHECK(CheckCullingCoversEveryCluster(grid) == 1100 - ClusterGrid::CULLING_GROUP_SIZE);
+
+	const ClusterGrid single{ 1, 1, 1, 64 };
+	CHECK(single.CullingDispatch().z == 1);
+	CHECK(CheckCullingCoversEveryCluster(single) == 1);
+}
+
+TEST_CASE("ClusterGrid index matches GetClusterIndex", "[ClusterGrid]")
+{
+	const ClusterGrid::View views[] = {
+		{ 1.0f, 8192.0f, 1920.0f, 1080.0f },
+		{ 10.0f, 20000.0f, 2560.0f, 1440.0f },
+		{ 1.0f, 4096.0f, 1000.0f, 1000.0f },  // exact multiples of the grid size
+	};
+
+	for (const auto& grid : ClusterGridPresets) {
+		for (const auto& view : views) {
+			INFO(grid.sizeX << "x" << grid.sizeY << "x" << grid.sizeZ << " at " << view.bufferWidth << "x" << view.bufferHeight);
+			uint index = 0;
+			CHECK_FALSE(grid.GetClusterIndex(view, 0.5f, 0.5f, view.lightsNear * 0.5f, index));
+			CHECK_FALSE(grid.GetClusterIndex(view, 0.5f, 0.5f, view.lightsFar * 2.0f, index));
+
+			REQUIRE(grid.GetClusterIndex(view, 0.0f, 0.0f, view.lightsNear, index));
+			CHECK(index == 0);
+
+			// The far plane and the bottom right corner stay in the last cluster
+			REQUIRE(grid.GetClusterIndex(view, 1.0f, 1.0f, view.lightsFar, index));
+			CHECK(index == grid.Count() - 1);
+
+			// Depth slices are logarithmic: the geometric middle of the range is the middle slice
+			REQUIRE(grid.GetClusterIndex(view, 0.0f, 0.0f, std::sqrt(view.lightsNear * view.lightsFar) * 1.001f, index));
+			CHECK(index == grid.Index(0, 0, grid.sizeZ / 2));
+
+			uint lastSlice = 0;
+			for (uint step = 0; step <= 256; step++) {
+				const float t = step / 256.0f;
+				const float z = view.lightsNear * std::pow(view.lightsFar / view.lightsNear, t);
+				REQUIRE(grid.GetClusterIndex(view, t, 1.0f - t, std::min(z, view.lightsFar), index));
+				REQUIRE(index < grid.Count());
+				const uint slice = index / (grid.sizeX * grid.sizeY);
+				CHECK(slice >= lastSlice);
+				lastSlice = slice;
+			}
+		}
+	}
+}
+
+TEST_CASE("ClusterGrid benchmark", "[.][benchmark][ClusterGrid]")
+{
+	const auto& grid = ClusterGridPresets[static_cast<uint>(ClusterGridPreset::High)];
+	const ClusterGrid::View view{ 1.0f, 8192.0f, 1920.0f, 1080.0f };
+	BENCHMARK("GetClusterIndex over a 64x64 tile")
+	{
+		uint sum = 0;
+		for (uint y = 0; y < 64; y++)
+			for (uint x = 0; x < 64; x++) {
+				uint index = 0;
+				if (grid.GetClusterIndex(view, x / 64.0f, y / 64.0f, 1.0f + x * y, index))
+					sum += index;
+			}
+		return sum;
+	};
+}
+
+namespace
+{
+	ClusterGridPreset Run(ClusterGridAutoTune& a_autoTune, uint a_frames, uint a_lightCount, bool a_overflowAtMedium)
+	{
+		for (uint i = 0; i < a_frames; i++) {
+			const auto current = a_autoTune.GetPreset();
+			a_autoTune.Update(current, a_lightCount, a_overflowAtMedium && current == ClusterGridPreset::Medium);
+		}
+		return a_autoTune.GetPreset();
+	}
+}
+
+TEST_CASE("ClusterGridAutoTune follows the light density after a delay", "[ClusterGrid]")
+{
+	ClusterGridAutoTune autoTune;
+	CHECK(Run(autoTune, 1000, 200, false) == ClusterGridPreset::Medium);
+
+	CHECK(Run(autoTune, ClusterGridAutoTune::SWITCH_FRAMES - 1, 10, false) == ClusterGridPreset::Medium);
+	CHECK(Run(autoTune, 1, 10, false) == ClusterGridPreset::Low);
+
+	// A short spike does not rebuild the grid
+	Run(autoTune, 60, 1000, false);
+	CHECK(Run(autoTune, 60, 10, false) == ClusterGridPreset::Low);
+	CHECK(Run(autoTune, ClusterGridAutoTune::SWITCH_FRAMES, 1000, false) == ClusterGridPreset::High);
+}
+
+TEST_CASE("ClusterGridAutoTune does not cycle after overflow", "[ClusterGrid]")
+{
+	ClusterGridAutoTune autoTune;
+
+	// Medium by density, but its clusters overflow: move to High and stay there
+	CHECK(Run(autoTune, ClusterGridAutoTune::SWITCH_FRAMES, 300, true) == ClusterGridPreset::High);
+	CHECK(autoTune.GetMinimumPreset() == ClusterGridPreset::High);
+	uint changes = 0;
+	auto last = autoTune.GetPreset();
+	for (uint i = 0; i < 10 * ClusterGridAutoTune::SWITCH_FRAMES; i++) {
+		Run(autoTune, 1, 300, true);
+		changes += autoTune.GetPreset() != last;
+		last = autoTune.GetPreset();
+	}
+	CHECK(changes == 0);
+	CHECK(last == ClusterGridPreset::High);
+
+	// A small drop in density keeps the finer grid
+	CHECK(Run(autoTune, 2 * ClusterGridAutoTune::SWITCH_FRAMES, 200, true) == ClusterGridPreset::High);
+
+	// Half the density the overflow was seen at releases it
+	CHECK(Run(autoTune, 1, 140, true) == ClusterGridPreset::High);
+	CHECK(autoTune.GetMinimumPreset() == ClusterGridPreset::Low);
+	CHECK(Run(autoTune, ClusterGridAutoTune::SWITCH_FRAMES, 140, false) == ClusterGridPreset::Medium);
+}
+
+TEST_CASE("ClusterGridAutoTune overflow at the finest preset changes nothing", "[ClusterGrid]")
+{
+	ClusterGridAutoTune autoTune;
+	Run(autoTune, ClusterGridAutoTune::SWITCH_FRAMES, 1000, false);
+	REQUIRE(autoTune.GetPreset() == ClusterGridPreset::High);
+	autoTune.Update(ClusterGridPreset::High, 1000, true);
+	CHECK(autoTune.GetMinimumPreset() == ClusterGridPreset::Low);
+
+	autoTune.Reset();
+	CHECK(autoTune.GetPreset() == ClusterGridPreset::Medium);
+}
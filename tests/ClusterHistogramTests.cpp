@@ -0,0 +1,113 @@
+#include "Catch.h"
+
+#include "Features/LightLimitFix/ClusterHistogram.h"
+
+namespace
+{
+	using Cluster = ClusterHistogram::Cluster;
+
+	Cluster MakeCluster(uint a_lightCount, uint a_candidateCount)
+	{
+		return { 0, a_lightCount, a_candidateCount, 0.0f };
+	}
+
+	uint BucketTotal(const ClusterHistogram& a_histogram)
+	{
+		return std::accumulate(std::begin(a_histogram.buckets), std::end(a_histogram.buckets), 0u);
+	}
+}
+
+TEST_CASE("ClusterHistogram of no clusters is empty", "[ClusterHistogram]")
+{
+	const auto histogram = ClusterHistogram::Reduce({}, 128, 0);
+	CHECK(histogram.clusterCount == 0);
+	CHECK(histogram.emptyClusters == 0);
+	CHECK(BucketTotal(histogram) == 0);
+	CHECK(histogram.indexCapacity == 0);
+	CHECK(histogram.maxLightCount == 0);
+}
+
+TEST_CASE("ClusterHistogram counts empty clusters outside the buckets", "[ClusterHistogram]")
+{
+	const std::vector<Cluster> clusters(16, MakeCluster(0, 0));
+	const auto histogram = ClusterHistogram::Reduce(clusters, 64, 0);
+	CHECK(histogram.clusterCount == 16);
+	CHECK(histogram.emptyClusters == 16);
+	CHECK(BucketTotal(histogram) == 0);
+	CHECK(histogram.indexCapacity == 16 * 64);
+}
+
+TEST_CASE("ClusterHistogram bucket boundaries", "[ClusterHistogram]")
+{
+	constexpr uint maxLights = 64;  // eight lights per bucket
+	const std::vector<Cluster> clusters = {
+		MakeCluster(1, 1),
+		MakeCluster(8, 8),
+		MakeCluster(9, 9),
+		MakeCluster(56, 56),
+		MakeCluster(57, 57),
+		MakeCluster(maxLights, maxLights),
+	};
+	const auto histogram = ClusterHistogram::Reduce(clusters, maxLights, 195);
+
+	const uint expected[ClusterHistogram::BUCKET_COUNT] = { 2, 1, 0, 0, 0, 0, 1, 2 };
+	for (uint i = 0; i < ClusterHistogram::BUCKET_COUNT; i++) {
+		INFO("bucket " << i);
+		CHECK(histogram.buckets[i] == expected[i]);
+	}
+	CHECK(histogram.maxLightCount == maxLights);
+	CHECK(histogram.overflowingClusters == 0);
+	CHECK(histogram.indexCount == 195);
+	CHECK(histogram.indexCapacity == 6 * maxLights);
+}
+
+TEST_CASE("ClusterHistogram with a capacity below the bucket count", "[ClusterHistogram]")
+{
+	// Four lights per cluster, each light count still lands in a valid bucket
+	const std::vector<Cluster> clusters = { MakeCluster(1, 1), MakeCluster(2, 2), MakeCluster(3, 3), MakeCluster(4, 4) };
+	const auto histogram = ClusterHistogram::Reduce(clusters, 4, 10);
+	CHECK(histogram.buckets[0] == 1);
+	CHECK(histogram.buckets[2] == 1);
+	CHECK(histogram.buckets[4] == 1);
+	CHECK(histogram.buckets[6] == 1);
+	CHECK(BucketTotal(histogram) == 4);
+}
+
+TEST_CASE("ClusterHistogram with no cluster capacity", "[ClusterHistogram]")
+{
+	const std::vector<Cluster> clusters = { MakeCluster(0, 3), MakeCluster(2, 5) };
+	const auto histogram = ClusterHistogram::Reduce(clusters, 0, 0);
+	CHECK(histogram.indexCapacity == 0);
+	CHECK(histogram.emptyClusters == 1);
+	CHECK(histogram.buckets[0] == 1);
+	CHECK(histogram.overflowingClusters == 1);
+	CHECK(histogram.droppedLights == 3);
+}
+
+TEST_CASE("ClusterHistogram overflow accounting", "[ClusterHistogram]")
+{
+	const std::vector<Cluster> clusters = {
+		MakeCluster(128, 128),  // full, nothing dropped
+		MakeCluster(128, 129),
+		MakeCluster(128, 300),
+		MakeCluster(5, 5),
+		MakeCluster(0, 0),
+	};
+	const auto histogram = ClusterHistogram::Reduce(clusters, 128, 389);
+	CHECK(histogram.overflowingClusters == 2);
+	CHECK(histogram.droppedLights == 1 + 172);
+	CHECK(histogram.buckets[ClusterHistogram::BUCKET_COUNT - 1] == 3);
+	CHECK(histogram.emptyClusters + BucketTotal(histogram) == histogram.clusterCount);
+}
+
+TEST_CASE("ClusterHistogram benchmark", "[.][benchmark][ClusterHistogram]")
+{
+	std::vector<Cluster> clusters(32 * 16 * 24);
+	for (uint i = 0; i < clusters.size(); i++)
+		clusters[i] = MakeCluster(i % 131 > 128 ? 128 : i % 131, i % 131);
+
+	BENCHMARK("Reduce 12288 clusters")
+	{
+		return ClusterHistogram::Reduce(clusters, 128, 0).droppedLights;
+	};
+}
@@ -0,0 +1,75 @@
+#include "Catch.h"
+
+#include "Features/SubsurfaceScattering/DiffusionKernel.h"
+
+using namespace DirectX;
+
+namespace
+{
+	float ScalarProfile(float a_falloff, float a_radius)
+	{
+		static constexpr float weights[] = { 0.100f, 0.118f, 0.113f, 0.358f, 0.078f };
+		static constexpr float variances[] = { 0.0484f, 0.187f, 0.567f, 1.99f, 7.41f };
+		const float rr = a_radius / (a_falloff + 0.001f);
+		float result = 0.0f;
+		for (size_t i = 0; i < std::size(weights); i++)
+			result += weights[i] / (2.0f * 3.14f * variances[i]) * std::exp(-(rr * rr) / (2.0f * variances[i]));
+		return result;
+	}
+}
+
+TEST_CASE("DiffusionKernel profile matches the scalar gaussian sum", "[DiffusionKernel]")
+{
+	const XMFLOAT3 falloff{ 1.0f, 0.37f, 0.3f };
+	for (float radius : { 0.0f, 0.1f, 0.5f, 1.0f, 2.0f, 3.0f }) {
+		XMFLOAT3 result;
+		XMStoreFloat3(&result, DiffusionKernel::Profile(XMLoadFloat3(&falloff), radius));
+		CHECK(result.x == Catch::Approx(ScalarProfile(falloff.x, radius)).epsilon(1e-4));
+		CHECK(result.y == Catch::Approx(ScalarProfile(falloff.y, radius)).epsilon(1e-4));
+		CHECK(result.z == Catch::Approx(ScalarProfile(falloff.z, radius)).epsilon(1e-4));
+	}
+}
+
+TEST_CASE("DiffusionKernel weights are normalized per channel", "[DiffusionKernel]")
+{
+	const float3 strength{ 0.48f, 0.41f, 0.28f };
+	const float3 falloff{ 0.56f, 0.56f, 0.56f };
+	DiffusionKernel::Kernel kernel;
+	DiffusionKernel::Calculate(strength, falloff, kernel);
+
+	CHECK(kernel.Sample[0].w == 0.0f);
+
+	float sum[3] = {};
+	for (const auto& sample : kernel.Sample) {
+		sum[0] += sample.x;
+		sum[1] += sample.y;
+		sum[2] += sample.z;
+		CHECK(std::abs(sample.w) <= 3.0f);
+	}
+	CHECK(sum[0] == Catch::Approx(1.0f).epsilon(1e-4));
+	CHECK(sum[1] == Catch::Approx(1.0f).epsilon(1e-4));
+	CHECK(sum[2] == Catch::Approx(1.0f).epsilon(1e-4));
+
+	// Offsets are symmetric around the center sample
+	for (uint i = 1; i <= SSSS_N_SAMPLES / 2; i++)
+		CHECK(kernel.Sample[i].w == Catch::Approx(-kernel.Sample[SSSS_N_SAMPLES - i].w));
+}
+
+TEST_CASE("DiffusionKernel with zero strength passes the center sample through", "[DiffusionKernel]")
+{
+	DiffusionKernel::Kernel kernel;
+	DiffusionKernel::Calculate(float3{ 0.0f, 0.0f, 0.0f }, float3{ 1.0f, 1.0f, 1.0f }, kernel);
+	CHECK(kernel.Sample[0].x == 1.0f);
+	for (uint i = 1; i < SSSS_N_SAMPLES; i++)
+		CHECK(kernel.Sample[i].x == 0.0f);
+}
+
+TEST_CASE("DiffusionKernel benchmark", "[.][benchmark][DiffusionKernel]")
+{
+	DiffusionKernel::Kernel kernel;
+	BENCHMARK("Calculate")
+	{
+		DiffusionKernel::Calculate(float3{ 0.48f, 0.41f, 0.28f }, float3{ 0.56f, 0.56f, 0.56f }, kernel);
+		return kernel.Sample[0].x;
+	};
+}
@@ -0,0 +1,188 @@
+#include "Catch.h"
+
+#include "DrawDispatch.h"
+
+#include <random>
+
+namespace
+{
+	// Same values as RE::BSShader::Type
+	enum ShaderType : size_t
+	{
+		None,
+		Grass,
+		Sky,
+		Water,
+		BloodSplatter,
+		ImageSpace,
+		Lighting,
+		Effect,
+		Utility,
+		DistantTree,
+		Particle,
+		Total
+	};
+
+	constexpr uint32_t Mask(std::initializer_list<ShaderType> a_types)
+	{
+		uint32_t mask = 0;
+		for (auto type : a_types)
+			mask |= 1u << type;
+		return mask;
+	}
+
+	// Draw returns early for types it does not handle, like the feature Draw overrides did before HasDraw
+	struct FakeFeature
+	{
+		std::string_view name;
+		uint32_t types;
+		bool loaded = true;
+		uint64_t draws = 0;
+
+		FakeFeature(std::string_view a_name, uint32_t a_types) :
+			name(a_name), types(a_types) {}
+		virtual ~FakeFeature() = default;
+
+		bool HasDraw(size_t a_type) const { return types & (1u << a_type); }
+
+		virtual void Draw(size_t a_type, uint32_t a_descriptor)
+		{
+			if (!HasDraw(a_type))
+				return;
+			draws += a_descriptor;
+		}
+	};
+
+	// The HasDraw overrides of the plugin features, in feature list order
+	std::vector<std::unique_ptr<FakeFeature>> MakeFeatures()
+	{
+		std::vector<std::unique_ptr<FakeFeature>> features;
+		features.push_back(std::make_unique<FakeFeature>("Grass Lighting", Mask({ Grass })));
+		features.push_back(std::make_unique<FakeFeature>("Distant Tree Lighting", Mask({ DistantTree })));
+		features.push_back(std::make_unique<FakeFeature>("Grass Collision", Mask({ Grass })));
+		features.push_back(std::make_unique<FakeFeature>("Screen Space Shadows", Mask({ Grass, DistantTree, Lighting })));
+		features.push_back(std::make_unique<FakeFeature>("Extended Materials", Mask({ Lighting })));
+		features.push_back(std::make_unique<FakeFeature>("Wetness Effects", Mask({ Lighting, Grass })));
+		features.push_back(std::make_unique<FakeFeature>("Light Limit Fix", Mask({ Lighting, Grass, Effect, Water })));
+		features.push_back(std::make_unique<FakeFeature>("Dynamic Cubemaps", Mask({ Lighting, Water })));
+		features.push_back(std::make_unique<FakeFeature>("Cloud Shadows", Mask({ Sky, Lighting, DistantTree, Grass })));
+		features.push_back(std::make_unique<FakeFeature>("Water Blending", Mask({ Water, Lighting })));
+		features.push_back(std::make_unique<FakeFeature>("Water Parallax", 0));
+		features.push_back(std::make_unique<FakeFeature>("Subsurface Scattering", Mask({ Lighting })));
+		features.push_back(std::make_unique<FakeFeature>("Terrain Blending", 0));
+		return features;
+	}
+
+	struct Draw
+	{
+		size_t type;
+		uint32_t descriptor;
+	};
+
+	// A frame of 10k draws, mostly lighting with some grass, effects and the rest
+	std::vector<Draw> MakeFrame()
+	{
+		std::mt19937 random(31);
+		std::discrete_distribution<size_t> types({ 0, 15, 1, 3, 1, 1, 60, 8, 4, 3, 4 });
+		std::uniform_int_distribution<uint32_t> descriptors(1, 1 << 16);
+		std::vector<Draw> draws(10000);
+		for (auto& draw : draws)
+			draw = { types(random), descriptors(random) };
+		return draws;
+	}
+
+	struct Features
+	{
+		std::vector<std::unique_ptr<FakeFeature>> owned = MakeFeatures();
+		std::vector<FakeFeature*> list;
+		DrawDispatch<FakeFeature, Total> dispatch;
+
+		Features()
+		{
+			for (auto& feature : owned)
+				list.push_back(feature.get());
+			// Unloaded features are skipped by both paths
+			owned[4]->loaded = false;
+			dispatch.Build(list, [](FakeFeature* a_feature, size_t a_type) { return a_feature->loaded && a_feature->HasDraw(a_type); });
+		}
+
+		// State::Draw before the per-type lists
+		void DrawAll(const std::vector<Draw>& a_draws)
+		{
+			for (const auto& draw : a_draws)
+				for (auto* feature : list)
+					if (feature->loaded)
+						feature->Draw(draw.type, draw.descriptor);
+		}
+
+		void DrawDispatched(const std::vector<Draw>& a_draws)
+		{
+			for (const auto& draw : a_draws)
+				for (auto* feature : dispatch[draw.type])
+					feature->Draw(draw.type, draw.descriptor);
+		}
+
+		std::vector<uint64_t> TakeDraws()
+		{
+			std::vector<uint64_t> draws;
+			for (auto& feature : owned)
+				draws.push_back(std::exchange(feature->draws, 0));
+			return draws;
+		}
+	};
+}
+
+TEST_CASE("DrawDispatch lists the loaded handlers of each type in order", "[DrawDispatch]")
+{
+	Features features;
+
+	CHECK(features.dispatch[None].empty());
+	CHECK(features.dispatch[Particle].empty());
+	REQUIRE(features.dispatch[Grass].size() == 6);
+	CHECK(features.dispatch[Grass].front()->name == "Grass Lighting");
+	CHECK(features.dispatch[Grass].back()->name == "Cloud Shadows");
+	REQUIRE(features.dispatch[Lighting].size() == 7);
+	CHECK(std::ranges::none_of(features.dispatch[Lighting], [](FakeFeature* a_feature) { return a_feature->name == "Extended Materials"; }));
+	CHECK(std::ranges::is_sorted(features.dispatch[Lighting], {}, [&](FakeFeature* a_feature) {
+		return std::ranges::find(features.list, a_feature) - features.list.begin();
+	}));
+
+	// Rebuilding after a feature loads picks it up
+	features.owned[4]->loaded = true;
+	features.dispatch.Build(features.list, [](FakeFeature* a_feature, size_t a_type) { return a_feature->loaded && a_feature->HasDraw(a_type); });
+	CHECK(features.dispatch[Lighting].size() == 8);
+}
+
+TEST_CASE("DrawDispatch does the same work as the full feature loop", "[DrawDispatch]")
+{
+	Features features;
+	const auto frame = MakeFrame();
+
+	features.DrawAll(frame);
+	const auto all = features.TakeDraws();
+	features.DrawDispatched(frame);
+	const auto dispatched = features.TakeDraws();
+
+	CHECK(all == dispatched);
+	CHECK(all[4] == 0);
+	CHECK(all[10] == 0);
+	CHECK(all[6] > 0);
+}
+
+TEST_CASE("DrawDispatch benchmark", "[.][benchmark][DrawDispatch]")
+{
+	Features features;
+	const auto frame = MakeFrame();
+
+	BENCHMARK("Full feature loop, 10k draws")
+	{
+		features.DrawAll(frame);
+		return features.owned[6]->draws;
+	};
+
+	BENCHMARK("Per-type lists, 10k draws")
+	{
+		features.DrawDispatched(frame);
+		return features.owned[6]->draws;
+	};
+}
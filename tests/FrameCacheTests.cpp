@@ -0,0 +1,111 @@
+#include "Catch.h"
+
+#include "FrameCache.h"
+
+#ifdef _MSC_VER
+#	define TEST_NOINLINE __declspec(noinline)
+#else
+#	define TEST_NOINLINE [[gnu::noinline]]
+#endif
+
+namespace
+{
+	// Shaped like State::FrameContext, with the engine pointers left opaque
+	struct FakeFrameContext
+	{
+		bool isVR = false;
+		float sunlightScale = 1.0f;
+		float directionalAmbient[3][4]{};
+		const void* sky = nullptr;
+		const void* worldSpace = nullptr;
+	};
+
+	// Stands in for the singletons State::GetFrameContext reads. The getters are not inlined,
+	// like the calls into the game and CommonLib they replace.
+	struct FakeEngine
+	{
+		bool isVR = false;
+		float sunlightScale[2] = { 1.5f, 1.25f };
+		float ambientRotate[3][3] = { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } };
+		float ambientTranslate[3] = { 0.1f, 0.2f, 0.3f };
+		int sky = 0;
+		int worldSpace = 0;
+		uint64_t reads = 0;
+
+		TEST_NOINLINE bool IsVR() { return reads++, isVR; }
+		TEST_NOINLINE const float* GetImageSpaceData() { return reads++, sunlightScale; }
+		TEST_NOINLINE const float (*GetAmbientRotate())[3] { return reads++, ambientRotate; }
+		TEST_NOINLINE const void* GetSky() { return reads++, &sky; }
+		TEST_NOINLINE const void* GetWorldSpace() { return reads++, &worldSpace; }
+
+		void Capture(FakeFrameContext& a_context)
+		{
+			a_context.isVR = IsVR();
+			a_context.sunlightScale = GetImageSpaceData()[a_context.isVR];
+			const auto rotate = GetAmbientRotate();
+			for (int row = 0; row < 3; row++) {
+				std::copy_n(rotate[row], 3, a_context.directionalAmbient[row]);
+				a_context.directionalAmbient[row][3] = ambientTranslate[row];
+			}
+			a_context.sky = GetSky();
+			a_context.worldSpace = GetWorldSpace();
+		}
+	};
+
+	// What the features read per draw: Wetness Effects, Grass Lighting and Tree LOD Lighting
+	constexpr int READERS_PER_DRAW = 3;
+	constexpr int DRAWS = 10000;
+}
+
+TEST_CASE("FrameCache captures once per frame", "[FrameCache]")
+{
+	FakeEngine engine;
+	Util::FrameCache<FakeFrameContext> cache;
+	auto capture = [&](FakeFrameContext& a_context) { engine.Capture(a_context); };
+
+	const auto& first = cache.Get(capture);
+	CHECK(first.sunlightScale == 1.5f);
+	CHECK(first.directionalAmbient[2][3] == 0.3f);
+	const auto reads = engine.reads;
+	CHECK(reads == 5);
+
+	// Values changed within a frame are not seen until the next one
+	engine.sunlightScale[0] = 2.0f;
+	CHECK(&cache.Get(capture) == &first);
+	CHECK(cache.Get(capture).sunlightScale == 1.5f);
+	CHECK(engine.reads == reads);
+
+	cache.Invalidate();
+	CHECK(cache.Get(capture).sunlightScale == 2.0f);
+	CHECK(engine.reads == 2 * reads);
+}
+
+TEST_CASE("FrameCache benchmark", "[.][benchmark][FrameCache]")
+{
+	FakeEngine engine;
+	Util::FrameCache<FakeFrameContext> cache;
+
+	BENCHMARK("Engine reads per draw, 10k draws")
+	{
+		float sum = 0.0f;
+		for (int draw = 0; draw < DRAWS; draw++) {
+			for (int reader = 0; reader < READERS_PER_DRAW; reader++) {
+				FakeFrameContext context;
+				engine.Capture(context);
+				sum += context.sunlightScale;
+			}
+		}
+		return sum;
+	};
+
+	BENCHMARK("FrameCache per draw, 10k draws")
+	{
+		cache.Invalidate();
+		float sum = 0.0f;
+		for (int draw = 0; draw < DRAWS; draw++) {
+			for (int reader = 0; reader < READERS_PER_DRAW; reader++)
+				sum += cache.Get([&](FakeFrameContext& a_context) { engine.Capture(a_context); }).sunlightScale;
+		}
+		return sum;
+	};
+}
@@ -0,0 +1,173 @@
+#include "Catch.h"
+
+#include "Features/LightLimitFix/LightStaging.h"
+
+namespace
+{
+	using Stream = LightStaging::Stream;
+
+	float Fade(float a_distance, float a_start, float a_end)
+	{
+		if (a_end == 0.0f)
+			return 1.0f;
+		if (a_end <= a_start)
+			return a_distance < a_start ? 1.0f : 0.0f;
+		return std::clamp(1.0f - (a_distance - a_start) / (a_end - a_start), 0.0f, 1.0f);
+	}
+
+	LightStaging::View MakeView()
+	{
+		LightStaging::View view;
+		view.eyeCount = 2;
+		view.eyeOffset = { 3.0f, 0.0f, 0.0f };
+		view.viewMatrix[0].m[3][0] = 10.0f;
+		view.viewMatrix[0].m[3][1] = 20.0f;
+		view.viewMatrix[0].m[3][2] = 30.0f;
+		// 90 degree rotation around z for the second eye
+		view.viewMatrix[1].m[0][0] = 0.0f;
+		view.viewMatrix[1].m[0][1] = 1.0f;
+		view.viewMatrix[1].m[1][0] = -1.0f;
+		view.viewMatrix[1].m[1][1] = 0.0f;
+		view.lightFadeStart = 100.0f;
+		view.lightFadeEnd = 400.0f;
+		view.lightsFar = 30.0f;
+		return view;
+	}
+
+	LightStaging::Light MakeLight(uint32_t a_index)
+	{
+		LightStaging::Light light;
+		const float t = static_cast<float>(a_index);
+		light.position = { std::fmod(t * 1.7f, 40.0f) - 20.0f, std::fmod(t * 0.9f, 30.0f) - 15.0f, std::fmod(t * 2.3f, 20.0f) - 10.0f };
+		light.radius = a_index % 11 == 0 ? 0.0f : 1.0f + std::fmod(t, 5.0f);
+		light.color = { 1.0f, 0.5f + std::fmod(t, 3.0f) * 0.25f, 0.25f };
+		light.lightFade = a_index % 2 == 0;
+		light.offset = { 0.5f, -0.25f, 0.125f };
+		light.flickerIntensity = a_index % 5 == 0 ? 0.3f : 0.0f;
+		light.flags = a_index % 3 == 0 ? LightStaging::kParticle : LightStaging::kNone;
+		return light;
+	}
+
+	void CheckAgainstScalar(const LightStaging& a_staging, const LightStaging::View& a_view, const std::vector<LightStaging::Light>& a_lights)
+	{
+		const float distantEnd = a_view.lightsFar * a_view.lightsFar;
+		const float distantStart = distantEnd * (a_view.lightFadeStart / a_view.lightFadeEnd);
+
+		for (uint32_t i = 0; i < a_lights.size(); i++) {
+			const auto& light = a_lights[i];
+			INFO("light " << i);
+
+			const float distance = light.position.x * light.position.x + light.position.y * light.position.y + light.position.z * light.position.z - light.radius * light.radius;
+			float dimmer = Fade(distance, distantStart, distantEnd);
+			if (light.lightFade)
+				dimmer *= Fade(distance, a_view.lightFadeStart, a_view.lightFadeEnd);
+
+			const float r = light.color.x * dimmer, g = light.color.y * dimmer, b = light.color.z * dimmer;
+			const bool visible = r + g + b > 1e-4f && light.radius > 1e-4f;
+			CHECK(((a_staging.GetFlags(i) & LightStaging::kVisible) != 0) == visible);
+			CHECK((a_staging.GetFlags(i) & ~LightStaging::kVisible) == light.flags);
+
+			const float red = std::max(0.0f, r - light.flickerIntensity);
+			const float green = std::max(0.0f, g - light.flickerIntensity);
+			const float blue = std::max(0.0f, b - light.flickerIntensity);
+			CHECK(a_staging.Data(Stream::Red)[i] == Catch::Approx(red).margin(1e-6));
+			CHECK(a_staging.Data(Stream::Green)[i] == Catch::Approx(green).margin(1e-6));
+			CHECK(a_staging.Data(Stream::Blue)[i] == Catch::Approx(blue).margin(1e-6));
+			CHECK(a_staging.Data(Stream::Grey)[i] == Catch::Approx(red * 0.3f + green * 0.59f + blue * 0.11f).margin(1e-6));
+
+			for (uint eye = 0; eye < a_view.eyeCount; eye++) {
+				const float3 eyeOffset = eye ? a_view.eyeOffset : float3{};
+				const float position[3] = {
+					light.position.x + light.offset.x + eyeOffset.x,
+					light.position.y + light.offset.y + eyeOffset.y,
+					light.position.z + light.offset.z + eyeOffset.z
+				};
+				const auto& m = a_view.viewMatrix[eye].m;
+				for (uint axis = 0; axis < 3; axis++) {
+					CHECK(a_staging.Data(Stream::PositionWS, eye, axis)[i] == Catch::Approx(position[axis]));
+					const float viewSpace = position[0] * m[0][axis] + position[1] * m[1][axis] + position[2] * m[2][axis] + m[3][axis];
+					CHECK(a_staging.Data(Stream::PositionVS, eye, axis)[i] == Catch::Approx(viewSpace).margin(1e-4));
+				}
+			}
+		}
+	}
+}
+
+TEST_CASE("LightStaging matches the scalar light evaluation", "[LightStaging]")
+{
+	const auto view = MakeView();
+
+	// 37 lights leave a partial last batch
+	std::vector<LightStaging::Light> lights;
+	for (uint32_t i = 0; i < 37; i++)
+		lights.push_back(MakeLight(i));
+
+	LightStaging staging;
+	for (const auto& light : lights)
+		staging.Add(light);
+	REQUIRE(staging.Size() == lights.size());
+
+	staging.Process(view);
+	CheckAgainstScalar(staging, view, lights);
+}
+
+TEST_CASE("LightStaging keeps staged lights when growing", "[LightStaging]")
+{
+	LightStaging staging;
+	staging.Reserve(3);
+
+	std::vector<LightStaging::Light> lights;
+	for (uint32_t i = 0; i < 300; i++) {
+		lights.push_back(MakeLight(i));
+		staging.Add(lights.back());
+	}
+
+	const auto view = MakeView();
+	staging.Process(view);
+	CheckAgainstScalar(staging, view, lights);
+
+	staging.Clear();
+	CHECK(staging.Size() == 0);
+	staging.Process(view);
+}
+
+TEST_CASE("LightStaging fade edges", "[LightStaging]")
+{
+	LightStaging::View view;
+	view.lightFadeStart = 100.0f;
+	view.lightFadeEnd = 100.0f;  // no ramp, a hard cut at the start distance
+	view.lightsFar = 1000.0f;
+
+	LightStaging staging;
+	LightStaging::Light light;
+	light.radius = 1.0f;
+	light.color = { 1.0f, 1.0f, 1.0f };
+	light.lightFade = true;
+
+	light.position = { 9.0f, 0.0f, 0.0f };  // 81 - 1 < 100
+	staging.Add(light);
+	light.position = { 11.0f, 0.0f, 0.0f };  // 121 - 1 >= 100
+	staging.Add(light);
+	light.lightFade = false;  // ignores the engine fade
+	staging.Add(light);
+
+	staging.Process(view);
+	CHECK(staging.Data(Stream::Red)[0] == 1.0f);
+	CHECK(staging.Data(Stream::Red)[1] == 0.0f);
+	CHECK((staging.GetFlags(1) & LightStaging::kVisible) == 0);
+	CHECK(staging.Data(Stream::Red)[2] == 1.0f);
+}
+
+TEST_CASE("LightStaging benchmark", "[.][benchmark][LightStaging]")
+{
+	const auto view = MakeView();
+	LightStaging staging;
+	for (uint32_t i = 0; i < 4096; i++)
+		staging.Add(MakeLight(i));
+
+	BENCHMARK("Process 4096 lights")
+	{
+		staging.Process(view);
+		return staging.Data(Stream::Grey)[0];
+	};
+}
@@ -0,0 +1,3 @@
+// Catch2 v2 has no prebuilt main, v3 links Catch2::Catch2WithMain instead of this file
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
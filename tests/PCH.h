@@ -0,0 +1,147 @@
+#pragma once
+
+// Stand-in for include/PCH.h when building engine-free units on the host.
+// Only the aliases and helpers those units use are provided; anything touching the game stays in the plugin.
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <ranges>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#if __has_include(<format>)
+#	include <format>
+#endif
+
+#if __has_include(<DirectXMath.h>)
+#	define HOST_TESTS_HAS_DIRECTXMATH 1
+#	include <DirectXMath.h>
+#endif
+
+#if __has_include(<EASTL/vector.h>)
+#	include <EASTL/vector.h>
+#else
+namespace eastl
+{
+	using std::vector;
+}
+#endif
+
+#if __has_include(<ankerl/unordered_dense.h>)
+#	include <ankerl/unordered_dense.h>
+#else
+namespace ankerl::unordered_dense
+{
+	template <class Key, class T, class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>>
+	using map = std::unordered_map<Key, T, Hash, KeyEqual>;
+}
+#endif
+
+#if __has_include(<SimpleIni.h>)
+#	include <SimpleIni.h>
+#else
+#	include "SimpleIniStandIn.h"
+#endif
+
+using namespace std::literals;
+using uint = uint32_t;
+
+namespace logger
+{
+	template <class... Args>
+	void trace(Args&&...)
+	{}
+	template <class... Args>
+	void debug(Args&&...)
+	{}
+	template <class... Args>
+	void info(Args&&...)
+	{}
+	template <class... Args>
+	void warn(Args&&...)
+	{}
+	template <class... Args>
+	void error(Args&&...)
+	{}
+	template <class... Args>
+	void critical(Args&&...)
+	{}
+}
+
+#ifdef HOST_TESTS_HAS_DIRECTXMATH
+struct float3 : DirectX::XMFLOAT3
+{
+	float3() :
+		XMFLOAT3(0.0f, 0.0f, 0.0f) {}
+	constexpr float3(float a_x, float a_y, float a_z) :
+		XMFLOAT3(a_x, a_y, a_z) {}
+};
+
+struct float4 : DirectX::XMFLOAT4
+{
+	float4() :
+		XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f) {}
+	constexpr float4(float a_x, float a_y, float a_z, float a_w) :
+		XMFLOAT4(a_x, a_y, a_z, a_w) {}
+};
+
+struct float4x4 : DirectX::XMFLOAT4X4
+{
+	float4x4() :
+		XMFLOAT4X4(1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f) {}
+};
+#else
+struct float3
+{
+	float x = 0.0f;
+	float y = 0.0f;
+	float z = 0.0f;
+};
+
+struct float4
+{
+	float x = 0.0f;
+	float y = 0.0f;
+	float z = 0.0f;
+	float w = 0.0f;
+};
+
+struct float4x4
+{
+	float m[4][4] = { { 1.0f, 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 0.0f, 1.0f } };
+};
+#endif
+
+#ifndef _MSC_VER
+#	include <cstdlib>
+
+inline void* _aligned_malloc(size_t a_size, size_t a_alignment)
+{
+	return std::aligned_alloc(a_alignment, (a_size + a_alignment - 1) & ~(a_alignment - 1));
+}
+
+inline void _aligned_free(void* a_block)
+{
+	std::free(a_block);
+}
+#endif
@@ -0,0 +1,200 @@
+#include "Catch.h"
+
+#include "Features/LightLimitFix/ParticleLightConfigCache.h"
+
+namespace
+{
+	struct FakeConfig
+	{
+		float colorMult = 1.0f;
+	};
+
+	struct FakeMaterial
+	{
+		std::string sourceTexturePath;
+		std::string greyscaleTexturePath;
+	};
+
+	using Configs = std::pair<const FakeConfig*, const FakeConfig*>;
+	using Cache = ParticleLightConfigCache<FakeMaterial, Configs>;
+
+	// Stands in for ParticleLights and LightLimitFix::ResolveParticleLightConfigs
+	struct ConfigMaps
+	{
+		ankerl::unordered_dense::map<std::string, FakeConfig> configs;
+		ankerl::unordered_dense::map<std::string, FakeConfig> gradientConfigs;
+		uint version = 1;
+		uint64_t resolves = 0;
+
+		explicit ConfigMaps(size_t a_count)
+		{
+			for (size_t i = 0; i < a_count; i++) {
+				configs.insert({ "fxfire" + std::to_string(i), FakeConfig{} });
+				gradientConfigs.insert({ "gradient" + std::to_string(i), FakeConfig{} });
+			}
+		}
+
+		std::optional<Configs> Resolve(FakeMaterial* a_material)
+		{
+			resolves++;
+			auto textureName = ExtractTextureStem(a_material->sourceTexturePath);
+			auto it = configs.find(textureName);
+			if (it == configs.end())
+				return std::nullopt;
+			const FakeConfig* gradient = nullptr;
+			if (!a_material->greyscaleTexturePath.empty()) {
+				auto itGradient = gradientConfigs.find(ExtractTextureStem(a_material->greyscaleTexturePath));
+				if (itGradient == gradientConfigs.end())
+					return std::nullopt;
+				gradient = &itGradient->second;
+			}
+			return std::make_pair(&it->second, gradient);
+		}
+
+		const std::optional<Configs>& Get(Cache& a_cache, FakeMaterial& a_material)
+		{
+			return a_cache.Get(&a_material, version, a_material.sourceTexturePath.data(), a_material.greyscaleTexturePath.data(),
+				[this](FakeMaterial* a_resolved) { return Resolve(a_resolved); });
+		}
+	};
+
+	// Every fourth material has no config, every other one a gradient
+	std::vector<FakeMaterial> MakeMaterials(size_t a_count, size_t a_configs)
+	{
+		std::vector<FakeMaterial> materials(a_count);
+		for (size_t i = 0; i < a_count; i++) {
+			auto index = std::to_string(i % a_configs);
+			materials[i].sourceTexturePath = (i % 4 == 3 ? "Textures\\Effects\\Smoke"s : "Textures\\Effects\\FXFire"s) + index + ".dds";
+			if (i % 2)
+				materials[i].greyscaleTexturePath = "Textures\\Effects\\Gradients\\Gradient" + index + ".dds";
+		}
+		return materials;
+	}
+}
+
+TEST_CASE("ExtractTextureStem lowercases the file name without extension", "[ParticleLightConfigCache]")
+{
+	CHECK(ExtractTextureStem("Textures\\Effects\\FXFire01.dds") == "fxfire01");
+	CHECK(ExtractTextureStem("textures/effects/FXSmoke.DDS") == "fxsmoke");
+	CHECK(ExtractTextureStem("").empty());
+	CHECK(ExtractTextureStem("FXFire01.dds").empty());
+	CHECK(ExtractTextureStem("Textures\\a").empty());
+}
+
+TEST_CASE("ParticleLightConfigCache resolves each material once", "[ParticleLightConfigCache]")
+{
+	ConfigMaps maps(8);
+	Cache cache;
+	auto materials = MakeMaterials(8, 8);
+
+	for (int frame = 0; frame < 3; frame++)
+		for (auto& material : materials)
+			maps.Get(cache, material);
+	CHECK(maps.resolves == 8);
+	CHECK(cache.GetMisses() == 8);
+	CHECK(cache.GetHits() == 16);
+
+	const auto& fire = maps.Get(cache, materials[1]);
+	REQUIRE(fire.has_value());
+	CHECK(fire->first == &maps.configs["fxfire1"]);
+	CHECK(fire->second == &maps.gradientConfigs["gradient1"]);
+	CHECK_FALSE(maps.Get(cache, materials[3]).has_value());
+	// Misses are cached too
+	CHECK(maps.resolves == 8);
+}
+
+TEST_CASE("ParticleLightConfigCache resolves again when a material address is reused", "[ParticleLightConfigCache]")
+{
+	ConfigMaps maps(8);
+	Cache cache;
+	auto materials = MakeMaterials(2, 8);
+
+	REQUIRE(maps.Get(cache, materials[0]).has_value());
+	// A new material at the same address has different interned paths
+	materials[0] = FakeMaterial{ "Textures\\Effects\\Smoke0.dds", {} };
+	CHECK_FALSE(maps.Get(cache, materials[0]).has_value());
+	CHECK(maps.resolves == 2);
+	CHECK(cache.GetSize() == 1);
+}
+
+TEST_CASE("ParticleLightConfigCache drops every entry on a config reload", "[ParticleLightConfigCache]")
+{
+	ConfigMaps maps(8);
+	Cache cache;
+	auto materials = MakeMaterials(8, 8);
+	for (auto& material : materials)
+		maps.Get(cache, material);
+	REQUIRE(cache.GetSize() == 8);
+
+	maps.version++;
+	maps.Get(cache, materials[0]);
+	CHECK(cache.GetSize() == 1);
+	CHECK(maps.resolves == 9);
+}
+
+TEST_CASE("ParticleLightConfigCache starts over above the entry limit", "[ParticleLightConfigCache]")
+{
+	ConfigMaps maps(64);
+	Cache cache;
+	auto materials = MakeMaterials(Cache::MAX_ENTRIES + 2, 64);
+
+	for (size_t i = 0; i <= Cache::MAX_ENTRIES; i++)
+		maps.Get(cache, materials[i]);
+	CHECK(cache.GetSize() == Cache::MAX_ENTRIES + 1);
+
+	maps.Get(cache, materials[Cache::MAX_ENTRIES + 1]);
+	CHECK(cache.GetSize() == 1);
+	maps.Get(cache, materials[0]);
+	CHECK(cache.GetMisses() == Cache::MAX_ENTRIES + 3);
+}
+
+TEST_CASE("ParticleLightConfigCache benchmark", "[.][benchmark][ParticleLightConfigCache]")
+{
+	ConfigMaps maps(512);
+	auto materials = MakeMaterials(256, 512);
+
+	{
+		Cache cache;
+		for (auto& material : materials)
+			maps.Get(cache, material);
+		BENCHMARK("Hit, 256 materials")
+		{
+			size_t found = 0;
+			for (auto& material : materials)
+				found += maps.Get(cache, material).has_value();
+			return found;
+		};
+	}
+
+	{
+		Cache cache;
+		BENCHMARK("Miss after a config reload, 256 materials")
+		{
+			maps.version++;
+			size_t found = 0;
+			for (auto& material : materials)
+				found += maps.Get(cache, material).has_value();
+			return found;
+		};
+	}
+
+	BENCHMARK("Uncached resolve, 256 materials")
+	{
+		size_t found = 0;
+		for (auto& material : materials)
+			found += maps.Resolve(&material).has_value();
+		return found;
+	};
+
+	auto streamed = MakeMaterials(Cache::MAX_ENTRIES + 1, 512);
+	{
+		Cache cache;
+		BENCHMARK("Stream of 4097 new materials including the clear")
+		{
+			size_t found = 0;
+			for (auto& material : streamed)
+				found += maps.Get(cache, material).has_value();
+			return found;
+		};
+	}
+}
@@ -0,0 +1,244 @@
+#include "Catch.h"
+
+#include "Features/LightLimitFix/ParticleLightsIni.h"
+#include "ScratchDirectory.h"
+
+namespace
+{
+	using namespace ParticleLightsIni;
+	using Catch::Approx;
+
+	std::string ConfigIni(size_t a_index)
+	{
+		return "[Light]\n"
+		       "Cull = " +
+		       std::string(a_index % 2 ? "true" : "false") +
+		       "\n"
+		       "ColorMultRed = 1." +
+		       std::to_string(a_index % 10) +
+		       "\n"
+		       "ColorMultGreen = 0.8\n"
+		       "ColorMultBlue = 0.6\n"
+		       "RadiusMult = 2.0\n"
+		       "Flicker = 1\n"
+		       "FlickerSpeed = 1.5\n"
+		       "FlickerIntensity = 0.25\n"
+		       "FlickerMovement = 3.14159265\n";
+	}
+
+	std::string GradientIni(size_t a_index)
+	{
+		char color[16];
+		snprintf(color, sizeof(color), "0x%06zX", (a_index * 0x10101) & 0xFFFFFF);
+		return "[Gradient]\nColor = "s + color + "\n";
+	}
+
+	// A Data\ParticleLights folder with a_configs inis and a_gradients gradient inis
+	std::vector<std::string> WriteCorpus(const ScratchDirectory& a_directory, size_t a_configs, size_t a_gradients)
+	{
+		std::vector<std::string> paths;
+		for (size_t i = 0; i < a_configs; i++)
+			paths.push_back(a_directory.Write("ParticleLights/FXFire" + std::to_string(i) + ".ini", ConfigIni(i)).string());
+		for (size_t i = 0; i < a_gradients; i++)
+			paths.push_back(a_directory.Write("ParticleLights/Gradients/Gradient" + std::to_string(i) + ".ini", GradientIni(i)).string());
+		return paths;
+	}
+
+	bool IsGradient(const std::string& a_path) { return a_path.find("Gradients") != std::string::npos; }
+
+	Snapshot LoadCorpus(SnapshotLoader& a_loader, const std::vector<std::string>& a_paths)
+	{
+		for (const auto& path : a_paths)
+			a_loader.Get(path, IsGradient(path));
+		return a_loader.GetSnapshot();
+	}
+
+	void CheckEqual(const SnapshotEntry& a_left, const SnapshotEntry& a_right)
+	{
+		CHECK(a_left.size == a_right.size);
+		CHECK(a_left.time == a_right.time);
+		CHECK(a_left.valid == a_right.valid);
+		CHECK(a_left.config.cull == a_right.config.cull);
+		CHECK(a_left.config.colorMult.red == a_right.config.colorMult.red);
+		CHECK(a_left.config.flickerMovement == a_right.config.flickerMovement);
+		CHECK(a_left.gradient.color.blue == a_right.gradient.color.blue);
+	}
+}
+
+TEST_CASE("ParticleLightsIni names configs by their lowercase file name", "[ParticleLightsIni]")
+{
+	CHECK(GetConfigName("Data\\ParticleLights\\FXFire01.ini") == "fxfire01");
+	CHECK(GetConfigName("Data/ParticleLights/Gradients/MagicBlue.INI") == "magicblue");
+	CHECK_FALSE(GetConfigName("FXFire01.ini").has_value());
+	CHECK_FALSE(GetConfigName("Data\\a").has_value());
+}
+
+TEST_CASE("ParticleLightsIni parses light configs", "[ParticleLightsIni]")
+{
+	ScratchDirectory directory("ParticleLightsIniConfig");
+
+	Config config;
+	REQUIRE(ParseConfig(directory.Write("FXFire.ini", ConfigIni(3)).string(), config));
+	CHECK(config.cull);
+	CHECK(config.colorMult.red == Approx(1.3f));
+	CHECK(config.colorMult.green == Approx(0.8f));
+	CHECK(config.radiusMult == Approx(2.0f));
+	CHECK(config.saturationMult == 1.0f);
+	CHECK(config.flicker);
+	CHECK(config.flickerSpeed == Approx(1.5f));
+	CHECK(config.flickerMovement == Approx(1.0f));
+
+	// Missing and malformed values keep the defaults, sections and keys ignore case
+	Config defaults;
+	REQUIRE(ParseConfig(directory.Write("Defaults.ini", "; comment\n[light]\ncolormultred = bright\nRADIUSMULT=\nFlicker = maybe\n").string(), defaults));
+	CHECK(defaults.colorMult.red == 1.0f);
+	CHECK(defaults.radiusMult == 1.0f);
+	CHECK_FALSE(defaults.flicker);
+	CHECK(defaults.flickerSpeed == 1.0f);
+
+	CHECK_FALSE(ParseConfig((directory.root / "Missing.ini").string(), config));
+}
+
+TEST_CASE("ParticleLightsIni parses gradient colors", "[ParticleLightsIni]")
+{
+	ScratchDirectory directory("ParticleLightsIniGradient");
+	auto parse = [&](std::string_view a_value, GradientConfig& a_gradient) {
+		return ParseGradient(directory.Write("Gradient.ini", "[Gradient]\nColor = "s + std::string(a_value) + "\n").string(), a_gradient);
+	};
+
+	GradientConfig gradient;
+	REQUIRE(parse("0xFF8000", gradient));
+	CHECK(gradient.color.red == 1.0f);
+	CHECK(gradient.color.green == Approx(128 / 255.0f));
+	CHECK(gradient.color.blue == 0.0f);
+	REQUIRE(parse("#00ff00", gradient));
+	CHECK(gradient.color.green == 1.0f);
+	REQUIRE(parse("0000FF", gradient));
+	CHECK(gradient.color.blue == 1.0f);
+
+	CHECK_FALSE(parse("", gradient));
+	CHECK_FALSE(parse("0x", gradient));
+	CHECK_FALSE(parse("blue", gradient));
+	CHECK_FALSE(parse("0xFF80 00", gradient));
+	CHECK_FALSE(parse("1FFFFFFFFFF", gradient));
+	CHECK_FALSE(ParseGradient(directory.Write("Empty.ini", "[Gradient]\n").string(), gradient));
+	CHECK_FALSE(ParseGradient((directory.root / "Missing.ini").string(), gradient));
+}
+
+TEST_CASE("ParticleLightsIni snapshots round-trip", "[ParticleLightsIni]")
+{
+	ScratchDirectory directory("ParticleLightsIniRoundTrip");
+	const auto paths = WriteCorpus(directory, 6, 3);
+	SnapshotLoader loader({});
+	const auto snapshot = LoadCorpus(loader, paths);
+	REQUIRE(snapshot.size() == 9);
+
+	const auto file = directory.root / "ParticleLights.cache";
+	REQUIRE(SaveSnapshot(snapshot, file));
+	const auto loaded = LoadSnapshot(file);
+	REQUIRE(loaded.size() == snapshot.size());
+	for (const auto& [path, entry] : snapshot) {
+		auto it = loaded.find(path);
+		REQUIRE(it != loaded.end());
+		CheckEqual(it->second, entry);
+	}
+
+	CHECK(DeserializeSnapshot(SerializeSnapshot({})).empty());
+	CHECK(LoadSnapshot(directory.root / "Missing.cache").empty());
+}
+
+TEST_CASE("ParticleLightsIni rejects truncated and mismatched snapshots", "[ParticleLightsIni]")
+{
+	Snapshot snapshot;
+	for (int i = 0; i < 3; i++) {
+		SnapshotEntry entry;
+		entry.size = 100 + i;
+		entry.valid = true;
+		snapshot.insert({ "Data\\ParticleLights\\Light" + std::to_string(i) + ".ini", entry });
+	}
+	const auto data = SerializeSnapshot(snapshot);
+	REQUIRE(DeserializeSnapshot(data).size() == 3);
+
+	for (size_t length = 0; length < data.size(); length++)
+		CHECK(DeserializeSnapshot(std::string_view(data).substr(0, length)).empty());
+
+	auto patched = [&](size_t a_offset, uint32_t a_value) {
+		auto copy = data;
+		memcpy(copy.data() + a_offset, &a_value, sizeof(a_value));
+		return DeserializeSnapshot(copy);
+	};
+	CHECK(patched(0, 0x12345678).empty());                                        // magic
+	CHECK(patched(4, SNAPSHOT_VERSION + 1).empty());                              // version
+	CHECK(patched(8, static_cast<uint32_t>(sizeof(SnapshotEntry) + 4)).empty());  // entry layout
+	CHECK(patched(12, 4).empty());                                                // more entries than data
+	CHECK(patched(12, std::numeric_limits<uint32_t>::max()).empty());             // count must not be trusted for reserve
+	CHECK(patched(16, std::numeric_limits<uint32_t>::max()).empty());             // path length past the end
+	CHECK(patched(12, 2).size() == 2);                                            // trailing data is ignored
+}
+
+TEST_CASE("ParticleLightsIni reuses unchanged inis from the snapshot", "[ParticleLightsIni]")
+{
+	ScratchDirectory directory("ParticleLightsIniLoader");
+	auto paths = WriteCorpus(directory, 4, 2);
+
+	SnapshotLoader cold({});
+	const auto first = LoadCorpus(cold, paths);
+	CHECK(cold.GetParsedCount() == 6);
+	CHECK(cold.GetReusedCount() == 0);
+	CHECK(cold.IsChanged());
+
+	SnapshotLoader warm(first);
+	const auto second = LoadCorpus(warm, paths);
+	CHECK(warm.GetParsedCount() == 0);
+	CHECK(warm.GetReusedCount() == 6);
+	CHECK_FALSE(warm.IsChanged());
+	CheckEqual(second.at(paths[1]), first.at(paths[1]));
+
+	// A changed size is parsed again, a removed ini drops out of the snapshot
+	directory.Write("ParticleLights/FXFire1.ini", ConfigIni(1) + "SaturationMult = 0.5\n");
+	std::filesystem::remove(paths[2]);
+	SnapshotLoader changed(second);
+	for (const auto& path : paths) {
+		const auto entry = changed.Get(path, IsGradient(path));
+		if (path == paths[1])
+			CHECK(entry.config.saturationMult == Approx(0.5f));
+		if (path == paths[2])
+			CHECK_FALSE(entry.valid);
+	}
+	CHECK(changed.GetParsedCount() == 2);
+	CHECK(changed.GetReusedCount() == 4);
+	CHECK(changed.GetSnapshot().size() == 5);
+	CHECK(changed.IsChanged());
+
+	// Without anything to parse, an ini that is no longer listed still changes the snapshot
+	SnapshotLoader unlisted(changed.GetSnapshot());
+	for (const auto& path : paths)
+		if (path != paths[2] && path != paths[3])
+			unlisted.Get(path, IsGradient(path));
+	CHECK(unlisted.GetParsedCount() == 0);
+	CHECK(unlisted.GetReusedCount() == 4);
+	CHECK(unlisted.IsChanged());
+}
+
+TEST_CASE("ParticleLightsIni benchmark", "[.][benchmark][ParticleLightsIni]")
+{
+	ScratchDirectory directory("ParticleLightsIniBenchmark");
+	const auto paths = WriteCorpus(directory, 3000, 1000);
+	const auto cache = directory.root / "ParticleLights.cache";
+	{
+		SnapshotLoader loader({});
+		SaveSnapshot(LoadCorpus(loader, paths), cache);
+	}
+
+	BENCHMARK("Cold parse of 4000 inis")
+	{
+		SnapshotLoader loader({});
+		return LoadCorpus(loader, paths).size();
+	};
+
+	BENCHMARK("Warm load of 4000 inis from the snapshot")
+	{
+		SnapshotLoader loader(LoadSnapshot(cache));
+		return LoadCorpus(loader, paths).size();
+	};
+}
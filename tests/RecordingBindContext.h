@@ -0,0 +1,45 @@
+#pragma once
+
+// Opaque stand-ins, the recording context only compares and logs the pointers
+struct ID3D11Buffer;
+struct ID3D11ShaderResourceView;
+
+/**
+ * Records the bind calls BindState forwards to its context instead of executing them.
+ * Only PSSetShaderResources, VSSetConstantBuffers and PSSetConstantBuffers exist, so this is a mock for
+ * BindState and cannot replay a feature pass. The log can be compared against an expected sequence
+ * or another run, and the tracked bindings show what a real context would end up with.
+ */
+class RecordingBindContext
+{
+public:
+	struct Call
+	{
+		std::string method;
+		uint32_t slot = 0;
+		std::vector<const void*> values;
+
+		bool operator==(const Call&) const = default;
+	};
+
+	void PSSetShaderResources(uint32_t a_slot, uint32_t a_count, ID3D11ShaderResourceView* const* a_views) { Record("PSSetShaderResources", psShaderResources, a_slot, a_count, a_views); }
+	void VSSetConstantBuffers(uint32_t a_slot, uint32_t a_count, ID3D11Buffer* const* a_buffers) { Record("VSSetConstantBuffers", vsConstantBuffers, a_slot, a_count, a_buffers); }
+	void PSSetConstantBuffers(uint32_t a_slot, uint32_t a_count, ID3D11Buffer* const* a_buffers) { Record("PSSetConstantBuffers", psConstantBuffers, a_slot, a_count, a_buffers); }
+
+	std::vector<Call> calls;
+	std::array<const void*, 128> psShaderResources{};
+	std::array<const void*, 14> vsConstantBuffers{};
+	std::array<const void*, 14> psConstantBuffers{};
+
+private:
+	template <class T, size_t N>
+	void Record(const char* a_method, std::array<const void*, N>& a_bound, uint32_t a_slot, uint32_t a_count, T* const* a_values)
+	{
+		Call call{ a_method, a_slot, {} };
+		for (uint32_t i = 0; i < a_count; i++) {
+			call.values.push_back(a_values[i]);
+			a_bound[a_slot + i] = a_values[i];
+		}
+		calls.push_back(std::move(call));
+	}
+};
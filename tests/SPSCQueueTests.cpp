@@ -0,0 +1,72 @@
+#include "Catch.h"
+
+#include "SPSCQueue.h"
+
+#include <thread>
+
+TEST_CASE("SPSCQueue drops values pushed while full", "[SPSCQueue]")
+{
+	Util::SPSCQueue<uint, 4> queue;
+	CHECK(queue.Empty());
+	for (uint i = 0; i < 4; i++)
+		CHECK(queue.Push(i));
+	CHECK_FALSE(queue.Push(4));
+	CHECK_FALSE(queue.Push(5));
+	CHECK(queue.Dropped() == 2);
+
+	std::vector<uint> drained;
+	CHECK(queue.Drain([&](uint a_value) { drained.push_back(a_value); }) == 4);
+	CHECK(drained == std::vector<uint>{ 0, 1, 2, 3 });
+	CHECK(queue.Empty());
+
+	// Slots are reusable once drained, and the indices wrap around the ring
+	for (uint i = 6; i < 9; i++)
+		CHECK(queue.Push(i));
+	drained.clear();
+	CHECK(queue.Drain([&](uint a_value) { drained.push_back(a_value); }) == 3);
+	CHECK(drained == std::vector<uint>{ 6, 7, 8 });
+	CHECK(queue.Dropped() == 2);
+	CHECK(queue.Drain([](uint) {}) == 0);
+}
+
+TEST_CASE("SPSCQueue keeps order across threads", "[SPSCQueue]")
+{
+	constexpr uint count = 1 << 20;
+	Util::SPSCQueue<uint, 256> queue;
+	std::vector<bool> accepted(count);
+	std::atomic<bool> done = false;
+
+	std::thread producer([&] {
+		for (uint i = 0; i < count; i++) {
+			accepted[i] = queue.Push(i);
+			if (i % 64 == 0)
+				std::this_thread::yield();
+		}
+		done.store(true, std::memory_order_release);
+	});
+
+	std::vector<uint> drained;
+	drained.reserve(count);
+	for (;;) {
+		const bool finished = done.load(std::memory_order_acquire);
+		queue.Drain([&](uint a_value) { drained.push_back(a_value); });
+		if (finished && queue.Empty())
+			break;
+		std::this_thread::yield();
+	}
+	producer.join();
+
+	// Strictly increasing values are both in order and free of duplicates
+	CHECK(std::ranges::adjacent_find(drained, std::greater_equal{}) == drained.end());
+
+	const auto pushed = static_cast<std::size_t>(std::ranges::count(accepted, true));
+	CHECK(pushed == drained.size());
+	CHECK(pushed + queue.Dropped() == count);
+
+	std::vector<uint> expected;
+	for (uint i = 0; i < count; i++) {
+		if (accepted[i])
+			expected.push_back(i);
+	}
+	CHECK(drained == expected);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+/**
+ * A temporary directory for tests that read files, removed again when the test ends.
+ * a_name has to be unique per test case, ctest may run the test and benchmark entries at the same time.
+ */
+class ScratchDirectory
+{
+public:
+	explicit ScratchDirectory(std::string_view a_name) :
+		root(std::filesystem::temp_directory_path() / ("CommunityShadersTests_" + std::string(a_name)))
+	{
+		std::filesystem::remove_all(root);
+		std::filesystem::create_directories(root);
+	}
+
+	~ScratchDirectory()
+	{
+		std::error_code error;
+		std::filesystem::remove_all(root, error);
+	}
+
+	std::filesystem::path Write(const std::filesystem::path& a_relativePath, std::string_view a_contents) const
+	{
+		const auto path = root / a_relativePath;
+		std::filesystem::create_directories(path.parent_path());
+		std::ofstream(path, std::ios::binary) << a_contents;
+		return path;
+	}
+
+	const std::filesystem::path root;
+};
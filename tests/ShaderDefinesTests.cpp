@@ -0,0 +1,185 @@
+#include "Catch.h"
+
+#include "ShaderDefines.h"
+
+namespace
+{
+	// Same member names as RE::BSShader::Type
+	enum class ShaderType
+	{
+		None,
+		Grass,
+		Sky,
+		Water,
+		BloodSplatter,
+		ImageSpace,
+		Lighting,
+		Effect,
+		Utility,
+		DistantTree,
+		Particle,
+		Total
+	};
+
+	// Same layout as D3D_SHADER_MACRO
+	struct Macro
+	{
+		const char* Name;
+		const char* Definition;
+	};
+
+	using Defines = std::array<Macro, 64>;
+
+	// What SShaderCache::GetShaderDefines does around the vanilla defines: feature defines, then the terminator
+	Defines GetDefines(ShaderType a_type, uint32_t a_descriptor, std::initializer_list<const char*> a_features = {})
+	{
+		Defines defines{};
+		auto lastIndex = SIE::GetVanillaShaderDefines(a_type, a_descriptor, defines.data());
+		for (auto feature : a_features)
+			defines[lastIndex++] = { feature, nullptr };
+		defines[lastIndex] = { nullptr, nullptr };
+		return defines;
+	}
+
+	std::string GetMerged(ShaderType a_type, uint32_t a_descriptor)
+	{
+		auto defines = GetDefines(a_type, a_descriptor);
+		return SIE::MergeDefinesString(defines);
+	}
+}
+
+TEST_CASE("Vanilla defines follow the descriptor of each shader type", "[ShaderDefines]")
+{
+	CHECK(GetMerged(ShaderType::Grass, 8) == "RENDER_DEPTH ");
+	CHECK(GetMerged(ShaderType::Grass, 0x10000 | 3) == "DO_ALPHA_TEST ");
+	CHECK(GetMerged(ShaderType::Grass, 0x10000 | 8) == "RENDER_DEPTH DO_ALPHA_TEST ");
+
+	CHECK(GetMerged(ShaderType::Sky, 0) == "OCCLUSION ");
+	CHECK(GetMerged(ShaderType::Sky, 2) == "TEX MOONMASK ");
+	CHECK(GetMerged(ShaderType::Sky, 5) == "TEX CLOUDS TEXLERP ");
+	CHECK(GetMerged(ShaderType::Sky, 8) == "DITHER ");
+	CHECK(GetMerged(ShaderType::Sky, 9) == "");
+
+	CHECK(GetMerged(ShaderType::Water, 0) == "WATER FOG SPECULAR NUM_SPECULAR_LIGHTS=0 ");
+	CHECK(GetMerged(ShaderType::Water, (3 << 11) | 0x1 | 0x400) == "WATER FOG VC BLEND_NORMALS SPECULAR NUM_SPECULAR_LIGHTS=3 ");
+	CHECK(GetMerged(ShaderType::Water, (8 << 11) | 0x10) == "WATER FOG DEPTH UNDERWATER ");
+	CHECK(GetMerged(ShaderType::Water, 11 << 11) == "WATER FOG SIMPLE ");
+	CHECK(GetMerged(ShaderType::Water, 15 << 11) == "WATER FOG ");
+
+	CHECK(GetMerged(ShaderType::BloodSplatter, 0) == "SPLATTER ");
+	CHECK(GetMerged(ShaderType::BloodSplatter, 1) == "FLARE ");
+	CHECK(GetMerged(ShaderType::BloodSplatter, 2) == "");
+
+	CHECK(GetMerged(ShaderType::DistantTree, 1) == "RENDER_DEPTH ");
+	CHECK(GetMerged(ShaderType::DistantTree, 0x10000) == "DO_ALPHA_TEST ");
+
+	CHECK(GetMerged(ShaderType::Particle, 0) == "");
+	CHECK(GetMerged(ShaderType::Particle, 3) == "GRAYSCALE_TO_COLOR GRAYSCALE_TO_ALPHA ");
+	CHECK(GetMerged(ShaderType::Particle, 5) == "ENVCUBE RAIN ");
+
+	CHECK(GetMerged(ShaderType::Effect, 0x1 | 0x40 | 0x4000000) == "VC TEXTURE MOTIONVECTORS_NORMALS ");
+	CHECK(GetMerged(ShaderType::Effect, 0x200) == "");  // bit 9 is unused
+
+	// Lighting defines come from the game, the other types have none
+	CHECK(GetMerged(ShaderType::Lighting, 0xFFFFFFFF) == "");
+	CHECK(GetMerged(ShaderType::Utility, 0xFFFFFFFF) == "");
+}
+
+TEST_CASE("Vanilla defines fit the define buffer", "[ShaderDefines]")
+{
+	Macro defines[64]{};
+	CHECK(SIE::GetVanillaShaderDefines(ShaderType::Effect, 0xFFFFFFFF, defines) == 26);
+	CHECK(SIE::GetVanillaShaderDefines(ShaderType::Water, 0xFFFFFFFF & ~(0xF << 11), defines) == 15);
+}
+
+TEST_CASE("MergeDefinesString stops at the terminator", "[ShaderDefines]")
+{
+	Defines defines{};
+	defines[0] = { "A", nullptr };
+	defines[1] = { "B", "" };
+	defines[2] = { "C", "2" };
+	defines[4] = { "D", nullptr };  // past the terminator
+	CHECK(SIE::MergeDefinesString(defines) == "A B C=2 ");
+	CHECK(SIE::MergeDefinesString(defines, true) == "A B C=2 D ");
+
+	Defines empty{};
+	CHECK(SIE::MergeDefinesString(empty, true) == "");
+}
+
+TEST_CASE("Sorted defines give the same key whatever order features add them in", "[ShaderDefines]")
+{
+	// Distinct buffers, so a comparison of pointers instead of names would order them differently
+	std::string first = "WETNESS_EFFECTS", second = "CLOUD_SHADOWS", third = "LIGHT_LIMIT_FIX";
+	std::string firstCopy = first, secondCopy = second, thirdCopy = third;
+
+	auto ordered = GetDefines(ShaderType::Water, 3 << 11, { first.c_str(), second.c_str(), third.c_str() });
+	auto reversed = GetDefines(ShaderType::Water, 3 << 11, { thirdCopy.c_str(), secondCopy.c_str(), firstCopy.c_str() });
+	const auto orderedKey = SIE::GetShaderKey("Water", "Pixel", SIE::MergeDefinesString(ordered, true));
+	const auto reversedKey = SIE::GetShaderKey("Water", "Pixel", SIE::MergeDefinesString(reversed, true));
+	CHECK(orderedKey == "Water:Pixel:CLOUD_SHADOWS FOG LIGHT_LIMIT_FIX NUM_SPECULAR_LIGHTS=3 SPECULAR WATER WETNESS_EFFECTS ");
+	CHECK(reversedKey == orderedKey);
+	CHECK(std::hash<std::string>{}(reversedKey) == std::hash<std::string>{}(orderedKey));
+
+	// Sorting is by value too, so the one define that carries one still tells permutations apart
+	auto otherLights = GetDefines(ShaderType::Water, 4 << 11, { first.c_str(), second.c_str(), third.c_str() });
+	CHECK(SIE::GetShaderKey("Water", "Pixel", SIE::MergeDefinesString(otherLights, true)) != orderedKey);
+}
+
+TEST_CASE("Shader keys only add the descriptor for logging", "[ShaderDefines]")
+{
+	CHECK(SIE::GetShaderKey("Effect", "Vertex", "VC ") == "Effect:Vertex:VC ");
+	CHECK(SIE::GetShaderKey("Effect", "Vertex", "VC ", 0x1A2B) == "Effect:Vertex:1A2B:VC ");
+	CHECK(SIE::GetShaderKey("Effect", "Vertex", "", 0xFFFFFFFF) == "Effect:Vertex:FFFFFFFF:");
+	CHECK(SIE::GetShaderKey("Effect", "Vertex", "", 0) == "Effect:Vertex:0:");
+
+	CHECK(SIE::GetTypeFromShaderKey(SIE::GetShaderKey("Effect", "Vertex", "VC ")) == "Effect");
+	CHECK(SIE::GetTypeFromShaderKey("Effect") == "");
+}
+
+TEST_CASE("Descriptors with the same defines share a key", "[ShaderDefines]")
+{
+	// Every Effect flag combination over the first 12 bits: bit 9 has no define, so pairs differing only there share a key
+	std::unordered_map<std::string, uint32_t> keys;
+	for (uint32_t descriptor = 0; descriptor < (1u << 12); descriptor++) {
+		auto defines = GetDefines(ShaderType::Effect, descriptor, { "LIGHT_LIMIT_FIX" });
+		auto [it, added] = keys.try_emplace(SIE::GetShaderKey("Effect", "Pixel", SIE::MergeDefinesString(defines, true)), descriptor);
+		if (!added)
+			CHECK((it->second ^ descriptor) == 0x200);
+	}
+	CHECK(keys.size() == (1u << 11));
+}
+
+TEST_CASE("Compilation task ids keep class, type and descriptor apart", "[ShaderDefines]")
+{
+	std::unordered_set<size_t> ids;
+	size_t count = 0;
+	for (uint32_t shaderClass = 0; shaderClass < 3; shaderClass++) {
+		for (uint32_t type = 0; type < static_cast<uint32_t>(ShaderType::Total); type++) {
+			for (uint32_t descriptor : { 0u, 1u, 0x10000u, 0x3F000000u, 0xFFFFFFFFu }) {
+				const auto id = SIE::GetShaderTaskId(shaderClass, type, descriptor);
+				CHECK(static_cast<uint32_t>(id) == descriptor);
+				ids.insert(id);
+				count++;
+			}
+		}
+	}
+	CHECK(ids.size() == count);
+}
+
+TEST_CASE("ShaderDefines benchmark", "[.][benchmark][ShaderDefines]")
+{
+	constexpr const char* features[] = { "WETNESS_EFFECTS", "CLOUD_SHADOWS", "LIGHT_LIMIT_FIX", "SCREEN_SPACE_SHADOWS", "DYNAMIC_CUBEMAPS", "SKYLIGHTING" };
+
+	BENCHMARK("Hash keys for 4096 Effect permutations")
+	{
+		size_t checksum = 0;
+		for (uint32_t descriptor = 0; descriptor < 4096; descriptor++) {
+			Defines defines{};
+			auto lastIndex = SIE::GetVanillaShaderDefines(ShaderType::Effect, descriptor << 12, defines.data());
+			for (auto feature : features)
+				defines[lastIndex++] = { feature, nullptr };
+			checksum += std::hash<std::string>{}(SIE::GetShaderKey("Effect", "Pixel", SIE::MergeDefinesString(defines, true)));
+		}
+		return checksum;
+	};
+}
@@ -0,0 +1,148 @@
+#include "Catch.h"
+
+#include "ShaderDescriptors.h"
+
+namespace
+{
+	// Same member names as RE::BSShader::Type
+	enum class ShaderType
+	{
+		None,
+		Grass,
+		Sky,
+		Water,
+		BloodSplatter,
+		ImageSpace,
+		Lighting,
+		Effect,
+		Utility,
+		DistantTree,
+		Particle,
+		Total
+	};
+
+	// The masking ModifyShaderLookup did inline before it moved to RemapShaderDescriptors, with the flag values spelled out
+	void BaselineRemap(ShaderType a_type, bool a_vr, bool a_enableImprovedSnow, uint32_t& a_vertexDescriptor, uint32_t& a_pixelDescriptor)
+	{
+		switch (a_type) {
+		case ShaderType::Lighting:
+			{
+				a_vertexDescriptor &= ~((1u << 23) | (1u << 17) | (1u << 20) | (1u << 13) | (1u << 14) | (1u << 22) | (1u << 11) |
+										(1u << 10) | (1u << 12) | (1u << 9) | (1u << 16) | (1u << 19) | (1u << 21));
+				a_pixelDescriptor &= ~((1u << 17) | (1u << 13) | (1u << 14) | (1u << 22));
+
+				if (a_vr || !a_enableImprovedSnow)
+					a_pixelDescriptor &= ~(1u << 21);
+
+				{
+					uint32_t technique = 0x3F & (a_vertexDescriptor >> 24);
+					if (technique == 2 || technique == 3 || technique == 4 || technique == 5 || technique == 13 || technique == 15 || technique == 14 || technique == 6)
+						a_vertexDescriptor &= ~(0x3F << 24);
+				}
+
+				{
+					uint32_t technique = 0x3F & (a_pixelDescriptor >> 24);
+					if (technique == 2)
+						a_pixelDescriptor &= ~(0x3F << 24);
+				}
+			}
+			break;
+		case ShaderType::Water:
+			a_vertexDescriptor &= ~((1u << 2) | (1u << 8) | (1u << 5) | (1u << 2));
+			a_pixelDescriptor &= ~((1u << 2) | (1u << 8) | (1u << 5));
+			break;
+		case ShaderType::Effect:
+			a_vertexDescriptor &= ~((1u << 19) | (1u << 20) | (1u << 21));
+			a_pixelDescriptor &= ~((1u << 19) | (1u << 20) | (1u << 21));
+			break;
+		default:
+			break;
+		}
+	}
+
+	struct Descriptor
+	{
+		ShaderType type;
+		uint32_t vertex;
+		uint32_t pixel;
+	};
+
+	// Descriptors as the engine issues them: a technique in bits 24-29 over a set of flags, with runs of repeats
+	std::vector<Descriptor> MakeDescriptorStream()
+	{
+		std::vector<Descriptor> stream;
+		uint32_t state = 0x12345678u;
+		auto next = [&state]() {
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			return state;
+		};
+
+		constexpr ShaderType types[] = { ShaderType::Lighting, ShaderType::Water, ShaderType::Effect, ShaderType::Grass, ShaderType::Sky };
+		for (auto type : types) {
+			for (uint32_t technique = 0; technique < 64; technique++) {
+				for (uint32_t bit = 0; bit < 24; bit++)
+					stream.push_back({ type, (technique << 24) | (1u << bit), (technique << 24) | (1u << bit) });
+				stream.push_back({ type, (technique << 24) | 0xFFFFFF, (technique << 24) | 0xFFFFFF });
+			}
+		}
+
+		for (uint32_t i = 0; i < 100000; i++) {
+			const auto type = types[next() % std::size(types)];
+			const uint32_t technique = next() % 21;
+			const uint32_t flags = next() & 0xFFFFFF;
+			const uint32_t pixelTechnique = next() % 4 == 0 ? next() % 21 : technique;
+			const uint32_t repeats = 1 + next() % 4;
+			for (uint32_t r = 0; r < repeats; r++)
+				stream.push_back({ type, (technique << 24) | flags, (pixelTechnique << 24) | (flags ^ (next() & 0x7E0000)) });
+		}
+		return stream;
+	}
+}
+
+TEST_CASE("RemapShaderDescriptors matches the baseline masking", "[ShaderDescriptors]")
+{
+	const auto stream = MakeDescriptorStream();
+	for (bool vr : { false, true }) {
+		for (bool enableImprovedSnow : { false, true }) {
+			size_t mismatches = 0;
+			for (const auto& descriptor : stream) {
+				uint32_t vertex = descriptor.vertex, pixel = descriptor.pixel;
+				SIE::RemapShaderDescriptors(descriptor.type, !vr && enableImprovedSnow, vertex, pixel);
+
+				uint32_t baselineVertex = descriptor.vertex, baselinePixel = descriptor.pixel;
+				BaselineRemap(descriptor.type, vr, enableImprovedSnow, baselineVertex, baselinePixel);
+
+				if (vertex != baselineVertex || pixel != baselinePixel) {
+					if (mismatches++ < 8)
+						FAIL_CHECK("type " << (int)descriptor.type << " vertex " << std::hex << descriptor.vertex << " pixel " << descriptor.pixel);
+				}
+			}
+			CHECK(mismatches == 0);
+		}
+	}
+}
+
+TEST_CASE("RemapShaderDescriptors leaves other shader types alone", "[ShaderDescriptors]")
+{
+	uint32_t vertex = 0xFFFFFFFF, pixel = 0xFFFFFFFF;
+	SIE::RemapShaderDescriptors(ShaderType::Particle, false, vertex, pixel);
+	CHECK(vertex == 0xFFFFFFFF);
+	CHECK(pixel == 0xFFFFFFFF);
+}
+
+TEST_CASE("RemapShaderDescriptors benchmark", "[.][benchmark][ShaderDescriptors]")
+{
+	const auto stream = MakeDescriptorStream();
+	BENCHMARK("Remap descriptor stream")
+	{
+		uint32_t checksum = 0;
+		for (const auto& descriptor : stream) {
+			uint32_t vertex = descriptor.vertex, pixel = descriptor.pixel;
+			SIE::RemapShaderDescriptors(descriptor.type, true, vertex, pixel);
+			checksum += vertex ^ pixel;
+		}
+		return checksum;
+	};
+}
@@ -0,0 +1,336 @@
+#include "Catch.h"
+
+#include "ShaderIncludeCache.h"
+
+namespace
+{
+	using SIE::ShaderIncludeCache;
+
+	// A scratch copy of the Shaders folder layout, removed when the test ends
+	class ShaderTree
+	{
+	public:
+		explicit ShaderTree(std::string_view a_name) :
+			root(std::filesystem::temp_directory_path() / ("ShaderIncludeCacheTests_" + std::string(a_name)))
+		{
+			std::filesystem::remove_all(root);
+			std::filesystem::create_directories(root);
+		}
+
+		~ShaderTree()
+		{
+			std::error_code error;
+			std::filesystem::remove_all(root, error);
+		}
+
+		std::filesystem::path Write(const std::filesystem::path& a_relativePath, std::string_view a_contents) const
+		{
+			const auto path = root / a_relativePath;
+			std::filesystem::create_directories(path.parent_path());
+			std::ofstream(path, std::ios::binary) << a_contents;
+			return path;
+		}
+
+		const std::filesystem::path root;
+	};
+
+	// Compiles an entry file as far as includes go: every #include of a file is opened with that file's data as the parent,
+	// depth first, through the same lookup as ShaderIncludeHandler::Open, and nothing is released until the walker is.
+	class IncludeWalker
+	{
+	public:
+		static constexpr uint MAX_DEPTH = 32;  // include guards are not evaluated, so cycles stop here like in the compiler
+
+		IncludeWalker(ShaderIncludeCache& a_cache, std::shared_ptr<const ShaderIncludeCache::File> a_entry) :
+			cache(a_cache), rootDirectory(a_entry->directory), openFiles{ std::move(a_entry) }
+		{}
+
+		/** @brief Walks the whole include tree and returns the bytes the compiler would have been given. */
+		size_t Walk() { return Walk(*openFiles.front(), 0); }
+
+		uint GetOpenCount() const { return opens; }
+		uint GetFailedCount() const { return failures; }
+
+	private:
+		const ShaderIncludeCache::File* Open(bool a_local, const std::string& a_fileName, const void* a_parentData)
+		{
+			opens++;
+			const ShaderIncludeCache::File* parent = nullptr;
+			for (const auto& file : openFiles) {
+				if (file->data.data() == a_parentData) {
+					parent = file.get();
+					break;
+				}
+			}
+
+			if (auto file = cache.LoadInclude(a_fileName, a_local, parent, rootDirectory)) {
+				openFiles.push_back(std::move(file));
+				return openFiles.back().get();
+			}
+			failures++;
+			return nullptr;
+		}
+
+		size_t Walk(const ShaderIncludeCache::File& a_file, uint a_depth)
+		{
+			size_t bytes = a_file.data.size();
+			if (a_depth == MAX_DEPTH)
+				return bytes;
+
+			std::string_view text = a_file.data;
+			while (!text.empty()) {
+				const auto end = text.find('\n');
+				auto line = text.substr(0, end);
+				text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+
+				line.remove_prefix(std::min(line.find_first_not_of(" \t"), line.size()));
+				if (!line.starts_with("#include"))
+					continue;
+				const auto open = line.find_first_of("\"<");
+				if (open == std::string_view::npos)
+					continue;
+				const bool local = line[open] == '"';
+				const auto close = line.find(local ? '"' : '>', open + 1);
+				if (close == std::string_view::npos)
+					continue;
+
+				if (auto included = Open(local, std::string(line.substr(open + 1, close - open - 1)), a_file.data.data()))
+					bytes += Walk(*included, a_depth + 1);
+			}
+			return bytes;
+		}
+
+		ShaderIncludeCache& cache;
+		std::filesystem::path rootDirectory;
+		std::vector<std::shared_ptr<const ShaderIncludeCache::File>> openFiles;
+		uint opens = 0;
+		uint failures = 0;
+	};
+
+	// Entry files shaped like the Shaders folder: common headers included from every entry and from feature headers,
+	// each feature with a nested header that reaches back up with relative and root paths
+	constexpr uint ENTRY_COUNT = 8;
+	constexpr uint SHARED_COUNT = 4;
+	constexpr uint FEATURE_COUNT = 8;
+
+	std::vector<std::filesystem::path> WriteNestedTree(const ShaderTree& a_tree, size_t a_padding)
+	{
+		const std::string padding(a_padding, ' ');
+		a_tree.Write("Common/Math.hlsli", padding + "\n");
+		for (uint i = 0; i < SHARED_COUNT; i++)
+			a_tree.Write("Common/Shared" + std::to_string(i) + ".hlsli", "#include <Common/Math.hlsli>\n" + padding + "\n");
+		for (uint f = 0; f < FEATURE_COUNT; f++) {
+			const auto feature = "Feature" + std::to_string(f);
+			a_tree.Write("Features/" + feature + ".hlsli", "  #include \"" + feature + "/Lighting.hlsli\"\n" + padding + "\n");
+			a_tree.Write("Features/" + feature + "/Lighting.hlsli",
+				"#include \"../../Common/Shared0.hlsli\"\n"
+				"#include \"Common/Math.hlsli\"\n" +
+					padding + "\n");
+		}
+
+		std::vector<std::filesystem::path> entries;
+		for (uint e = 0; e < ENTRY_COUNT; e++) {
+			std::string contents = "// Entry " + std::to_string(e) + "\r\n";
+			for (uint i = 0; i < SHARED_COUNT; i++)
+				contents += "#include \"Common/Shared" + std::to_string(i) + ".hlsli\"\r\n";
+			for (uint f = 0; f < FEATURE_COUNT; f++)
+				contents += "#include \"Features/Feature" + std::to_string(f) + ".hlsli\"\r\n";
+			entries.push_back(a_tree.Write("Entry" + std::to_string(e) + ".hlsl", contents + padding));
+		}
+		return entries;
+	}
+
+	// Per entry: the shared headers and their Math include, then per feature its header, the nested header, Shared0 with Math again, and Math
+	constexpr uint OPENS_PER_ENTRY = 2 * SHARED_COUNT + FEATURE_COUNT * 5;
+	constexpr uint FILES_PER_ENTRY = 1 + SHARED_COUNT + 1 + 2 * FEATURE_COUNT;
+}
+
+TEST_CASE("ShaderIncludeCache counts hits and misses", "[ShaderIncludeCache]")
+{
+	ShaderTree tree("Counters");
+	const auto path = tree.Write("Common/Color.hlsli", "float3 Color;");
+	ShaderIncludeCache cache;
+
+	CHECK(cache.Load(tree.root / "Missing.hlsli") == nullptr);
+	CHECK(cache.GetStats().misses == 0);
+
+	const auto first = cache.Load(path);
+	REQUIRE(first);
+	CHECK(first->data == "float3 Color;");
+	CHECK(first->directory == tree.root / "Common");
+
+	// Other spellings of the same path share the entry
+	const auto second = cache.Load(tree.root / "Features" / ".." / "Common" / "Color.hlsli");
+	CHECK(second == first);
+	CHECK(cache.Load(path) == first);
+
+	auto stats = cache.GetStats();
+	CHECK(stats.files == 1);
+	CHECK(stats.bytes == 13);
+	CHECK(stats.hits == 2);
+	CHECK(stats.misses == 1);
+
+	cache.Clear();
+	CHECK(cache.Load(path) != first);
+	stats = cache.GetStats();
+	CHECK(stats.files == 1);
+	CHECK(stats.misses == 2);
+}
+
+TEST_CASE("ShaderIncludeCache rereads modified files", "[ShaderIncludeCache]")
+{
+	ShaderTree tree("Modified");
+	const auto path = tree.Write("Lighting.hlsl", "// version 1");
+	ShaderIncludeCache cache;
+
+	const auto original = cache.Load(path);
+	REQUIRE(original);
+
+	tree.Write("Lighting.hlsl", "// version 2");
+	std::filesystem::last_write_time(path, original->writeTime + std::chrono::seconds(2));
+	const auto modified = cache.Load(path);
+	REQUIRE(modified);
+	CHECK(modified->data == "// version 2");
+	CHECK(cache.GetStats().misses == 2);
+
+	// A compile that still holds the old file keeps its contents
+	CHECK(original->data == "// version 1");
+
+	CHECK(cache.Load(path) == modified);
+	CHECK(cache.GetStats().hits == 1);
+}
+
+TEST_CASE("ShaderIncludeCache resolves includes like the compiler", "[ShaderIncludeCache]")
+{
+	ShaderTree tree("Resolve");
+	const auto entryPath = tree.Write("Lighting.hlsl", "#include \"Common/VR.hlsli\"");
+	tree.Write("Common/VR.hlsli", "// shared VR");
+	tree.Write("Common/Color.hlsli", "// shared color");
+	tree.Write("Features/Common/Color.hlsli", "// feature color");
+	tree.Write("Features/Wetness.hlsli", "#include \"../Common/VR.hlsli\"");
+	ShaderIncludeCache cache;
+
+	const auto entry = cache.Load(entryPath);
+	REQUIRE(entry);
+	const auto& rootDirectory = entry->directory;
+
+	// Includes of the entry file resolve against its directory
+	const auto vr = cache.LoadInclude("Common/VR.hlsli", true, entry.get(), rootDirectory);
+	REQUIRE(vr);
+	CHECK(vr->data == "// shared VR");
+
+	// A relative path from a nested file resolves against that file, to the same cached entry
+	const auto feature = cache.LoadInclude("Features/Wetness.hlsli", true, entry.get(), rootDirectory);
+	REQUIRE(feature);
+	CHECK(cache.LoadInclude("../Common/VR.hlsli", true, feature.get(), rootDirectory) == vr);
+
+	// The including file's directory wins over the entry directory
+	const auto color = cache.LoadInclude("Common/Color.hlsli", true, feature.get(), rootDirectory);
+	REQUIRE(color);
+	CHECK(color->data == "// feature color");
+
+	// System includes and includes missing next to the parent use the entry directory
+	CHECK(cache.LoadInclude("Common/Color.hlsli", false, feature.get(), rootDirectory)->data == "// shared color");
+	CHECK(cache.LoadInclude("Common/VR.hlsli", true, color.get(), rootDirectory) == vr);
+	CHECK(cache.LoadInclude("Common/VR.hlsli", true, nullptr, rootDirectory) == vr);
+
+	CHECK(cache.LoadInclude("Common/Missing.hlsli", true, feature.get(), rootDirectory) == nullptr);
+
+	const auto stats = cache.GetStats();
+	CHECK(stats.files == 5);
+	CHECK(stats.misses == 5);
+	CHECK(stats.hits == 3);
+}
+
+TEST_CASE("ShaderIncludeCache serves nested include trees", "[ShaderIncludeCache]")
+{
+	ShaderTree tree("Nested");
+	const auto entries = WriteNestedTree(tree, 16);
+	ShaderIncludeCache cache;
+
+	IncludeWalker first(cache, cache.Load(entries[0]));
+	first.Walk();
+	CHECK(first.GetOpenCount() == OPENS_PER_ENTRY);
+	CHECK(first.GetFailedCount() == 0);
+	auto stats = cache.GetStats();
+	CHECK(stats.files == FILES_PER_ENTRY);
+	CHECK(stats.misses == FILES_PER_ENTRY);
+	CHECK(stats.hits == OPENS_PER_ENTRY - (FILES_PER_ENTRY - 1));
+
+	// Another permutation of the same entry file only hits the cache
+	IncludeWalker permutation(cache, cache.Load(entries[0]));
+	CHECK(permutation.Walk() > 0);
+	stats = cache.GetStats();
+	CHECK(stats.misses == FILES_PER_ENTRY);
+	CHECK(stats.hits == 2 * OPENS_PER_ENTRY - (FILES_PER_ENTRY - 1) + 1);
+
+	// Other entry files only add themselves
+	for (size_t e = 1; e < entries.size(); e++)
+		IncludeWalker(cache, cache.Load(entries[e])).Walk();
+	CHECK(cache.GetStats().files == FILES_PER_ENTRY + ENTRY_COUNT - 1);
+
+	// A missing include fails that open only, and a file including itself stops at the depth limit
+	const auto broken = tree.Write("Broken.hlsl", "#include \"Common/Missing.hlsli\"\n#include \"Broken.hlsl\"\n");
+	IncludeWalker walker(cache, cache.Load(broken));
+	walker.Walk();
+	CHECK(walker.GetFailedCount() == IncludeWalker::MAX_DEPTH);
+	CHECK(walker.GetOpenCount() == 2 * IncludeWalker::MAX_DEPTH);
+}
+
+TEST_CASE("ShaderIncludeCache benchmark", "[.][benchmark][ShaderIncludeCache]")
+{
+	// Entry files that each include the same tree of common headers
+	ShaderTree tree("Benchmark");
+	std::vector<std::filesystem::path> paths;
+	const std::string contents(8 * 1024, ' ');
+	for (uint i = 0; i < 64; i++)
+		paths.push_back(tree.Write("Common/Header" + std::to_string(i) + ".hlsli", contents));
+
+	ShaderIncludeCache cache;
+	for (const auto& path : paths)
+		cache.Load(path);
+
+	BENCHMARK("Load 64 cached headers")
+	{
+		size_t bytes = 0;
+		for (const auto& path : paths)
+			bytes += cache.Load(path)->data.size();
+		return bytes;
+	};
+
+	BENCHMARK("Load 64 uncached headers")
+	{
+		ShaderIncludeCache uncached;
+		size_t bytes = 0;
+		for (const auto& path : paths)
+			bytes += uncached.Load(path)->data.size();
+		return bytes;
+	};
+
+	// Every entry file compiled the way ShaderIncludeHandler opens its includes
+	ShaderTree nested("BenchmarkNested");
+	const auto entries = WriteNestedTree(nested, 8 * 1024);
+	auto walkEntries = [&](ShaderIncludeCache& a_cache) {
+		size_t bytes = 0;
+		for (const auto& entry : entries)
+			bytes += IncludeWalker(a_cache, a_cache.Load(entry)).Walk();
+		return bytes;
+	};
+	for (const auto& entry : entries)
+		IncludeWalker(cache, cache.Load(entry)).Walk();
+
+	BENCHMARK("Walk 8 nested include trees, cached")
+	{
+		return walkEntries(cache);
+	};
+
+	BENCHMARK("Walk 8 nested include trees, cache cleared per compile")
+	{
+		size_t bytes = 0;
+		for (const auto& entry : entries) {
+			ShaderIncludeCache uncached;
+			bytes += IncludeWalker(uncached, uncached.Load(entry)).Walk();
+		}
+		return bytes;
+	};
+}
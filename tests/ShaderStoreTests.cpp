@@ -0,0 +1,225 @@
+#include "Catch.h"
+
+#include "ShaderStore.h"
+
+#include <deque>
+
+namespace
+{
+	// Stands in for the D3D object, counting references like COM does
+	struct FakeObject
+	{
+		int references = 1;
+		void AddRef() { references++; }
+		void Release() { references--; }
+	};
+
+	struct FakeShader
+	{
+		FakeObject* shader = nullptr;
+	};
+
+	struct FakeOwner
+	{};
+
+	constexpr size_t TYPE = 1;
+	constexpr size_t BYTECODE_SIZE = 1024;
+	constexpr size_t SHADER_BYTES = 3 * BYTECODE_SIZE;
+	constexpr size_t CLONE_BYTES = BYTECODE_SIZE;
+
+	using Store = SIE::ShaderStore<FakeShader, FakeOwner, 4>;
+
+	// Creates shaders the way ShaderCache::MakeAndAdd*Shader does, cloning shared bytecode
+	class Harness
+	{
+	public:
+		FakeShader* Get(uint32_t a_descriptor, uint32_t a_frame)
+		{
+			if (auto shader = store.Find(TYPE, a_descriptor, a_frame))
+				return shader;
+			return Make(a_descriptor, a_frame);
+		}
+
+		FakeShader* Make(uint32_t a_descriptor, uint32_t a_frame)
+		{
+			const uint64_t hash = GetHash(a_descriptor);
+			if (auto source = store.FindShared(TYPE, hash)) {
+				auto clone = std::make_unique<FakeShader>(FakeShader{ source->shader });
+				clone->shader->AddRef();
+				auto [stored, added] = store.Add(TYPE, a_descriptor, clone, &owner, hash, CLONE_BYTES, BYTECODE_SIZE, true, a_frame);
+				if (!added)
+					clone->shader->Release();
+				return stored;
+			}
+			auto shader = std::make_unique<FakeShader>(FakeShader{ &objects.emplace_back() });
+			auto [stored, added] = store.Add(TYPE, a_descriptor, shader, &owner, hash, SHADER_BYTES, BYTECODE_SIZE, false, a_frame);
+			if (!added)
+				shader->shader->Release();
+			return stored;
+		}
+
+		// Same as ShaderCache::EvictUnusedShaders for one store
+		void Evict(uint32_t a_frame, uint32_t a_minAge, size_t a_budget)
+		{
+			std::vector<Store::Candidate> candidates;
+			store.CollectCandidates(a_frame, a_minAge, candidates);
+			for (const auto& candidate : candidates) {
+				if (store.GetBytes() <= a_budget)
+					break;
+				auto entry = store.Evict(candidate.type, candidate.descriptor);
+				entry.shader->shader->Release();
+			}
+		}
+
+		int LiveObjects() const
+		{
+			return static_cast<int>(std::ranges::count_if(objects, [](const FakeObject& a_object) { return a_object.references > 0; }));
+		}
+
+		int References() const
+		{
+			int references = 0;
+			for (const auto& object : objects) {
+				REQUIRE(object.references >= 0);
+				references += object.references;
+			}
+			return references;
+		}
+
+		// Pairs of descriptors compile to the same bytecode
+		static uint64_t GetHash(uint32_t a_descriptor) { return 0x1000 + a_descriptor / 2; }
+
+		Store store;
+		FakeOwner owner;
+		std::deque<FakeObject> objects;
+	};
+}
+
+TEST_CASE("ShaderStore keeps the first of two racing adds", "[ShaderStore]")
+{
+	Store store;
+	FakeOwner owner;
+	FakeObject first, second;
+
+	auto shader = std::make_unique<FakeShader>(FakeShader{ &first });
+	auto [stored, added] = store.Add(TYPE, 7, shader, &owner, 1, SHADER_BYTES, BYTECODE_SIZE, false, 0);
+	REQUIRE(added);
+	CHECK(shader == nullptr);
+
+	auto late = std::make_unique<FakeShader>(FakeShader{ &second });
+	auto [existing, lateAdded] = store.Add(TYPE, 7, late, &owner, 1, SHADER_BYTES, BYTECODE_SIZE, false, 0);
+	CHECK_FALSE(lateAdded);
+	CHECK(existing == stored);
+	REQUIRE(late != nullptr);
+	CHECK(late->shader == &second);
+
+	CHECK(store.GetBytes() == SHADER_BYTES);
+	CHECK(store.GetCount() == 1);
+	CHECK(store.GetRestores() == 0);
+	CHECK(store.GetBytecodeStats(TYPE).descriptors == 1);
+}
+
+TEST_CASE("ShaderStore counts only evicted shaders as restores", "[ShaderStore]")
+{
+	Harness harness;
+	harness.Get(0, 0);
+	harness.Get(2, 0);
+	CHECK_FALSE(harness.store.WasEvicted(TYPE, 0));
+	CHECK(harness.store.GetRestores() == 0);
+
+	harness.store.Evict(TYPE, 0).shader->shader->Release();
+	CHECK(harness.store.WasEvicted(TYPE, 0));
+	CHECK(harness.store.Find(TYPE, 0, 1) == nullptr);
+
+	harness.Get(0, 1);
+	CHECK_FALSE(harness.store.WasEvicted(TYPE, 0));
+	CHECK(harness.store.GetRestores() == 1);
+	CHECK(harness.store.GetEvictions() == 1);
+	CHECK(harness.References() == 2);
+}
+
+TEST_CASE("ShaderStore counts each clone once across source evictions", "[ShaderStore]")
+{
+	Harness harness;
+	harness.Get(0, 0);  // source
+	harness.Get(1, 0);  // clone
+	auto stats = harness.store.GetBytecodeStats(TYPE);
+	CHECK(stats.unique == 1);
+	CHECK(stats.descriptors == 2);
+	CHECK(stats.savedBytes == BYTECODE_SIZE);
+
+	// The clone outlives its source, and the same bytecode gets a new source
+	harness.store.Evict(TYPE, 0).shader->shader->Release();
+	CHECK(harness.store.GetBytecodeStats(TYPE).unique == 0);
+	harness.Get(0, 1);
+	stats = harness.store.GetBytecodeStats(TYPE);
+	CHECK(stats.unique == 1);
+	CHECK(stats.descriptors == 1);
+
+	// Evicting the old clone must not take a descriptor from the new source
+	harness.store.Evict(TYPE, 1).shader->shader->Release();
+	stats = harness.store.GetBytecodeStats(TYPE);
+	CHECK(stats.descriptors == 1);
+	CHECK(stats.savedBytes == 0);
+
+	harness.Get(1, 2);
+	stats = harness.store.GetBytecodeStats(TYPE);
+	CHECK(stats.descriptors == 2);
+	CHECK(stats.savedBytes == BYTECODE_SIZE);
+	CHECK(harness.References() == 2);
+	CHECK(harness.LiveObjects() == 1);
+}
+
+TEST_CASE("ShaderStore evicts least recently used shaders on a frame trace", "[ShaderStore]")
+{
+	constexpr uint32_t MIN_AGE = 20;
+	constexpr size_t BUDGET = 24 * SHADER_BYTES;
+	Harness harness;
+
+	// Two areas that draw 32 descriptors each, visited in turn, with a few descriptors drawn everywhere
+	auto drawArea = [&](uint32_t a_first, uint32_t a_frames, uint32_t& a_frame) {
+		for (uint32_t i = 0; i < a_frames; i++, a_frame++) {
+			for (uint32_t descriptor = a_first; descriptor < a_first + 32; descriptor++)
+				REQUIRE(harness.Get(descriptor, a_frame));
+			for (uint32_t descriptor = 1000; descriptor < 1004; descriptor++)
+				REQUIRE(harness.Get(descriptor, a_frame));
+			harness.Evict(a_frame, MIN_AGE, BUDGET);
+		}
+	};
+
+	uint32_t frame = 0;
+	drawArea(0, 100, frame);
+	// Everything drawn this frame is too recent to evict, so the budget can be exceeded
+	CHECK(harness.store.GetCount() == 36);
+	CHECK(harness.store.GetEvictions() == 0);
+
+	drawArea(100, 100, frame);
+	// The first area went least recently used first, the shared descriptors stayed
+	for (uint32_t descriptor = 0; descriptor < 32; descriptor++)
+		CHECK(harness.store.WasEvicted(TYPE, descriptor));
+	for (uint32_t descriptor = 1000; descriptor < 1004; descriptor++)
+		CHECK(harness.store.Find(TYPE, descriptor, frame));
+	CHECK(harness.store.GetEvictions() == 32);
+	CHECK(harness.store.GetRestores() == 0);
+
+	drawArea(0, 100, frame);
+	CHECK(harness.store.GetRestores() == 32);
+	CHECK(harness.store.GetEvictions() == 64);
+	CHECK(harness.store.WasEvicted(TYPE, 100));
+
+	// Every live entry holds exactly one reference, evicted ones none
+	CHECK(harness.References() == static_cast<int>(harness.store.GetCount()));
+	const auto stats = harness.store.GetBytecodeStats(TYPE);
+	CHECK(stats.descriptors <= harness.store.GetCount());
+	CHECK(stats.savedBytes <= harness.store.GetCount() * BYTECODE_SIZE);
+
+	// Once nothing is drawn for long enough, the store shrinks to the budget
+	frame += MIN_AGE;
+	harness.Evict(frame, MIN_AGE, BUDGET);
+	CHECK(harness.store.GetBytes() <= BUDGET);
+
+	harness.store.Clear([](FakeShader& a_shader) { a_shader.shader->Release(); });
+	CHECK(harness.store.GetBytes() == 0);
+	CHECK(harness.References() == 0);
+	CHECK_FALSE(harness.store.WasEvicted(TYPE, 100));
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+// Stand-in for CSimpleIniA (brofield/simpleini) when the real header is not installed on the host.
+// Covers the calls engine-free units make and follows the library where they depend on it:
+// case-insensitive sections and keys, trimmed values, ';' and '#' comments, the last duplicate key
+// winning unless SetMultiKey is set, and the GetBoolValue/GetDoubleValue parsing rules.
+
+enum SI_Error
+{
+	SI_OK = 0,
+	SI_UPDATED = 1,
+	SI_INSERTED = 2,
+	SI_FAIL = -1,
+	SI_NOMEM = -2,
+	SI_FILE = -3
+};
+
+class CSimpleIniA
+{
+public:
+	void SetUnicode(bool a_isUtf8 = true) { isUtf8 = a_isUtf8; }
+	void SetMultiKey(bool a_allowMultiKey = true) { allowMultiKey = a_allowMultiKey; }
+
+	SI_Error LoadFile(const char* a_path)
+	{
+		std::error_code error;
+		std::ifstream file(a_path, std::ios::binary);
+		if (!file || !std::filesystem::is_regular_file(a_path, error))
+			return SI_FILE;
+		std::string data{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+		std::string_view text = data;
+		if (isUtf8 && text.starts_with("\xEF\xBB\xBF"))
+			text.remove_prefix(3);
+
+		std::string section;
+		while (!text.empty()) {
+			auto end = text.find_first_of("\r\n");
+			auto line = Trim(text.substr(0, end));
+			text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+			if (line.empty() || line.front() == ';' || line.front() == '#')
+				continue;
+			if (line.front() == '[') {
+				auto close = line.find(']');
+				if (close != std::string_view::npos)
+					section = Lower(Trim(line.substr(1, close - 1)));
+				continue;
+			}
+			auto equals = line.find('=');
+			if (equals == std::string_view::npos)
+				continue;
+			auto& values = sections[section][Lower(Trim(line.substr(0, equals)))];
+			if (!allowMultiKey)
+				values.clear();
+			values.emplace_back(Trim(line.substr(equals + 1)));
+		}
+		return SI_OK;
+	}
+
+	const char* GetValue(const char* a_section, const char* a_key, const char* a_default = nullptr) const
+	{
+		auto sectionIt = sections.find(Lower(a_section));
+		if (sectionIt == sections.end())
+			return a_default;
+		auto keyIt = sectionIt->second.find(Lower(a_key));
+		if (keyIt == sectionIt->second.end())
+			return a_default;
+		return keyIt->second.front().c_str();
+	}
+
+	bool GetBoolValue(const char* a_section, const char* a_key, bool a_default = false) const
+	{
+		const char* value = GetValue(a_section, a_key);
+		if (!value || !*value)
+			return a_default;
+		switch (value[0]) {
+		case 't':
+		case 'T':
+		case 'y':
+		case 'Y':
+		case '1':
+			return true;
+		case 'f':
+		case 'F':
+		case 'n':
+		case 'N':
+		case '0':
+			return false;
+		case 'o':
+		case 'O':
+			if (value[1] == 'n' || value[1] == 'N')
+				return true;
+			if (value[1] == 'f' || value[1] == 'F')
+				return false;
+			break;
+		}
+		return a_default;
+	}
+
+	double GetDoubleValue(const char* a_section, const char* a_key, double a_default = 0) const
+	{
+		const char* value = GetValue(a_section, a_key);
+		if (!value || !*value)
+			return a_default;
+		char* end = nullptr;
+		double result = strtod(value, &end);
+		return end == value ? a_default : result;
+	}
+
+private:
+	static std::string_view Trim(std::string_view a_text)
+	{
+		constexpr std::string_view whitespace = " \t";
+		auto first = a_text.find_first_not_of(whitespace);
+		if (first == std::string_view::npos)
+			return {};
+		return a_text.substr(first, a_text.find_last_not_of(whitespace) - first + 1);
+	}
+
+	static std::string Lower(std::string_view a_text)
+	{
+		std::string lower{ a_text };
+		std::ranges::transform(lower, lower.begin(), [](char a_char) { return static_cast<char>(::tolower(a_char)); });
+		return lower;
+	}
+
+	bool isUtf8 = false;
+	bool allowMultiKey = false;
+	std::unordered_map<std::string, std::unordered_map<std::string, std::vector<std::string>>> sections;
+};
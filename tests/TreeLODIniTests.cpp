@@ -0,0 +1,108 @@
+#include "Catch.h"
+
+#include "Features/DistantTreeLighting/TreeLODIni.h"
+#include "ScratchDirectory.h"
+
+namespace
+{
+	// A Data folder with the TreeLOD.ini files DynDOLOD generates, one per worldspace
+	class LODTree : public ScratchDirectory
+	{
+	public:
+		using ScratchDirectory::ScratchDirectory;
+
+		void WriteIni(std::string_view a_worldSpace, std::string_view a_contents) const
+		{
+			Write(TreeLODIni::GetPath({}, a_worldSpace), a_contents);
+		}
+
+		bool Read(std::string_view a_worldSpace) const { return TreeLODIni::ReadComplexAtlasTexture(root, a_worldSpace); }
+	};
+
+	std::string GeneratedIni(bool a_complex)
+	{
+		return "; Generated by DynDOLOD\n"
+		       "[Information]\n"
+		       "Version=3.00\n"
+		       "ComplexAtlasTexture=" +
+		       std::string(a_complex ? "true" : "false") +
+		       "\n"
+		       "[Atlas]\n"
+		       "Width=8192\n";
+	}
+}
+
+TEST_CASE("TreeLODIni builds the DynDOLOD path", "[TreeLODIni]")
+{
+	CHECK(TreeLODIni::GetPath("Data", "Tamriel") == std::filesystem::path("Data") / "Textures" / "Terrain" / "Tamriel" / "Trees" / "TamrielTreeLOD.ini");
+}
+
+TEST_CASE("TreeLODIni reads the flag of each worldspace", "[TreeLODIni]")
+{
+	LODTree tree("TreeLODIniGenerated");
+	std::vector<std::string> worldSpaces;
+	for (int i = 0; i < 64; i++) {
+		worldSpaces.push_back("WorldSpace" + std::to_string(i));
+		tree.WriteIni(worldSpaces.back(), GeneratedIni(i % 3 == 0));
+	}
+
+	for (int i = 0; i < 64; i++)
+		CHECK(tree.Read(worldSpaces[i]) == (i % 3 == 0));
+}
+
+TEST_CASE("TreeLODIni treats missing inis as simple atlases", "[TreeLODIni]")
+{
+	LODTree tree("TreeLODIniMissing");
+	tree.WriteIni("Tamriel", GeneratedIni(true));
+
+	CHECK_FALSE(tree.Read("DLC2SolstheimWorld"));
+	CHECK_FALSE(tree.Read(""));
+	CHECK_FALSE(TreeLODIni::ReadComplexAtlasTexture(tree.root / "Missing", "Tamriel"));
+
+	// A folder where the ini should be cannot be read either
+	std::filesystem::create_directories(TreeLODIni::GetPath(tree.root, "Blackreach"));
+	CHECK_FALSE(tree.Read("Blackreach"));
+}
+
+TEST_CASE("TreeLODIni falls back on malformed values", "[TreeLODIni]")
+{
+	LODTree tree("TreeLODIniMalformed");
+	auto read = [&](std::string_view a_contents) {
+		tree.WriteIni("Tamriel", a_contents);
+		return tree.Read("Tamriel");
+	};
+
+	CHECK(read("[Information]\nComplexAtlasTexture=1\n"));
+	CHECK(read("[Information]\nComplexAtlasTexture = yes\n"));
+	CHECK(read("[Information]\r\nComplexAtlasTexture=on\r\n"));
+	CHECK(read("\xEF\xBB\xBF[Information]\nComplexAtlasTexture=true\n"));
+	CHECK_FALSE(read("[Information]\nComplexAtlasTexture=\n"));
+	CHECK_FALSE(read("[Information]\nComplexAtlasTexture=2\n"));
+	CHECK_FALSE(read("[Information]\nComplexAtlasTexture=maybe\n"));
+	CHECK_FALSE(read("[Information]\n;ComplexAtlasTexture=true\n"));
+	CHECK_FALSE(read("ComplexAtlasTexture=true\n"));
+	CHECK_FALSE(read("[Atlas]\nComplexAtlasTexture=true\n"));
+	CHECK_FALSE(read("[Information\nComplexAtlasTexture\n"));
+	CHECK_FALSE(read(""));
+	CHECK_FALSE(read(std::string("\0\x01\x02garbage", 10)));
+}
+
+TEST_CASE("TreeLODIni ignores case in the ini", "[TreeLODIni]")
+{
+	LODTree tree("TreeLODIniCase");
+	auto read = [&](std::string_view a_contents) {
+		tree.WriteIni("Tamriel", a_contents);
+		return tree.Read("Tamriel");
+	};
+
+	CHECK(read("[INFORMATION]\ncomplexatlastexture=TRUE\n"));
+	CHECK(read("[information]\nComplexAtlasTexture=True\n"));
+	CHECK(read("[Information]\nCOMPLEXATLASTEXTURE=Yes\n"));
+	CHECK_FALSE(read("[Information]\nComplexAtlasTexture=FALSE\n"));
+
+	// Editor IDs and folder names can differ in case, which only the game's file system ignores
+	tree.WriteIni("DLC01SoulCairn", GeneratedIni(true));
+	const bool caseInsensitive = std::filesystem::exists(TreeLODIni::GetPath(tree.root, "dlc01soulcairn"));
+	CHECK(tree.Read("dlc01soulcairn") == caseInsensitive);
+	CHECK(tree.Read("DLC01SoulCairn"));
+}
@@ -0,0 +1,201 @@
+#include "Catch.h"
+
+#include "Features/WetnessEffects/WetnessSimulation.h"
+
+namespace
+{
+	using WeatherType = WetnessSimulation::WeatherType;
+
+	constexpr double START_TIME = 100.0 * 86400.0;  // game time 0 means not started
+	constexpr double TIMESCALE = 20.0;              // game seconds per real second
+	constexpr float HOUR = 3600.0f;
+
+	// Wetness and puddle depth gained or lost per game hour, before the output clamps them to 1
+	constexpr float RAIN_WETNESS_PER_HOUR = 2.0f * WetnessSimulation::WETNESS_SCALE;
+	constexpr float RAIN_PUDDLE_PER_HOUR = 2.0f * WetnessSimulation::PUDDLE_SCALE;
+	constexpr float CLEAR_WETNESS_PER_HOUR = -1.518f * WetnessSimulation::WETNESS_SCALE;
+	constexpr float CLEAR_PUDDLE_PER_HOUR = -1.518f * WetnessSimulation::PUDDLE_SCALE;
+
+	WetnessSimulation::Input MakeInput(WeatherType a_type, double a_gameTime)
+	{
+		WetnessSimulation::Input input;
+		input.hasWeather = true;
+		input.currentWeather.id = static_cast<uint32_t>(a_type) + 1;
+		input.currentWeather.type = a_type;
+		input.currentWeather.raining = a_type == WeatherType::Rainy ? 1.0f : 0.0f;
+		input.gameTime = a_gameTime;
+		return input;
+	}
+
+	// Ticks at a_hz real frames per second for a_gameSeconds of game time
+	WetnessSimulation::Output Run(WetnessSimulation& a_simulation, double& a_gameTime, WeatherType a_type, double a_gameSeconds, double a_hz)
+	{
+		const auto frames = static_cast<uint64_t>(std::llround(a_gameSeconds / TIMESCALE * a_hz));
+		const double start = a_gameTime;
+		WetnessSimulation::Output output;
+		for (uint64_t frame = 1; frame <= frames; frame++)
+			output = a_simulation.Tick(MakeInput(a_type, start + frame * TIMESCALE / a_hz));
+		a_gameTime = start + a_gameSeconds;
+		return output;
+	}
+}
+
+TEST_CASE("WetnessSimulation ramps up in rain and dries when clear", "[WetnessSimulation]")
+{
+	WetnessSimulation simulation;
+	double gameTime = START_TIME;
+	auto output = simulation.Tick(MakeInput(WeatherType::Clear, gameTime));
+	CHECK(output.wetness == 0.0f);
+	CHECK(output.puddleWetness == 0.0f);
+
+	output = Run(simulation, gameTime, WeatherType::Rainy, 0.1 * HOUR, 60.0);
+	CHECK(output.raining == 1.0f);
+	CHECK(output.wetness == Catch::Approx(0.1f * RAIN_WETNESS_PER_HOUR).margin(1e-3));
+	CHECK(output.puddleWetness == Catch::Approx(0.1f * RAIN_PUDDLE_PER_HOUR).margin(1e-3));
+
+	// Both depths saturate after an hour of rain
+	output = Run(simulation, gameTime, WeatherType::Rainy, HOUR, 60.0);
+	CHECK(output.wetness == 1.0f);
+	CHECK(output.puddleWetness == 1.0f);
+	CHECK(simulation.GetWetnessDepth() == Catch::Approx(2.0f));
+	CHECK(simulation.GetPuddleDepth() == Catch::Approx(1.1f * RAIN_PUDDLE_PER_HOUR).margin(1e-3));
+
+	// Surfaces dry faster than puddles
+	output = Run(simulation, gameTime, WeatherType::Clear, 0.5 * HOUR, 60.0);
+	CHECK(output.raining == 0.0f);
+	CHECK(output.wetness == Catch::Approx(2.0f + 0.5f * CLEAR_WETNESS_PER_HOUR).margin(1e-3));
+	CHECK(output.puddleWetness == 1.0f);
+
+	output = Run(simulation, gameTime, WeatherType::Clear, 0.5 * HOUR, 60.0);
+	CHECK(output.wetness == 0.0f);
+	CHECK(output.puddleWetness == Catch::Approx(1.1f * RAIN_PUDDLE_PER_HOUR + CLEAR_PUDDLE_PER_HOUR).margin(1e-3));
+
+	output = Run(simulation, gameTime, WeatherType::Clear, 2.0 * HOUR, 60.0);
+	CHECK(output.wetness == 0.0f);
+	CHECK(output.puddleWetness == 0.0f);
+}
+
+TEST_CASE("WetnessSimulation snaps to the weather after a day or more", "[WetnessSimulation]")
+{
+	WetnessSimulation simulation;
+	simulation.Tick(MakeInput(WeatherType::Clear, START_TIME));
+
+	auto output = simulation.Tick(MakeInput(WeatherType::Rainy, START_TIME + 86400.0));
+	CHECK(simulation.GetLastStepCount() == 0);
+	CHECK(output.wetness == 1.0f);
+	CHECK(output.puddleWetness == 1.0f);
+	CHECK(simulation.GetWetnessDepth() == 2.0f);
+	CHECK(simulation.GetPuddleDepth() == 3.0f);
+
+	output = simulation.Tick(MakeInput(WeatherType::Cloudy, START_TIME + 10 * 86400.0));
+	CHECK(output.wetness == 0.0f);
+	CHECK(output.puddleWetness == 0.0f);
+
+	// Going back a day or more snaps too
+	simulation.Tick(MakeInput(WeatherType::Rainy, START_TIME));
+	CHECK(simulation.GetPuddleDepth() == 3.0f);
+}
+
+TEST_CASE("WetnessSimulation handles time going backwards", "[WetnessSimulation]")
+{
+	WetnessSimulation simulation;
+	double gameTime = START_TIME;
+	simulation.Tick(MakeInput(WeatherType::Rainy, gameTime));
+	Run(simulation, gameTime, WeatherType::Rainy, 0.25 * HOUR, 30.0);
+	const float puddleDepth = simulation.GetPuddleDepth();
+	REQUIRE(puddleDepth > 0.0f);
+
+	// Loading a save ten minutes earlier in the same rain takes the rain of those minutes back out
+	gameTime -= 600.0;
+	auto output = simulation.Tick(MakeInput(WeatherType::Rainy, gameTime));
+	CHECK(simulation.GetLastStepCount() == 1);
+	CHECK(simulation.GetPuddleDepth() == Catch::Approx(puddleDepth - 600.0f / HOUR * RAIN_PUDDLE_PER_HOUR).margin(1e-4));
+	CHECK(output.puddleWetness >= 0.0f);
+
+	// The time that was jumped over is not caught up afterwards
+	output = simulation.Tick(MakeInput(WeatherType::Rainy, gameTime + 1.0));
+	CHECK(simulation.GetLastStepCount() == 1);
+
+	// Nothing to take back from dry surfaces
+	WetnessSimulation dry;
+	dry.Tick(MakeInput(WeatherType::Clear, START_TIME));
+	output = dry.Tick(MakeInput(WeatherType::Clear, START_TIME - 600.0));
+	CHECK(dry.GetLastStepCount() == 0);
+	CHECK(output.wetness == 0.0f);
+	CHECK(output.puddleWetness == 0.0f);
+}
+
+TEST_CASE("WetnessSimulation output does not depend on the frame rate", "[WetnessSimulation]")
+{
+	WetnessSimulation slow, fast;
+	double slowTime = START_TIME, fastTime = START_TIME;
+	slow.Tick(MakeInput(WeatherType::Clear, slowTime));
+	fast.Tick(MakeInput(WeatherType::Clear, fastTime));
+
+	// Equal up to one step that one side may not have taken yet
+	constexpr float STEP_WETNESS = RAIN_WETNESS_PER_HOUR / HOUR * static_cast<float>(WetnessSimulation::STEP_SECONDS);
+	const std::pair<WeatherType, double> phases[] = {
+		{ WeatherType::Rainy, 0.2 * HOUR },
+		{ WeatherType::Cloudy, 0.1 * HOUR },
+		{ WeatherType::Rainy, 0.3 * HOUR },
+		{ WeatherType::Clear, 0.4 * HOUR },
+	};
+	for (const auto& [type, seconds] : phases) {
+		const auto slowOutput = Run(slow, slowTime, type, seconds, 30.0);
+		const auto fastOutput = Run(fast, fastTime, type, seconds, 144.0);
+		INFO("weather " << static_cast<int>(type));
+		CHECK(slowOutput.wetness == Catch::Approx(fastOutput.wetness).margin(STEP_WETNESS));
+		CHECK(slowOutput.puddleWetness == Catch::Approx(fastOutput.puddleWetness).margin(STEP_WETNESS));
+		CHECK(slowOutput.raining == fastOutput.raining);
+	}
+	CHECK(slow.GetWetnessDepth() > 0.0f);
+}
+
+TEST_CASE("WetnessSimulation caps the steps of a large time delta", "[WetnessSimulation]")
+{
+	WetnessSimulation capped, stepped;
+	capped.Tick(MakeInput(WeatherType::Rainy, START_TIME));
+	stepped.Tick(MakeInput(WeatherType::Rainy, START_TIME));
+
+	capped.Tick(MakeInput(WeatherType::Rainy, START_TIME + 10.5));
+	CHECK(capped.GetLastStepCount() == 10);
+
+	// 1440 seconds of rain take MAX_STEPS longer steps, and end where one second steps end
+	constexpr double delta = 0.4 * HOUR;
+	capped.Tick(MakeInput(WeatherType::Rainy, START_TIME + 10.5 + delta));
+	CHECK(capped.GetLastStepCount() <= WetnessSimulation::MAX_STEPS);
+	CHECK(capped.GetLastStepCount() >= WetnessSimulation::MAX_STEPS - 1);
+
+	double gameTime = START_TIME;
+	Run(stepped, gameTime, WeatherType::Rainy, 10.0, TIMESCALE);
+	gameTime = START_TIME + 10.5;
+	stepped.Tick(MakeInput(WeatherType::Rainy, gameTime));
+	Run(stepped, gameTime, WeatherType::Rainy, delta, TIMESCALE);
+	REQUIRE(stepped.GetWetnessDepth() < 2.0f);
+	CHECK(capped.GetWetnessDepth() == Catch::Approx(stepped.GetWetnessDepth()).margin(1e-3));
+	CHECK(capped.GetPuddleDepth() == Catch::Approx(stepped.GetPuddleDepth()).margin(1e-3));
+
+	// Half a day, just below the snap, is still capped
+	capped.Tick(MakeInput(WeatherType::Clear, START_TIME + 10.5 + delta + 12.0 * HOUR));
+	CHECK(capped.GetLastStepCount() <= WetnessSimulation::MAX_STEPS);
+	CHECK(capped.GetWetnessDepth() == 0.0f);
+}
+
+TEST_CASE("WetnessSimulation benchmark", "[.][benchmark][WetnessSimulation]")
+{
+	WetnessSimulation simulation;
+	double gameTime = START_TIME;
+	simulation.Tick(MakeInput(WeatherType::Rainy, gameTime));
+
+	BENCHMARK("Tick at 144 Hz")
+	{
+		gameTime += TIMESCALE / 144.0;
+		return simulation.Tick(MakeInput(WeatherType::Rainy, gameTime)).wetness;
+	};
+
+	BENCHMARK("Tick after a 12 hour wait")
+	{
+		gameTime += 12.0 * HOUR;
+		return simulation.Tick(MakeInput(WeatherType::Rainy, gameTime)).wetness;
+	};
+}